@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include "audio_core/audio_core.h"
@@ -11,6 +12,7 @@
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "core/core_timing.h"
+#include "core/settings.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/hle/service/dsp_dsp.h"
 
@@ -34,6 +36,10 @@ static void AudioTickCallback(u64 /*userdata*/, int cycles_late) {
 
 void Init() {
     DSP::HLE::Init();
+    // Offline rendering can't drop frames when the queue is full, the frames are output directly
+    if (Settings::values.use_audio_thread && !Settings::values.audio_offline_rendering) {
+        DSP::HLE::StartAudioThread(std::max<size_t>(Settings::values.audio_queue_depth, 1));
+    }
 
     tick_event = CoreTiming::RegisterEvent("AudioCore::tick_event", AudioTickCallback);
     CoreTiming::ScheduleEvent(audio_frame_ticks, tick_event);
@@ -69,4 +75,8 @@ void Shutdown() {
     DSP::HLE::Shutdown();
 }
 
+void DoState(PointerWrap& p) {
+    DSP::HLE::DoState(p);
+}
+
 } // namespace AudioCore
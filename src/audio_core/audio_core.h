@@ -6,6 +6,8 @@
 
 #include <string>
 
+class PointerWrap;
+
 namespace Kernel {
 class VMManager;
 }
@@ -29,4 +31,7 @@ void EnableStretching(bool enable);
 /// Shutdown Audio Core
 void Shutdown();
 
+/// Saves or loads the state of the emulated DSP
+void DoState(PointerWrap& p);
+
 } // namespace
@@ -0,0 +1,205 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "audio_core/audio_core.h"
+#include "audio_core/capture_sink.h"
+#include "audio_core/hle/common.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "common/thread.h"
+#include "common/threadsafe_queue.h"
+
+namespace AudioCore {
+
+/// Number of stereo samples handed to the writer thread at once
+static constexpr size_t chunk_samples = 4096;
+
+struct WavHeader {
+    std::array<char, 4> riff_id;
+    u32_le riff_size;
+    std::array<char, 4> wave_id;
+    std::array<char, 4> fmt_id;
+    u32_le fmt_size;
+    u16_le format;
+    u16_le channels;
+    u32_le sample_rate;
+    u32_le byte_rate;
+    u16_le block_align;
+    u16_le bits_per_sample;
+    std::array<char, 4> data_id;
+    u32_le data_size;
+};
+static_assert(sizeof(WavHeader) == 44, "WavHeader has incorrect size");
+
+static WavHeader MakeWavHeader(u32 data_size) {
+    constexpr u32 channels = 2;
+    constexpr u32 bytes_per_sample = sizeof(s16);
+
+    WavHeader header;
+    header.riff_id = {{'R', 'I', 'F', 'F'}};
+    header.riff_size = static_cast<u32>(sizeof(WavHeader) - 8 + data_size);
+    header.wave_id = {{'W', 'A', 'V', 'E'}};
+    header.fmt_id = {{'f', 'm', 't', ' '}};
+    header.fmt_size = 16;
+    header.format = 1; // PCM
+    header.channels = channels;
+    header.sample_rate = native_sample_rate;
+    header.byte_rate = native_sample_rate * channels * bytes_per_sample;
+    header.block_align = channels * bytes_per_sample;
+    header.bits_per_sample = bytes_per_sample * 8;
+    header.data_id = {{'d', 'a', 't', 'a'}};
+    header.data_size = data_size;
+    return header;
+}
+
+struct CaptureSink::Impl {
+    FileUtil::IOFile file;
+    FileUtil::IOFile hash_file;
+    bool is_wav = false;
+
+    /// Samples not handed to the writer thread yet, only accessed by the producer
+    std::vector<s16> chunk;
+
+    Common::SPSCQueue<std::vector<s16>> write_queue;
+    Common::Event chunks_available;
+    std::atomic<bool> stop_writer{false};
+    std::unique_ptr<std::thread> writer;
+
+    // Only accessed by the writer thread
+    u64 bytes_written = 0;
+    std::vector<s16> partial_frame;
+    u64 frame_count = 0;
+    u64 combined_hash = 0;
+
+    void Write(const std::vector<s16>& samples);
+    void HashFrame(const s16* frame);
+    void RunWriter();
+};
+
+void CaptureSink::Impl::HashFrame(const s16* frame) {
+    constexpr size_t frame_size = DSP::HLE::samples_per_frame * 2 * sizeof(s16);
+    const u64 hash = Common::ComputeHash64(frame, frame_size);
+
+    const std::array<u64, 2> hashes = {{combined_hash, hash}};
+    combined_hash = Common::ComputeHash64(hashes.data(), sizeof(hashes));
+
+    std::array<char, 40> line;
+    const int length = std::snprintf(line.data(), line.size(), "%" PRIu64 " %016" PRIx64 "\n",
+                                     frame_count, hash);
+    hash_file.WriteBytes(line.data(), length);
+    frame_count++;
+}
+
+void CaptureSink::Impl::Write(const std::vector<s16>& samples) {
+    if (file.IsOpen()) {
+        bytes_written += file.WriteArray(samples.data(), samples.size()) * sizeof(s16);
+    }
+
+    if (!hash_file.IsOpen())
+        return;
+
+    // Frames are hashed regardless of how the samples were split by EnqueueSamples
+    constexpr size_t frame_values = DSP::HLE::samples_per_frame * 2;
+    size_t position = 0;
+    if (!partial_frame.empty()) {
+        const size_t needed = std::min(frame_values - partial_frame.size(), samples.size());
+        partial_frame.insert(partial_frame.end(), samples.begin(), samples.begin() + needed);
+        position = needed;
+        if (partial_frame.size() < frame_values)
+            return;
+        HashFrame(partial_frame.data());
+        partial_frame.clear();
+    }
+    for (; position + frame_values <= samples.size(); position += frame_values) {
+        HashFrame(&samples[position]);
+    }
+    partial_frame.assign(samples.begin() + position, samples.end());
+}
+
+void CaptureSink::Impl::RunWriter() {
+    Common::SetCurrentThreadName("AudioCapture");
+
+    while (true) {
+        std::vector<s16> samples;
+        while (write_queue.Pop(samples)) {
+            Write(samples);
+        }
+
+        // Checked after emptying the queue, the chunks pushed before the request are written
+        if (stop_writer.load(std::memory_order_acquire) && write_queue.Empty())
+            return;
+        chunks_available.Wait();
+    }
+}
+
+CaptureSink::CaptureSink(const std::string& path) : impl(std::make_unique<Impl>()) {
+    const std::string extension = path.size() >= 4 ? path.substr(path.size() - 4) : "";
+    impl->is_wav = extension == ".wav" || extension == ".WAV";
+
+    if (!impl->file.Open(path, "wb")) {
+        LOG_ERROR(Audio_Sink, "Could not open audio capture file %s, samples are discarded",
+                  path.c_str());
+    } else if (impl->is_wav) {
+        // The sizes are written once they are known, when the sink is destroyed
+        impl->file.WriteObject(MakeWavHeader(0));
+    }
+
+    const std::string hash_path = path + ".hashes";
+    if (!impl->hash_file.Open(hash_path, "w")) {
+        LOG_ERROR(Audio_Sink, "Could not open audio hash file %s", hash_path.c_str());
+    }
+
+    impl->chunk.reserve(chunk_samples * 2);
+    impl->writer = std::make_unique<std::thread>([this] { impl->RunWriter(); });
+
+    LOG_INFO(Audio_Sink, "Capturing audio to %s", path.c_str());
+}
+
+CaptureSink::~CaptureSink() {
+    if (!impl->chunk.empty()) {
+        impl->write_queue.Push(std::move(impl->chunk));
+    }
+    impl->stop_writer.store(true, std::memory_order_release);
+    impl->chunks_available.Set();
+    impl->writer->join();
+
+    if (impl->is_wav && impl->file.IsOpen()) {
+        impl->file.Seek(0, SEEK_SET);
+        impl->file.WriteObject(MakeWavHeader(static_cast<u32>(impl->bytes_written)));
+    }
+
+    LOG_INFO(Audio_Sink, "Captured %" PRIu64 " audio frames, hash %016" PRIx64, impl->frame_count,
+             impl->combined_hash);
+}
+
+unsigned int CaptureSink::GetNativeSampleRate() const {
+    return native_sample_rate;
+}
+
+void CaptureSink::EnqueueSamples(const s16* samples, size_t sample_count) {
+    impl->chunk.insert(impl->chunk.end(), samples, samples + sample_count * 2);
+    if (impl->chunk.size() < chunk_samples * 2)
+        return;
+
+    impl->write_queue.Push(std::move(impl->chunk));
+    impl->chunks_available.Set();
+    impl->chunk = std::vector<s16>();
+    impl->chunk.reserve(chunk_samples * 2);
+}
+
+size_t CaptureSink::SamplesInQueue() const {
+    // The writer thread never makes the emulation wait
+    return 0;
+}
+
+} // namespace AudioCore
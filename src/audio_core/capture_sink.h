@@ -0,0 +1,45 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include "audio_core/sink.h"
+
+namespace AudioCore {
+
+/**
+ * Sink writing the samples to a file instead of playing them, for regression tests and benchmarks
+ * without a sound device. The file is a WAV file if its name ends with ".wav", and raw interleaved
+ * stereo PCM16 otherwise. A hash of every frame of samples_per_frame samples is written to a text
+ * file next to it, with ".hashes" appended to the name, to compare runs frame by frame.
+ *
+ * The samples are written by a background thread, EnqueueSamples only copies them. The sink never
+ * has samples waiting to be played, so it doesn't slow down emulation.
+ */
+class CaptureSink final : public Sink {
+public:
+    explicit CaptureSink(const std::string& path);
+    ~CaptureSink() override;
+
+    unsigned int GetNativeSampleRate() const override;
+
+    void EnqueueSamples(const s16* samples, size_t sample_count) override;
+
+    size_t SamplesInQueue() const override;
+
+    void SetDevice(int device_id) override {}
+
+    std::vector<std::string> GetDeviceList() const override {
+        return {};
+    }
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+} // namespace AudioCore
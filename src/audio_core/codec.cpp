@@ -15,6 +15,30 @@ namespace Codec {
 
 StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
                            const std::array<s16, 16>& adpcm_coeff, ADPCMState& state) {
+    const size_t ret_size =
+        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
+    StereoBuffer16 ret(ret_size);
+    DecodeADPCM(data, 0, ret_size, adpcm_coeff, state, ret.data());
+    return ret;
+}
+
+StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
+                          const size_t sample_count) {
+    StereoBuffer16 ret(sample_count);
+    DecodePCM8(num_channels, data, 0, sample_count, ret.data());
+    return ret;
+}
+
+StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
+                           const size_t sample_count) {
+    StereoBuffer16 ret(sample_count);
+    DecodePCM16(num_channels, data, 0, sample_count, ret.data());
+    return ret;
+}
+
+void DecodeADPCM(const u8* const data, const size_t first_sample, const size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state,
+                 std::array<s16, 2>* output) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
@@ -24,16 +48,14 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
     constexpr std::array<int, 16> SIGNED_NIBBLES = {
         {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
 
-    const size_t ret_size =
-        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    StereoBuffer16 ret(ret_size);
-
     int yn1 = state.yn1, yn2 = state.yn2;
 
-    const size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
+    size_t framei = first_sample / SAMPLES_PER_FRAME;
+    size_t samplei = first_sample % SAMPLES_PER_FRAME;
+    size_t outputi = 0;
+    while (outputi < sample_count) {
+        const u8* const frame = data + framei * FRAME_LEN;
+        const int frame_header = frame[0];
         const int scale = 1 << (frame_header & 0xF);
         const int idx = (frame_header >> 4) & 0x7;
 
@@ -41,8 +63,10 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
         const int coef1 = adpcm_coeff[idx * 2 + 0];
         const int coef2 = adpcm_coeff[idx * 2 + 1];
 
-        // Decodes an audio sample. One nibble produces one sample.
-        const auto decode_sample = [&](const int nibble) -> s16 {
+        // One nibble produces one sample, the high nibble of each byte comes first.
+        for (; samplei < SAMPLES_PER_FRAME && outputi < sample_count; samplei++, outputi++) {
+            const u8 byte = frame[1 + samplei / 2];
+            const int nibble = SIGNED_NIBBLES[samplei % 2 == 0 ? byte >> 4 : byte & 0xF];
             const int xn = nibble * scale;
             // We first transform everything into 11 bit fixed point, perform the second order
             // digital filter, then transform back.
@@ -54,28 +78,15 @@ StereoBuffer16 DecodeADPCM(const u8* const data, const size_t sample_count,
             // Advance output feedback.
             yn2 = yn1;
             yn1 = val;
-            return (s16)val;
-        };
-
-        size_t outputi = framei * SAMPLES_PER_FRAME;
-        size_t datai = framei * FRAME_LEN + 1;
-        for (size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi].fill(sample1);
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi].fill(sample2);
-            outputi++;
-
-            datai++;
+            output[outputi].fill(static_cast<s16>(val));
         }
+
+        samplei = 0;
+        framei++;
     }
 
     state.yn1 = yn1;
     state.yn2 = yn2;
-
-    return ret;
 }
 
 static s16 SignExtendS8(u8 x) {
@@ -84,42 +95,36 @@ static s16 SignExtendS8(u8 x) {
     return static_cast<s16>(static_cast<s8>(x));
 }
 
-StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
-                          const size_t sample_count) {
+void DecodePCM8(const unsigned num_channels, const u8* const data, const size_t first_sample,
+                const size_t sample_count, std::array<s16, 2>* output) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    StereoBuffer16 ret(sample_count);
-
+    const u8* const input = data + first_sample * num_channels;
     if (num_channels == 1) {
         for (size_t i = 0; i < sample_count; i++) {
-            ret[i].fill(SignExtendS8(data[i]));
+            output[i].fill(SignExtendS8(input[i]));
         }
     } else {
         for (size_t i = 0; i < sample_count; i++) {
-            ret[i][0] = SignExtendS8(data[i * 2 + 0]);
-            ret[i][1] = SignExtendS8(data[i * 2 + 1]);
+            output[i][0] = SignExtendS8(input[i * 2 + 0]);
+            output[i][1] = SignExtendS8(input[i * 2 + 1]);
         }
     }
-
-    return ret;
 }
 
-StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
-                           const size_t sample_count) {
+void DecodePCM16(const unsigned num_channels, const u8* const data, const size_t first_sample,
+                 const size_t sample_count, std::array<s16, 2>* output) {
     ASSERT(num_channels == 1 || num_channels == 2);
 
-    StereoBuffer16 ret(sample_count);
-
+    const u8* const input = data + first_sample * num_channels * sizeof(s16);
     if (num_channels == 1) {
         for (size_t i = 0; i < sample_count; i++) {
             s16 sample;
-            std::memcpy(&sample, data + i * sizeof(s16), sizeof(s16));
-            ret[i].fill(sample);
+            std::memcpy(&sample, input + i * sizeof(s16), sizeof(s16));
+            output[i].fill(sample);
         }
     } else {
-        std::memcpy(ret.data(), data, sample_count * 2 * sizeof(u16));
+        std::memcpy(output, input, sample_count * 2 * sizeof(u16));
     }
-
-    return ret;
 }
 };
@@ -48,4 +48,43 @@ StereoBuffer16 DecodePCM8(const unsigned num_channels, const u8* const data,
  */
 StereoBuffer16 DecodePCM16(const unsigned num_channels, const u8* const data,
                            const size_t sample_count);
+
+// The following decode part of a buffer into a caller-provided array, so that a buffer can be
+// decoded a few samples at a time as it plays.
+
+/**
+ * Decodes part of an ADPCM buffer. The parts must be decoded in order, as each sample depends on
+ * the previous ones through the state.
+ * @param data Pointer to the start of the buffer that contains ADPCM data
+ * @param first_sample Index of the first sample to decode
+ * @param sample_count Number of samples to decode
+ * @param adpcm_coeff ADPCM coefficients
+ * @param state ADPCM state, this is updated with new state
+ * @param output Receives sample_count decoded stereo samples
+ */
+void DecodeADPCM(const u8* const data, const size_t first_sample, const size_t sample_count,
+                 const std::array<s16, 16>& adpcm_coeff, ADPCMState& state,
+                 std::array<s16, 2>* output);
+
+/**
+ * Decodes part of a PCM8 buffer.
+ * @param num_channels Number of channels
+ * @param data Pointer to the start of the buffer that contains PCM8 data
+ * @param first_sample Index of the first sample to decode
+ * @param sample_count Number of samples to decode
+ * @param output Receives sample_count decoded stereo samples
+ */
+void DecodePCM8(const unsigned num_channels, const u8* const data, const size_t first_sample,
+                const size_t sample_count, std::array<s16, 2>* output);
+
+/**
+ * Decodes part of a PCM16 buffer.
+ * @param num_channels Number of channels
+ * @param data Pointer to the start of the buffer that contains PCM16 data
+ * @param first_sample Index of the first sample to decode
+ * @param sample_count Number of samples to decode
+ * @param output Receives sample_count decoded stereo samples
+ */
+void DecodePCM16(const unsigned num_channels, const u8* const data, const size_t first_sample,
+                 const size_t sample_count, std::array<s16, 2>* output);
 };
@@ -3,13 +3,22 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
+#include <cinttypes>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/mixers.h"
 #include "audio_core/hle/pipe.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/sink.h"
 #include "audio_core/time_stretch.h"
+#include "common/assert.h"
+#include "common/chunk_file.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "common/threadsafe_queue.h"
 
 namespace DSP {
 namespace HLE {
@@ -85,6 +94,8 @@ static StereoFrame16 GenerateCurrentFrame() {
 
 // Audio output
 
+/// Guards the output state below, which is used by the audio thread when it is running
+static std::mutex output_mutex;
 static bool perform_time_stretching = true;
 static std::unique_ptr<AudioCore::Sink> sink;
 static AudioCore::TimeStretcher time_stretcher;
@@ -117,6 +128,7 @@ static void OutputCurrentFrame(const StereoFrame16& frame) {
 }
 
 void EnableStretching(bool enable) {
+    std::lock_guard<std::mutex> lock(output_mutex);
     if (perform_time_stretching == enable)
         return;
 
@@ -126,6 +138,73 @@ void EnableStretching(bool enable) {
     perform_time_stretching = enable;
 }
 
+// Audio thread
+
+static std::unique_ptr<std::thread> audio_thread;
+/// Frames generated by the emulation thread, only allocated while the audio thread is running
+static std::unique_ptr<Common::BoundedSPSCQueue<StereoFrame16>> frame_queue;
+static Common::Event frames_available;
+static std::atomic<bool> stop_audio_thread{false};
+
+static std::atomic<u64> queue_overruns{0};
+static std::atomic<u64> queue_underruns{0};
+
+static void RunAudioThread() {
+    Common::SetCurrentThreadName("AudioThread");
+
+    // The sink is empty before the first frame, which isn't an underrun
+    bool started = false;
+    while (true) {
+        StereoFrame16 frame;
+        while (frame_queue->Pop(frame)) {
+            std::lock_guard<std::mutex> lock(output_mutex);
+            if (started && sink->SamplesInQueue() == 0) {
+                queue_underruns.fetch_add(1, std::memory_order_relaxed);
+            }
+            started = true;
+            OutputCurrentFrame(frame);
+        }
+
+        // Checked after emptying the queue, the frames pushed before the request are output
+        if (stop_audio_thread.load(std::memory_order_acquire) && frame_queue->Empty())
+            return;
+        frames_available.Wait();
+    }
+}
+
+void StartAudioThread(size_t queue_depth) {
+    ASSERT(audio_thread == nullptr);
+    ASSERT(queue_depth > 0);
+
+    frame_queue = std::make_unique<Common::BoundedSPSCQueue<StereoFrame16>>(queue_depth);
+    queue_overruns = 0;
+    queue_underruns = 0;
+    stop_audio_thread = false;
+    audio_thread = std::make_unique<std::thread>(RunAudioThread);
+
+    LOG_INFO(Audio_DSP, "Audio thread started with a queue of %zu frames", queue_depth);
+}
+
+void StopAudioThread() {
+    if (audio_thread == nullptr)
+        return;
+
+    stop_audio_thread.store(true, std::memory_order_release);
+    frames_available.Set();
+    audio_thread->join();
+    audio_thread.reset();
+    frame_queue.reset();
+
+    const AudioQueueStats stats = GetAudioQueueStats();
+    LOG_INFO(Audio_DSP, "Audio thread stopped, %" PRIu64 " overruns, %" PRIu64 " underruns",
+             stats.overruns, stats.underruns);
+}
+
+AudioQueueStats GetAudioQueueStats() {
+    return {queue_overruns.load(std::memory_order_relaxed),
+            queue_underruns.load(std::memory_order_relaxed)};
+}
+
 // Public Interface
 
 void Init() {
@@ -137,6 +216,7 @@ void Init() {
 
     mixers.Reset();
 
+    std::lock_guard<std::mutex> lock(output_mutex);
     time_stretcher.Reset();
     if (sink) {
         time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
@@ -144,6 +224,9 @@ void Init() {
 }
 
 void Shutdown() {
+    StopAudioThread();
+
+    std::lock_guard<std::mutex> lock(output_mutex);
     if (perform_time_stretching) {
         FlushResidualStretcherAudio();
     }
@@ -156,12 +239,30 @@ bool Tick() {
     // shared memory region)
     current_frame = GenerateCurrentFrame();
 
-    OutputCurrentFrame(current_frame);
+    if (audio_thread != nullptr) {
+        if (frame_queue->TryPush(current_frame)) {
+            frames_available.Set();
+        } else {
+            queue_overruns.fetch_add(1, std::memory_order_relaxed);
+        }
+    } else {
+        std::lock_guard<std::mutex> lock(output_mutex);
+        OutputCurrentFrame(current_frame);
+    }
 
     return true;
 }
 
+void DoState(PointerWrap& p) {
+    PipesDoState(p);
+    for (auto& source : sources) {
+        source.DoState(p);
+    }
+    mixers.DoState(p);
+}
+
 void SetSink(std::unique_ptr<AudioCore::Sink> sink_) {
+    std::lock_guard<std::mutex> lock(output_mutex);
     sink = std::move(sink_);
     time_stretcher.SetOutputSampleRate(sink->GetNativeSampleRate());
 }
@@ -18,6 +18,8 @@ namespace AudioCore {
 class Sink;
 }
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 
@@ -576,5 +578,32 @@ void SetSink(std::unique_ptr<AudioCore::Sink> sink);
  */
 void EnableStretching(bool enable);
 
+/**
+ * Starts the audio thread. The frames generated by Tick are then passed to the audio thread through
+ * a lock-free queue, and the time stretching and the sink run there instead of on the emulation
+ * thread. A frame generated while the queue is full is dropped.
+ * @param queue_depth Number of frames the queue holds.
+ */
+void StartAudioThread(size_t queue_depth);
+
+/// Outputs the frames left in the queue and stops the audio thread
+void StopAudioThread();
+
+struct AudioQueueStats {
+    /// Frames dropped because the queue was full
+    u64 overruns;
+    /// Frames output after the sink ran out of samples to play
+    u64 underruns;
+};
+
+/// Returns the counters of the queue of the audio thread since it was started
+AudioQueueStats GetAudioQueueStats();
+
+/**
+ * Saves or loads the state of the DSP. The shared memory regions are saved with the address space
+ * they are mapped in, and the audio already sent to the sink isn't saved.
+ */
+void DoState(PointerWrap& p);
+
 } // namespace HLE
 } // namespace DSP
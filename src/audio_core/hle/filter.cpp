@@ -7,6 +7,7 @@
 #include "audio_core/hle/common.h"
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/filter.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/math_util.h"
 
@@ -17,6 +18,13 @@ void SourceFilters::Reset() {
     Enable(false, false);
 }
 
+void SourceFilters::DoState(PointerWrap& p) {
+    p.Do(simple_filter_enabled);
+    p.Do(biquad_filter_enabled);
+    p.DoVoid(&simple_filter, sizeof(simple_filter));
+    p.DoVoid(&biquad_filter, sizeof(biquad_filter));
+}
+
 void SourceFilters::Enable(bool simple, bool biquad) {
     simple_filter_enabled = simple;
     biquad_filter_enabled = biquad;
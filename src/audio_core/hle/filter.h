@@ -9,6 +9,8 @@
 #include "audio_core/hle/dsp.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 
@@ -49,6 +51,9 @@ public:
      */
     void ProcessFrame(StereoFrame16& frame);
 
+    /// Saves or loads the filter configuration and history
+    void DoState(PointerWrap& p);
+
 private:
     bool simple_filter_enabled;
     bool biquad_filter_enabled;
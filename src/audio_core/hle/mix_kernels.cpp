@@ -0,0 +1,114 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "audio_core/hle/mix_kernels.h"
+#include "common/math_util.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif // ARCHITECTURE_x86_64
+
+namespace DSP {
+namespace HLE {
+
+static s16 ClampToS16(s32 value) {
+    return static_cast<s16>(MathUtil::Clamp(value, -32768, 32767));
+}
+
+static void MixIntoGeneric(QuadFrame32& dest, const StereoFrame16& source,
+                           const std::array<float, 4>& gains) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        // Conversion from stereo (source) to quadraphonic (dest) occurs here.
+        dest[samplei][0] += static_cast<s32>(gains[0] * source[samplei][0]);
+        dest[samplei][1] += static_cast<s32>(gains[1] * source[samplei][1]);
+        dest[samplei][2] += static_cast<s32>(gains[2] * source[samplei][0]);
+        dest[samplei][3] += static_cast<s32>(gains[3] * source[samplei][1]);
+    }
+}
+
+static void DownmixStereoGeneric(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const auto& sample = samples[samplei];
+        s16 left = ClampToS16(static_cast<s32>(gain * sample[0] + gain * sample[2]));
+        s16 right = ClampToS16(static_cast<s32>(gain * sample[1] + gain * sample[3]));
+        dest[samplei][0] = ClampToS16(dest[samplei][0] + left);
+        dest[samplei][1] = ClampToS16(dest[samplei][1] + right);
+    }
+}
+
+static void DownmixMonoGeneric(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+        const auto& sample = samples[samplei];
+        s16 mono = ClampToS16(static_cast<s32>(
+            (gain * sample[0] + gain * sample[1] + gain * sample[2] + gain * sample[3]) / 2));
+        dest[samplei][0] = ClampToS16(dest[samplei][0] + mono);
+        dest[samplei][1] = ClampToS16(dest[samplei][1] + mono);
+    }
+}
+
+static void InterleaveGeneric(QuadFrame32& dest, const IntermediateMixSamples::Samples& source) {
+    for (size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (size_t channel = 0; channel < 4; channel++) {
+            dest[sample][channel] = source.pcm32[channel][sample];
+        }
+    }
+}
+
+static void DeinterleaveGeneric(IntermediateMixSamples::Samples& dest, const QuadFrame32& source) {
+    for (size_t sample = 0; sample < samples_per_frame; sample++) {
+        for (size_t channel = 0; channel < 4; channel++) {
+            dest.pcm32[channel][sample] = source[sample][channel];
+        }
+    }
+}
+
+static void InterpolateLinearGeneric(const std::array<s16, 2>* input, u64 fposition,
+                                     u64 step_size, std::array<s16, 2>* output, size_t count) {
+    constexpr u64 scale_factor = 1 << 24;
+    constexpr u64 scale_mask = scale_factor - 1;
+
+    for (size_t i = 0; i < count; i++, fposition += step_size) {
+        const std::array<s16, 2>& x0 = input[fposition / scale_factor];
+        const std::array<s16, 2>& x1 = input[fposition / scale_factor + 1];
+        const u64 fraction = fposition & scale_mask;
+
+        // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
+        // This is a saturated subtraction. (Verified by black-box fuzzing.)
+        s64 delta0 = MathUtil::Clamp<s64>(x1[0] - x0[0], -32768, 32767);
+        s64 delta1 = MathUtil::Clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+        // The product is unsigned, so a negative delta is rounded towards negative infinity.
+        output[i] = std::array<s16, 2>{
+            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+        };
+    }
+}
+
+const MixKernels mix_kernels_generic = {
+    "Generic",         MixIntoGeneric,      DownmixStereoGeneric,    DownmixMonoGeneric,
+    InterleaveGeneric, DeinterleaveGeneric, InterpolateLinearGeneric,
+};
+
+const MixKernels& GetMixKernels() {
+    static const MixKernels& kernels = *GetSupportedMixKernels().back();
+    return kernels;
+}
+
+std::vector<const MixKernels*> GetSupportedMixKernels() {
+    std::vector<const MixKernels*> kernels = {&mix_kernels_generic};
+
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.sse4_1)
+        kernels.push_back(&mix_kernels_sse41);
+    if (caps.avx2)
+        kernels.push_back(&mix_kernels_avx2);
+#endif // ARCHITECTURE_x86_64
+
+    return kernels;
+}
+
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,65 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "audio_core/hle/common.h"
+#include "audio_core/hle/dsp.h"
+#include "common/common_types.h"
+
+namespace DSP {
+namespace HLE {
+
+/**
+ * Implementation of the per-sample loops of the mixing stages, written for one instruction set.
+ * All implementations are bit-exact with each other.
+ */
+struct MixKernels {
+    const char* name;
+
+    /// Adds source to dest, the left and right channels scaled by the gains of the four channels
+    void (*mix_into)(QuadFrame32& dest, const StereoFrame16& source,
+                     const std::array<float, 4>& gains);
+
+    /// Downmixes samples to stereo, scales it by gain, and adds it to dest, saturating
+    void (*downmix_stereo)(StereoFrame16& dest, const QuadFrame32& samples, float gain);
+
+    /// Downmixes samples to mono, scales it by gain, and adds it to dest, saturating
+    void (*downmix_mono)(StereoFrame16& dest, const QuadFrame32& samples, float gain);
+
+    /// Copies the samples from the layout of the shared memory, one array per channel
+    void (*interleave)(QuadFrame32& dest, const IntermediateMixSamples::Samples& source);
+
+    /// Copies the samples to the layout of the shared memory, one array per channel
+    void (*deinterleave)(IntermediateMixSamples::Samples& dest, const QuadFrame32& source);
+
+    /**
+     * Linear interpolation. Output i is interpolated between input[n] and input[n + 1], where
+     * n + fraction is fposition + i * step_size, in fixed point with 24 fractional bits.
+     */
+    void (*interpolate_linear)(const std::array<s16, 2>* input, u64 fposition, u64 step_size,
+                               std::array<s16, 2>* output, size_t count);
+};
+
+/// Returns the fastest mixing kernels supported by the host CPU
+const MixKernels& GetMixKernels();
+
+/// Returns all mixing kernels supported by the host CPU, starting with the portable ones
+std::vector<const MixKernels*> GetSupportedMixKernels();
+
+/// Portable implementation
+extern const MixKernels mix_kernels_generic;
+
+#ifdef ARCHITECTURE_x86_64
+/// SSE4.1 implementation
+extern const MixKernels mix_kernels_sse41;
+/// AVX2 implementation
+extern const MixKernels mix_kernels_avx2;
+#endif // ARCHITECTURE_x86_64
+
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,205 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <immintrin.h>
+#include "audio_core/hle/mix_kernels.h"
+
+namespace DSP {
+namespace HLE {
+
+static_assert(samples_per_frame % 8 == 0, "Frames are processed 8 samples at a time");
+
+/// Transposes the 4x4 matrices in the low and high halves of the rows independently
+static void Transpose4x4(__m256& r0, __m256& r1, __m256& r2, __m256& r3) {
+    const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+    const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+    const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+/// Reorders the stereo samples (0, 2, 4, 6, 1, 3, 5, 7), as left by in-lane packing, to sequence
+static __m256i UnpermuteStereo(__m256i samples) {
+    return _mm256_permutevar8x32_epi32(samples, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+static void MixIntoAVX2(QuadFrame32& dest, const StereoFrame16& source,
+                        const std::array<float, 4>& gains) {
+    const __m128 gain4 = _mm_loadu_ps(gains.data());
+    const __m256 gain = _mm256_insertf128_ps(_mm256_castps128_ps256(gain4), gain4, 1);
+    const __m256i duplicate[2] = {_mm256_setr_epi32(0, 1, 0, 1, 2, 3, 2, 3),
+                                  _mm256_setr_epi32(4, 5, 4, 5, 6, 7, 6, 7)};
+
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        // Four stereo samples, as (l0, r0, l1, r1, l2, r2, l3, r3)
+        const __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&source[samplei]));
+        const __m256 in = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(pcm));
+
+        for (size_t i = 0; i < 2; i++) {
+            __m256i* const out = reinterpret_cast<__m256i*>(&dest[samplei + i * 2]);
+            const __m256 stereo = _mm256_permutevar8x32_ps(in, duplicate[i]);
+            const __m256i quad = _mm256_cvttps_epi32(_mm256_mul_ps(stereo, gain));
+            _mm256_storeu_si256(out, _mm256_add_epi32(_mm256_loadu_si256(out), quad));
+        }
+    }
+}
+
+/// Loads two samples, scaled by gain
+static __m256 LoadScaledSamples(const QuadFrame32& samples, size_t samplei, __m256 gain) {
+    const __m256i sample =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&samples[samplei]));
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(sample), gain);
+}
+
+static void DownmixStereoAVX2(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    const __m256 gain_vec = _mm256_set1_ps(gain);
+
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 8) {
+        __m256i lr[2];
+        for (size_t i = 0; i < 2; i++) {
+            const __m256 s01 = LoadScaledSamples(samples, samplei + i * 4 + 0, gain_vec);
+            const __m256 s23 = LoadScaledSamples(samples, samplei + i * 4 + 2, gain_vec);
+            // (front left + back left, front right + back right) of samples 0, 2, then 1, 3
+            lr[i] = _mm256_cvttps_epi32(
+                _mm256_add_ps(_mm256_shuffle_ps(s01, s23, _MM_SHUFFLE(1, 0, 1, 0)),
+                              _mm256_shuffle_ps(s01, s23, _MM_SHUFFLE(3, 2, 3, 2))));
+        }
+        const __m256i mix = UnpermuteStereo(_mm256_packs_epi32(lr[0], lr[1]));
+
+        __m256i* const out = reinterpret_cast<__m256i*>(&dest[samplei]);
+        _mm256_storeu_si256(out, _mm256_adds_epi16(_mm256_loadu_si256(out), mix));
+    }
+}
+
+static void DownmixMonoAVX2(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    const __m256 gain_vec = _mm256_set1_ps(gain);
+    const __m256 two = _mm256_set1_ps(2.0f);
+
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 8) {
+        __m256 c0 = LoadScaledSamples(samples, samplei + 0, gain_vec);
+        __m256 c1 = LoadScaledSamples(samples, samplei + 2, gain_vec);
+        __m256 c2 = LoadScaledSamples(samples, samplei + 4, gain_vec);
+        __m256 c3 = LoadScaledSamples(samples, samplei + 6, gain_vec);
+        // The channels of samples (0, 2, 4, 6, 1, 3, 5, 7)
+        Transpose4x4(c0, c1, c2, c3);
+
+        // The channels are added in the same order as the portable implementation
+        const __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(c0, c1), c2), c3);
+        const __m256i mono = _mm256_cvttps_epi32(_mm256_div_ps(sum, two));
+        const __m256i packed = _mm256_packs_epi32(mono, mono);
+        const __m256i mix = UnpermuteStereo(_mm256_unpacklo_epi16(packed, packed));
+
+        __m256i* const out = reinterpret_cast<__m256i*>(&dest[samplei]);
+        _mm256_storeu_si256(out, _mm256_adds_epi16(_mm256_loadu_si256(out), mix));
+    }
+}
+
+static void InterleaveAVX2(QuadFrame32& dest, const IntermediateMixSamples::Samples& source) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 8) {
+        __m256 c[4];
+        for (size_t channel = 0; channel < 4; channel++) {
+            c[channel] =
+                _mm256_loadu_ps(reinterpret_cast<const float*>(&source.pcm32[channel][samplei]));
+        }
+        // Samples (0, 4), (1, 5), (2, 6), (3, 7)
+        Transpose4x4(c[0], c[1], c[2], c[3]);
+
+        float* const out = reinterpret_cast<float*>(&dest[samplei]);
+        _mm256_storeu_ps(out + 0, _mm256_permute2f128_ps(c[0], c[1], 0x20));
+        _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(c[2], c[3], 0x20));
+        _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(c[0], c[1], 0x31));
+        _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(c[2], c[3], 0x31));
+    }
+}
+
+static void DeinterleaveAVX2(IntermediateMixSamples::Samples& dest, const QuadFrame32& source) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 8) {
+        const float* const in = reinterpret_cast<const float*>(&source[samplei]);
+        const __m256 s01 = _mm256_loadu_ps(in + 0);
+        const __m256 s23 = _mm256_loadu_ps(in + 8);
+        const __m256 s45 = _mm256_loadu_ps(in + 16);
+        const __m256 s67 = _mm256_loadu_ps(in + 24);
+
+        __m256 c[4] = {
+            _mm256_permute2f128_ps(s01, s45, 0x20), _mm256_permute2f128_ps(s01, s45, 0x31),
+            _mm256_permute2f128_ps(s23, s67, 0x20), _mm256_permute2f128_ps(s23, s67, 0x31),
+        };
+        Transpose4x4(c[0], c[1], c[2], c[3]);
+
+        for (size_t channel = 0; channel < 4; channel++) {
+            _mm256_storeu_ps(reinterpret_cast<float*>(&dest.pcm32[channel][samplei]), c[channel]);
+        }
+    }
+}
+
+/**
+ * Linear interpolation of four output samples, from the input pairs (x0, x1) of each. The fraction
+ * is a vector (f0, f0, f1, f1, f2, f2, f3, f3) of 24 bits fractions. See the SSE4.1 implementation.
+ */
+static __m256i InterpolateLinearQuad(__m128i x0, __m128i x1, __m256i fraction) {
+    const __m256i delta = _mm256_cvtepi16_epi32(_mm_subs_epi16(x1, x0));
+
+    const __m256i frac_high = _mm256_srli_epi32(fraction, 12);
+    const __m256i frac_low = _mm256_and_si256(fraction, _mm256_set1_epi32(0xFFF));
+    const __m256i low = _mm256_srai_epi32(_mm256_mullo_epi32(frac_low, delta), 12);
+    const __m256i step =
+        _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(frac_high, delta), low), 12);
+
+    const __m256i result = _mm256_add_epi32(_mm256_cvtepi16_epi32(x0), step);
+    return _mm256_srai_epi32(_mm256_slli_epi32(result, 16), 16);
+}
+
+static void InterpolateLinearAVX2(const std::array<s16, 2>* input, u64 fposition, u64 step_size,
+                                  std::array<s16, 2>* output, size_t count) {
+    constexpr u64 scale_factor = 1 << 24;
+    constexpr u64 scale_mask = scale_factor - 1;
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i x0[2], x1[2];
+        u32 fractions[8];
+        for (size_t half = 0; half < 2; half++) {
+            __m128i pairs[4];
+            for (size_t k = 0; k < 4; k++, fposition += step_size) {
+                // The input samples x0 and x1 are adjacent, and loaded together
+                pairs[k] = _mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(&input[fposition / scale_factor]));
+                fractions[half * 4 + k] = static_cast<u32>(fposition & scale_mask);
+            }
+
+            const __m128 pairs01 = _mm_castsi128_ps(_mm_unpacklo_epi64(pairs[0], pairs[1]));
+            const __m128 pairs23 = _mm_castsi128_ps(_mm_unpacklo_epi64(pairs[2], pairs[3]));
+            x0[half] =
+                _mm_castps_si128(_mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(2, 0, 2, 0)));
+            x1[half] =
+                _mm_castps_si128(_mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(3, 1, 3, 1)));
+        }
+
+        __m256i out[2];
+        for (size_t half = 0; half < 2; half++) {
+            const u32* const f = &fractions[half * 4];
+            const __m256i fraction =
+                _mm256_setr_epi32(f[0], f[0], f[1], f[1], f[2], f[2], f[3], f[3]);
+            out[half] = InterpolateLinearQuad(x0[half], x1[half], fraction);
+        }
+
+        // Packing works within 128 bits lanes, leaving the outputs as (0, 1, 4, 5, 2, 3, 6, 7)
+        const __m256i packed = _mm256_packs_epi32(out[0], out[1]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&output[i]),
+                            _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+
+    mix_kernels_generic.interpolate_linear(input, fposition, step_size, output + i, count - i);
+}
+
+const MixKernels mix_kernels_avx2 = {
+    "AVX2",         MixIntoAVX2,      DownmixStereoAVX2,    DownmixMonoAVX2,
+    InterleaveAVX2, DeinterleaveAVX2, InterpolateLinearAVX2,
+};
+
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,169 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <smmintrin.h>
+#include "audio_core/hle/mix_kernels.h"
+
+namespace DSP {
+namespace HLE {
+
+static_assert(samples_per_frame % 4 == 0, "Frames are processed 4 samples at a time");
+
+static void MixIntoSSE41(QuadFrame32& dest, const StereoFrame16& source,
+                         const std::array<float, 4>& gains) {
+    const __m128 gain = _mm_loadu_ps(gains.data());
+
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 2) {
+        // Two stereo samples, as (l0, r0, l1, r1)
+        const __m128i pcm = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&source[samplei]));
+        const __m128 in = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(pcm));
+
+        for (size_t i = 0; i < 2; i++) {
+            __m128i* const out = reinterpret_cast<__m128i*>(&dest[samplei + i]);
+            const __m128 stereo = i == 0 ? _mm_movelh_ps(in, in) : _mm_movehl_ps(in, in);
+            const __m128i quad = _mm_cvttps_epi32(_mm_mul_ps(stereo, gain));
+            _mm_storeu_si128(out, _mm_add_epi32(_mm_loadu_si128(out), quad));
+        }
+    }
+}
+
+static __m128 LoadScaledSample(const QuadFrame32& samples, size_t samplei, __m128 gain) {
+    const __m128i sample = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[samplei]));
+    return _mm_mul_ps(_mm_cvtepi32_ps(sample), gain);
+}
+
+static void DownmixStereoSSE41(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    const __m128 gain_vec = _mm_set1_ps(gain);
+
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        const __m128 s0 = LoadScaledSample(samples, samplei + 0, gain_vec);
+        const __m128 s1 = LoadScaledSample(samples, samplei + 1, gain_vec);
+        const __m128 s2 = LoadScaledSample(samples, samplei + 2, gain_vec);
+        const __m128 s3 = LoadScaledSample(samples, samplei + 3, gain_vec);
+
+        // (front left + back left, front right + back right) of two samples each
+        const __m128 lr01 = _mm_add_ps(_mm_movelh_ps(s0, s1), _mm_movehl_ps(s1, s0));
+        const __m128 lr23 = _mm_add_ps(_mm_movelh_ps(s2, s3), _mm_movehl_ps(s3, s2));
+        const __m128i mix = _mm_packs_epi32(_mm_cvttps_epi32(lr01), _mm_cvttps_epi32(lr23));
+
+        __m128i* const out = reinterpret_cast<__m128i*>(&dest[samplei]);
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), mix));
+    }
+}
+
+static void DownmixMonoSSE41(StereoFrame16& dest, const QuadFrame32& samples, float gain) {
+    const __m128 gain_vec = _mm_set1_ps(gain);
+    const __m128 two = _mm_set1_ps(2.0f);
+
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128 c0 = LoadScaledSample(samples, samplei + 0, gain_vec);
+        __m128 c1 = LoadScaledSample(samples, samplei + 1, gain_vec);
+        __m128 c2 = LoadScaledSample(samples, samplei + 2, gain_vec);
+        __m128 c3 = LoadScaledSample(samples, samplei + 3, gain_vec);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+        // The channels are added in the same order as the portable implementation
+        const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_add_ps(c0, c1), c2), c3);
+        const __m128i mono = _mm_cvttps_epi32(_mm_div_ps(sum, two));
+        const __m128i packed = _mm_packs_epi32(mono, mono);
+        const __m128i mix = _mm_unpacklo_epi16(packed, packed);
+
+        __m128i* const out = reinterpret_cast<__m128i*>(&dest[samplei]);
+        _mm_storeu_si128(out, _mm_adds_epi16(_mm_loadu_si128(out), mix));
+    }
+}
+
+static void InterleaveSSE41(QuadFrame32& dest, const IntermediateMixSamples::Samples& source) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128 c[4];
+        for (size_t channel = 0; channel < 4; channel++) {
+            c[channel] =
+                _mm_loadu_ps(reinterpret_cast<const float*>(&source.pcm32[channel][samplei]));
+        }
+        _MM_TRANSPOSE4_PS(c[0], c[1], c[2], c[3]);
+        for (size_t i = 0; i < 4; i++) {
+            _mm_storeu_ps(reinterpret_cast<float*>(&dest[samplei + i]), c[i]);
+        }
+    }
+}
+
+static void DeinterleaveSSE41(IntermediateMixSamples::Samples& dest, const QuadFrame32& source) {
+    for (size_t samplei = 0; samplei < samples_per_frame; samplei += 4) {
+        __m128 s[4];
+        for (size_t i = 0; i < 4; i++) {
+            s[i] = _mm_loadu_ps(reinterpret_cast<const float*>(&source[samplei + i]));
+        }
+        _MM_TRANSPOSE4_PS(s[0], s[1], s[2], s[3]);
+        for (size_t channel = 0; channel < 4; channel++) {
+            _mm_storeu_ps(reinterpret_cast<float*>(&dest.pcm32[channel][samplei]), s[channel]);
+        }
+    }
+}
+
+/**
+ * Linear interpolation of two output samples, from the input pairs (x0, x1) of each. The fraction
+ * is a vector (f0, f0, f1, f1) of 24 bits fractions.
+ */
+static __m128i InterpolateLinearPair(__m128i x0, __m128i x1, __m128i fraction) {
+    // A saturated subtraction, as the portable implementation
+    const __m128i delta = _mm_cvtepi16_epi32(_mm_subs_epi16(x1, x0));
+
+    // fraction * delta >> 24 is computed as two products of 12 bits of the fraction, so that it
+    // fits in 32 bits. Arithmetic shifts round towards negative infinity like the unsigned
+    // division of the portable implementation.
+    const __m128i frac_high = _mm_srli_epi32(fraction, 12);
+    const __m128i frac_low = _mm_and_si128(fraction, _mm_set1_epi32(0xFFF));
+    const __m128i low = _mm_srai_epi32(_mm_mullo_epi32(frac_low, delta), 12);
+    const __m128i step = _mm_srai_epi32(_mm_add_epi32(_mm_mullo_epi32(frac_high, delta), low), 12);
+
+    // The sum wraps around in the portable implementation, keep its low 16 bits
+    const __m128i result = _mm_add_epi32(_mm_cvtepi16_epi32(x0), step);
+    return _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+}
+
+static void InterpolateLinearSSE41(const std::array<s16, 2>* input, u64 fposition, u64 step_size,
+                                   std::array<s16, 2>* output, size_t count) {
+    constexpr u64 scale_factor = 1 << 24;
+    constexpr u64 scale_mask = scale_factor - 1;
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pairs[4];
+        u32 fractions[4];
+        for (size_t k = 0; k < 4; k++, fposition += step_size) {
+            // The input samples x0 and x1 are adjacent, and loaded together
+            pairs[k] = _mm_loadl_epi64(
+                reinterpret_cast<const __m128i*>(&input[fposition / scale_factor]));
+            fractions[k] = static_cast<u32>(fposition & scale_mask);
+        }
+
+        // One stereo sample per 32 bits lane, (x0 of output 0, x1 of output 0, x0 of output 1...)
+        const __m128 pairs01 = _mm_castsi128_ps(_mm_unpacklo_epi64(pairs[0], pairs[1]));
+        const __m128 pairs23 = _mm_castsi128_ps(_mm_unpacklo_epi64(pairs[2], pairs[3]));
+        const __m128i x0 =
+            _mm_castps_si128(_mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i x1 =
+            _mm_castps_si128(_mm_shuffle_ps(pairs01, pairs23, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        const __m128i out01 = InterpolateLinearPair(
+            x0, x1, _mm_setr_epi32(fractions[0], fractions[0], fractions[1], fractions[1]));
+        const __m128i out23 =
+            InterpolateLinearPair(_mm_srli_si128(x0, 8), _mm_srli_si128(x1, 8),
+                                  _mm_setr_epi32(fractions[2], fractions[2], fractions[3],
+                                                 fractions[3]));
+
+        // The results are within the s16 range, this doesn't saturate
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&output[i]), _mm_packs_epi32(out01, out23));
+    }
+
+    mix_kernels_generic.interpolate_linear(input, fposition, step_size, output + i, count - i);
+}
+
+const MixKernels mix_kernels_sse41 = {
+    "SSE4.1",        MixIntoSSE41,      DownmixStereoSSE41,    DownmixMonoSSE41,
+    InterleaveSSE41, DeinterleaveSSE41, InterpolateLinearSSE41,
+};
+
+} // namespace HLE
+} // namespace DSP
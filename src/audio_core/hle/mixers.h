@@ -26,6 +26,9 @@ public:
         return current_frame;
     }
 
+    /// Saves or loads the state of the mixers
+    void DoState(PointerWrap& p);
+
 private:
     StereoFrame16 current_frame = {};
 
@@ -7,6 +7,7 @@
 #include "audio_core/hle/dsp.h"
 #include "audio_core/hle/pipe.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hle/service/dsp_dsp.h"
@@ -25,6 +26,13 @@ void ResetPipes() {
     dsp_state = DspState::Off;
 }
 
+void PipesDoState(PointerWrap& p) {
+    p.Do(dsp_state);
+    for (auto& data : pipe_data) {
+        p.Do(data);
+    }
+}
+
 std::vector<u8> PipeRead(DspPipe pipe_number, u32 length) {
     const size_t pipe_index = static_cast<size_t>(pipe_number);
 
@@ -8,12 +8,17 @@
 #include <vector>
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace DSP {
 namespace HLE {
 
 /// Reset the pipes by setting pipe positions back to the beginning.
 void ResetPipes();
 
+/// Saves or loads the state of the DSP and the data left in the pipes
+void PipesDoState(PointerWrap& p);
+
 enum class DspPipe {
     Debug = 0,
     Dma = 1,
@@ -6,9 +6,11 @@
 #include <array>
 #include "audio_core/codec.h"
 #include "audio_core/hle/common.h"
+#include "audio_core/hle/mix_kernels.h"
 #include "audio_core/hle/source.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/memory.h"
 
@@ -30,14 +32,8 @@ void Source::MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const {
     if (!state.enabled)
         return;
 
-    const std::array<float, 4>& gains = state.gain.at(intermediate_mix_id);
-    for (size_t samplei = 0; samplei < samples_per_frame; samplei++) {
-        // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
-        dest[samplei][0] += static_cast<s32>(gains[0] * current_frame[samplei][0]);
-        dest[samplei][1] += static_cast<s32>(gains[1] * current_frame[samplei][1]);
-        dest[samplei][2] += static_cast<s32>(gains[2] * current_frame[samplei][0]);
-        dest[samplei][3] += static_cast<s32>(gains[3] * current_frame[samplei][1]);
-    }
+    // Conversion from stereo (current_frame) to quadraphonic (dest) occurs here.
+    GetMixKernels().mix_into(dest, current_frame, state.gain.at(intermediate_mix_id));
 }
 
 void Source::Reset() {
@@ -45,6 +41,51 @@ void Source::Reset() {
     state = {};
 }
 
+void Source::DoState(PointerWrap& p) {
+    p.DoVoid(current_frame.data(), sizeof(current_frame));
+
+    p.Do(state.enabled);
+    p.Do(state.sync);
+    p.DoVoid(state.gain.data(), sizeof(state.gain));
+
+    // std::priority_queue doesn't expose its container, the buffers are saved in pop order
+    std::vector<Buffer> buffers;
+    for (auto queue = state.input_queue; !queue.empty(); queue.pop()) {
+        buffers.push_back(queue.top());
+    }
+    u32 num_buffers = static_cast<u32>(buffers.size());
+    p.Do(num_buffers);
+    buffers.resize(num_buffers);
+    for (auto& buffer : buffers) {
+        p.DoVoid(&buffer, sizeof(buffer));
+    }
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        state.input_queue = {};
+        for (const auto& buffer : buffers) {
+            state.input_queue.push(buffer);
+        }
+    }
+
+    p.Do(state.mono_or_stereo);
+    p.Do(state.format);
+    p.Do(state.current_sample_number);
+    p.Do(state.next_sample_number);
+    p.DoVoid(&state.current_buffer, sizeof(state.current_buffer));
+    p.Do(state.current_buffer_samples);
+    p.Do(state.samples_decoded);
+    p.DoVoid(state.decode_buffer.data(), sizeof(state.decode_buffer));
+    p.Do(state.decode_position);
+    p.Do(state.decode_size);
+    p.Do(state.buffer_update);
+    p.Do(state.current_buffer_id);
+    p.DoVoid(state.adpcm_coeffs.data(), sizeof(state.adpcm_coeffs));
+    p.DoVoid(&state.adpcm_state, sizeof(state.adpcm_state));
+    p.Do(state.rate_multiplier);
+    p.Do(state.interpolation_mode);
+    p.DoVoid(&state.interp_state, sizeof(state.interp_state));
+    state.filters.DoState(p);
+}
+
 void Source::ParseConfig(SourceConfiguration::Configuration& config,
                          const s16_le (&adpcm_coeffs)[16]) {
     if (!config.dirty_raw) {
@@ -228,7 +269,7 @@ void Source::ParseConfig(SourceConfiguration::Configuration& config,
 void Source::GenerateFrame() {
     current_frame.fill({});
 
-    if (state.current_buffer.empty() && !DequeueBuffer()) {
+    if (IsCurrentBufferDone() && !DequeueBuffer()) {
         state.enabled = false;
         state.buffer_update = true;
         state.current_buffer_id = 0;
@@ -239,28 +280,56 @@ void Source::GenerateFrame() {
 
     state.current_sample_number = state.next_sample_number;
     while (frame_position < current_frame.size()) {
-        if (state.current_buffer.empty() && !DequeueBuffer()) {
-            break;
+        if (IsCurrentBufferDone()) {
+            if (!DequeueBuffer())
+                break;
+            continue;
         }
 
-        const size_t size_to_copy =
-            std::min(state.current_buffer.size(), current_frame.size() - frame_position);
+        if (state.decode_position == state.decode_size) {
+            DecodeNextChunk();
+        }
 
-        std::copy(state.current_buffer.begin(), state.current_buffer.begin() + size_to_copy,
-                  current_frame.begin() + frame_position);
-        state.current_buffer.erase(state.current_buffer.begin(),
-                                   state.current_buffer.begin() + size_to_copy);
+        const std::array<s16, 2>* const input = &state.decode_buffer[state.decode_position];
+        const size_t input_size = state.decode_size - state.decode_position;
+        std::array<s16, 2>* const output = &current_frame[frame_position];
+        const size_t output_size = current_frame.size() - frame_position;
 
-        frame_position += size_to_copy;
-        state.next_sample_number += static_cast<u32>(size_to_copy);
+        AudioInterp::StreamResult result{};
+        switch (state.interpolation_mode) {
+        case InterpolationMode::None:
+            result = AudioInterp::None(state.interp_state, input, input_size, output, output_size,
+                                       state.rate_multiplier);
+            break;
+        case InterpolationMode::Linear:
+            result = AudioInterp::Linear(state.interp_state, input, input_size, output,
+                                         output_size, state.rate_multiplier);
+            break;
+        case InterpolationMode::Polyphase:
+            // TODO(merry): Implement polyphase interpolation
+            result = AudioInterp::Linear(state.interp_state, input, input_size, output,
+                                         output_size, state.rate_multiplier);
+            break;
+        default:
+            UNIMPLEMENTED();
+            break;
+        }
+
+        state.decode_position += static_cast<u32>(result.consumed);
+        frame_position += result.produced;
+        state.next_sample_number += static_cast<u32>(result.produced);
     }
 
     state.filters.ProcessFrame(current_frame);
 }
 
+bool Source::IsCurrentBufferDone() const {
+    return state.samples_decoded == state.current_buffer_samples &&
+           state.decode_position == state.decode_size;
+}
+
 bool Source::DequeueBuffer() {
-    ASSERT_MSG(state.current_buffer.empty(),
-               "Shouldn't dequeue; we still have data in current_buffer");
+    ASSERT_MSG(IsCurrentBufferDone(), "Shouldn't dequeue; we still have data in current_buffer");
 
     if (state.input_queue.empty())
         return false;
@@ -277,51 +346,23 @@ bool Source::DequeueBuffer() {
         state.adpcm_state.yn2 = buf.adpcm_yn[1];
     }
 
-    const u8* const memory = Memory::GetPhysicalPointer(buf.physical_address);
-    if (memory) {
-        const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
-        switch (buf.format) {
-        case Format::PCM8:
-            state.current_buffer = Codec::DecodePCM8(num_channels, memory, buf.length);
-            break;
-        case Format::PCM16:
-            state.current_buffer = Codec::DecodePCM16(num_channels, memory, buf.length);
-            break;
-        case Format::ADPCM:
-            DEBUG_ASSERT(num_channels == 1);
-            state.current_buffer =
-                Codec::DecodeADPCM(memory, buf.length, state.adpcm_coeffs, state.adpcm_state);
-            break;
-        default:
-            UNIMPLEMENTED();
-            break;
-        }
-    } else {
+    state.current_buffer = buf;
+    state.current_buffer_samples = 0;
+    state.samples_decoded = 0;
+    state.decode_position = 0;
+    state.decode_size = 0;
+
+    if (!Memory::GetPhysicalPointer(buf.physical_address)) {
         LOG_WARNING(Audio_DSP,
                     "source_id=%zu buffer_id=%hu length=%u: Invalid physical address 0x%08X",
                     source_id, buf.buffer_id, buf.length, buf.physical_address);
-        state.current_buffer.clear();
         return true;
     }
 
-    switch (state.interpolation_mode) {
-    case InterpolationMode::None:
-        state.current_buffer =
-            AudioInterp::None(state.interp_state, state.current_buffer, state.rate_multiplier);
-        break;
-    case InterpolationMode::Linear:
-        state.current_buffer =
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier);
-        break;
-    case InterpolationMode::Polyphase:
-        // TODO(merry): Implement polyphase interpolation
-        state.current_buffer =
-            AudioInterp::Linear(state.interp_state, state.current_buffer, state.rate_multiplier);
-        break;
-    default:
-        UNIMPLEMENTED();
-        break;
-    }
+    // ADPCM samples are decoded in pairs. Buffers of less than two samples aren't played.
+    const u32 num_samples = buf.format == Format::ADPCM ? (buf.length + 1) & ~1u : buf.length;
+    state.current_buffer_samples = num_samples >= 2 ? num_samples : 0;
+    state.interp_state.fposition = 0;
 
     // the first playthrough starts at play_position, loops start at the beginning of the buffer
     state.current_sample_number = (!buf.has_played) ? buf.play_position : 0;
@@ -332,12 +373,48 @@ bool Source::DequeueBuffer() {
 
     buf.has_played = true;
 
-    LOG_TRACE(Audio_DSP, "source_id=%zu buffer_id=%hu from_queue=%s current_buffer.size()=%zu",
-              source_id, buf.buffer_id, buf.from_queue ? "true" : "false",
-              state.current_buffer.size());
+    LOG_TRACE(Audio_DSP, "source_id=%zu buffer_id=%hu from_queue=%s num_samples=%u", source_id,
+              buf.buffer_id, buf.from_queue ? "true" : "false", state.current_buffer_samples);
     return true;
 }
 
+void Source::DecodeNextChunk() {
+    const Buffer& buf = state.current_buffer;
+    const u32 first_sample = state.samples_decoded;
+    const u32 num_samples = std::min<u32>(state.current_buffer_samples - first_sample,
+                                          static_cast<u32>(decode_buffer_size));
+    std::array<s16, 2>* const output = state.decode_buffer.data();
+
+    state.samples_decoded += num_samples;
+    state.decode_position = 0;
+    state.decode_size = num_samples;
+
+    // The pointer is looked up for each chunk rather than kept, so that it needn't be saved
+    const u8* const memory = Memory::GetPhysicalPointer(buf.physical_address);
+    if (!memory) {
+        std::fill(output, output + num_samples, std::array<s16, 2>{});
+        return;
+    }
+
+    const unsigned num_channels = buf.mono_or_stereo == MonoOrStereo::Stereo ? 2 : 1;
+    switch (buf.format) {
+    case Format::PCM8:
+        Codec::DecodePCM8(num_channels, memory, first_sample, num_samples, output);
+        break;
+    case Format::PCM16:
+        Codec::DecodePCM16(num_channels, memory, first_sample, num_samples, output);
+        break;
+    case Format::ADPCM:
+        DEBUG_ASSERT(num_channels == 1);
+        Codec::DecodeADPCM(memory, first_sample, num_samples, state.adpcm_coeffs,
+                           state.adpcm_state, output);
+        break;
+    default:
+        UNIMPLEMENTED();
+        break;
+    }
+}
+
 SourceStatus::Status Source::GetCurrentStatus() {
     SourceStatus::Status ret;
 
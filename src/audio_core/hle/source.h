@@ -54,6 +54,9 @@ public:
      */
     void MixInto(QuadFrame32& dest, size_t intermediate_mix_id) const;
 
+    /// Saves or loads the state of the source, including its queued buffers
+    void DoState(PointerWrap& p);
+
 private:
     const size_t source_id;
     StereoFrame16 current_frame;
@@ -80,6 +83,9 @@ private:
         bool has_played;       // = false;
     };
 
+    /// Number of samples decoded at a time from the current buffer
+    static constexpr size_t decode_buffer_size = samples_per_frame;
+
     struct BufferOrder {
         bool operator()(const Buffer& a, const Buffer& b) const {
             // Lower buffer_id comes first.
@@ -108,7 +114,15 @@ private:
 
         u32 current_sample_number = 0;
         u32 next_sample_number = 0;
-        std::vector<std::array<s16, 2>> current_buffer;
+        Buffer current_buffer = {};
+        /// Number of samples in current_buffer, and how many of them have been decoded so far
+        u32 current_buffer_samples = 0;
+        u32 samples_decoded = 0;
+
+        /// The buffer is decoded a chunk at a time, as it is resampled into the frame
+        std::array<std::array<s16, 2>, decode_buffer_size> decode_buffer = {};
+        u32 decode_position = 0;
+        u32 decode_size = 0;
 
         // buffer_id state
 
@@ -138,9 +152,12 @@ private:
     void ParseConfig(SourceConfiguration::Configuration& config, const s16_le (&adpcm_coeffs)[16]);
     /// INTERNAL: Generate the current audio output for this frame based on our internal state.
     void GenerateFrame();
-    /// INTERNAL: Dequeues a buffer and does preprocessing on it (decoding, resampling). Puts it
-    /// into current_buffer.
+    /// INTERNAL: Dequeues a buffer and puts it into current_buffer, to be decoded as it is played.
     bool DequeueBuffer();
+    /// INTERNAL: Whether all of the samples of current_buffer have been resampled.
+    bool IsCurrentBufferDone() const;
+    /// INTERNAL: Decodes the next chunk of current_buffer into decode_buffer.
+    void DecodeNextChunk();
     /// INTERNAL: Generates a SourceStatus::Status based on our internal state.
     SourceStatus::Status GetCurrentStatus();
 };
@@ -2,85 +2,124 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <limits>
+#include "audio_core/hle/mix_kernels.h"
 #include "audio_core/interpolate.h"
 #include "common/assert.h"
-#include "common/math_util.h"
 
 namespace AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
 // (This is not verified. This was chosen for minimal error.)
 constexpr u64 scale_factor = 1 << 24;
-constexpr u64 scale_mask = scale_factor - 1;
 
-/// Here we step over the input in steps of rate_multiplier, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
-static StereoBuffer16 StepOverSamples(State& state, const StereoBuffer16& input,
-                                      float rate_multiplier, Function fn) {
-    ASSERT(rate_multiplier > 0);
-
-    if (input.size() < 2)
-        return {};
+/// Number of steps of step_size from 0 before reaching distance
+static size_t StepsBefore(u64 distance, u64 step_size) {
+    if (step_size == 0)
+        return std::numeric_limits<size_t>::max();
+    return static_cast<size_t>((distance + step_size - 1) / step_size);
+}
 
-    StereoBuffer16 output;
-    output.reserve(static_cast<size_t>(input.size() / rate_multiplier));
+/// Here we step over the input in steps of rate_multiplier, until we consume all of the input or
+/// fill the output. The kernel interpolates the outputs between two adjacent input samples, the
+/// two samples before the input come from the state.
+template <typename Kernel>
+static StreamResult StepOverSamples(State& state, const std::array<s16, 2>* input,
+                                    size_t input_size, std::array<s16, 2>* output,
+                                    size_t output_size, float rate_multiplier, Kernel kernel) {
+    ASSERT(rate_multiplier > 0);
 
-    u64 step_size = static_cast<u64>(rate_multiplier * scale_factor);
+    const u64 step_size = static_cast<u64>(rate_multiplier * scale_factor);
 
-    u64 fposition = 0;
-    const u64 max_fposition = input.size() * scale_factor;
+    u64 fposition = state.fposition;
+    const u64 max_fposition = input_size * scale_factor;
+    size_t outputi = 0;
 
-    while (fposition < 1 * scale_factor) {
-        u64 fraction = fposition & scale_mask;
+    // Positions before the second input sample are between the historical samples and the first
+    const u64 history_end = std::min(2 * scale_factor, max_fposition);
+    if (fposition < history_end) {
+        const std::array<std::array<s16, 2>, 3> history = {{state.xn2, state.xn1, input[0]}};
+        const size_t count = std::min(StepsBefore(history_end - fposition, step_size), output_size);
+        kernel(history.data(), fposition, step_size, output, count);
+        fposition += count * step_size;
+        outputi += count;
+    }
 
-        output.push_back(fn(fraction, state.xn2, state.xn1, input[0]));
+    if (fposition >= 2 * scale_factor && fposition < max_fposition) {
+        const size_t count =
+            std::min(StepsBefore(max_fposition - fposition, step_size), output_size - outputi);
+        kernel(input, fposition - 2 * scale_factor, step_size, output + outputi, count);
+        fposition += count * step_size;
+        outputi += count;
+    }
 
-        fposition += step_size;
+    // The samples before the next output position are no longer needed, except the last two
+    const size_t consumed = std::min(static_cast<size_t>(fposition / scale_factor), input_size);
+    if (consumed >= 2) {
+        state.xn2 = input[consumed - 2];
+        state.xn1 = input[consumed - 1];
+    } else if (consumed == 1) {
+        state.xn2 = state.xn1;
+        state.xn1 = input[0];
     }
+    state.fposition = fposition - consumed * scale_factor;
 
-    while (fposition < 2 * scale_factor) {
-        u64 fraction = fposition & scale_mask;
+    return {consumed, outputi};
+}
 
-        output.push_back(fn(fraction, state.xn1, input[0], input[1]));
+/// Resamples a whole buffer at once
+template <typename Kernel>
+static StereoBuffer16 StepOverBuffer(State& state, const StereoBuffer16& input,
+                                     float rate_multiplier, Kernel kernel) {
+    ASSERT(rate_multiplier > 0);
 
-        fposition += step_size;
-    }
+    if (input.size() < 2)
+        return {};
 
-    while (fposition < max_fposition) {
-        u64 fraction = fposition & scale_mask;
+    const u64 step_size = static_cast<u64>(rate_multiplier * scale_factor);
+    const u64 max_fposition = input.size() * scale_factor;
 
-        size_t index = static_cast<size_t>(fposition / scale_factor);
-        output.push_back(fn(fraction, input[index - 2], input[index - 1], input[index]));
+    StereoBuffer16 output((max_fposition + step_size - 1) / step_size);
+    state.fposition = 0;
+    const StreamResult result = StepOverSamples(state, input.data(), input.size(), output.data(),
+                                                output.size(), rate_multiplier, kernel);
+    state.fposition = 0;
 
-        fposition += step_size;
-    }
+    ASSERT(result.consumed == input.size() && result.produced == output.size());
+    return output;
+}
 
-    state.xn2 = input[input.size() - 2];
-    state.xn1 = input[input.size() - 1];
+static void NoneKernel(const std::array<s16, 2>* input, u64 fposition, u64 step_size,
+                       std::array<s16, 2>* output, size_t count) {
+    for (size_t i = 0; i < count; i++, fposition += step_size) {
+        output[i] = input[fposition / scale_factor];
+    }
+}
 
-    return output;
+static void LinearKernel(const std::array<s16, 2>* input, u64 fposition, u64 step_size,
+                         std::array<s16, 2>* output, size_t count) {
+    DSP::HLE::GetMixKernels().interpolate_linear(input, fposition, step_size, output, count);
 }
 
 StereoBuffer16 None(State& state, const StereoBuffer16& input, float rate_multiplier) {
-    return StepOverSamples(
-        state, input, rate_multiplier,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+    return StepOverBuffer(state, input, rate_multiplier, NoneKernel);
 }
 
 StereoBuffer16 Linear(State& state, const StereoBuffer16& input, float rate_multiplier) {
-    // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    return StepOverSamples(state, input, rate_multiplier,
-                           [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                               // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                               s64 delta0 = MathUtil::Clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                               s64 delta1 = MathUtil::Clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                               return std::array<s16, 2>{
-                                   static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                                   static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                               };
-                           });
+    return StepOverBuffer(state, input, rate_multiplier, LinearKernel);
+}
+
+StreamResult None(State& state, const std::array<s16, 2>* input, size_t input_size,
+                  std::array<s16, 2>* output, size_t output_size, float rate_multiplier) {
+    return StepOverSamples(state, input, input_size, output, output_size, rate_multiplier,
+                           NoneKernel);
+}
+
+StreamResult Linear(State& state, const std::array<s16, 2>* input, size_t input_size,
+                    std::array<s16, 2>* output, size_t output_size, float rate_multiplier) {
+    return StepOverSamples(state, input, input_size, output, output_size, rate_multiplier,
+                           LinearKernel);
 }
 
 } // namespace AudioInterp
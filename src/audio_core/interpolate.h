@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include <vector>
 #include "common/common_types.h"
 
@@ -17,6 +18,15 @@ struct State {
     // Two historical samples.
     std::array<s16, 2> xn1 = {}; ///< x[n-1]
     std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    /// Position of the next output sample relative to the next input sample, when streaming.
+    /// Fixed point with 24 fractional bits.
+    u64 fposition = 0;
+};
+
+/// Result of resampling part of a stream
+struct StreamResult {
+    size_t consumed; ///< Number of input samples that are no longer needed
+    size_t produced; ///< Number of output samples written
 };
 
 /**
@@ -39,4 +49,23 @@ StereoBuffer16 None(State& state, const StereoBuffer16& input, float rate_multip
  */
 StereoBuffer16 Linear(State& state, const StereoBuffer16& input, float rate_multiplier);
 
+// The following resample a stream a few samples at a time, into a caller-provided array. They
+// produce the same samples as resampling the whole stream at once. The position in the stream is
+// kept in the state; reset state.fposition to 0 to start a new buffer like the functions above do.
+
+/**
+ * No interpolation, streaming. Stops when the input is used up or the output is full.
+ * @param input The input samples after the ones consumed by the previous call.
+ * @param output Receives at most output_size samples.
+ * @param rate_multiplier Stretch factor. Must be a positive non-zero value.
+ * @return The number of input samples consumed and output samples produced. The input samples
+ *         that aren't consumed must be passed again to the next call.
+ */
+StreamResult None(State& state, const std::array<s16, 2>* input, size_t input_size,
+                  std::array<s16, 2>* output, size_t output_size, float rate_multiplier);
+
+/// Linear interpolation, streaming. See the streaming None.
+StreamResult Linear(State& state, const std::array<s16, 2>* input, size_t input_size,
+                    std::array<s16, 2>* output, size_t output_size, float rate_multiplier);
+
 } // namespace AudioInterp
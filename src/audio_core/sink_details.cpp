@@ -5,12 +5,14 @@
 #include <algorithm>
 #include <memory>
 #include <vector>
+#include "audio_core/capture_sink.h"
 #include "audio_core/null_sink.h"
 #include "audio_core/sink_details.h"
 #ifdef HAVE_SDL2
 #include "audio_core/sdl2_sink.h"
 #endif
 #include "common/logging/log.h"
+#include "core/settings.h"
 
 namespace AudioCore {
 
@@ -20,6 +22,8 @@ const std::vector<SinkDetails> g_sink_details = {
     {"sdl2", []() { return std::make_unique<SDL2Sink>(); }},
 #endif
     {"null", []() { return std::make_unique<NullSink>(); }},
+    {"capture",
+     []() { return std::make_unique<CaptureSink>(Settings::values.audio_capture_path); }},
 };
 
 const SinkDetails& GetSinkDetails(std::string sink_id) {
@@ -23,6 +23,8 @@
 
 #include "citra/config.h"
 #include "citra/emu_window/emu_window_sdl2.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
@@ -32,6 +34,7 @@
 #include "core/core.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/loader/loader.h"
+#include "core/savestate.h"
 #include "core/settings.h"
 #include "video_core/video_core.h"
 
@@ -40,6 +43,8 @@ static void PrintHelp(const char* argv0) {
               << " [options] <filename>\n"
                  "-g, --gdbport=NUMBER  Enable gdb stub on port NUMBER\n"
                  "-h, --help            Display this help and exit\n"
+                 "-l, --load-state=FILE Load a save state of the title once it started\n"
+                 "-s, --save-state=FILE Save the state of the title when the window is closed\n"
                  "-v, --version         Output version information and exit\n";
 }
 
@@ -64,16 +69,20 @@ int main(int argc, char** argv) {
     }
 #endif
     std::string filepath;
+    std::string load_state_path;
+    std::string save_state_path;
 
     static struct option long_options[] = {
         {"gdbport", required_argument, 0, 'g'},
         {"help", no_argument, 0, 'h'},
+        {"load-state", required_argument, 0, 'l'},
+        {"save-state", required_argument, 0, 's'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        char arg = getopt_long(argc, argv, "g:hv", long_options, &option_index);
+        char arg = getopt_long(argc, argv, "g:hl:s:v", long_options, &option_index);
         if (arg != -1) {
             switch (arg) {
             case 'g':
@@ -90,6 +99,12 @@ int main(int argc, char** argv) {
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
+            case 'l':
+                load_state_path = optarg;
+                break;
+            case 's':
+                save_state_path = optarg;
+                break;
             case 'v':
                 PrintVersion();
                 return 0;
@@ -110,6 +125,8 @@ int main(int argc, char** argv) {
 
     Log::Filter log_filter(Log::Level::Debug);
     Log::SetFilter(&log_filter);
+    Log::Init(FileUtil::GetUserPath(D_LOGS_IDX) + LOG_FILE);
+    SCOPE_EXIT({ Log::Shutdown(); });
 
     MicroProfileOnThreadCreate("EmuThread");
     SCOPE_EXIT({ MicroProfileShutdown(); });
@@ -143,9 +160,19 @@ int main(int argc, char** argv) {
         return -1;
     }
 
+    if (!load_state_path.empty() && !SaveState::LoadFromFile(load_state_path)) {
+        LOG_CRITICAL(Frontend, "Failed to load the save state %s!", load_state_path.c_str());
+        return -1;
+    }
+
     while (emu_window->IsOpen()) {
         system.RunLoop();
     }
 
+    if (!save_state_path.empty() && !SaveState::SaveToFile(save_state_path)) {
+        LOG_CRITICAL(Frontend, "Failed to save the state to %s!", save_state_path.c_str());
+        return -1;
+    }
+
     return 0;
 }
@@ -51,6 +51,26 @@ use_hw_renderer =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Number of threads used by the software renderer to rasterize triangles
+# 0: One per host CPU core, 1 (default): Single-threaded, Otherwise the number of threads to use
+sw_rasterizer_threads =
+
+# Number of threads used to run the vertex shader of large draw calls
+# 0: One per host CPU core, 1 (default): Single-threaded, Otherwise the number of threads to use
+vertex_shader_threads =
+
+# Whether to store the shaders used by each title on disk and compile them ahead of time at boot
+# 0: Off, 1 (default): On
+use_disk_shader_cache =
+
+# Whether to compile shaders on a separate thread, running them on the interpreter until they are ready
+# 0 (default): Off, 1: On
+use_async_shader_compilation =
+
+# Whether to process the GPU commands on a separate thread, decoupled from the emulated CPU
+# 0 (default): Off, 1: On
+use_gpu_thread =
+
 # Resolution scale factor
 # 0: Auto (scales resolution to window size), 1: Native 3DS screen resolution, Otherwise a scale
 # factor for the 3DS resolution
@@ -82,7 +102,8 @@ swap_screen =
 
 [Audio]
 # Which audio output engine to use.
-# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available)
+# auto (default): Auto-select, null: No audio output, sdl2: SDL2 (if available),
+# capture: Write the audio to audio_capture_path
 output_engine =
 
 # Whether or not to enable the audio-stretching post-processing effect.
@@ -95,6 +116,26 @@ enable_audio_stretching =
 # auto (default): Auto-select
 output_device =
 
+# Whether to run the audio stretching and output on a dedicated thread.
+# Frames are generated on the emulation thread and queued for the audio thread.
+# 0: No, 1 (default): Yes
+use_audio_thread =
+
+# Number of 5ms frames queued for the audio thread. Frames generated while the queue is full are
+# dropped.
+# Must be at least 1, 8 (default)
+audio_queue_depth =
+
+# File the capture output engine writes the audio to. A WAV file if the name ends with .wav, raw
+# interleaved stereo 16 bits PCM otherwise. A hash of every frame is written next to it, to the
+# same name followed by .hashes.
+audio_capture_path =
+
+# Renders the audio as fast as emulation runs, for capturing it. This disables audio stretching,
+# the frame limiter and the audio thread, and never drops frames.
+# 0 (default): No, 1: Yes
+audio_offline_rendering =
+
 [Data Storage]
 # Whether to create a virtual SD card.
 # 1 (default): Yes, 0: No
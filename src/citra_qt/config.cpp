@@ -44,6 +44,14 @@ void Config::ReadValues() {
     qt_config->beginGroup("Renderer");
     Settings::values.use_hw_renderer = qt_config->value("use_hw_renderer", true).toBool();
     Settings::values.use_shader_jit = qt_config->value("use_shader_jit", true).toBool();
+    Settings::values.sw_rasterizer_threads =
+        static_cast<u16>(qt_config->value("sw_rasterizer_threads", 1).toInt());
+    Settings::values.vertex_shader_threads =
+        static_cast<u16>(qt_config->value("vertex_shader_threads", 1).toInt());
+    Settings::values.use_disk_shader_cache =
+        qt_config->value("use_disk_shader_cache", true).toBool();
+    Settings::values.use_async_shader_compilation =
+        qt_config->value("use_async_shader_compilation", false).toBool();
     Settings::values.resolution_factor = qt_config->value("resolution_factor", 1.0).toFloat();
     Settings::values.use_vsync = qt_config->value("use_vsync", false).toBool();
     Settings::values.toggle_framelimit = qt_config->value("toggle_framelimit", true).toBool();
@@ -65,6 +73,13 @@ void Config::ReadValues() {
         qt_config->value("enable_audio_stretching", true).toBool();
     Settings::values.audio_device_id =
         qt_config->value("output_device", "auto").toString().toStdString();
+    Settings::values.use_audio_thread = qt_config->value("use_audio_thread", true).toBool();
+    Settings::values.audio_queue_depth =
+        static_cast<u16>(qt_config->value("audio_queue_depth", 8).toInt());
+    Settings::values.audio_capture_path =
+        qt_config->value("audio_capture_path", "audio_capture.wav").toString().toStdString();
+    Settings::values.audio_offline_rendering =
+        qt_config->value("audio_offline_rendering", false).toBool();
     qt_config->endGroup();
 
     qt_config->beginGroup("Data Storage");
@@ -153,6 +168,11 @@ void Config::SaveValues() {
     qt_config->beginGroup("Renderer");
     qt_config->setValue("use_hw_renderer", Settings::values.use_hw_renderer);
     qt_config->setValue("use_shader_jit", Settings::values.use_shader_jit);
+    qt_config->setValue("sw_rasterizer_threads", Settings::values.sw_rasterizer_threads);
+    qt_config->setValue("vertex_shader_threads", Settings::values.vertex_shader_threads);
+    qt_config->setValue("use_disk_shader_cache", Settings::values.use_disk_shader_cache);
+    qt_config->setValue("use_async_shader_compilation",
+                        Settings::values.use_async_shader_compilation);
     qt_config->setValue("resolution_factor", (double)Settings::values.resolution_factor);
     qt_config->setValue("use_vsync", Settings::values.use_vsync);
     qt_config->setValue("toggle_framelimit", Settings::values.toggle_framelimit);
@@ -172,6 +192,11 @@ void Config::SaveValues() {
     qt_config->setValue("output_engine", QString::fromStdString(Settings::values.sink_id));
     qt_config->setValue("enable_audio_stretching", Settings::values.enable_audio_stretching);
     qt_config->setValue("output_device", QString::fromStdString(Settings::values.audio_device_id));
+    qt_config->setValue("use_audio_thread", Settings::values.use_audio_thread);
+    qt_config->setValue("audio_queue_depth", Settings::values.audio_queue_depth);
+    qt_config->setValue("audio_capture_path",
+                        QString::fromStdString(Settings::values.audio_capture_path));
+    qt_config->setValue("audio_offline_rendering", Settings::values.audio_offline_rendering);
     qt_config->endGroup();
 
     qt_config->beginGroup("Data Storage");
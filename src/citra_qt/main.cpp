@@ -31,6 +31,8 @@
 #include "citra_qt/hotkeys.h"
 #include "citra_qt/main.h"
 #include "citra_qt/ui_settings.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
@@ -627,6 +629,8 @@ void GMainWindow::closeEvent(QCloseEvent* event) {
 int main(int argc, char* argv[]) {
     Log::Filter log_filter(Log::Level::Info);
     Log::SetFilter(&log_filter);
+    Log::Init(FileUtil::GetUserPath(D_LOGS_IDX) + LOG_FILE);
+    SCOPE_EXIT({ Log::Shutdown(); });
 
     MicroProfileOnThreadCreate("Frontend");
     SCOPE_EXIT({ MicroProfileShutdown(); });
@@ -36,6 +36,7 @@
 #include <cstring>
 #include <dirent.h>
 #include <pwd.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #endif
 
@@ -57,6 +58,7 @@
 #endif
 
 #include <algorithm>
+#include <limits>
 #include <sys/stat.h>
 
 #ifndef S_ISDIR
@@ -715,6 +717,7 @@ const std::string& GetUserPath(const unsigned int DirIDX, const std::string& new
         paths[D_SDMC_IDX] = paths[D_USER_IDX] + SDMC_DIR DIR_SEP;
         paths[D_NAND_IDX] = paths[D_USER_IDX] + NAND_DIR DIR_SEP;
         paths[D_SYSDATA_IDX] = paths[D_USER_IDX] + SYSDATA_DIR DIR_SEP;
+        paths[D_LOGS_IDX] = paths[D_USER_IDX] + LOG_DIR DIR_SEP;
     }
 
     if (!newPath.empty()) {
@@ -736,6 +739,7 @@ const std::string& GetUserPath(const unsigned int DirIDX, const std::string& new
             paths[D_CACHE_IDX] = paths[D_USER_IDX] + CACHE_DIR DIR_SEP;
             paths[D_SDMC_IDX] = paths[D_USER_IDX] + SDMC_DIR DIR_SEP;
             paths[D_NAND_IDX] = paths[D_USER_IDX] + NAND_DIR DIR_SEP;
+            paths[D_LOGS_IDX] = paths[D_USER_IDX] + LOG_DIR DIR_SEP;
             break;
         }
     }
@@ -889,4 +893,63 @@ bool IOFile::Resize(u64 size) {
     return m_good;
 }
 
+MappedFile::MappedFile(const IOFile& file) {
+    const u64 file_size = file.GetSize();
+    if (!file.IsOpen() || file_size == 0 || file_size > std::numeric_limits<size_t>::max())
+        return;
+
+#ifdef _WIN32
+    const HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file.GetHandle())));
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        LOG_ERROR(Common_Filesystem, "CreateFileMapping failed: %s", GetLastErrorMsg());
+        return;
+    }
+    data = static_cast<u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        LOG_ERROR(Common_Filesystem, "MapViewOfFile failed: %s", GetLastErrorMsg());
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+        return;
+    }
+#else
+    void* view = mmap(nullptr, static_cast<size_t>(file_size), PROT_READ, MAP_PRIVATE,
+                      fileno(file.GetHandle()), 0);
+    if (view == MAP_FAILED) {
+        LOG_ERROR(Common_Filesystem, "mmap failed: %s", GetLastErrorMsg());
+        return;
+    }
+    data = static_cast<u8*>(view);
+    madvise(view, static_cast<size_t>(file_size), MADV_RANDOM);
+#endif
+
+    size = file_size;
+}
+
+MappedFile::~MappedFile() {
+    if (!IsMapped())
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mapping_handle);
+#else
+    munmap(data, static_cast<size_t>(size));
+#endif
+}
+
+void MappedFile::WillNeed(u64 offset, u64 length) const {
+    if (!IsMapped() || offset >= size)
+        return;
+    length = std::min(length, size - offset);
+
+#ifdef _WIN32
+    // The hint needs PrefetchVirtualMemory from Windows 8, pages are read as they are accessed
+#else
+    static const u64 page_size = static_cast<u64>(sysconf(_SC_PAGESIZE));
+    const u64 start = offset & ~(page_size - 1);
+    madvise(data + start, static_cast<size_t>(offset + length - start), MADV_WILLNEED);
+#endif
+}
+
 } // namespace
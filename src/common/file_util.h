@@ -248,11 +248,48 @@ public:
         std::clearerr(m_file);
     }
 
+    std::FILE* GetHandle() const {
+        return m_file;
+    }
+
 private:
     std::FILE* m_file = nullptr;
     bool m_good = true;
 };
 
+/**
+ * Read-only view of a whole file mapped in memory. The pages are read from the file as they are
+ * accessed, and readers request read-ahead themselves with WillNeed.
+ */
+class MappedFile : public NonCopyable {
+public:
+    /// Maps the file, which can be closed afterwards. Check IsMapped, the mapping can fail.
+    explicit MappedFile(const IOFile& file);
+    ~MappedFile();
+
+    bool IsMapped() const {
+        return data != nullptr;
+    }
+
+    const u8* GetData() const {
+        return data;
+    }
+
+    u64 GetSize() const {
+        return size;
+    }
+
+    /// Tells the OS that a range is going to be read soon, so that it is read in the background
+    void WillNeed(u64 offset, u64 length) const;
+
+private:
+    u8* data = nullptr;
+    u64 size = 0;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
 } // namespace
 
 // To deal with Windows being dumb at unicode:
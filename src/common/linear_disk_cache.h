@@ -4,18 +4,18 @@
 
 #pragma once
 
+#include <cstring>
 #include <fstream>
 #include "common/common_types.h"
-
-// defined in Version.cpp
-extern const char* scm_rev_git_str;
+#include "common/file_util.h"
+#include "common/scm_rev.h"
 
 // On disk format:
 // header{
 // u32 'DCAC';
-// u32 version;  // svn_rev
 // u16 sizeof(key_type);
 // u16 sizeof(value_type);
+// char version[40]; // git revision
 //}
 
 // key_value_pair{
@@ -46,7 +46,7 @@ template <typename K, typename V>
 class LinearDiskCache {
 public:
     // return number of read entries
-    u32 OpenAndRead(const char* filename, LinearDiskCacheReader<K, V>& reader) {
+    u32 OpenAndRead(const std::string& filename, LinearDiskCacheReader<K, V>& reader) {
         using std::ios_base;
 
         // close any currently opened file
@@ -92,8 +92,9 @@ public:
                 m_num_entries++;
                 last_pos = m_file.tellg();
             }
-            m_file.seekp(last_pos);
+            // The error flags have to be cleared first, or seeking would fail after reaching the end
             m_file.clear();
+            m_file.seekp(last_pos);
 
             delete[] value;
             return m_num_entries;
@@ -102,7 +103,7 @@ public:
         // failed to open file for reading or bad header
         // close and recreate file
         Close();
-        m_file.open(filename, ios_base::out | ios_base::trunc | ios_base::binary);
+        OpenFStream(m_file, filename, ios_base::out | ios_base::trunc | ios_base::binary);
         WriteHeader();
         return 0;
     }
@@ -138,7 +139,7 @@ private:
         char file_header[sizeof(Header)];
 
         return (Read(file_header, sizeof(Header)) &&
-                !memcmp((const char*)&m_header, file_header, sizeof(Header)));
+                !std::memcmp((const char*)&m_header, file_header, sizeof(Header)));
     }
 
     template <typename D>
@@ -153,7 +154,8 @@ private:
 
     struct Header {
         Header() : id(*(u32*)"DCAC"), key_t_size(sizeof(K)), value_t_size(sizeof(V)) {
-            memcpy(ver, scm_rev_git_str, 40);
+            std::memset(ver, 0, sizeof(ver));
+            std::strncpy(ver, Common::g_scm_rev, sizeof(ver));
         }
 
         const u32 id;
@@ -4,13 +4,24 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #include "common/assert.h"
 #include "common/common_funcs.h" // snprintf compatibility define
+#include "common/file_util.h"
 #include "common/logging/backend.h"
 #include "common/logging/filter.h"
 #include "common/logging/log.h"
+#include "common/logging/ring.h"
 #include "common/logging/text_formatter.h"
+#include "common/thread.h"
 
 namespace Log {
 
@@ -105,23 +116,30 @@ const char* GetLevelName(Level log_level) {
 #undef LVL
 }
 
-Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
-                  const char* function, const char* format, va_list args) {
+static std::chrono::microseconds GetTimestamp() {
     using std::chrono::steady_clock;
     using std::chrono::duration_cast;
 
     static steady_clock::time_point time_origin = steady_clock::now();
+    return duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+}
 
+static std::string FormatLocation(const char* filename, unsigned int line_nr,
+                                  const char* function) {
+    std::array<char, 1024> location;
+    snprintf(location.data(), location.size(), "%s:%s:%u", filename, function, line_nr);
+    return location.data();
+}
+
+Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+                  const char* function, const char* format, va_list args) {
     std::array<char, 4 * 1024> formatting_buffer;
 
     Entry entry;
-    entry.timestamp = duration_cast<std::chrono::microseconds>(steady_clock::now() - time_origin);
+    entry.timestamp = GetTimestamp();
     entry.log_class = log_class;
     entry.log_level = log_level;
-
-    snprintf(formatting_buffer.data(), formatting_buffer.size(), "%s:%s:%u", filename, function,
-             line_nr);
-    entry.location = std::string(formatting_buffer.data());
+    entry.location = FormatLocation(filename, line_nr, function);
 
     vsnprintf(formatting_buffer.data(), formatting_buffer.size(), format, args);
     entry.message = std::string(formatting_buffer.data());
@@ -129,19 +147,354 @@ Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsign
     return entry;
 }
 
+namespace {
+
+/// Messages longer than this are truncated
+constexpr size_t MAX_MESSAGE_LENGTH = 4 * 1024 - 1;
+
+/// The log file is rotated once it grows larger than this
+constexpr u64 MAX_LOG_FILE_SIZE = 32 * 1024 * 1024;
+/// Number of rotated log files to keep, named <log file>.1 (the newest) to <log file>.N
+constexpr int LOG_FILE_BACKUPS = 3;
+
+/// Log file that is moved aside when it grows too large
+class LogFile {
+public:
+    void Open(const std::string& path_) {
+        path = path_;
+        if (!FileUtil::Exists(path))
+            FileUtil::CreateFullPath(path);
+
+        // Keep the log of the previous session around
+        Rotate();
+    }
+
+    void Write(const char* text, size_t length) {
+        if (!file.IsOpen())
+            return;
+
+        file.WriteBytes(text, length);
+        size += length;
+        if (size > MAX_LOG_FILE_SIZE)
+            Rotate();
+    }
+
+    void Flush() {
+        if (file.IsOpen())
+            file.Flush();
+    }
+
+    void Close() {
+        file.Close();
+    }
+
+private:
+    void Rotate() {
+        file.Close();
+
+        for (int i = LOG_FILE_BACKUPS; i > 0; --i) {
+            const std::string source = i == 1 ? path : path + "." + std::to_string(i - 1);
+            const std::string destination = path + "." + std::to_string(i);
+            if (!FileUtil::Exists(source))
+                continue;
+            if (FileUtil::Exists(destination))
+                FileUtil::Delete(destination);
+            FileUtil::Rename(source, destination);
+        }
+
+        file.Open(path, "w");
+        size = 0;
+    }
+
+    std::string path;
+    FileUtil::IOFile file;
+    u64 size = 0;
+};
+
+class Backend {
+public:
+    void Init(const std::string& log_file) {
+        if (running)
+            return;
+
+        if (!log_file.empty())
+            file.Open(log_file);
+
+        stop = false;
+        thread = std::thread(&Backend::ThreadLoop, this);
+        running = true;
+    }
+
+    void Shutdown() {
+        if (!thread.joinable())
+            return;
+
+        // Messages logged from now on are written out right away by the calling thread
+        running = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wakeup_cv.notify_one();
+        thread.join();
+
+        file.Close();
+    }
+
+    bool IsRunning() const {
+        return running;
+    }
+
+    /**
+     * Queues a message in the ring of the calling thread.
+     * @returns false, without consuming `args`, if the calling thread is exiting and can't queue
+     *          messages anymore
+     */
+    bool Push(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
+              const char* function, const char* format, va_list args) {
+        Ring* ring = GetThreadRing();
+        if (ring == nullptr)
+            return false;
+
+        std::array<char, MAX_MESSAGE_LENGTH + 1> message;
+        const int length = vsnprintf(message.data(), message.size(), format, args);
+
+        RecordHeader header;
+        header.log_class = log_class;
+        header.log_level = log_level;
+        header.message_length =
+            static_cast<u16>(std::min<size_t>(std::max(length, 0), MAX_MESSAGE_LENGTH));
+        header.line_nr = line_nr;
+        header.timestamp = GetTimestamp();
+        header.filename = filename;
+        header.function = function;
+
+        const auto usage = ring->Push(header, message.data());
+
+        // Wake up the logging thread early when a burst of messages fills up the ring
+        if (usage.first < Ring::SIZE / 2 && usage.second >= Ring::SIZE / 2) {
+            wakeup_requested = true;
+            wakeup_cv.notify_one();
+        }
+        return true;
+    }
+
+    void Flush() {
+        if (!running || std::this_thread::get_id() == thread.get_id())
+            return;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        const u64 ticket = ++flush_requested;
+        wakeup_cv.notify_one();
+        flushed_cv.wait(lock, [&] { return flush_done >= ticket || !running; });
+    }
+
+    u64 GetDroppedCount() {
+        std::vector<Ring*> all_rings;
+        ring_pool.GetRings(all_rings);
+
+        u64 dropped = 0;
+        for (const Ring* ring : all_rings) {
+            dropped += ring->GetDroppedCount();
+        }
+        return dropped;
+    }
+
+    RingPool& GetRingPool() {
+        return ring_pool;
+    }
+
+private:
+    /// Returns the ring of the calling thread, or nullptr if the thread is exiting
+    Ring* GetThreadRing();
+
+    void ThreadLoop() {
+        Common::SetCurrentThreadName("Logger");
+
+        while (true) {
+            bool stopping;
+            u64 flush_ticket;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup_cv.wait_for(lock, std::chrono::milliseconds(10), [this] {
+                    return stop || wakeup_requested || flush_requested != flush_done;
+                });
+                wakeup_requested = false;
+                stopping = stop;
+                flush_ticket = flush_requested;
+            }
+
+            Drain();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                flush_done = flush_ticket;
+            }
+            flushed_cv.notify_all();
+
+            if (stopping)
+                return;
+        }
+    }
+
+    /// Writes out all queued messages, merging the rings in timestamp order
+    void Drain() {
+        drained_rings.clear();
+        ring_pool.GetRings(drained_rings);
+
+        while (true) {
+            Ring* oldest_ring = nullptr;
+            const RecordHeader* oldest = nullptr;
+            for (Ring* ring : drained_rings) {
+                const RecordHeader* header = ring->Peek();
+                if (header == nullptr)
+                    continue;
+                if (oldest == nullptr || header->timestamp < oldest->timestamp) {
+                    oldest_ring = ring;
+                    oldest = header;
+                }
+            }
+            if (oldest == nullptr)
+                break;
+
+            Entry entry;
+            entry.timestamp = oldest->timestamp;
+            entry.log_class = oldest->log_class;
+            entry.log_level = oldest->log_level;
+            entry.location = FormatLocation(oldest->filename, oldest->line_nr, oldest->function);
+            entry.message = reinterpret_cast<const char*>(oldest + 1);
+            oldest_ring->Pop(oldest);
+
+            Write(entry);
+        }
+
+        u64 dropped = 0;
+        for (const Ring* ring : drained_rings) {
+            dropped += ring->GetDroppedCount();
+        }
+        if (dropped != reported_dropped) {
+            Entry entry;
+            entry.timestamp = GetTimestamp();
+            entry.log_class = Class::Log;
+            entry.log_level = Level::Warning;
+            entry.location = FormatLocation(__FILE__, __LINE__, __func__);
+            entry.message = std::to_string(dropped - reported_dropped) +
+                            " messages were dropped because the log buffer was full";
+            reported_dropped = dropped;
+
+            Write(entry);
+        }
+
+        file.Flush();
+    }
+
+    void Write(const Entry& entry) {
+        PrintColoredMessage(entry);
+
+        std::array<char, 5 * 1024> format_buffer;
+        FormatLogMessage(entry, format_buffer.data(), format_buffer.size() - 1);
+        const size_t length = std::strlen(format_buffer.data());
+        format_buffer[length] = '\n';
+        file.Write(format_buffer.data(), length + 1);
+    }
+
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable wakeup_cv;
+    std::condition_variable flushed_cv;
+    /// Set by producers without taking the mutex, so that they never block
+    std::atomic<bool> wakeup_requested{false};
+    bool stop = false;
+    u64 flush_requested = 0;
+    u64 flush_done = 0;
+
+    /// Rings of the threads that log, kept across restarts of the backend
+    RingPool ring_pool;
+
+    // Only accessed by the logging thread
+    std::vector<Ring*> drained_rings;
+    u64 reported_dropped = 0;
+    LogFile file;
+};
+
+Backend& GetBackend() {
+    // Never destroyed, so that messages can still be logged during static destruction
+    static Backend* backend = new Backend;
+    return *backend;
+}
+
+/// Hands the ring of a thread back to the pool when the thread exits
+struct ThreadRing {
+    ~ThreadRing() {
+        if (ring != nullptr)
+            GetBackend().GetRingPool().Release(ring);
+        exited = true;
+    }
+
+    Ring* ring = nullptr;
+
+    /// Set once the ring is released. Trivially destructible, so that it can still be read by
+    /// the destructors of other thread_local objects that log.
+    static thread_local bool exited;
+};
+
+thread_local bool ThreadRing::exited = false;
+static thread_local ThreadRing thread_ring;
+
+Ring* Backend::GetThreadRing() {
+    if (ThreadRing::exited)
+        return nullptr;
+
+    if (thread_ring.ring == nullptr)
+        thread_ring.ring = ring_pool.Acquire();
+    return thread_ring.ring;
+}
+
+} // anonymous namespace
+
 static Filter* filter = nullptr;
 
 void SetFilter(Filter* new_filter) {
     filter = new_filter;
 }
 
+void Init(const std::string& log_file) {
+    GetBackend().Init(log_file);
+}
+
+void Shutdown() {
+    GetBackend().Shutdown();
+}
+
+void Flush() {
+    GetBackend().Flush();
+}
+
+u64 GetDroppedMessageCount() {
+    return GetBackend().GetDroppedCount();
+}
+
 void LogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_nr,
                 const char* function, const char* format, ...) {
     if (filter != nullptr && !filter->CheckMessage(log_class, log_level))
         return;
 
+    Backend& backend = GetBackend();
+
     va_list args;
     va_start(args, format);
+    if (backend.IsRunning() &&
+        backend.Push(log_class, log_level, filename, line_nr, function, format, args)) {
+        va_end(args);
+
+        // Critical messages usually precede a crash, make sure they aren't lost
+        if (log_level == Level::Critical)
+            backend.Flush();
+        return;
+    }
+
     Entry entry = CreateEntry(log_class, log_level, filename, line_nr, function, format, args);
     va_end(args);
 
@@ -8,6 +8,7 @@
 #include <cstdarg>
 #include <string>
 #include <utility>
+#include "common/common_types.h"
 #include "common/logging/log.h"
 
 namespace Log {
@@ -47,4 +48,22 @@ Entry CreateEntry(Class log_class, Level log_level, const char* filename, unsign
                   const char* function, const char* format, va_list args);
 
 void SetFilter(Filter* filter);
+
+/**
+ * Starts the logging thread. Until it is stopped, messages are queued in a ring buffer owned by
+ * the calling thread, and formatted and written out by the logging thread. Messages are dropped
+ * when a ring is full. Without the logging thread, messages are written out right away.
+ * @param log_file Path of the log file, which is rotated when it grows too large. If empty,
+ *                 messages are only printed to the console.
+ */
+void Init(const std::string& log_file);
+
+/// Writes out the queued messages and stops the logging thread
+void Shutdown();
+
+/// Waits until the messages queued so far are written out
+void Flush();
+
+/// Returns the number of messages dropped because the ring buffer of their thread was full
+u64 GetDroppedMessageCount();
 }
@@ -0,0 +1,167 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "common/alignment.h"
+#include "common/common_types.h"
+#include "common/logging/log.h"
+
+namespace Log {
+
+/**
+ * A queued message. The message text follows the header, and the location is only formatted by
+ * the logging thread, since the file and function names are string literals.
+ */
+struct RecordHeader {
+    /// Size of the record including the message, or the size of the padding at the end of the
+    /// ring if PADDING_FLAG is set.
+    u32 size;
+    Class log_class;
+    Level log_level;
+    u16 message_length;
+    u32 line_nr;
+    std::chrono::microseconds timestamp;
+    const char* filename;
+    const char* function;
+
+    static constexpr u32 PADDING_FLAG = 0x80000000;
+};
+static_assert(sizeof(RecordHeader) % 8 == 0, "Records must stay 8-byte aligned");
+
+/// Single producer, single consumer ring buffer of variable-sized records
+class Ring {
+public:
+    /// Size of the ring buffer of each thread that logs messages
+    static constexpr size_t SIZE = 256 * 1024;
+
+    /**
+     * Copies the record into the ring. Only called by the thread that owns the ring.
+     * @returns The number of bytes in use before and after the push
+     */
+    std::pair<size_t, size_t> Push(const RecordHeader& header, const char* message) {
+        const u32 size = Common::AlignUp<u32>(
+            static_cast<u32>(sizeof(RecordHeader) + header.message_length + 1), 8);
+
+        u64 write = write_pos.load(std::memory_order_relaxed);
+        const u64 read = read_pos.load(std::memory_order_acquire);
+
+        // Records are never split, the end of the ring is skipped if the record doesn't fit
+        const size_t offset = write % SIZE;
+        const size_t contiguous = SIZE - offset;
+        const size_t padding = contiguous < size ? contiguous : 0;
+
+        const size_t used = static_cast<size_t>(write - read);
+        if (used + padding + size > SIZE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return {used, used};
+        }
+
+        if (padding != 0) {
+            const u32 padding_size = static_cast<u32>(padding) | RecordHeader::PADDING_FLAG;
+            std::memcpy(&buffer[offset], &padding_size, sizeof(padding_size));
+            write += padding;
+        }
+
+        u8* record = &buffer[write % SIZE];
+        std::memcpy(record, &header, sizeof(RecordHeader));
+        std::memcpy(record, &size, sizeof(size));
+        std::memcpy(record + sizeof(RecordHeader), message, header.message_length);
+        record[sizeof(RecordHeader) + header.message_length] = '\0';
+
+        write_pos.store(write + size, std::memory_order_release);
+        return {used, used + padding + size};
+    }
+
+    /// Returns the oldest record in the ring, or nullptr if it is empty
+    const RecordHeader* Peek() {
+        u64 read = read_pos.load(std::memory_order_relaxed);
+        const u64 write = write_pos.load(std::memory_order_acquire);
+
+        while (read != write) {
+            const RecordHeader* header =
+                reinterpret_cast<const RecordHeader*>(&buffer[read % SIZE]);
+            if (!(header->size & RecordHeader::PADDING_FLAG))
+                return header;
+
+            read += header->size & ~RecordHeader::PADDING_FLAG;
+            read_pos.store(read, std::memory_order_release);
+        }
+        return nullptr;
+    }
+
+    /// Removes the record returned by Peek
+    void Pop(const RecordHeader* header) {
+        read_pos.store(read_pos.load(std::memory_order_relaxed) + header->size,
+                       std::memory_order_release);
+    }
+
+    u64 GetDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(8) std::array<u8, SIZE> buffer;
+
+    // Kept on separate cache lines, since they are written by different threads
+    alignas(64) std::atomic<u64> write_pos{0};
+    alignas(64) std::atomic<u64> read_pos{0};
+    alignas(64) std::atomic<u64> dropped{0};
+};
+
+/**
+ * Owns the rings of all threads. A ring is handed back to the pool when its thread exits, and the
+ * next thread that starts logging takes it over along with any messages still queued in it. This
+ * keeps the number of rings at the largest number of threads that were logging at the same time.
+ */
+class RingPool {
+public:
+    /// Returns a ring that no other thread is pushing to
+    Ring* Acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!free_rings.empty()) {
+            Ring* ring = free_rings.back();
+            free_rings.pop_back();
+            return ring;
+        }
+
+        rings.push_back(std::make_unique<Ring>());
+        return rings.back().get();
+    }
+
+    /// Hands back a ring returned by Acquire. The calling thread must not push to it anymore.
+    void Release(Ring* ring) {
+        std::lock_guard<std::mutex> lock(mutex);
+        free_rings.push_back(ring);
+    }
+
+    /// Appends all rings, including the ones not in use, to `out`
+    void GetRings(std::vector<Ring*>& out) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& ring : rings) {
+            out.push_back(ring.get());
+        }
+    }
+
+    /// Returns the number of rings allocated so far
+    size_t GetSize() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return rings.size();
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring*> free_rings;
+};
+
+} // namespace Log
@@ -0,0 +1,91 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/thread.h"
+#include "common/thread_pool.h"
+
+namespace Common {
+
+ThreadPool::ThreadPool(size_t num_threads, const std::string& name) {
+    ASSERT(num_threads > 0);
+
+    workers.reserve(num_threads - 1);
+    for (size_t i = 1; i < num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i, name);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop_requested = true;
+    }
+    work_available.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t, size_t)>& func) {
+    if (workers.empty() || count <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            func(i, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &func;
+        job_count = count;
+        next_index = 0;
+        busy_workers = workers.size();
+        ++generation;
+    }
+    work_available.notify_all();
+
+    RunIterations(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    work_done.wait(lock, [this] { return busy_workers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::WorkerLoop(size_t thread_index, std::string name) {
+    SetCurrentThreadName(name.c_str());
+
+    size_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_available.wait(lock, [this, seen_generation] {
+                return stop_requested || generation != seen_generation;
+            });
+            if (stop_requested)
+                return;
+            seen_generation = generation;
+        }
+
+        RunIterations(thread_index);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy_workers == 0)
+                work_done.notify_one();
+        }
+    }
+}
+
+void ThreadPool::RunIterations(size_t thread_index) {
+    const auto& func = *job;
+    const size_t count = job_count;
+
+    for (size_t index = next_index++; index < count; index = next_index++) {
+        func(index, thread_index);
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,69 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+/**
+ * A fixed set of worker threads which cooperatively execute the iterations of a parallel loop.
+ * The thread calling ParallelFor takes part in the work too, so a pool created for N threads only
+ * spawns N - 1 background threads.
+ */
+class ThreadPool {
+public:
+    /**
+     * Creates the pool and spawns its worker threads.
+     * @param num_threads Total number of threads taking part in a ParallelFor, including the caller
+     * @param name Debugger-visible name given to the worker threads
+     */
+    ThreadPool(size_t num_threads, const std::string& name);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Returns the total number of threads taking part in a ParallelFor, including the caller
+    size_t GetNumThreads() const {
+        return workers.size() + 1;
+    }
+
+    /**
+     * Calls func(index, thread_index) once for every index in [0, count), distributing the
+     * iterations among the threads of the pool, and returns once all of them have completed.
+     * thread_index is in [0, GetNumThreads()) and identifies the thread running the iteration,
+     * which allows callers to keep per-thread scratch state. No ordering is guaranteed between
+     * iterations. Must not be called concurrently or from within func.
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t, size_t)>& func);
+
+private:
+    void WorkerLoop(size_t thread_index, std::string name);
+    void RunIterations(size_t thread_index);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+
+    const std::function<void(size_t, size_t)>* job = nullptr;
+    size_t job_count = 0;
+    std::atomic<size_t> next_index{0};
+
+    size_t generation = 0; ///< Incremented once each time work is handed out
+    size_t busy_workers = 0;
+    bool stop_requested = false;
+};
+
+} // namespace Common
@@ -0,0 +1,208 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Unbounded lock-free queue with any number of producers and a single consumer, after Dmitry
+ * Vyukov's node-based MPSC queue. Push never blocks and never fails, but allocates a node. A Pop
+ * running concurrently with a Push may not see the pushed element yet.
+ */
+template <typename T>
+class MPSCQueue : NonCopyable {
+public:
+    MPSCQueue() {
+        Node* stub = new Node;
+        head.store(stub, std::memory_order_relaxed);
+        tail = stub;
+    }
+
+    ~MPSCQueue() {
+        while (tail != nullptr) {
+            Node* next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+
+    /// Appends an element to the queue, callable from any thread
+    void Push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+
+        Node* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * Removes the oldest element from the queue. Only called by the consumer thread.
+     * @returns False if the queue is empty
+     */
+    bool Pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return false;
+
+        // The popped node becomes the new stub
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    /// Only called by the consumer thread
+    bool Empty() const {
+        return tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    /// Last pushed node, written by producers
+    std::atomic<Node*> head;
+    /// Stub node in front of the oldest element, only accessed by the consumer
+    Node* tail;
+};
+
+/**
+ * Unbounded lock-free queue with a single producer and a single consumer. Push never blocks and
+ * never fails, but allocates a node. A Pop running concurrently with a Push may not see the pushed
+ * element yet.
+ */
+template <typename T>
+class SPSCQueue : NonCopyable {
+public:
+    SPSCQueue() {
+        head = tail = new Node;
+    }
+
+    ~SPSCQueue() {
+        while (tail != nullptr) {
+            Node* next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+
+    /// Appends an element to the queue. Only called by the producer thread.
+    void Push(T value) {
+        Node* node = new Node;
+        head->value = std::move(value);
+        // Publishing the new stub makes the element written to the old one visible
+        head->next.store(node, std::memory_order_release);
+        head = node;
+    }
+
+    /**
+     * Removes the oldest element from the queue. Only called by the consumer thread.
+     * @returns False if the queue is empty
+     */
+    bool Pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return false;
+
+        value = std::move(tail->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    /// Only called by the consumer thread
+    bool Empty() const {
+        return tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value;
+    };
+
+    /// Empty node the next element is written to, only accessed by the producer
+    Node* head;
+    /// Node holding the oldest element, or equal to head if empty, only accessed by the consumer
+    Node* tail;
+};
+
+/**
+ * Fixed-capacity lock-free ring buffer with a single producer and a single consumer. Neither Push
+ * nor Pop allocates or blocks, a Push fails instead when the queue is full.
+ */
+template <typename T>
+class BoundedSPSCQueue : NonCopyable {
+public:
+    /// One slot is kept empty to tell a full queue from an empty one
+    explicit BoundedSPSCQueue(size_t capacity) : slots(capacity + 1) {}
+
+    /**
+     * Appends an element to the queue. Only called by the producer thread.
+     * @returns False if the queue is full, in which case the element is dropped
+     */
+    bool TryPush(T value) {
+        const size_t write = write_index.load(std::memory_order_relaxed);
+        const size_t next = Next(write);
+        if (next == read_index.load(std::memory_order_acquire))
+            return false;
+
+        slots[write] = std::move(value);
+        write_index.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Removes the oldest element from the queue. Only called by the consumer thread.
+     * @returns False if the queue is empty
+     */
+    bool Pop(T& value) {
+        const size_t read = read_index.load(std::memory_order_relaxed);
+        if (read == write_index.load(std::memory_order_acquire))
+            return false;
+
+        value = std::move(slots[read]);
+        read_index.store(Next(read), std::memory_order_release);
+        return true;
+    }
+
+    /// Only called by the consumer thread
+    bool Empty() const {
+        return read_index.load(std::memory_order_relaxed) ==
+               write_index.load(std::memory_order_acquire);
+    }
+
+    /// Number of elements in the queue, only exact when called by the producer or the consumer
+    size_t Size() const {
+        const size_t write = write_index.load(std::memory_order_acquire);
+        const size_t read = read_index.load(std::memory_order_acquire);
+        return write >= read ? write - read : write + slots.size() - read;
+    }
+
+    size_t Capacity() const {
+        return slots.size() - 1;
+    }
+
+private:
+    size_t Next(size_t index) const {
+        return index + 1 == slots.size() ? 0 : index + 1;
+    }
+
+    std::vector<T> slots;
+    /// Slot the next element is written to, written by the producer
+    alignas(64) std::atomic<size_t> write_index{0};
+    /// Slot of the oldest element, written by the consumer. Kept on its own cache line.
+    alignas(64) std::atomic<size_t> read_index{0};
+};
+
+} // namespace Common
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include "common/common_types.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 #include "core/arm/skyeye_common/vfp/asm_vfp.h"
@@ -41,6 +42,13 @@ public:
     /// Clear all instruction cache
     virtual void ClearInstructionCache() = 0;
 
+    /**
+     * Invalidates the cached code translated from the given address range
+     * @param start_address Start of the range
+     * @param length Length of the range in bytes
+     */
+    virtual void InvalidateCacheRange(u32 start_address, size_t length) = 0;
+
     /**
      * Set the Program Counter to an address
      * @param addr Address to set PC to
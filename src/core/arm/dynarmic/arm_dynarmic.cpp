@@ -9,6 +9,7 @@
 #include "common/microprofile.h"
 #include "core/arm/dynarmic/arm_dynarmic.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/hle/svc.h"
@@ -35,6 +36,12 @@ static void InterpreterFallback(u32 pc, Dynarmic::Jit* jit, void* user_arg) {
     jit->SetFpscr(state->VFP[VFP_FPSCR]);
 }
 
+static u32 MemoryReadCode(u32 vaddr) {
+    // Lets writes to the page invalidate the blocks compiled from it
+    Memory::MarkRegionAsCode(vaddr, sizeof(u32));
+    return Memory::Read32(vaddr);
+}
+
 static bool IsReadOnlyMemory(u32 vaddr) {
     // TODO(bunnei): ImplementMe
     return false;
@@ -46,11 +53,11 @@ static Dynarmic::UserCallbacks GetUserCallbacks(ARMul_State* interpeter_state) {
     user_callbacks.user_arg = static_cast<void*>(interpeter_state);
     user_callbacks.CallSVC = &SVC::CallSVC;
     user_callbacks.IsReadOnlyMemory = &IsReadOnlyMemory;
-    user_callbacks.MemoryReadCode = &Memory::Read32;
-    user_callbacks.MemoryRead8 = &Memory::Read8;
-    user_callbacks.MemoryRead16 = &Memory::Read16;
-    user_callbacks.MemoryRead32 = &Memory::Read32;
-    user_callbacks.MemoryRead64 = &Memory::Read64;
+    user_callbacks.MemoryReadCode = &MemoryReadCode;
+    user_callbacks.MemoryRead8 = &Memory::JitRead8;
+    user_callbacks.MemoryRead16 = &Memory::JitRead16;
+    user_callbacks.MemoryRead32 = &Memory::JitRead32;
+    user_callbacks.MemoryRead64 = &Memory::JitRead64;
     user_callbacks.MemoryWrite8 = &Memory::Write8;
     user_callbacks.MemoryWrite16 = &Memory::Write16;
     user_callbacks.MemoryWrite32 = &Memory::Write32;
@@ -66,6 +73,7 @@ ARM_Dynarmic::ARM_Dynarmic(PrivilegeMode initial_mode) {
 
 void ARM_Dynarmic::SetPC(u32 pc) {
     jit->Regs()[15] = pc;
+    idle_loop_detector.Reset();
 }
 
 u32 ARM_Dynarmic::GetPC() const {
@@ -137,7 +145,15 @@ void ARM_Dynarmic::ExecuteInstructions(int num_instructions) {
     ZeroUpperAVX();
     unsigned ticks_executed = jit->Run(static_cast<unsigned>(num_instructions));
 
+    for (const auto& range : pending_invalidations) {
+        jit->InvalidateCacheRange(range.first, range.second);
+    }
+    pending_invalidations.clear();
+
+    const bool events_ran = down_count < static_cast<s64>(ticks_executed);
     AddTicks(ticks_executed);
+
+    idle_loop_detector.EndSlice(jit->Regs()[15], (jit->Cpsr() & (1 << 5)) != 0, events_ran);
 }
 
 void ARM_Dynarmic::SaveContext(ARM_Interface::ThreadContext& ctx) {
@@ -160,6 +176,7 @@ void ARM_Dynarmic::LoadContext(const ARM_Interface::ThreadContext& ctx) {
     jit->Regs()[13] = ctx.sp;
     jit->Regs()[14] = ctx.lr;
     jit->Regs()[15] = ctx.pc;
+    idle_loop_detector.Reset();
     jit->Cpsr() = ctx.cpsr;
 
     jit->SetFpscr(ctx.fpscr);
@@ -174,4 +191,19 @@ void ARM_Dynarmic::PrepareReschedule() {
 
 void ARM_Dynarmic::ClearInstructionCache() {
     jit->ClearCache();
+    ClearTransCache(interpreter_state.get());
+    idle_loop_detector.Clear();
+}
+
+void ARM_Dynarmic::InvalidateCacheRange(u32 start_address, size_t length) {
+    if (jit->IsExecuting()) {
+        // A store of the JIT hit a code page. The block doing it may be among the invalidated
+        // ones, so the JIT stops at the end of it and the blocks are invalidated after that.
+        pending_invalidations.emplace_back(start_address, length);
+        jit->HaltExecution();
+    } else {
+        jit->InvalidateCacheRange(start_address, length);
+    }
+    InvalidateTransCacheRange(interpreter_state.get(), start_address, static_cast<u32>(length));
+    idle_loop_detector.InvalidateRange(start_address, length);
 }
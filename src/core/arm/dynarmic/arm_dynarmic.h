@@ -5,9 +5,12 @@
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 #include <dynarmic/dynarmic.h>
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
+#include "core/arm/idle_loop_detector.h"
 #include "core/arm/skyeye_common/armstate.h"
 
 class ARM_Dynarmic final : public ARM_Interface {
@@ -36,8 +39,12 @@ public:
     void ExecuteInstructions(int num_instructions) override;
 
     void ClearInstructionCache() override;
+    void InvalidateCacheRange(u32 start_address, size_t length) override;
 
 private:
     std::unique_ptr<Dynarmic::Jit> jit;
     std::unique_ptr<ARMul_State> interpreter_state;
+    IdleLoopDetector idle_loop_detector;
+    /// Ranges written to while the JIT was running, invalidated once it returns
+    std::vector<std::pair<u32, size_t>> pending_invalidations;
 };
@@ -21,12 +21,18 @@ ARM_DynCom::ARM_DynCom(PrivilegeMode initial_mode) {
 ARM_DynCom::~ARM_DynCom() {}
 
 void ARM_DynCom::ClearInstructionCache() {
-    state->instruction_cache.clear();
-    trans_cache_buf_top = 0;
+    ClearTransCache(state.get());
+    idle_loop_detector.Clear();
+}
+
+void ARM_DynCom::InvalidateCacheRange(u32 start_address, size_t length) {
+    InvalidateTransCacheRange(state.get(), start_address, static_cast<u32>(length));
+    idle_loop_detector.InvalidateRange(start_address, length);
 }
 
 void ARM_DynCom::SetPC(u32 pc) {
     state->Reg[15] = pc;
+    idle_loop_detector.Reset();
 }
 
 u32 ARM_DynCom::GetPC() const {
@@ -86,7 +92,10 @@ void ARM_DynCom::ExecuteInstructions(int num_instructions) {
     // executing one instruction at a time. Otherwise, if a block is being executed, more
     // instructions may actually be executed than specified.
     unsigned ticks_executed = InterpreterMainLoop(state.get());
+    const bool events_ran = down_count < static_cast<s64>(ticks_executed);
     AddTicks(ticks_executed);
+
+    idle_loop_detector.EndSlice(state->Reg[15], state->TFlag != 0, events_ran);
 }
 
 void ARM_DynCom::SaveContext(ThreadContext& ctx) {
@@ -109,6 +118,7 @@ void ARM_DynCom::LoadContext(const ThreadContext& ctx) {
     state->Reg[13] = ctx.sp;
     state->Reg[14] = ctx.lr;
     state->Reg[15] = ctx.pc;
+    idle_loop_detector.Reset();
     state->Cpsr = ctx.cpsr;
 
     state->VFP[VFP_FPSCR] = ctx.fpscr;
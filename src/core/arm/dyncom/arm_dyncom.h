@@ -7,6 +7,7 @@
 #include <memory>
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
+#include "core/arm/idle_loop_detector.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 #include "core/arm/skyeye_common/armstate.h"
 
@@ -16,6 +17,7 @@ public:
     ~ARM_DynCom();
 
     void ClearInstructionCache() override;
+    void InvalidateCacheRange(u32 start_address, size_t length) override;
 
     void SetPC(u32 pc) override;
     u32 GetPC() const override;
@@ -40,4 +42,5 @@ public:
 
 private:
     std::unique_ptr<ARMul_State> state;
+    IdleLoopDetector idle_loop_detector;
 };
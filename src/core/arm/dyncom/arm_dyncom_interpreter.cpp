@@ -849,10 +849,9 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr)
     ARM_INST_PTR inst_base = nullptr;
     TransExtData ret = TransExtData::NON_BRANCH;
     int size = 0; // instruction size of basic block
-    bb_start = trans_cache_buf_top;
+    bb_start = AllocTransBlock(cpu->Reg[15]);
 
     u32 phys_addr = addr;
-    u32 pc_start = cpu->Reg[15];
 
     while (ret == TransExtData::NON_BRANCH) {
         unsigned int inst_size = InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
@@ -867,7 +866,8 @@ static int InterpreterTranslateBlock(ARMul_State* cpu, int& bb_start, u32 addr)
         ret = inst_base->br;
     };
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    GetTransBlock(bb_start)->end_pc = phys_addr;
+    RegisterTransBlock(cpu, bb_start);
 
     return KEEP_GOING;
 }
@@ -876,18 +876,18 @@ static int InterpreterTranslateSingle(ARMul_State* cpu, int& bb_start, u32 addr)
     MICROPROFILE_SCOPE(DynCom_Decode);
 
     ARM_INST_PTR inst_base = nullptr;
-    bb_start = trans_cache_buf_top;
+    bb_start = AllocTransBlock(cpu->Reg[15]);
 
     u32 phys_addr = addr;
-    u32 pc_start = cpu->Reg[15];
 
-    InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
+    phys_addr += InterpreterTranslateInstruction(cpu, phys_addr, inst_base);
 
     if (inst_base->br == TransExtData::NON_BRANCH) {
         inst_base->br = TransExtData::SINGLE_STEP;
     }
 
-    cpu->instruction_cache[pc_start] = bb_start;
+    GetTransBlock(bb_start)->end_pc = phys_addr;
+    RegisterTransBlock(cpu, bb_start);
 
     return KEEP_GOING;
 }
@@ -1622,6 +1622,10 @@ unsigned InterpreterMainLoop(ARMul_State* cpu) {
     unsigned int num_instrs = 0;
 
     int ptr;
+    // Block being executed, -1 before the first one
+    int block = -1;
+    // Generation of the translation cache the block was taken from
+    u32 block_generation = trans_cache_generation;
 
     LOAD_NZCVT;
 DISPATCH : {
@@ -1636,18 +1640,54 @@ DISPATCH : {
     else
         cpu->Reg[15] &= 0xfffffffc;
 
-    // Find the cached instruction cream, otherwise translate it...
-    auto itr = cpu->instruction_cache.find(cpu->Reg[15]);
-    if (itr != cpu->instruction_cache.end()) {
-        ptr = itr->second;
-    } else if (cpu->NumInstrsToExecute != 1) {
-        if (InterpreterTranslateBlock(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
-    } else {
-        if (InterpreterTranslateSingle(cpu, ptr, cpu->Reg[15]) == FETCH_EXCEPTION)
-            goto END;
+    // The cache may have been cleared while executing the previous block, e.g. by an SVC or by
+    // loading a savestate, in which case its header can't be trusted anymore
+    if (block_generation != trans_cache_generation)
+        block = -1;
+
+    // Follow the link of the previous block, or find the cached block, otherwise translate it...
+    int next_block = -1;
+    if (block >= 0) {
+        const TransBlock* previous = GetTransBlock(block);
+        for (int i = 0; i < 2; ++i) {
+            if (previous->link_pc[i] == cpu->Reg[15] && previous->link_block[i] >= 0 &&
+                GetTransBlock(previous->link_block[i])->valid) {
+                next_block = previous->link_block[i];
+                break;
+            }
+        }
     }
 
+    if (next_block < 0) {
+        next_block = FindTransBlock(cpu, cpu->Reg[15]);
+        if (next_block < 0) {
+            if (trans_cache_buf_top + TRANS_BLOCK_MAX_SIZE > TRANS_CACHE_SIZE) {
+                ClearTransCache(cpu);
+                block = -1;
+            }
+
+            if (cpu->NumInstrsToExecute != 1) {
+                if (InterpreterTranslateBlock(cpu, next_block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            } else {
+                if (InterpreterTranslateSingle(cpu, next_block, cpu->Reg[15]) == FETCH_EXCEPTION)
+                    goto END;
+            }
+        }
+
+        // Patch the exit of the previous block
+        if (block >= 0) {
+            TransBlock* previous = GetTransBlock(block);
+            previous->link_pc[previous->next_link] = cpu->Reg[15];
+            previous->link_block[previous->next_link] = next_block;
+            previous->next_link ^= 1;
+        }
+    }
+
+    block = next_block;
+    block_generation = trans_cache_generation;
+    ptr = block + sizeof(TransBlock);
+
     // Find breakpoint if one exists within the block
     if (GDBStub::IsConnected()) {
         breakpoint_data =
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <cstdlib>
+#include <vector>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "core/arm/dyncom/arm_dyncom_interpreter.h"
@@ -6,9 +8,11 @@
 #include "core/arm/skyeye_common/armstate.h"
 #include "core/arm/skyeye_common/armsupp.h"
 #include "core/arm/skyeye_common/vfp/vfp.h"
+#include "core/memory.h"
 
-char trans_cache_buf[TRANS_CACHE_SIZE];
+char* trans_cache_buf = nullptr;
 size_t trans_cache_buf_top = 0;
+u32 trans_cache_generation = 0;
 
 static void* AllocBuffer(size_t size) {
     size_t start = trans_cache_buf_top;
@@ -17,6 +21,97 @@ static void* AllocBuffer(size_t size) {
     return static_cast<void*>(&trans_cache_buf[start]);
 }
 
+int AllocTransBlock(u32 start_pc) {
+    // Only allocated once code actually runs on the interpreter
+    if (trans_cache_buf == nullptr)
+        trans_cache_buf = new char[TRANS_CACHE_SIZE];
+
+    const int block = static_cast<int>(trans_cache_buf_top);
+    TransBlock* header = static_cast<TransBlock*>(AllocBuffer(sizeof(TransBlock)));
+    header->start_pc = start_pc;
+    header->end_pc = start_pc;
+    header->valid = 1;
+    header->link_block[0] = header->link_block[1] = -1;
+    header->link_pc[0] = header->link_pc[1] = 0;
+    header->next_link = 0;
+    return block;
+}
+
+static ARMul_State::BlockLookupEntry& GetLookupEntry(ARMul_State* cpu, u32 pc) {
+    return cpu->block_lookup_table[(pc >> 1) % cpu->block_lookup_table.size()];
+}
+
+int FindTransBlock(ARMul_State* cpu, u32 pc) {
+    ARMul_State::BlockLookupEntry& entry = GetLookupEntry(cpu, pc);
+    if (entry.pc == pc && entry.block >= 0)
+        return entry.block;
+
+    auto itr = cpu->instruction_cache.find(pc);
+    if (itr == cpu->instruction_cache.end())
+        return -1;
+
+    entry = {pc, itr->second};
+    return itr->second;
+}
+
+void RegisterTransBlock(ARMul_State* cpu, int block) {
+    const TransBlock* header = GetTransBlock(block);
+    cpu->instruction_cache[header->start_pc] = block;
+    GetLookupEntry(cpu, header->start_pc) = {header->start_pc, block};
+
+    // A block ending with a 32-bit Thumb instruction can spill into the next page
+    const u32 last_page = (header->end_pc - 1) >> Memory::PAGE_BITS;
+    for (u32 page = header->start_pc >> Memory::PAGE_BITS; page <= last_page; ++page) {
+        cpu->page_blocks[page].push_back(block);
+    }
+    Memory::MarkRegionAsCode(header->start_pc, header->end_pc - header->start_pc);
+}
+
+void ClearTransCache(ARMul_State* cpu) {
+    cpu->instruction_cache.clear();
+    cpu->page_blocks.clear();
+    cpu->block_lookup_table.fill({0, -1});
+    trans_cache_buf_top = 0;
+    ++trans_cache_generation;
+}
+
+void InvalidateTransCacheRange(ARMul_State* cpu, u32 start, u32 size) {
+    if (size == 0)
+        return;
+
+    const u64 end = static_cast<u64>(start) + size;
+    const u32 last_page = static_cast<u32>((end - 1) >> Memory::PAGE_BITS);
+    for (u32 page = start >> Memory::PAGE_BITS; page <= last_page; ++page) {
+        auto page_itr = cpu->page_blocks.find(page);
+        if (page_itr == cpu->page_blocks.end())
+            continue;
+
+        std::vector<int>& blocks = page_itr->second;
+        for (int block : blocks) {
+            TransBlock* header = GetTransBlock(block);
+            if (!header->valid || header->end_pc <= start || header->start_pc >= end)
+                continue;
+
+            // Links to the block check this, so they don't need to be unpatched
+            header->valid = 0;
+
+            auto itr = cpu->instruction_cache.find(header->start_pc);
+            if (itr != cpu->instruction_cache.end() && itr->second == block)
+                cpu->instruction_cache.erase(itr);
+
+            ARMul_State::BlockLookupEntry& entry = GetLookupEntry(cpu, header->start_pc);
+            if (entry.block == block)
+                entry.block = -1;
+        }
+
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                    [](int block) { return !GetTransBlock(block)->valid; }),
+                     blocks.end());
+        if (blocks.empty())
+            cpu->page_blocks.erase(page_itr);
+    }
+}
+
 #define glue(x, y) x##y
 #define INTERPRETER_TRANSLATE(s) glue(InterpreterTranslate_, s)
 
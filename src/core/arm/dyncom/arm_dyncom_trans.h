@@ -489,6 +489,49 @@ typedef ARM_INST_PTR (*transop_fp_t)(unsigned int, int);
 extern const transop_fp_t arm_instruction_trans[];
 extern const size_t arm_instruction_trans_len;
 
-#define TRANS_CACHE_SIZE (64 * 1024 * 2000)
-extern char trans_cache_buf[TRANS_CACHE_SIZE];
+/**
+ * Header of a translated basic block, followed by its translated instructions in the translation
+ * cache. Blocks are referred to by their offset in the cache.
+ */
+struct TransBlock {
+    u32 start_pc;
+    /// Address following the last instruction of the block
+    u32 end_pc;
+    /// Cleared when the code of the block is invalidated
+    u32 valid;
+    /// The last two blocks this block exited to, patched in on exit so that the next exit to the
+    /// same address doesn't have to look the block up
+    u32 link_pc[2];
+    int link_block[2];
+    u32 next_link;
+};
+
+#define TRANS_CACHE_SIZE (32 * 1024 * 1024)
+/// The cache is flushed before translating a block once less than this is left. A block covers
+/// at most a page of code, so it never exceeds this.
+#define TRANS_BLOCK_MAX_SIZE (1024 * 1024)
+
+extern char* trans_cache_buf;
 extern size_t trans_cache_buf_top;
+/// Incremented by ClearTransCache. Block offsets taken before a clear may refer to stale headers
+/// or into the middle of newer blocks, so they must not be followed or patched after it.
+extern u32 trans_cache_generation;
+
+inline TransBlock* GetTransBlock(int block) {
+    return reinterpret_cast<TransBlock*>(&trans_cache_buf[block]);
+}
+
+/// Allocates the header of a new block starting at pc, returning its offset
+int AllocTransBlock(u32 start_pc);
+
+/// Returns the offset of the valid block starting at pc, or -1 if there is none
+int FindTransBlock(ARMul_State* cpu, u32 pc);
+
+/// Makes a block translated by AllocTransBlock and the instruction translators visible to lookups
+void RegisterTransBlock(ARMul_State* cpu, int block);
+
+/// Removes all translated blocks
+void ClearTransCache(ARMul_State* cpu);
+
+/// Removes the translated blocks overlapping the address range
+void InvalidateTransCacheRange(ARMul_State* cpu, u32 start, u32 size);
@@ -0,0 +1,393 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/microprofile.h"
+#include "core/arm/idle_loop_detector.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+
+constexpr u32 IdleLoopDetector::MAX_LOOP_INSTRUCTIONS;
+constexpr u32 IdleLoopDetector::NO_LOOP;
+
+namespace {
+
+/// Bit used for the condition flags in register masks
+constexpr u32 FLAGS = 1 << 16;
+constexpr u32 PC = 15;
+
+/// Effects of an instruction on the registers, as far as the analysis is concerned
+struct InstructionInfo {
+    /// False if the instruction has side effects, or isn't understood by the analysis
+    bool allowed = false;
+    /// Registers read and written, with FLAGS for the condition flags
+    u32 reads = 0;
+    u32 writes = 0;
+    /// Whether the writes only happen if a condition passes
+    bool conditional = false;
+    bool is_branch = false;
+    u32 branch_target = 0;
+};
+
+u32 RegisterBit(u32 reg) {
+    return 1 << reg;
+}
+
+u32 SignExtend(u32 value, u32 bits) {
+    const u32 mask = 1 << (bits - 1);
+    return (value ^ mask) - mask;
+}
+
+InstructionInfo DecodeARM(u32 inst, u32 pc) {
+    InstructionInfo info;
+
+    const u32 cond = inst >> 28;
+    if (cond == 0xF)
+        return info;
+    if (cond != 0xE) {
+        info.conditional = true;
+        info.reads |= FLAGS;
+    }
+
+    const u32 rn = (inst >> 16) & 0xF;
+    const u32 rd = (inst >> 12) & 0xF;
+    const u32 rm = inst & 0xF;
+    const bool pre_indexed = (inst >> 24) & 1;
+    const bool writeback = (inst >> 21) & 1;
+    const bool load = (inst >> 20) & 1;
+
+    if ((inst & 0x0F000000) == 0x0A000000) {
+        // B
+        info.allowed = true;
+        info.is_branch = true;
+        info.branch_target = pc + 8 + (SignExtend(inst & 0xFFFFFF, 24) << 2);
+        return info;
+    }
+
+    if ((inst & 0x0C000000) == 0x04000000) {
+        // LDR/LDRB with an offset and without writeback
+        const bool register_offset = (inst >> 25) & 1;
+        if (!load || !pre_indexed || writeback || rd == PC || (register_offset && (inst & 0x10)))
+            return info;
+
+        if (rn != PC)
+            info.reads |= RegisterBit(rn);
+        if (register_offset) {
+            if (rm == PC)
+                return info;
+            info.reads |= RegisterBit(rm);
+            // RRX shifts in the carry flag
+            if ((inst & 0xFE0) == 0x060)
+                info.reads |= FLAGS;
+        }
+        info.writes |= RegisterBit(rd);
+        info.allowed = true;
+        return info;
+    }
+
+    if ((inst & 0x0E000090) == 0x00000090) {
+        // LDRH/LDRSB/LDRSH with an offset and without writeback. Everything else in this space
+        // (multiplies, swaps, stores, LDRD) is rejected.
+        const bool immediate_offset = (inst >> 22) & 1;
+        if ((inst & 0x60) == 0 || !load || !pre_indexed || writeback || rd == PC)
+            return info;
+
+        if (rn != PC)
+            info.reads |= RegisterBit(rn);
+        if (!immediate_offset) {
+            if (rm == PC)
+                return info;
+            info.reads |= RegisterBit(rm);
+        }
+        info.writes |= RegisterBit(rd);
+        info.allowed = true;
+        return info;
+    }
+
+    if ((inst & 0x0C000000) == 0x00000000) {
+        // Data processing
+        const u32 opcode = (inst >> 21) & 0xF;
+        const bool set_flags = (inst >> 20) & 1;
+        const bool immediate = (inst >> 25) & 1;
+        const bool is_compare = opcode >= 0x8 && opcode <= 0xB;
+
+        // Compares without S are MRS/MSR/BX and friends
+        if (is_compare && !set_flags)
+            return info;
+        if (!is_compare && rd == PC)
+            return info;
+
+        // MOV and MVN don't have a first operand
+        if (opcode != 0xD && opcode != 0xF) {
+            if (rn == PC)
+                return info;
+            info.reads |= RegisterBit(rn);
+        }
+        if (!immediate) {
+            if (rm == PC)
+                return info;
+            info.reads |= RegisterBit(rm);
+            if (inst & 0x10) {
+                const u32 rs = (inst >> 8) & 0xF;
+                if (rs == PC)
+                    return info;
+                info.reads |= RegisterBit(rs);
+            } else if ((inst & 0xFE0) == 0x060) {
+                // RRX
+                info.reads |= FLAGS;
+            }
+        }
+        // ADC, SBC and RSC use the carry flag
+        if (opcode >= 0x5 && opcode <= 0x7)
+            info.reads |= FLAGS;
+
+        if (!is_compare)
+            info.writes |= RegisterBit(rd);
+        if (set_flags)
+            info.writes |= FLAGS;
+        info.allowed = true;
+        return info;
+    }
+
+    return info;
+}
+
+InstructionInfo DecodeThumb(u16 inst, u32 pc) {
+    InstructionInfo info;
+
+    const u32 low_rd = inst & 0x7;
+    const u32 low_rn = (inst >> 3) & 0x7;
+
+    if ((inst & 0xF800) < 0x1800) {
+        // LSL/LSR/ASR by immediate
+        info.reads |= RegisterBit(low_rn);
+        info.writes |= RegisterBit(low_rd) | FLAGS;
+        info.allowed = true;
+    } else if ((inst & 0xF800) == 0x1800) {
+        // ADD/SUB with a register or a 3-bit immediate
+        info.reads |= RegisterBit(low_rn);
+        if (!(inst & 0x400))
+            info.reads |= RegisterBit((inst >> 6) & 0x7);
+        info.writes |= RegisterBit(low_rd) | FLAGS;
+        info.allowed = true;
+    } else if ((inst & 0xE000) == 0x2000) {
+        // MOV/CMP/ADD/SUB with an 8-bit immediate
+        const u32 opcode = (inst >> 11) & 0x3;
+        const u32 rd = (inst >> 8) & 0x7;
+        if (opcode != 0)
+            info.reads |= RegisterBit(rd);
+        if (opcode != 1)
+            info.writes |= RegisterBit(rd);
+        info.writes |= FLAGS;
+        info.allowed = true;
+    } else if ((inst & 0xFC00) == 0x4000) {
+        // Data processing
+        const u32 opcode = (inst >> 6) & 0xF;
+        info.reads |= RegisterBit(low_rn);
+        // NEG and MVN don't read the destination
+        if (opcode != 0x9 && opcode != 0xF)
+            info.reads |= RegisterBit(low_rd);
+        // ADC and SBC use the carry flag
+        if (opcode == 0x5 || opcode == 0x6)
+            info.reads |= FLAGS;
+        // TST, CMP and CMN only set the flags
+        if (opcode != 0x8 && opcode != 0xA && opcode != 0xB)
+            info.writes |= RegisterBit(low_rd);
+        info.writes |= FLAGS;
+        info.allowed = true;
+    } else if ((inst & 0xFC00) == 0x4400) {
+        // ADD/CMP/MOV with high registers. BX and BLX are rejected.
+        const u32 opcode = (inst >> 8) & 0x3;
+        const u32 rd = (inst & 0x7) | ((inst >> 4) & 0x8);
+        const u32 rm = (inst >> 3) & 0xF;
+        if (opcode == 3 || rd == PC || rm == PC)
+            return info;
+
+        info.reads |= RegisterBit(rm);
+        if (opcode != 2)
+            info.reads |= RegisterBit(rd);
+        if (opcode == 1)
+            info.writes |= FLAGS;
+        else
+            info.writes |= RegisterBit(rd);
+        info.allowed = true;
+    } else if ((inst & 0xF800) == 0x4800) {
+        // LDR (literal)
+        info.writes |= RegisterBit((inst >> 8) & 0x7);
+        info.allowed = true;
+    } else if ((inst & 0xF000) == 0x5000) {
+        // Loads and stores with a register offset. The stores (STR, STRH, STRB) are rejected.
+        if (((inst >> 9) & 0x7) < 3)
+            return info;
+        info.reads |= RegisterBit(low_rn) | RegisterBit((inst >> 6) & 0x7);
+        info.writes |= RegisterBit(low_rd);
+        info.allowed = true;
+    } else if ((inst & 0xE800) == 0x6800 || (inst & 0xF800) == 0x8800) {
+        // LDR/LDRB/LDRH with an immediate offset
+        info.reads |= RegisterBit(low_rn);
+        info.writes |= RegisterBit(low_rd);
+        info.allowed = true;
+    } else if ((inst & 0xF800) == 0x9800) {
+        // LDR (SP relative)
+        info.reads |= RegisterBit(13);
+        info.writes |= RegisterBit((inst >> 8) & 0x7);
+        info.allowed = true;
+    } else if ((inst & 0xF000) == 0xD000) {
+        // Conditional branch. Condition 0xE is undefined and 0xF is SVC.
+        if (((inst >> 8) & 0xF) >= 0xE)
+            return info;
+        info.conditional = true;
+        info.reads |= FLAGS;
+        info.is_branch = true;
+        info.branch_target = pc + 4 + (SignExtend(inst & 0xFF, 8) << 1);
+        info.allowed = true;
+    } else if ((inst & 0xF800) == 0xE000) {
+        // Unconditional branch
+        info.is_branch = true;
+        info.branch_target = pc + 4 + (SignExtend(inst & 0x7FF, 11) << 1);
+        info.allowed = true;
+    }
+
+    return info;
+}
+
+InstructionInfo Decode(u32 address, bool thumb) {
+    if (!Memory::IsValidVirtualAddress(address))
+        return {};
+    if (thumb)
+        return DecodeThumb(Memory::Read16(address), address);
+    return DecodeARM(Memory::Read32(address), address);
+}
+
+/**
+ * Returns whether the loop from start to the branch back to it at end can only exit after an
+ * event. That is the case if it only contains allowed instructions, the only other branches in it
+ * leave the loop, and no value it reads was written by the previous iteration.
+ */
+bool IsIdleLoopBody(u32 start, u32 end, bool thumb) {
+    const u32 instruction_size = thumb ? 2 : 4;
+
+    // Registers written unconditionally so far in the iteration
+    u32 defined = 0;
+    // Registers read before being written in the iteration, i.e. coming from the previous one
+    u32 live_in = 0;
+    // Registers written anywhere in the iteration
+    u32 written = 0;
+
+    for (u32 address = start; address <= end; address += instruction_size) {
+        const InstructionInfo info = Decode(address, thumb);
+        if (!info.allowed)
+            return false;
+
+        if (info.is_branch) {
+            const bool leaves_loop = info.branch_target < start || info.branch_target > end;
+            if (address == end ? info.branch_target != start : !leaves_loop)
+                return false;
+        }
+
+        live_in |= info.reads & ~defined;
+        written |= info.writes;
+        if (!info.conditional)
+            defined |= info.writes;
+    }
+
+    return (live_in & written) == 0;
+}
+
+} // Anonymous namespace
+
+const IdleLoopDetector::Analysis& IdleLoopDetector::Analyze(u32 pc, bool thumb) {
+    const u32 key = pc | (thumb ? 1 : 0);
+    auto itr = analyses.find(key);
+    if (itr != analyses.end())
+        return itr->second;
+
+    const u32 instruction_size = thumb ? 2 : 4;
+    Analysis analysis{pc, pc, false, 0};
+
+    // Look for the branch back to the start of the loop the pc is in
+    for (u32 i = 0; i < MAX_LOOP_INSTRUCTIONS; ++i) {
+        const u32 address = pc + i * instruction_size;
+        const InstructionInfo info = Decode(address, thumb);
+        analysis.end = address + instruction_size;
+        if (!info.allowed)
+            break;
+        if (!info.is_branch)
+            continue;
+
+        if (info.branch_target <= pc) {
+            const u32 body_size = address + instruction_size - info.branch_target;
+            if (body_size <= MAX_LOOP_INSTRUCTIONS * instruction_size &&
+                info.branch_target % instruction_size == 0) {
+                analysis.begin = info.branch_target;
+                analysis.idle = IsIdleLoopBody(info.branch_target, address, thumb);
+                analysis.loop_start = info.branch_target;
+            }
+            break;
+        }
+        // Branches forward past the pc may leave the loop, anything else means there's no loop
+        if (info.branch_target <= address)
+            break;
+    }
+
+    // Don't let the analyses of code that is never invalidated pile up
+    if (analyses.size() >= 4096)
+        analyses.clear();
+    return analyses.emplace(key, analysis).first->second;
+}
+
+bool IdleLoopDetector::IsIdleLoop(u32 pc, bool thumb) {
+    return Analyze(pc, thumb).idle;
+}
+
+MICROPROFILE_DEFINE(ARM_IdleLoop, "ARM", "Idle loop skip", MP_RGB(128, 128, 255));
+
+void IdleLoopDetector::EndSlice(u32 pc, bool thumb, bool events_ran) {
+    // Only the memory an event changed can make the loop exit, so the CPU must go around the loop
+    // for a whole slice after the last event before skipping time.
+    if (events_ran) {
+        candidate_loop = NO_LOOP;
+        return;
+    }
+
+    const Analysis& analysis = Analyze(pc, thumb);
+    if (!analysis.idle) {
+        candidate_loop = NO_LOOP;
+        return;
+    }
+
+    const u32 loop = analysis.loop_start | (thumb ? 1 : 0);
+    if (candidate_loop != loop) {
+        candidate_loop = loop;
+        return;
+    }
+
+    candidate_loop = NO_LOOP;
+
+    MICROPROFILE_SCOPE(ARM_IdleLoop);
+    const u64 idle_ticks = CoreTiming::GetIdleTicks();
+    CoreTiming::Idle();
+    MICROPROFILE_META_CPU("Skipped cycles",
+                          static_cast<int>(CoreTiming::GetIdleTicks() - idle_ticks));
+    CoreTiming::Advance();
+}
+
+void IdleLoopDetector::Reset() {
+    candidate_loop = NO_LOOP;
+}
+
+void IdleLoopDetector::InvalidateRange(u32 start_address, size_t length) {
+    const u64 end_address = static_cast<u64>(start_address) + length;
+    for (auto itr = analyses.begin(); itr != analyses.end();) {
+        if (itr->second.begin < end_address && itr->second.end > start_address)
+            itr = analyses.erase(itr);
+        else
+            ++itr;
+    }
+    candidate_loop = NO_LOOP;
+}
+
+void IdleLoopDetector::Clear() {
+    analyses.clear();
+    candidate_loop = NO_LOOP;
+}
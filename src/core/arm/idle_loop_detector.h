@@ -0,0 +1,71 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+#include "common/common_types.h"
+
+/**
+ * Detects when the CPU spins in an idle loop, e.g. polling the shared page or an HID ring until
+ * an event changes it, so that the CPU backends can skip straight to the next scheduled event
+ * instead of executing the loop until then.
+ *
+ * An idle loop is a short loop ending in a branch back to its start, made only of loads,
+ * compares and arithmetic whose results don't carry over to the next iteration. Such a loop has
+ * no side effects and every iteration computes the same thing, so it can only exit once an event
+ * changes the memory it reads.
+ */
+class IdleLoopDetector {
+public:
+    /// Maximum number of instructions in a loop body
+    static constexpr u32 MAX_LOOP_INSTRUCTIONS = 16;
+
+    /**
+     * Returns whether the given address is inside an idle loop
+     * @param pc Address of the next instruction to execute
+     * @param thumb Whether the CPU is in Thumb mode
+     */
+    bool IsIdleLoop(u32 pc, bool thumb);
+
+    /**
+     * Called by the CPU backends at the end of each slice of execution. Skips the time to the next
+     * scheduled event if the CPU ended two slices in a row in the same idle loop, without an event
+     * running between them.
+     * @param pc Address of the next instruction to execute
+     * @param thumb Whether the CPU is in Thumb mode
+     * @param events_ran Whether events ran at the end of this slice
+     */
+    void EndSlice(u32 pc, bool thumb, bool events_ran);
+
+    /// Forgets the loop the CPU was in, e.g. after a context switch
+    void Reset();
+
+    /// Forgets the loops analyzed from the given address range, after the code there changed
+    void InvalidateRange(u32 start_address, size_t length);
+
+    /// Forgets all analyzed loops
+    void Clear();
+
+private:
+    struct Analysis {
+        /// Address range that was read to analyze the code, end excluded
+        u32 begin;
+        u32 end;
+        bool idle;
+        /// Start of the idle loop, if the code is in one
+        u32 loop_start;
+    };
+
+    static constexpr u32 NO_LOOP = 0xFFFFFFFF;
+
+    const Analysis& Analyze(u32 pc, bool thumb);
+
+    /// Analyses of the code at each address, keyed by address | thumb
+    std::unordered_map<u32, Analysis> analyses;
+
+    /// Start | thumb of the idle loop the previous slice ended in, or NO_LOOP
+    u32 candidate_loop = NO_LOOP;
+};
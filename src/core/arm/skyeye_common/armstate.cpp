@@ -11,6 +11,7 @@
 #include "core/memory.h"
 
 ARMul_State::ARMul_State(PrivilegeMode initial_mode) {
+    block_lookup_table.fill({0, -1});
     Reset();
     ChangePrivilegeMode(initial_mode);
 }
@@ -19,6 +19,7 @@
 
 #include <array>
 #include <unordered_map>
+#include <vector>
 #include "common/common_types.h"
 #include "core/arm/skyeye_common/arm_regformat.h"
 
@@ -232,6 +233,16 @@ public:
     // process for our purposes), not per ARMul_State (which tracks CPU core state).
     std::unordered_map<u32, int> instruction_cache;
 
+    struct BlockLookupEntry {
+        u32 pc;
+        int block; ///< -1 if the entry is empty
+    };
+    /// Direct-mapped cache of recently looked up blocks, in front of instruction_cache
+    std::array<BlockLookupEntry, 4096> block_lookup_table;
+
+    /// Blocks in the translation cache that overlap each page, for invalidation
+    std::unordered_map<u32, std::vector<int>> page_blocks;
+
 private:
     void ResetMPCoreCP15Registers();
 
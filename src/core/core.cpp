@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cinttypes>
 #include <memory>
 
 #include "audio_core/audio_core.h"
@@ -16,6 +17,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/service/service.h"
+#include "core/hw/gpu_thread.h"
 #include "core/hw/hw.h"
 #include "core/loader/loader.h"
 #include "core/settings.h"
@@ -84,6 +86,12 @@ System::ResultStatus System::Load(EmuWindow* emu_window, const std::string& file
         return ResultStatus::ErrorSystemMode;
     }
 
+    // Homebrew doesn't have a program id, in which case the persistent caches are disabled
+    u64 program_id;
+    if (app_loader->ReadProgramId(program_id) != Loader::ResultStatus::Success)
+        program_id = 0;
+    VideoCore::g_program_id = program_id;
+
     ResultStatus init_result{Init(emu_window, system_mode.get())};
     if (init_result != ResultStatus::Success) {
         LOG_CRITICAL(Core, "Failed to initialize system (Error %i)!", init_result);
@@ -113,6 +121,11 @@ void System::PrepareReschedule() {
     reschedule_pending = true;
 }
 
+std::unique_ptr<ARM_Interface> System::SetCPU(std::unique_ptr<ARM_Interface> cpu) {
+    cpu_core.swap(cpu);
+    return cpu;
+}
+
 void System::Reschedule() {
     if (!reschedule_pending) {
         return;
@@ -146,14 +159,30 @@ System::ResultStatus System::Init(EmuWindow* emu_window, u32 system_mode) {
         return ResultStatus::ErrorVideoCore;
     }
 
+    if (Settings::values.use_gpu_thread) {
+        GPUThread::Init(emu_window);
+    }
+
     LOG_DEBUG(Core, "Initialized OK");
 
     return ResultStatus::Success;
 }
 
 void System::Shutdown() {
+    const Memory::AccessStats memory_stats = Memory::GetAccessStats();
+    LOG_INFO(HW_Memory,
+             "Memory slow path: %" PRIu64 " unmapped, %" PRIu64 " special, %" PRIu64
+             " rasterizer cached, %" PRIu64 " rasterizer cached special accesses, %" PRIu64
+             " cached pages released",
+             memory_stats.unmapped, memory_stats.special, memory_stats.rasterizer_cached_memory,
+             memory_stats.rasterizer_cached_special, memory_stats.released_cached_pages);
+    LOG_INFO(HW_Memory,
+             "Translated code: %" PRIu64 " invalidations, %" PRIu64 " JIT reads of code pages",
+             memory_stats.code_invalidations, memory_stats.jit_code_page_reads);
+
     GDBStub::Shutdown();
     AudioCore::Shutdown();
+    GPUThread::Shutdown();
     VideoCore::Shutdown();
     Service::Shutdown();
     Kernel::Shutdown();
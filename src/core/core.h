@@ -91,6 +91,13 @@ public:
         return *cpu_core;
     }
 
+    /**
+     * Replaces the emulated CPU, without initializing the rest of the system. Used by tests that
+     * run the CPU or CoreTiming on their own.
+     * @returns The previous CPU
+     */
+    std::unique_ptr<ARM_Interface> SetCPU(std::unique_ptr<ARM_Interface> cpu);
+
 private:
     /**
      * Initialize the emulated system.
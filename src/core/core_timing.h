@@ -7,6 +7,9 @@
 #include <functional>
 #include <string>
 #include "common/common_types.h"
+#include "core/core_timing_queue.h"
+
+class PointerWrap;
 
 // This is a system to schedule events into the emulated machine's future. Time is measured
 // in main CPU clock cycles.
@@ -91,10 +94,22 @@ void UnregisterAllEvents();
  * @param cycles_into_future The number of cycles after which this event will be fired
  * @param event_type The event type to fire, as returned from RegisterEvent
  * @param userdata Optional parameter to pass to the callback when fired
+ * @returns A handle that can be used to unschedule the event
  */
-void ScheduleEvent(s64 cycles_into_future, int event_type, u64 userdata = 0);
+EventHandle ScheduleEvent(s64 cycles_into_future, int event_type, u64 userdata = 0);
 
+/// Schedules an event from any thread. It is added to the queue on the next Advance.
+/// The delay is counted from GetTicks(), which reads the CPU state: threads other than the CPU
+/// thread use ScheduleEventAt_Threadsafe with a time they got from the CPU thread instead.
 void ScheduleEvent_Threadsafe(s64 cycles_into_future, int event_type, u64 userdata = 0);
+/**
+ * Schedules an event from any thread at the specified absolute time, in ticks. It is added to the
+ * queue on the next Advance, and fires right away if that time already passed.
+ * @param time The time at which this event will be fired, as returned by GetTicks
+ * @param event_type The event type to fire, as returned from RegisterEvent
+ * @param userdata Optional parameter to pass to the callback when fired
+ */
+void ScheduleEventAt_Threadsafe(s64 time, int event_type, u64 userdata = 0);
 void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata = 0);
 
 /**
@@ -105,9 +120,19 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata = 0);
  */
 s64 UnscheduleEvent(int event_type, u64 userdata);
 
+/**
+ * Unschedules the event with the specified handle
+ * @param handle The handle returned by ScheduleEvent. Nothing happens if the event already fired.
+ * @returns The remaining ticks until the event would have fired, or 0 if it isn't scheduled
+ */
+s64 UnscheduleEvent(EventHandle handle);
+
+/// Like UnscheduleEvent, but also covers events not yet moved from the threadsafe queue.
+/// This must be run ONLY from within the cpu thread.
 s64 UnscheduleThreadsafeEvent(int event_type, u64 userdata);
 
 void RemoveEvent(int event_type);
+/// This must be run ONLY from within the cpu thread.
 void RemoveThreadsafeEvent(int event_type);
 void RemoveAllEvents(int event_type);
 bool IsScheduled(int event_type);
@@ -125,6 +150,10 @@ void ClearPendingEvents();
 
 void LogPendingEvents();
 
+/// Saves or loads the scheduled events and the emulated time. The event types aren't saved, they
+/// must be registered in the same order as when the state was saved.
+void DoState(PointerWrap& p);
+
 /// Warning: not included in save states.
 void RegisterAdvanceCallback(void (*callback)(int cycles_executed));
 void RegisterMHzChangeCallback(MHzChangeCallback callback);
@@ -0,0 +1,170 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "common/assert.h"
+#include "common/chunk_file.h"
+#include "core/core_timing_queue.h"
+
+namespace CoreTiming {
+
+constexpr u32 EventQueue::INVALID_INDEX;
+
+EventHandle EventQueue::Push(s64 time, int type, u64 userdata) {
+    ASSERT(type >= 0);
+
+    u32 index;
+    if (free_slots.empty()) {
+        index = static_cast<u32>(slots.size());
+        slots.emplace_back();
+        slots.back().generation = 1;
+    } else {
+        index = free_slots.back();
+        free_slots.pop_back();
+    }
+
+    if (static_cast<size_t>(type) >= first_of_type.size())
+        first_of_type.resize(type + 1, INVALID_INDEX);
+
+    Slot& slot = slots[index];
+    slot.event = {time, userdata, type};
+    slot.order = next_order++;
+
+    slot.prev_of_type = INVALID_INDEX;
+    slot.next_of_type = first_of_type[type];
+    if (slot.next_of_type != INVALID_INDEX)
+        slots[slot.next_of_type].prev_of_type = index;
+    first_of_type[type] = index;
+
+    heap.push_back(index);
+    SiftUp(static_cast<u32>(heap.size() - 1));
+
+    return (static_cast<u64>(slot.generation) << 32) | index;
+}
+
+EventQueue::Event EventQueue::Pop() {
+    const Event event = Top();
+    RemoveSlot(heap.front());
+    return event;
+}
+
+const EventQueue::Event* EventQueue::Find(EventHandle handle) const {
+    const u32 index = GetSlotIndex(handle);
+    return index != INVALID_INDEX ? &slots[index].event : nullptr;
+}
+
+void EventQueue::Remove(EventHandle handle) {
+    const u32 index = GetSlotIndex(handle);
+    if (index != INVALID_INDEX)
+        RemoveSlot(index);
+}
+
+void EventQueue::Clear() {
+    for (u32 index : heap) {
+        FreeSlot(index);
+    }
+    heap.clear();
+    std::fill(first_of_type.begin(), first_of_type.end(), INVALID_INDEX);
+}
+
+void EventQueue::DoState(PointerWrap& p) {
+    // The slots are saved as they are rather than as a list of events, since the handles held by
+    // the kernel objects index into them
+    p.Do(slots);
+    p.Do(free_slots);
+    p.Do(heap);
+    p.Do(first_of_type);
+    p.Do(next_order);
+}
+
+std::vector<EventQueue::Event> EventQueue::GetSortedEvents() const {
+    std::vector<u32> sorted = heap;
+    std::sort(sorted.begin(), sorted.end(), [this](u32 a, u32 b) { return IsBefore(a, b); });
+
+    std::vector<Event> events;
+    events.reserve(sorted.size());
+    for (u32 index : sorted) {
+        events.push_back(slots[index].event);
+    }
+    return events;
+}
+
+u32 EventQueue::GetSlotIndex(EventHandle handle) const {
+    const u32 index = static_cast<u32>(handle);
+    const u32 generation = static_cast<u32>(handle >> 32);
+    if (index >= slots.size() || slots[index].generation != generation ||
+        slots[index].heap_index == INVALID_INDEX)
+        return INVALID_INDEX;
+    return index;
+}
+
+void EventQueue::PlaceInHeap(u32 heap_index, u32 slot_index) {
+    heap[heap_index] = slot_index;
+    slots[slot_index].heap_index = heap_index;
+}
+
+void EventQueue::SiftUp(u32 heap_index) {
+    const u32 slot_index = heap[heap_index];
+    while (heap_index > 0) {
+        const u32 parent = (heap_index - 1) / 2;
+        if (!IsBefore(slot_index, heap[parent]))
+            break;
+        PlaceInHeap(heap_index, heap[parent]);
+        heap_index = parent;
+    }
+    PlaceInHeap(heap_index, slot_index);
+}
+
+void EventQueue::SiftDown(u32 heap_index) {
+    const u32 slot_index = heap[heap_index];
+    const u32 size = static_cast<u32>(heap.size());
+    while (true) {
+        u32 child = 2 * heap_index + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && IsBefore(heap[child + 1], heap[child]))
+            ++child;
+        if (!IsBefore(heap[child], slot_index))
+            break;
+        PlaceInHeap(heap_index, heap[child]);
+        heap_index = child;
+    }
+    PlaceInHeap(heap_index, slot_index);
+}
+
+void EventQueue::RemoveSlot(u32 slot_index) {
+    Slot& slot = slots[slot_index];
+
+    if (slot.prev_of_type != INVALID_INDEX)
+        slots[slot.prev_of_type].next_of_type = slot.next_of_type;
+    else
+        first_of_type[slot.event.type] = slot.next_of_type;
+    if (slot.next_of_type != INVALID_INDEX)
+        slots[slot.next_of_type].prev_of_type = slot.prev_of_type;
+
+    // Fill the hole with the last element of the heap, which can then move either way
+    const u32 heap_index = slot.heap_index;
+    const u32 last = heap.back();
+    heap.pop_back();
+    if (heap_index < heap.size()) {
+        PlaceInHeap(heap_index, last);
+        if (heap_index > 0 && IsBefore(last, heap[(heap_index - 1) / 2]))
+            SiftUp(heap_index);
+        else
+            SiftDown(heap_index);
+    }
+
+    FreeSlot(slot_index);
+}
+
+void EventQueue::FreeSlot(u32 slot_index) {
+    Slot& slot = slots[slot_index];
+    slot.heap_index = INVALID_INDEX;
+    // Generation 0 is never used, so that no handle equals INVALID_EVENT_HANDLE
+    if (++slot.generation == 0)
+        slot.generation = 1;
+    free_slots.push_back(slot_index);
+}
+
+} // namespace CoreTiming
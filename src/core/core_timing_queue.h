@@ -0,0 +1,128 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "common/common_types.h"
+
+class PointerWrap;
+
+namespace CoreTiming {
+
+/// Identifies a scheduled event. Handles of events that fired or were unscheduled become stale.
+using EventHandle = u64;
+constexpr EventHandle INVALID_EVENT_HANDLE = 0;
+
+/**
+ * Priority queue of the scheduled events, ordered by time and then by the order they were
+ * scheduled in. This is a binary min-heap of indices into a pool of event slots: adding or
+ * removing an event is O(log n), and looking up an event by handle is O(1). The scheduled events
+ * of each type are also linked together, so that removing events by type doesn't have to visit
+ * the events of other types.
+ */
+class EventQueue {
+public:
+    struct Event {
+        s64 time;
+        u64 userdata;
+        int type;
+    };
+
+    bool Empty() const {
+        return heap.empty();
+    }
+
+    size_t Size() const {
+        return heap.size();
+    }
+
+    /// Returns the next event to fire. The queue must not be empty.
+    const Event& Top() const {
+        return slots[heap.front()].event;
+    }
+
+    EventHandle Push(s64 time, int type, u64 userdata);
+
+    /// Removes and returns the next event to fire. The queue must not be empty.
+    Event Pop();
+
+    /// Returns the scheduled event, or nullptr if the handle is stale
+    const Event* Find(EventHandle handle) const;
+
+    /// Removes the scheduled event, if the handle isn't stale
+    void Remove(EventHandle handle);
+
+    /**
+     * Removes the scheduled events of the given type for which the predicate returns true
+     * @param pred Function taking a const Event&
+     */
+    template <typename Predicate>
+    void RemoveIf(int type, Predicate pred) {
+        if (type < 0 || static_cast<size_t>(type) >= first_of_type.size())
+            return;
+
+        u32 index = first_of_type[type];
+        while (index != INVALID_INDEX) {
+            const u32 next = slots[index].next_of_type;
+            if (pred(static_cast<const Event&>(slots[index].event)))
+                RemoveSlot(index);
+            index = next;
+        }
+    }
+
+    /// Returns whether any event of the given type is scheduled
+    bool HasType(int type) const {
+        return type >= 0 && static_cast<size_t>(type) < first_of_type.size() &&
+               first_of_type[type] != INVALID_INDEX;
+    }
+
+    void Clear();
+
+    /// Returns the scheduled events in the order they will fire
+    std::vector<Event> GetSortedEvents() const;
+
+    /// Saves or loads the queue. The handles of the scheduled events stay valid across a load.
+    void DoState(PointerWrap& p);
+
+private:
+    static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+    struct Slot {
+        Event event;
+        /// Orders events scheduled for the same time, in the order they were scheduled
+        u64 order;
+        /// Incremented when the slot is freed, to detect stale handles
+        u32 generation;
+        /// Position in the heap, INVALID_INDEX if the slot is free
+        u32 heap_index;
+        /// Neighbours in the list of scheduled events of the same type
+        u32 prev_of_type;
+        u32 next_of_type;
+    };
+
+    bool IsBefore(u32 a, u32 b) const {
+        const Slot& slot_a = slots[a];
+        const Slot& slot_b = slots[b];
+        return slot_a.event.time < slot_b.event.time ||
+               (slot_a.event.time == slot_b.event.time && slot_a.order < slot_b.order);
+    }
+
+    u32 GetSlotIndex(EventHandle handle) const;
+    void PlaceInHeap(u32 heap_index, u32 slot_index);
+    void SiftUp(u32 heap_index);
+    void SiftDown(u32 heap_index);
+    void RemoveSlot(u32 slot_index);
+    void FreeSlot(u32 slot_index);
+
+    std::vector<Slot> slots;
+    std::vector<u32> free_slots;
+    /// Indices of the slots of the scheduled events
+    std::vector<u32> heap;
+    /// Index of the first slot in the list of scheduled events of each type
+    std::vector<u32> first_of_type;
+    u64 next_order = 0;
+};
+
+} // namespace CoreTiming
@@ -16,13 +16,19 @@ namespace FileSys {
 
 ArchiveFactory_RomFS::ArchiveFactory_RomFS(Loader::AppLoader& app_loader) {
     // Load the RomFS from the app
+    std::shared_ptr<FileUtil::IOFile> romfs_file;
+    u64 data_offset = 0;
+    u64 data_size = 0;
     if (Loader::ResultStatus::Success != app_loader.ReadRomFS(romfs_file, data_offset, data_size)) {
         LOG_ERROR(Service_FS, "Unable to read RomFS!");
     }
+
+    // The RomFS is mapped once and shared by all the archives opened from it
+    source = std::make_shared<IVFCSource>(std::move(romfs_file), data_offset, data_size);
 }
 
 ResultVal<std::unique_ptr<ArchiveBackend>> ArchiveFactory_RomFS::Open(const Path& path) {
-    auto archive = std::make_unique<IVFCArchive>(romfs_file, data_offset, data_size);
+    auto archive = std::make_unique<IVFCArchive>(source);
     return MakeResult<std::unique_ptr<ArchiveBackend>>(std::move(archive));
 }
 
@@ -17,6 +17,8 @@
 
 namespace FileSys {
 
+struct IVFCSource;
+
 /// File system interface to the RomFS archive
 class ArchiveFactory_RomFS final : public ArchiveFactory {
 public:
@@ -30,9 +32,7 @@ public:
     ResultVal<ArchiveFormatInfo> GetFormatInfo(const Path& path) const override;
 
 private:
-    std::shared_ptr<FileUtil::IOFile> romfs_file;
-    u64 data_offset;
-    u64 data_size;
+    std::shared_ptr<IVFCSource> source;
 };
 
 } // namespace FileSys
@@ -28,6 +28,10 @@ public:
     }
 
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
+    /// Reads only fail when the file wasn't opened for reading, before reading anything
+    bool ReadCanFailPartway() const override {
+        return false;
+    }
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
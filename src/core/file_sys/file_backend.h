@@ -27,6 +27,14 @@ public:
      */
     virtual ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const = 0;
 
+    /**
+     * Whether a failed Read may have written part of the buffer. The data of these files is read
+     * into a temporary buffer, so that a failure leaves the emulated memory untouched.
+     */
+    virtual bool ReadCanFailPartway() const {
+        return true;
+    }
+
     /**
      * Write data to the file
      * @param offset Offset in bytes to start writing data to
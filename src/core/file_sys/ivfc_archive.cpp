@@ -2,6 +2,9 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
 #include <cstring>
 #include <memory>
 #include "common/common_types.h"
@@ -13,6 +16,33 @@
 
 namespace FileSys {
 
+/// Size of the data requested ahead of sequential reads, doubled after each sequential read
+static constexpr u64 MIN_READ_AHEAD_SIZE = 128 * 1024;
+static constexpr u64 MAX_READ_AHEAD_SIZE = 4 * 1024 * 1024;
+
+IVFCSource::IVFCSource(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
+    : romfs_file(std::move(file)), data_offset(offset), data_size(size) {
+    if (romfs_file == nullptr)
+        return;
+
+    mapping = std::make_unique<FileUtil::MappedFile>(*romfs_file);
+    if (!mapping->IsMapped() || data_offset + data_size > mapping->GetSize()) {
+        LOG_WARNING(Service_FS, "Could not map the IVFC archive, reading it from the file");
+        mapping.reset();
+    }
+}
+
+IVFCSource::~IVFCSource() {
+    if (stats.read_count == 0)
+        return;
+
+    LOG_INFO(Service_FS,
+             "IVFC archive: %" PRIu64 " reads (%" PRIu64 " sequential), %" PRIu64
+             " bytes, %" PRIu64 " us in total, %" PRIu64 " us at most",
+             stats.read_count, stats.sequential_reads, stats.bytes_read,
+             stats.total_read_ns / 1000, stats.max_read_ns / 1000);
+}
+
 std::string IVFCArchive::GetName() const {
     return "IVFC";
 }
@@ -20,7 +50,7 @@ std::string IVFCArchive::GetName() const {
 ResultVal<std::unique_ptr<FileBackend>> IVFCArchive::OpenFile(const Path& path,
                                                               const Mode& mode) const {
     return MakeResult<std::unique_ptr<FileBackend>>(
-        std::make_unique<IVFCFile>(romfs_file, data_offset, data_size));
+        std::make_unique<IVFCFile>(source));
 }
 
 ResultCode IVFCArchive::DeleteFile(const Path& path) const {
@@ -85,12 +115,66 @@ u64 IVFCArchive::GetFreeBytes() const {
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+void IVFCFile::ReadAhead(const u64 offset, const size_t length, const bool sequential) const {
+    const u64 end = offset + length;
+    if (!sequential) {
+        // Only the data of this read is needed, request it at once instead of page by page
+        source->mapping->WillNeed(source->data_offset + offset, length);
+        read_ahead_end = end;
+        read_ahead_size = MIN_READ_AHEAD_SIZE;
+        return;
+    }
+
+    // Request more data once half of the data requested ahead has been read
+    if (end + read_ahead_size / 2 < read_ahead_end)
+        return;
+
+    // Including the part of this read that wasn't requested ahead, if it is larger than that
+    const u64 start = std::max(offset, read_ahead_end);
+    read_ahead_end = std::min(end + read_ahead_size, source->data_size);
+    if (read_ahead_end > start) {
+        source->mapping->WillNeed(source->data_offset + start, read_ahead_end - start);
+    }
+    read_ahead_size = std::min(read_ahead_size * 2, MAX_READ_AHEAD_SIZE);
+}
+
 ResultVal<size_t> IVFCFile::Read(const u64 offset, const size_t length, u8* buffer) const {
     LOG_TRACE(Service_FS, "called offset=%llu, length=%zu", offset, length);
-    romfs_file->Seek(data_offset + offset, SEEK_SET);
-    size_t read_length = (size_t)std::min((u64)length, data_size - offset);
-
-    return MakeResult<size_t>(romfs_file->ReadBytes(buffer, read_length));
+    const auto start_time = std::chrono::steady_clock::now();
+
+    const u64 data_size = source->data_size;
+    const size_t read_length =
+        offset < data_size ? static_cast<size_t>(std::min<u64>(length, data_size - offset)) : 0;
+
+    IVFCReadStats& stats = source->stats;
+    const bool sequential = offset == next_offset;
+    if (sequential) {
+        stats.sequential_reads++;
+    }
+    next_offset = offset + read_length;
+
+    size_t bytes_read;
+    if (source->mapping != nullptr) {
+        if (read_length > 0) {
+            ReadAhead(offset, read_length, sequential);
+            std::memcpy(buffer, source->mapping->GetData() + source->data_offset + offset,
+                        read_length);
+        }
+        bytes_read = read_length;
+    } else {
+        source->romfs_file->Seek(source->data_offset + offset, SEEK_SET);
+        bytes_read = source->romfs_file->ReadBytes(buffer, read_length);
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start_time);
+    const u64 elapsed_ns = static_cast<u64>(elapsed.count());
+    stats.read_count++;
+    stats.bytes_read += bytes_read;
+    stats.total_read_ns += elapsed_ns;
+    stats.max_read_ns = std::max(stats.max_read_ns, elapsed_ns);
+
+    return MakeResult<size_t>(bytes_read);
 }
 
 ResultVal<size_t> IVFCFile::Write(const u64 offset, const size_t length, const bool flush,
@@ -101,7 +185,7 @@ ResultVal<size_t> IVFCFile::Write(const u64 offset, const size_t length, const b
 }
 
 u64 IVFCFile::GetSize() const {
-    return data_size;
+    return source->data_size;
 }
 
 bool IVFCFile::SetSize(const u64 size) const {
@@ -5,8 +5,10 @@
 #pragma once
 
 #include <cstddef>
+#include <limits>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 #include "common/common_types.h"
 #include "common/file_util.h"
@@ -20,6 +22,32 @@
 
 namespace FileSys {
 
+/// Counters of the reads from the files of an IVFC archive
+struct IVFCReadStats {
+    u64 read_count = 0;
+    u64 bytes_read = 0;
+    /// Reads starting where the previous read of the same file ended
+    u64 sequential_reads = 0;
+    /// Time spent in the reads, in nanoseconds
+    u64 total_read_ns = 0;
+    u64 max_read_ns = 0;
+};
+
+/// The data of an IVFC archive, shared by the archive and the files opened from it
+struct IVFCSource : NonCopyable {
+    IVFCSource(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size);
+    /// Logs the read counters
+    ~IVFCSource();
+
+    std::shared_ptr<FileUtil::IOFile> romfs_file;
+    /// View of the whole file the data is read from, or nullptr if it couldn't be mapped
+    std::unique_ptr<FileUtil::MappedFile> mapping;
+    u64 data_offset;
+    u64 data_size;
+
+    IVFCReadStats stats;
+};
+
 /**
  * Helper which implements an interface to deal with IVFC images used in some archives
  * This should be subclassed by concrete archive types, which will provide the
@@ -28,7 +56,9 @@ namespace FileSys {
 class IVFCArchive : public ArchiveBackend {
 public:
     IVFCArchive(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
-        : romfs_file(file), data_offset(offset), data_size(size) {}
+        : source(std::make_shared<IVFCSource>(std::move(file), offset, size)) {}
+    /// Opens an archive on data already mapped by another archive
+    explicit IVFCArchive(std::shared_ptr<IVFCSource> source_) : source(std::move(source_)) {}
 
     std::string GetName() const override;
 
@@ -44,18 +74,23 @@ public:
     ResultVal<std::unique_ptr<DirectoryBackend>> OpenDirectory(const Path& path) const override;
     u64 GetFreeBytes() const override;
 
+    /// Returns the counters of the reads from the files opened from this archive
+    const IVFCReadStats& GetReadStats() const {
+        return source->stats;
+    }
+
 protected:
-    std::shared_ptr<FileUtil::IOFile> romfs_file;
-    u64 data_offset;
-    u64 data_size;
+    std::shared_ptr<IVFCSource> source;
 };
 
 class IVFCFile : public FileBackend {
 public:
-    IVFCFile(std::shared_ptr<FileUtil::IOFile> file, u64 offset, u64 size)
-        : romfs_file(file), data_offset(offset), data_size(size) {}
+    explicit IVFCFile(std::shared_ptr<IVFCSource> source_) : source(std::move(source_)) {}
 
     ResultVal<size_t> Read(u64 offset, size_t length, u8* buffer) const override;
+    bool ReadCanFailPartway() const override {
+        return false;
+    }
     ResultVal<size_t> Write(u64 offset, size_t length, bool flush, const u8* buffer) const override;
     u64 GetSize() const override;
     bool SetSize(u64 size) const override;
@@ -65,9 +100,18 @@ public:
     void Flush() const override {}
 
 private:
-    std::shared_ptr<FileUtil::IOFile> romfs_file;
-    u64 data_offset;
-    u64 data_size;
+    /// Requests the data of a read from the mapped file, and the data following it ahead of time
+    /// if the reads are sequential
+    void ReadAhead(u64 offset, size_t length, bool sequential) const;
+
+    std::shared_ptr<IVFCSource> source;
+
+    /// Where the next read starts if the reads are sequential, none before the first read
+    mutable u64 next_offset = std::numeric_limits<u64>::max();
+    /// End of the data requested ahead of time
+    mutable u64 read_ahead_end = 0;
+    /// Amount of data requested ahead, which grows as long as the reads are sequential
+    mutable u64 read_ahead_size = 0;
 };
 
 class IVFCDirectory : public DirectoryBackend {
@@ -5,6 +5,7 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/memory.h"
 
@@ -24,6 +25,10 @@ SharedPtr<AddressArbiter> AddressArbiter::Create(std::string name) {
     return address_arbiter;
 }
 
+void AddressArbiter::DoState(PointerWrap& p) {
+    p.Do(name);
+}
+
 ResultCode AddressArbiter::ArbitrateAddress(ArbitrationType type, VAddr address, s32 value,
                                             u64 nanoseconds) {
     switch (type) {
@@ -47,11 +47,15 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     std::string name; ///< Name of address arbiter object (optional)
 
     ResultCode ArbitrateAddress(ArbitrationType type, VAddr address, s32 value, u64 nanoseconds);
 
 private:
+    friend class ObjectRegistry;
+
     AddressArbiter();
     ~AddressArbiter() override;
 };
@@ -28,6 +28,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Creates a new Session pair, adds the created ServerSession to the associated ServerPort's
      * list of pending sessions, and signals the ServerPort, causing any threads
@@ -42,6 +44,8 @@ public:
     std::string name;    ///< Name of client port (optional)
 
 private:
+    friend class ObjectRegistry;
+
     ClientPort();
     ~ClientPort() override;
 };
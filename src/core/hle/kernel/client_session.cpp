@@ -5,6 +5,7 @@
 #include "common/assert.h"
 
 #include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/server_session.h"
 
 namespace Kernel {
@@ -22,6 +23,12 @@ ClientSession::~ClientSession() {
     // 0xC920181A.
 }
 
+void ClientSession::DoState(PointerWrap& p) {
+    p.Do(name);
+    DoObject(p, server_session);
+    p.Do(session_status);
+}
+
 ResultVal<SharedPtr<ClientSession>> ClientSession::Create(ServerSession* server_session,
                                                           std::string name) {
     SharedPtr<ClientSession> client_session(new ClientSession);
@@ -38,6 +38,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Sends an SyncRequest from the current emulated thread.
      * @return ResultCode of the operation.
@@ -49,6 +51,8 @@ public:
     SessionStatus session_status;  ///< The session's current status.
 
 private:
+    friend class ObjectRegistry;
+
     ClientSession();
     ~ClientSession() override;
 
@@ -8,6 +8,7 @@
 #include "common/assert.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -36,6 +37,13 @@ void Event::Acquire(Thread* thread) {
         signaled = false;
 }
 
+void Event::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(reset_type);
+    p.Do(signaled);
+    p.Do(name);
+}
+
 void Event::Signal() {
     signaled = true;
     WakeupAllWaitingThreads();
@@ -30,6 +30,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     ResetType reset_type; ///< Current ResetType
 
     bool signaled;    ///< Whether the event has already been signaled
@@ -44,6 +46,8 @@ public:
     void Clear();
 
 private:
+    friend class ObjectRegistry;
+
     Event();
     ~Event() override;
 };
@@ -3,15 +3,31 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include "common/assert.h"
+#include "common/chunk_file.h"
 #include "common/logging/log.h"
 #include "core/hle/config_mem.h"
+#include "core/hle/kernel/address_arbiter.h"
+#include "core/hle/kernel/client_port.h"
+#include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/event.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/savestate.h"
+#include "core/hle/kernel/semaphore.h"
+#include "core/hle/kernel/server_port.h"
+#include "core/hle/kernel/server_session.h"
+#include "core/hle/kernel/shared_memory.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
+#include "core/hle/service/service.h"
 #include "core/hle/shared_page.h"
 
 namespace Kernel {
@@ -19,10 +35,321 @@ namespace Kernel {
 unsigned int Object::next_object_id;
 HandleTable g_handle_table;
 
+/**
+ * Keeps a list of all the existing objects, so that loading a state can find the objects that
+ * still exist, and tracks the objects and memory blocks already saved or loaded during a state.
+ */
+class ObjectRegistry {
+public:
+    static void Register(Object* object) {
+        object->next_object = first_object;
+        if (first_object != nullptr)
+            first_object->prev_object = object;
+        first_object = object;
+    }
+
+    static void Unregister(Object* object) {
+        if (object->prev_object != nullptr)
+            object->prev_object->next_object = object->next_object;
+        else
+            first_object = object->next_object;
+        if (object->next_object != nullptr)
+            object->next_object->prev_object = object->prev_object;
+    }
+
+    static void BeginState(PointerWrap& p);
+    static void EndState(PointerWrap& p);
+    static void DoObject(PointerWrap& p, SharedPtr<Object>& object);
+    static void DoMemoryBlock(PointerWrap& p, std::shared_ptr<std::vector<u8>>& block);
+    static void DoHLEHandler(PointerWrap& p,
+                             std::shared_ptr<Service::SessionRequestHandler>& handler);
+
+private:
+    static SharedPtr<Object> CreateObject(HandleType type);
+
+    static constexpr u32 NULL_ID = 0xFFFFFFFF;
+
+    static Object* first_object;
+
+    /// Objects and memory blocks saved so far, by id and by address
+    static std::unordered_map<unsigned int, const Object*> saved_objects;
+    static std::unordered_map<const std::vector<u8>*, u32> saved_blocks;
+
+    /// Objects and memory blocks loaded so far, by id and by index
+    static std::unordered_map<unsigned int, SharedPtr<Object>> loaded_objects;
+    static std::vector<std::shared_ptr<std::vector<u8>>> loaded_blocks;
+    /// Existing memory blocks that were loaded in place, which can't be reused for another block
+    static std::unordered_set<const std::vector<u8>*> reused_blocks;
+
+    /// The objects that existed before the load, by id. They are kept alive until the end of the
+    /// load, so that the objects left out of the state are destroyed once the state is consistent.
+    static std::unordered_map<unsigned int, SharedPtr<Object>> existing_objects;
+
+    /// HLE handlers of the service ports, by port name
+    static std::unordered_map<std::string, std::shared_ptr<Service::SessionRequestHandler>>
+        hle_handlers;
+};
+
+constexpr u32 ObjectRegistry::NULL_ID;
+Object* ObjectRegistry::first_object = nullptr;
+std::unordered_map<unsigned int, const Object*> ObjectRegistry::saved_objects;
+std::unordered_map<const std::vector<u8>*, u32> ObjectRegistry::saved_blocks;
+std::unordered_map<unsigned int, SharedPtr<Object>> ObjectRegistry::loaded_objects;
+std::vector<std::shared_ptr<std::vector<u8>>> ObjectRegistry::loaded_blocks;
+std::unordered_set<const std::vector<u8>*> ObjectRegistry::reused_blocks;
+std::unordered_map<unsigned int, SharedPtr<Object>> ObjectRegistry::existing_objects;
+std::unordered_map<std::string, std::shared_ptr<Service::SessionRequestHandler>>
+    ObjectRegistry::hle_handlers;
+
+void ObjectRegistry::BeginState(PointerWrap& p) {
+    saved_objects.clear();
+    saved_blocks.clear();
+    loaded_objects.clear();
+    loaded_blocks.clear();
+    reused_blocks.clear();
+    existing_objects.clear();
+    hle_handlers.clear();
+
+    if (p.GetMode() != PointerWrap::MODE_READ)
+        return;
+
+    for (Object* object = first_object; object != nullptr; object = object->next_object) {
+        existing_objects.emplace(object->object_id, object);
+    }
+
+    for (const auto* ports : {&Service::g_kernel_named_ports, &Service::g_srv_services}) {
+        for (const auto& port : *ports) {
+            hle_handlers.emplace(port.first, port.second->server_port->hle_handler);
+        }
+    }
+}
+
+void ObjectRegistry::EndState(PointerWrap& p) {
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        saved_objects.clear();
+        saved_blocks.clear();
+        return;
+    }
+
+    std::unordered_set<const Object*> loaded;
+    for (const auto& object : loaded_objects) {
+        loaded.insert(object.second.get());
+    }
+    loaded_objects.clear();
+    loaded_blocks.clear();
+    reused_blocks.clear();
+    hle_handlers.clear();
+
+    // Destroy the objects that aren't referenced anymore, and give the ones that survive, because
+    // the HLE services still hold them, ids that don't collide with the loaded ones
+    existing_objects.clear();
+    for (Object* object = first_object; object != nullptr; object = object->next_object) {
+        if (loaded.count(object) == 0)
+            object->object_id = Object::next_object_id++;
+    }
+}
+
+SharedPtr<Object> ObjectRegistry::CreateObject(HandleType type) {
+    switch (type) {
+    case HandleType::Event:
+        return new Event;
+    case HandleType::Mutex:
+        return new Mutex;
+    case HandleType::SharedMemory:
+        return new SharedMemory;
+    case HandleType::Thread:
+        return new Thread;
+    case HandleType::Process:
+        return new Process;
+    case HandleType::AddressArbiter:
+        return new AddressArbiter;
+    case HandleType::Semaphore:
+        return new Semaphore;
+    case HandleType::Timer:
+        return new Timer;
+    case HandleType::ResourceLimit:
+        return new ResourceLimit;
+    case HandleType::CodeSet:
+        return new CodeSet;
+    case HandleType::ClientPort:
+        return new ClientPort;
+    case HandleType::ServerPort:
+        return new ServerPort;
+    case HandleType::ClientSession:
+        return new ClientSession;
+    case HandleType::ServerSession:
+        return new ServerSession;
+    case HandleType::Unknown:
+        break;
+    }
+    return nullptr;
+}
+
+void ObjectRegistry::DoObject(PointerWrap& p, SharedPtr<Object>& object) {
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        u32 id = object != nullptr ? object->object_id : NULL_ID;
+        p.Do(id);
+        if (object == nullptr)
+            return;
+
+        auto saved = saved_objects.emplace(id, object.get());
+        if (!saved.second) {
+            ASSERT_MSG(saved.first->second == object.get(), "Two kernel objects have the id %u",
+                       id);
+            return;
+        }
+
+        HandleType type = object->GetHandleType();
+        p.Do(type);
+        object->DoState(p);
+        return;
+    }
+
+    u32 id;
+    p.Do(id);
+    if (id == NULL_ID) {
+        object = nullptr;
+        return;
+    }
+
+    auto loaded = loaded_objects.find(id);
+    if (loaded != loaded_objects.end()) {
+        object = loaded->second;
+        return;
+    }
+
+    HandleType type;
+    p.Do(type);
+
+    SharedPtr<Object> target;
+    auto existing = existing_objects.find(id);
+    if (existing != existing_objects.end() && existing->second->GetHandleType() == type) {
+        target = existing->second;
+    } else {
+        target = CreateObject(type);
+        if (target == nullptr) {
+            LOG_ERROR(Kernel, "Savestate failure: object %u has an invalid type %u", id,
+                      static_cast<u32>(type));
+            p.SetError(PointerWrap::ERROR_FAILURE);
+            object = nullptr;
+            return;
+        }
+        target->object_id = id;
+    }
+
+    // Registered before loading it, since it may be referenced by the objects it references
+    loaded_objects.emplace(id, target);
+    target->DoState(p);
+    object = std::move(target);
+}
+
+void ObjectRegistry::DoMemoryBlock(PointerWrap& p, std::shared_ptr<std::vector<u8>>& block) {
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        u32 index = NULL_ID;
+        if (block != nullptr) {
+            auto saved = saved_blocks.emplace(block.get(), static_cast<u32>(saved_blocks.size()));
+            index = saved.first->second;
+            p.Do(index);
+            if (!saved.second)
+                return;
+        } else {
+            p.Do(index);
+            return;
+        }
+
+        u32 size = static_cast<u32>(block->size());
+        u32 capacity = static_cast<u32>(block->capacity());
+        p.Do(size);
+        p.Do(capacity);
+        p.DoVoid(block->data(), size);
+        return;
+    }
+
+    u32 index;
+    p.Do(index);
+    if (index == NULL_ID) {
+        block = nullptr;
+        return;
+    }
+    if (index < loaded_blocks.size()) {
+        block = loaded_blocks[index];
+        return;
+    }
+    if (index != loaded_blocks.size()) {
+        LOG_ERROR(Kernel, "Savestate failure: memory block %u out of order", index);
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+
+    std::shared_ptr<std::vector<u8>> target;
+    if (block != nullptr && reused_blocks.insert(block.get()).second)
+        target = block;
+    else
+        target = std::make_shared<std::vector<u8>>();
+
+    u32 size;
+    u32 capacity;
+    p.Do(size);
+    p.Do(capacity);
+    target->reserve(capacity);
+    target->resize(size);
+    p.DoVoid(target->data(), size);
+
+    loaded_blocks.push_back(target);
+    block = std::move(target);
+}
+
+void ObjectRegistry::DoHLEHandler(PointerWrap& p,
+                                  std::shared_ptr<Service::SessionRequestHandler>& handler) {
+    std::string port_name;
+    if (p.GetMode() != PointerWrap::MODE_READ && handler != nullptr) {
+        auto service = dynamic_cast<const Service::Interface*>(handler.get());
+        ASSERT_MSG(service != nullptr, "HLE handler isn't a service");
+        port_name = service->GetPortName();
+    }
+    p.Do(port_name);
+
+    if (p.GetMode() != PointerWrap::MODE_READ)
+        return;
+
+    if (port_name.empty()) {
+        handler = nullptr;
+        return;
+    }
+
+    auto found = hle_handlers.find(port_name);
+    if (found == hle_handlers.end()) {
+        LOG_ERROR(Kernel, "Savestate failure: unknown service port %s", port_name.c_str());
+        p.SetError(PointerWrap::ERROR_FAILURE);
+        return;
+    }
+    handler = found->second;
+}
+
+void DoObject(PointerWrap& p, SharedPtr<Object>& object) {
+    ObjectRegistry::DoObject(p, object);
+}
+
+void DoMemoryBlock(PointerWrap& p, std::shared_ptr<std::vector<u8>>& block) {
+    ObjectRegistry::DoMemoryBlock(p, block);
+}
+
+void DoHLEHandler(PointerWrap& p, std::shared_ptr<Service::SessionRequestHandler>& handler) {
+    ObjectRegistry::DoHLEHandler(p, handler);
+}
+
+Object::Object() {
+    ObjectRegistry::Register(this);
+}
+
+Object::~Object() {
+    ObjectRegistry::Unregister(this);
+}
+
 void WaitObject::AddWaitingThread(SharedPtr<Thread> thread) {
     auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
     if (itr == waiting_threads.end())
-        waiting_threads.push_back(std::move(thread));
+        InsertWaitingThread(std::move(thread));
 }
 
 void WaitObject::RemoveWaitingThread(Thread* thread) {
@@ -35,18 +362,13 @@ void WaitObject::RemoveWaitingThread(Thread* thread) {
 }
 
 SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() {
-    Thread* candidate = nullptr;
-    s32 candidate_priority = THREADPRIO_LOWEST + 1;
-
+    // The waiting threads are ordered by priority, so the first ready thread is the best one
     for (const auto& thread : waiting_threads) {
         // The list of waiting threads must not contain threads that are not waiting to be awakened.
         ASSERT_MSG(thread->status == THREADSTATUS_WAIT_SYNCH_ANY ||
                        thread->status == THREADSTATUS_WAIT_SYNCH_ALL,
                    "Inconsistent thread statuses in waiting_threads");
 
-        if (thread->current_priority >= candidate_priority)
-            continue;
-
         if (ShouldWait(thread.get()))
             continue;
 
@@ -60,13 +382,30 @@ SharedPtr<Thread> WaitObject::GetHighestPriorityReadyThread() {
                                         });
         }
 
-        if (ready_to_run) {
-            candidate = thread.get();
-            candidate_priority = thread->current_priority;
-        }
+        if (ready_to_run)
+            return thread;
     }
 
-    return candidate;
+    return nullptr;
+}
+
+void WaitObject::UpdateWaitingThreadPriority(Thread* thread) {
+    auto itr = std::find(waiting_threads.begin(), waiting_threads.end(), thread);
+    if (itr == waiting_threads.end())
+        return;
+
+    SharedPtr<Thread> waiting_thread = std::move(*itr);
+    waiting_threads.erase(itr);
+    InsertWaitingThread(std::move(waiting_thread));
+}
+
+void WaitObject::InsertWaitingThread(SharedPtr<Thread> thread) {
+    auto itr = std::upper_bound(waiting_threads.begin(), waiting_threads.end(),
+                                thread->current_priority,
+                                [](s32 priority, const SharedPtr<Thread>& waiting_thread) {
+                                    return priority < waiting_thread->current_priority;
+                                });
+    waiting_threads.insert(itr, std::move(thread));
 }
 
 void WaitObject::WakeupAllWaitingThreads() {
@@ -98,6 +437,10 @@ const std::vector<SharedPtr<Thread>>& WaitObject::GetWaitingThreads() const {
     return waiting_threads;
 }
 
+void WaitObject::DoState(PointerWrap& p) {
+    DoObjects(p, waiting_threads);
+}
+
 HandleTable::HandleTable() {
     next_generation = 1;
     Clear();
@@ -177,8 +520,20 @@ void HandleTable::Clear() {
     next_free_slot = 0;
 }
 
+void HandleTable::DoState(PointerWrap& p) {
+    for (auto& object : objects) {
+        DoObject(p, object);
+    }
+    p.DoArray(generations.data(), static_cast<int>(generations.size()));
+    p.Do(next_generation);
+    p.Do(next_free_slot);
+}
+
 /// Initialize the kernel
 void Init(u32 system_mode) {
+    // Reset before the resource limits are created, as the ids identify the objects in save states
+    Object::next_object_id = 0;
+
     ConfigMem::Init();
     SharedPage::Init();
 
@@ -188,7 +543,6 @@ void Init(u32 system_mode) {
     Kernel::ThreadingInit();
     Kernel::TimersInit();
 
-    Object::next_object_id = 0;
     // TODO(Subv): Start the process ids from 10 for now, as lower PIDs are
     // reserved for low-level services
     Process::next_process_id = 10;
@@ -206,4 +560,53 @@ void Shutdown() {
     Kernel::MemoryShutdown();
 }
 
+/// Saves or loads the ports of the HLE services, in the order of their names
+static void DoServicePorts(PointerWrap& p,
+                           std::unordered_map<std::string, SharedPtr<ClientPort>>& ports) {
+    std::map<std::string, SharedPtr<ClientPort>> sorted_ports(ports.begin(), ports.end());
+    u32 num_ports = static_cast<u32>(sorted_ports.size());
+    p.Do(num_ports);
+
+    auto port = sorted_ports.begin();
+    for (u32 i = 0; i < num_ports; ++i) {
+        std::string name;
+        SharedPtr<ClientPort> client_port;
+        if (p.GetMode() != PointerWrap::MODE_READ) {
+            name = port->first;
+            client_port = port->second;
+            ++port;
+        }
+        p.Do(name);
+        DoObject(p, client_port);
+        if (p.GetMode() == PointerWrap::MODE_READ)
+            ports[name] = std::move(client_port);
+    }
+}
+
+void DoState(PointerWrap& p) {
+    auto s = p.Section("Kernel", 1);
+    if (!s)
+        return;
+
+    ObjectRegistry::BeginState(p);
+
+    Kernel::MemoryDoState(p);
+    Kernel::ResourceLimitsDoState(p);
+    Kernel::ThreadingDoState(p);
+    Kernel::TimersDoState(p);
+    g_handle_table.DoState(p);
+    DoObject(p, g_current_process);
+    DoServicePorts(p, Service::g_kernel_named_ports);
+    DoServicePorts(p, Service::g_srv_services);
+
+    p.Do(Process::next_process_id);
+    p.Do(Object::next_object_id);
+
+    ObjectRegistry::EndState(p);
+
+    // The loaded memory blocks may have moved
+    if (p.GetMode() == PointerWrap::MODE_READ && g_current_process != nullptr)
+        g_current_process->vm_manager.RefreshMemoryMappings();
+}
+
 } // namespace
@@ -13,6 +13,8 @@
 #include "common/common_types.h"
 #include "core/hle/result.h"
 
+class PointerWrap;
+
 namespace Kernel {
 
 using Handle = u32;
@@ -61,7 +63,8 @@ enum class ResetType {
 
 class Object : NonCopyable {
 public:
-    virtual ~Object() {}
+    Object();
+    virtual ~Object();
 
     /// Returns a unique identifier for the object. For debugging purposes only.
     unsigned int GetObjectId() const {
@@ -76,6 +79,12 @@ public:
     }
     virtual Kernel::HandleType GetHandleType() const = 0;
 
+    /**
+     * Saves or loads the state of the object. The references to other objects are saved with
+     * DoObject, which takes care of objects referenced more than once.
+     */
+    virtual void DoState(PointerWrap& p) = 0;
+
     /**
      * Check if a thread can wait on the object
      * @return True if a thread can wait on the object, otherwise false
@@ -109,9 +118,14 @@ public:
 private:
     friend void intrusive_ptr_add_ref(Object*);
     friend void intrusive_ptr_release(Object*);
+    friend class ObjectRegistry;
 
     unsigned int ref_count = 0;
     unsigned int object_id = next_object_id++;
+
+    /// Neighbours in the list of all the existing objects, see ObjectRegistry
+    Object* prev_object = nullptr;
+    Object* next_object = nullptr;
 };
 
 // Special functions used by boost::instrusive_ptr to do automatic ref-counting
@@ -162,11 +176,23 @@ public:
     /// Obtains the highest priority thread that is ready to run from this object's waiting list.
     SharedPtr<Thread> GetHighestPriorityReadyThread();
 
-    /// Get a const reference to the waiting threads list for debug use
+    /**
+     * Moves a waiting thread to its place in the waiting list after its priority changed
+     * @param thread Pointer to the waiting thread
+     */
+    void UpdateWaitingThreadPriority(Thread* thread);
+
+    /// Get a const reference to the waiting threads list, ordered by priority, for debug use
     const std::vector<SharedPtr<Thread>>& GetWaitingThreads() const;
 
+    /// Saves or loads the waiting threads list. Derived objects call it from their DoState.
+    void DoState(PointerWrap& p) override;
+
 private:
-    /// Threads waiting for this object to become available
+    /// Inserts a thread in the waiting list after the threads of equal or better priority
+    void InsertWaitingThread(SharedPtr<Thread> thread);
+
+    /// Threads waiting for this object to become available, ordered by priority
     std::vector<SharedPtr<Thread>> waiting_threads;
 };
 
@@ -258,6 +284,9 @@ public:
     /// Closes all handles held in this table.
     void Clear();
 
+    /// Saves or loads the handles and the objects they point to.
+    void DoState(PointerWrap& p);
+
 private:
     /**
      * This is the maximum limit of handles allowed per process in CTR-OS. It can be further
@@ -299,4 +328,10 @@ void Init(u32 system_mode);
 /// Shutdown the kernel
 void Shutdown();
 
+/**
+ * Saves or loads the state of the kernel: the objects reachable from the handle tables, the
+ * threads, the processes and their memory.
+ */
+void DoState(PointerWrap& p);
+
 } // namespace
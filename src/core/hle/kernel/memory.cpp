@@ -11,6 +11,7 @@
 #include "common/logging/log.h"
 #include "core/hle/config_mem.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/hle/result.h"
 #include "core/hle/shared_page.h"
@@ -80,6 +81,15 @@ void MemoryShutdown() {
     }
 }
 
+void MemoryDoState(PointerWrap& p) {
+    for (auto& region : memory_regions) {
+        p.Do(region.base);
+        p.Do(region.size);
+        p.Do(region.used);
+        DoMemoryBlock(p, region.linear_heap_memory);
+    }
+}
+
 MemoryRegionInfo* GetMemoryRegion(MemoryRegion region) {
     switch (region) {
     case MemoryRegion::APPLICATION:
@@ -22,6 +22,8 @@ struct MemoryRegionInfo {
 
 void MemoryInit(u32 mem_type);
 void MemoryShutdown();
+/// Saves or loads the usage and the linear heap of the memory regions
+void MemoryDoState(PointerWrap& p);
 MemoryRegionInfo* GetMemoryRegion(MemoryRegion region);
 }
 
@@ -9,6 +9,7 @@
 #include "core/core.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/mutex.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 
 namespace Kernel {
@@ -39,6 +40,14 @@ SharedPtr<Mutex> Mutex::Create(bool initial_locked, std::string name) {
     return mutex;
 }
 
+void Mutex::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(lock_count);
+    p.Do(priority);
+    p.Do(name);
+    DoObject(p, holding_thread);
+}
+
 bool Mutex::ShouldWait(Thread* thread) const {
     return lock_count > 0 && thread != holding_thread;
 }
@@ -90,11 +99,9 @@ void Mutex::UpdatePriority() {
     if (!holding_thread)
         return;
 
-    s32 best_priority = THREADPRIO_LOWEST;
-    for (auto& waiter : GetWaitingThreads()) {
-        if (waiter->current_priority < best_priority)
-            best_priority = waiter->current_priority;
-    }
+    // The waiting threads are ordered by priority
+    const auto& waiters = GetWaitingThreads();
+    s32 best_priority = waiters.empty() ? THREADPRIO_LOWEST : waiters.front()->current_priority;
 
     if (best_priority != priority) {
         priority = best_priority;
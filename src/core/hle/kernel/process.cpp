@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <memory>
 #include "common/assert.h"
 #include "common/common_funcs.h"
@@ -9,6 +10,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
@@ -27,6 +29,22 @@ SharedPtr<CodeSet> CodeSet::Create(std::string name, u64 program_id) {
 CodeSet::CodeSet() {}
 CodeSet::~CodeSet() {}
 
+static void DoSegment(PointerWrap& p, CodeSet::Segment& segment) {
+    p.Do(segment.offset);
+    p.Do(segment.addr);
+    p.Do(segment.size);
+}
+
+void CodeSet::DoState(PointerWrap& p) {
+    p.Do(name);
+    p.Do(program_id);
+    DoMemoryBlock(p, memory);
+    DoSegment(p, code);
+    DoSegment(p, rodata);
+    DoSegment(p, data);
+    p.Do(entrypoint);
+}
+
 u32 Process::next_process_id;
 
 SharedPtr<Process> Process::Create(SharedPtr<CodeSet> code_set) {
@@ -40,6 +58,48 @@ SharedPtr<Process> Process::Create(SharedPtr<CodeSet> code_set) {
     return process;
 }
 
+void Process::DoState(PointerWrap& p) {
+    DoObject(p, codeset);
+    DoObject(p, resource_limit);
+    p.DoVoid(&svc_access_mask, sizeof(svc_access_mask));
+    p.Do(handle_table_size);
+
+    u32 num_mappings = static_cast<u32>(address_mappings.size());
+    p.Do(num_mappings);
+    address_mappings.resize(num_mappings);
+    for (auto& mapping : address_mappings) {
+        p.Do(mapping);
+    }
+
+    p.Do(flags.raw);
+    p.Do(kernel_version);
+    p.Do(ideal_processor);
+    p.Do(process_id);
+
+    vm_manager.DoState(p);
+    DoMemoryBlock(p, heap_memory);
+    p.Do(heap_start);
+    p.Do(heap_end);
+    p.Do(heap_used);
+    p.Do(linear_heap_used);
+    p.Do(misc_memory_used);
+
+    // The memory region is saved as its MemoryRegion value, 0 for none
+    u16 region = 0;
+    for (auto candidate : {MemoryRegion::APPLICATION, MemoryRegion::SYSTEM, MemoryRegion::BASE}) {
+        if (memory_region == GetMemoryRegion(candidate))
+            region = static_cast<u16>(candidate);
+    }
+    p.Do(region);
+    memory_region = region != 0 ? GetMemoryRegion(static_cast<MemoryRegion>(region)) : nullptr;
+
+    std::vector<u8> tls_masks(tls_slots.size());
+    std::transform(tls_slots.begin(), tls_slots.end(), tls_masks.begin(),
+                   [](const std::bitset<8>& slots) { return static_cast<u8>(slots.to_ulong()); });
+    p.Do(tls_masks);
+    tls_slots.assign(tls_masks.begin(), tls_masks.end());
+}
+
 void Process::ParseKernelCaps(const u32* kernel_caps, size_t len) {
     for (size_t i = 0; i < len; ++i) {
         u32 descriptor = kernel_caps[i];
@@ -66,6 +66,8 @@ struct CodeSet final : public Object {
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /// Name of the process
     std::string name;
     /// Title ID corresponding to the process
@@ -83,6 +85,8 @@ struct CodeSet final : public Object {
     VAddr entrypoint;
 
 private:
+    friend class ObjectRegistry;
+
     CodeSet();
     ~CodeSet() override;
 };
@@ -103,6 +107,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     static u32 next_process_id;
 
     SharedPtr<CodeSet> codeset;
@@ -171,6 +177,8 @@ public:
     ResultCode LinearFree(VAddr target, u32 size);
 
 private:
+    friend class ObjectRegistry;
+
     Process();
     ~Process() override;
 };
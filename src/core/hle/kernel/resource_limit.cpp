@@ -5,6 +5,7 @@
 #include <cstring>
 #include "common/logging/log.h"
 #include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/savestate.h"
 
 namespace Kernel {
 
@@ -20,6 +21,29 @@ SharedPtr<ResourceLimit> ResourceLimit::Create(std::string name) {
     return resource_limit;
 }
 
+void ResourceLimit::DoState(PointerWrap& p) {
+    p.Do(name);
+    p.Do(max_priority);
+    p.Do(max_commit);
+    p.Do(max_threads);
+    p.Do(max_events);
+    p.Do(max_mutexes);
+    p.Do(max_semaphores);
+    p.Do(max_timers);
+    p.Do(max_shared_mems);
+    p.Do(max_address_arbiters);
+    p.Do(max_cpu_time);
+    p.Do(current_commit);
+    p.Do(current_threads);
+    p.Do(current_events);
+    p.Do(current_mutexes);
+    p.Do(current_semaphores);
+    p.Do(current_timers);
+    p.Do(current_shared_mems);
+    p.Do(current_address_arbiters);
+    p.Do(current_cpu_time);
+}
+
 SharedPtr<ResourceLimit> ResourceLimit::GetForCategory(ResourceLimitCategory category) {
     switch (category) {
     case ResourceLimitCategory::APPLICATION:
@@ -150,4 +174,10 @@ void ResourceLimitsInit() {
 
 void ResourceLimitsShutdown() {}
 
+void ResourceLimitsDoState(PointerWrap& p) {
+    for (auto& resource_limit : resource_limits) {
+        DoObject(p, resource_limit);
+    }
+}
+
 } // namespace
@@ -55,6 +55,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Gets the current value for the specified resource.
      * @param resource Requested resource type
@@ -113,6 +115,8 @@ public:
     s32 current_cpu_time = 0;
 
 private:
+    friend class ObjectRegistry;
+
     ResourceLimit();
     ~ResourceLimit() override;
 };
@@ -123,4 +127,7 @@ void ResourceLimitsInit();
 // Destroys the resource limits
 void ResourceLimitsShutdown();
 
+/// Saves or loads the resource limits of each category
+void ResourceLimitsDoState(PointerWrap& p);
+
 } // namespace
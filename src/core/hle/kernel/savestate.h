@@ -0,0 +1,74 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <boost/container/flat_set.hpp>
+#include "common/assert.h"
+#include "common/chunk_file.h"
+#include "common/common_types.h"
+#include "core/hle/kernel/kernel.h"
+
+namespace Service {
+class SessionRequestHandler;
+}
+
+namespace Kernel {
+
+/**
+ * Saves or loads a reference to a kernel object. The first reference to an object saves the object
+ * itself, the following ones only its id. When loading, an object that still exists with the same
+ * id and type is loaded in place, so that the references the HLE services hold to it stay valid.
+ * Otherwise it is created again.
+ */
+void DoObject(PointerWrap& p, SharedPtr<Object>& object);
+
+template <typename T>
+void DoObject(PointerWrap& p, SharedPtr<T>& object) {
+    SharedPtr<Object> generic = object;
+    DoObject(p, generic);
+    object = boost::dynamic_pointer_cast<T>(generic);
+    ASSERT_MSG(object == generic, "Savestate object %u has the wrong type",
+               generic->GetObjectId());
+}
+
+/// Saves or loads a non-owning reference to a kernel object, which something else keeps alive
+template <typename T>
+void DoObject(PointerWrap& p, T*& object) {
+    SharedPtr<T> shared = p.GetMode() == PointerWrap::MODE_READ ? nullptr : object;
+    DoObject(p, shared);
+    object = shared.get();
+}
+
+template <typename T>
+void DoObjects(PointerWrap& p, std::vector<SharedPtr<T>>& objects) {
+    u32 size = static_cast<u32>(objects.size());
+    p.Do(size);
+    objects.resize(size);
+    for (auto& object : objects) {
+        DoObject(p, object);
+    }
+}
+
+template <typename T>
+void DoObjects(PointerWrap& p, boost::container::flat_set<SharedPtr<T>>& objects) {
+    std::vector<SharedPtr<T>> list(objects.begin(), objects.end());
+    DoObjects(p, list);
+    objects.clear();
+    objects.insert(list.begin(), list.end());
+}
+
+/**
+ * Saves or loads a block of memory shared between VMAs and kernel objects. Like the objects, each
+ * block is saved once and loaded in place when possible. The capacity of the block is kept, so
+ * that a block that mustn't move when it grows, like the linear heap, doesn't move after a load.
+ */
+void DoMemoryBlock(PointerWrap& p, std::shared_ptr<std::vector<u8>>& block);
+
+/// Saves or loads the HLE handler of a port or session, by the name of the service port
+void DoHLEHandler(PointerWrap& p, std::shared_ptr<Service::SessionRequestHandler>& handler);
+
+} // namespace Kernel
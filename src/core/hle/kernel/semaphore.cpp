@@ -4,6 +4,7 @@
 
 #include "common/assert.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/semaphore.h"
 #include "core/hle/kernel/thread.h"
 
@@ -30,6 +31,13 @@ ResultVal<SharedPtr<Semaphore>> Semaphore::Create(s32 initial_count, s32 max_cou
     return MakeResult<SharedPtr<Semaphore>>(std::move(semaphore));
 }
 
+void Semaphore::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(max_count);
+    p.Do(available_count);
+    p.Do(name);
+}
+
 bool Semaphore::ShouldWait(Thread* thread) const {
     return available_count <= 0;
 }
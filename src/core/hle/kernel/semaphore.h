@@ -35,6 +35,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     s32 max_count;       ///< Maximum number of simultaneous holders the semaphore can have
     s32 available_count; ///< Number of free slots left in the semaphore
     std::string name;    ///< Name of semaphore (optional)
@@ -50,6 +52,8 @@ public:
     ResultVal<s32> Release(s32 release_count);
 
 private:
+    friend class ObjectRegistry;
+
     Semaphore();
     ~Semaphore() override;
 };
@@ -6,6 +6,7 @@
 #include "common/assert.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/thread.h"
 
@@ -14,6 +15,13 @@ namespace Kernel {
 ServerPort::ServerPort() {}
 ServerPort::~ServerPort() {}
 
+void ServerPort::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(name);
+    DoObjects(p, pending_sessions);
+    DoHLEHandler(p, hle_handler);
+}
+
 bool ServerPort::ShouldWait(Thread* thread) const {
     // If there are no pending sessions, we wait until a new one is added.
     return pending_sessions.size() == 0;
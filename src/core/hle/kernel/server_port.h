@@ -44,6 +44,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     std::string name; ///< Name of port (optional)
 
     std::vector<SharedPtr<WaitObject>>
@@ -57,6 +59,8 @@ public:
     void Acquire(Thread* thread) override;
 
 private:
+    friend class ObjectRegistry;
+
     ServerPort();
     ~ServerPort() override;
 };
@@ -5,6 +5,7 @@
 #include <tuple>
 
 #include "core/hle/kernel/client_session.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/server_session.h"
 #include "core/hle/kernel/thread.h"
 
@@ -18,6 +19,22 @@ ServerSession::~ServerSession() {
     // if the session is still open, set the connection status to 3 (Closed by server),
 }
 
+void ServerSession::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(name);
+    p.Do(signaled);
+
+    // The HLE handlers keep their connected sessions alive, move the session to its new handler
+    auto previous_handler = hle_handler;
+    DoHLEHandler(p, hle_handler);
+    if (p.GetMode() == PointerWrap::MODE_READ && hle_handler != previous_handler) {
+        if (previous_handler != nullptr)
+            previous_handler->ClientDisconnected(this);
+        if (hle_handler != nullptr)
+            hle_handler->ClientConnected(this);
+    }
+}
+
 ResultVal<SharedPtr<ServerSession>> ServerSession::Create(
     std::string name, std::shared_ptr<Service::SessionRequestHandler> hle_handler) {
     SharedPtr<ServerSession> server_session(new ServerSession);
@@ -40,6 +40,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     using SessionPair = std::tuple<SharedPtr<ServerSession>, SharedPtr<ClientSession>>;
 
     /**
@@ -67,6 +69,8 @@ public:
         hle_handler; ///< This session's HLE request handler (optional)
 
 private:
+    friend class ObjectRegistry;
+
     ServerSession();
     ~ServerSession() override;
 
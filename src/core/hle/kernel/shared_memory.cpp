@@ -5,6 +5,7 @@
 #include <cstring>
 #include "common/logging/log.h"
 #include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/shared_memory.h"
 #include "core/memory.h"
 
@@ -13,6 +14,18 @@ namespace Kernel {
 SharedMemory::SharedMemory() {}
 SharedMemory::~SharedMemory() {}
 
+void SharedMemory::DoState(PointerWrap& p) {
+    DoObject(p, owner_process);
+    p.Do(base_address);
+    p.Do(linear_heap_phys_address);
+    DoMemoryBlock(p, backing_block);
+    p.Do(backing_block_offset);
+    p.Do(size);
+    p.Do(permissions);
+    p.Do(other_permissions);
+    p.Do(name);
+}
+
 SharedPtr<SharedMemory> SharedMemory::Create(SharedPtr<Process> owner_process, u32 size,
                                              MemoryPermission permissions,
                                              MemoryPermission other_permissions, VAddr address,
@@ -73,6 +73,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     /**
      * Converts the specified MemoryPermission into the equivalent VMAPermission.
      * @param permission The MemoryPermission to convert.
@@ -125,6 +127,8 @@ public:
     std::string name;
 
 private:
+    friend class ObjectRegistry;
+
     SharedMemory();
     ~SharedMemory() override;
 };
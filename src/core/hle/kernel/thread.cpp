@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <list>
+#include <unordered_map>
 #include <vector>
 #include "common/assert.h"
 #include "common/common_types.h"
@@ -18,6 +19,7 @@
 #include "core/hle/kernel/memory.h"
 #include "core/hle/kernel/mutex.h"
 #include "core/hle/kernel/process.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/result.h"
 #include "core/memory.h"
@@ -45,6 +47,10 @@ static std::vector<SharedPtr<Thread>> thread_list;
 // Lists only ready thread ids.
 static Common::ThreadQueueList<Thread*, THREADPRIO_LOWEST + 1> ready_queue;
 
+// Lists the threads waiting to be arbitrated on each address, in priority order. Threads of equal
+// priority are in the order they started waiting.
+static std::unordered_map<VAddr, std::vector<Thread*>> arbiter_waiters;
+
 static SharedPtr<Thread> current_thread;
 
 // The first available thread id at startup
@@ -61,23 +67,69 @@ inline static u32 const NewThreadId() {
 Thread::Thread() {}
 Thread::~Thread() {}
 
+void Thread::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(context);
+    p.Do(thread_id);
+    p.Do(status);
+    p.Do(entry_point);
+    p.Do(stack_top);
+    p.Do(nominal_priority);
+    p.Do(current_priority);
+    p.Do(last_running_ticks);
+    p.Do(processor_id);
+    p.Do(tls_address);
+    DoObjects(p, held_mutexes);
+    DoObjects(p, pending_mutexes);
+    DoObject(p, owner_process);
+    DoObjects(p, wait_objects);
+    p.Do(wait_address);
+    p.Do(wait_set_output);
+    p.Do(name);
+    p.Do(callback_handle);
+    p.Do(wakeup_event);
+}
+
 Thread* GetCurrentThread() {
     return current_thread.get();
 }
 
-/**
- * Check if the specified thread is waiting on the specified address to be arbitrated
- * @param thread The thread to test
- * @param wait_address The address to test against
- * @return True if the thread is waiting, false otherwise
- */
-static bool CheckWait_AddressArbiter(const Thread* thread, VAddr wait_address) {
-    return thread->status == THREADSTATUS_WAIT_ARB && wait_address == thread->wait_address;
+/// Adds a thread to the waiters of its wait address, after the waiters of equal or better priority
+static void AddArbiterWaiter(Thread* thread) {
+    auto& waiters = arbiter_waiters[thread->wait_address];
+    auto itr = std::upper_bound(
+        waiters.begin(), waiters.end(), thread->current_priority,
+        [](s32 priority, const Thread* waiter) { return priority < waiter->current_priority; });
+    waiters.insert(itr, thread);
+}
+
+/// Removes a thread from the waiters of its wait address, and the address once nothing waits on it
+static void RemoveArbiterWaiter(Thread* thread) {
+    auto waiters = arbiter_waiters.find(thread->wait_address);
+    if (waiters != arbiter_waiters.end()) {
+        auto itr = std::find(waiters->second.begin(), waiters->second.end(), thread);
+        if (itr != waiters->second.end())
+            waiters->second.erase(itr);
+        if (waiters->second.empty())
+            arbiter_waiters.erase(waiters);
+    }
+}
+
+/// Moves a waiting thread to its place in the wait queues it's in after its priority changed
+static void ReorderWaitingThread(Thread* thread) {
+    if (thread->status == THREADSTATUS_WAIT_ARB) {
+        RemoveArbiterWaiter(thread);
+        AddArbiterWaiter(thread);
+    }
+    for (auto& wait_object : thread->wait_objects) {
+        wait_object->UpdateWaitingThreadPriority(thread);
+    }
 }
 
 void Thread::Stop() {
     // Cancel any outstanding wakeup events for this thread
-    CoreTiming::UnscheduleEvent(ThreadWakeupEventType, callback_handle);
+    CoreTiming::UnscheduleEvent(wakeup_event);
+    wakeup_event = CoreTiming::INVALID_EVENT_HANDLE;
     wakeup_callback_handle_table.Close(callback_handle);
     callback_handle = 0;
 
@@ -85,6 +137,8 @@ void Thread::Stop() {
     // This is only needed when the thread is termintated forcefully (SVC TerminateProcess)
     if (status == THREADSTATUS_READY) {
         ready_queue.remove(current_priority, this);
+    } else if (status == THREADSTATUS_WAIT_ARB) {
+        RemoveArbiterWaiter(this);
     }
 
     status = THREADSTATUS_DEAD;
@@ -108,36 +162,29 @@ void Thread::Stop() {
 }
 
 Thread* ArbitrateHighestPriorityThread(u32 address) {
-    Thread* highest_priority_thread = nullptr;
-    s32 priority = THREADPRIO_LOWEST;
-
-    // Iterate through threads, find highest priority thread that is waiting to be arbitrated...
-    for (auto& thread : thread_list) {
-        if (!CheckWait_AddressArbiter(thread.get(), address))
-            continue;
-
-        if (thread == nullptr)
-            continue;
+    auto waiters = arbiter_waiters.find(address);
+    if (waiters == arbiter_waiters.end())
+        return nullptr;
 
-        if (thread->current_priority <= priority) {
-            highest_priority_thread = thread.get();
-            priority = thread->current_priority;
-        }
-    }
-
-    // If a thread was arbitrated, resume it
-    if (nullptr != highest_priority_thread) {
-        highest_priority_thread->ResumeFromWait();
-    }
+    // The waiters are sorted by priority, so the first one is the one to resume
+    Thread* highest_priority_thread = waiters->second.front();
+    highest_priority_thread->ResumeFromWait();
 
     return highest_priority_thread;
 }
 
 void ArbitrateAllThreads(u32 address) {
-    // Resume all threads found to be waiting on the address
-    for (auto& thread : thread_list) {
-        if (CheckWait_AddressArbiter(thread.get(), address))
-            thread->ResumeFromWait();
+    auto waiters = arbiter_waiters.find(address);
+    if (waiters == arbiter_waiters.end())
+        return;
+
+    // Resume all threads found to be waiting on the address. Resuming a thread removes it from the
+    // waiters, so take the list first.
+    std::vector<Thread*> threads;
+    threads.swap(waiters->second);
+    arbiter_waiters.erase(waiters);
+    for (Thread* thread : threads) {
+        thread->ResumeFromWait();
     }
 }
 
@@ -167,7 +214,8 @@ static void SwitchContext(Thread* new_thread) {
                    "Thread must be ready to become running.");
 
         // Cancel any outstanding wakeup events for this thread
-        CoreTiming::UnscheduleEvent(ThreadWakeupEventType, new_thread->callback_handle);
+        CoreTiming::UnscheduleEvent(new_thread->wakeup_event);
+        new_thread->wakeup_event = CoreTiming::INVALID_EVENT_HANDLE;
 
         current_thread = new_thread;
 
@@ -213,6 +261,7 @@ void WaitCurrentThread_ArbitrateAddress(VAddr wait_address) {
     Thread* thread = GetCurrentThread();
     thread->wait_address = wait_address;
     thread->status = THREADSTATUS_WAIT_ARB;
+    AddArbiterWaiter(thread);
 }
 
 void ExitCurrentThread() {
@@ -255,16 +304,21 @@ void Thread::WakeAfterDelay(s64 nanoseconds) {
         return;
 
     u64 microseconds = nanoseconds / 1000;
-    CoreTiming::ScheduleEvent(usToCycles(microseconds), ThreadWakeupEventType, callback_handle);
+    CoreTiming::UnscheduleEvent(wakeup_event);
+    wakeup_event =
+        CoreTiming::ScheduleEvent(usToCycles(microseconds), ThreadWakeupEventType, callback_handle);
 }
 
 void Thread::ResumeFromWait() {
     ASSERT_MSG(wait_objects.empty(), "Thread is waking up while waiting for objects");
 
     switch (status) {
+    case THREADSTATUS_WAIT_ARB:
+        RemoveArbiterWaiter(this);
+        break;
+
     case THREADSTATUS_WAIT_SYNCH_ALL:
     case THREADSTATUS_WAIT_SYNCH_ANY:
-    case THREADSTATUS_WAIT_ARB:
     case THREADSTATUS_WAIT_SLEEP:
         break;
 
@@ -366,7 +420,6 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     SharedPtr<Thread> thread(new Thread);
 
     thread_list.push_back(thread);
-    ready_queue.prepare(priority);
 
     thread->thread_id = NewThreadId();
     thread->status = THREADSTATUS_DORMANT;
@@ -380,6 +433,7 @@ ResultVal<SharedPtr<Thread>> Thread::Create(std::string name, VAddr entry_point,
     thread->wait_address = 0;
     thread->name = std::move(name);
     thread->callback_handle = wakeup_callback_handle_table.Create(thread).MoveFrom();
+    thread->wakeup_event = CoreTiming::INVALID_EVENT_HANDLE;
     thread->owner_process = g_current_process;
 
     // Find the next available TLS index, and mark it as used
@@ -444,10 +498,9 @@ void Thread::SetPriority(s32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
 
     nominal_priority = current_priority = priority;
+    ReorderWaitingThread(this);
 }
 
 void Thread::UpdatePriority() {
@@ -463,9 +516,8 @@ void Thread::BoostPriority(s32 priority) {
     // If thread was ready, adjust queues
     if (status == THREADSTATUS_READY)
         ready_queue.move(this, current_priority, priority);
-    else
-        ready_queue.prepare(priority);
     current_priority = priority;
+    ReorderWaitingThread(this);
 }
 
 SharedPtr<Thread> SetupMainThread(u32 entry_point, s32 priority) {
@@ -536,6 +588,69 @@ void ThreadingShutdown() {
     }
     thread_list.clear();
     ready_queue.clear();
+    arbiter_waiters.clear();
+}
+
+void ThreadingDoState(PointerWrap& p) {
+    // The context of the running thread only lives in the CPU
+    if (p.GetMode() == PointerWrap::MODE_WRITE && current_thread != nullptr)
+        Core::CPU().SaveContext(current_thread->context);
+
+    DoObjects(p, thread_list);
+    DoObject(p, current_thread);
+    p.Do(next_thread_id);
+
+    if (p.GetMode() == PointerWrap::MODE_READ)
+        ready_queue.clear();
+    for (u32 priority = 0; priority <= THREADPRIO_LOWEST; ++priority) {
+        std::vector<Thread*> threads(ready_queue.get_queue(priority).begin(),
+                                     ready_queue.get_queue(priority).end());
+        u32 count = static_cast<u32>(threads.size());
+        p.Do(count);
+        threads.resize(count);
+        for (auto& thread : threads) {
+            DoObject(p, thread);
+        }
+        if (p.GetMode() == PointerWrap::MODE_READ) {
+            for (Thread* thread : threads) {
+                ready_queue.push_back(priority, thread);
+            }
+        }
+    }
+
+    u32 num_addresses = static_cast<u32>(arbiter_waiters.size());
+    p.Do(num_addresses);
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        arbiter_waiters.clear();
+        for (u32 i = 0; i < num_addresses; ++i) {
+            VAddr address;
+            u32 count;
+            p.Do(address);
+            p.Do(count);
+            auto& waiters = arbiter_waiters[address];
+            waiters.resize(count);
+            for (auto& thread : waiters) {
+                DoObject(p, thread);
+            }
+        }
+    } else {
+        for (auto& entry : arbiter_waiters) {
+            VAddr address = entry.first;
+            u32 count = static_cast<u32>(entry.second.size());
+            p.Do(address);
+            p.Do(count);
+            for (auto& thread : entry.second) {
+                DoObject(p, thread);
+            }
+        }
+    }
+
+    wakeup_callback_handle_table.DoState(p);
+
+    if (p.GetMode() == PointerWrap::MODE_READ && current_thread != nullptr) {
+        Core::CPU().LoadContext(current_thread->context);
+        Core::CPU().SetCP15Register(CP15_THREAD_URO, current_thread->GetTLSAddress());
+    }
 }
 
 const std::vector<SharedPtr<Thread>>& GetThreadList() {
@@ -12,6 +12,7 @@
 #include "common/common_types.h"
 #include "core/arm/arm_interface.h"
 #include "core/core.h"
+#include "core/core_timing_queue.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/result.h"
 
@@ -73,6 +74,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     bool ShouldWait(Thread* thread) const override;
     void Acquire(Thread* thread) override;
 
@@ -204,8 +207,12 @@ public:
 
     /// Handle used as userdata to reference this object when inserting into the CoreTiming queue.
     Handle callback_handle;
+    /// Pending wakeup event scheduled by WakeAfterDelay
+    CoreTiming::EventHandle wakeup_event;
 
 private:
+    friend class ObjectRegistry;
+
     Thread();
     ~Thread() override;
 };
@@ -271,6 +278,11 @@ void ThreadingInit();
  */
 void ThreadingShutdown();
 
+/**
+ * Saves or loads the threads and the scheduler state, and the CPU context of the current thread
+ */
+void ThreadingDoState(PointerWrap& p);
+
 /**
  * Get a const reference to the thread list for debug use
  */
@@ -7,6 +7,7 @@
 #include "common/logging/log.h"
 #include "core/core_timing.h"
 #include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/thread.h"
 #include "core/hle/kernel/timer.h"
 
@@ -29,11 +30,23 @@ SharedPtr<Timer> Timer::Create(ResetType reset_type, std::string name) {
     timer->name = std::move(name);
     timer->initial_delay = 0;
     timer->interval_delay = 0;
+    timer->timer_event = CoreTiming::INVALID_EVENT_HANDLE;
     timer->callback_handle = timer_callback_handle_table.Create(timer).MoveFrom();
 
     return timer;
 }
 
+void Timer::DoState(PointerWrap& p) {
+    WaitObject::DoState(p);
+    p.Do(reset_type);
+    p.Do(signaled);
+    p.Do(name);
+    p.Do(initial_delay);
+    p.Do(interval_delay);
+    p.Do(timer_event);
+    p.Do(callback_handle);
+}
+
 bool Timer::ShouldWait(Thread* thread) const {
     return !signaled;
 }
@@ -53,12 +66,13 @@ void Timer::Set(s64 initial, s64 interval) {
     interval_delay = interval;
 
     u64 initial_microseconds = initial / 1000;
-    CoreTiming::ScheduleEvent(usToCycles(initial_microseconds), timer_callback_event_type,
-                              callback_handle);
+    timer_event = CoreTiming::ScheduleEvent(usToCycles(initial_microseconds),
+                                            timer_callback_event_type, callback_handle);
 }
 
 void Timer::Cancel() {
-    CoreTiming::UnscheduleEvent(timer_callback_event_type, callback_handle);
+    CoreTiming::UnscheduleEvent(timer_event);
+    timer_event = CoreTiming::INVALID_EVENT_HANDLE;
 }
 
 void Timer::Clear() {
@@ -92,8 +106,9 @@ static void TimerCallback(u64 timer_handle, int cycles_late) {
     if (timer->interval_delay != 0) {
         // Reschedule the timer with the interval delay
         u64 interval_microseconds = timer->interval_delay / 1000;
-        CoreTiming::ScheduleEvent(usToCycles(interval_microseconds) - cycles_late,
-                                  timer_callback_event_type, timer_handle);
+        timer->timer_event =
+            CoreTiming::ScheduleEvent(usToCycles(interval_microseconds) - cycles_late,
+                                      timer_callback_event_type, timer_handle);
     }
 }
 
@@ -104,4 +119,8 @@ void TimersInit() {
 
 void TimersShutdown() {}
 
+void TimersDoState(PointerWrap& p) {
+    timer_callback_handle_table.DoState(p);
+}
+
 } // namespace
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "common/common_types.h"
+#include "core/core_timing_queue.h"
 #include "core/hle/kernel/kernel.h"
 
 namespace Kernel {
@@ -31,6 +32,8 @@ public:
         return HANDLE_TYPE;
     }
 
+    void DoState(PointerWrap& p) override;
+
     ResetType reset_type; ///< The ResetType of this timer
 
     bool signaled;    ///< Whether the timer has been signaled or not
@@ -39,6 +42,9 @@ public:
     u64 initial_delay;  ///< The delay until the timer fires for the first time
     u64 interval_delay; ///< The delay until the timer fires after the first time
 
+    /// Pending event that fires the timer
+    CoreTiming::EventHandle timer_event;
+
     bool ShouldWait(Thread* thread) const override;
     void Acquire(Thread* thread) override;
 
@@ -55,6 +61,8 @@ public:
     void Clear();
 
 private:
+    friend class ObjectRegistry;
+
     Timer();
     ~Timer() override;
 
@@ -66,5 +74,7 @@ private:
 void TimersInit();
 /// Tears down the timer variables
 void TimersShutdown();
+/// Saves or loads the handles the timer events use to find their timer
+void TimersDoState(PointerWrap& p);
 
 } // namespace
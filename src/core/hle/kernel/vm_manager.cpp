@@ -4,6 +4,9 @@
 
 #include <iterator>
 #include "common/assert.h"
+#include "common/chunk_file.h"
+#include "common/logging/log.h"
+#include "core/hle/kernel/savestate.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
 #include "core/memory_setup.h"
@@ -190,6 +193,79 @@ void VMManager::RefreshMemoryBlockMappings(const std::vector<u8>* block) {
     }
 }
 
+void VMManager::RefreshMemoryMappings() {
+    for (const auto& p : vma_map) {
+        UpdatePageTableForVMA(p.second);
+    }
+}
+
+void VMManager::DoState(PointerWrap& p) {
+    u32 num_vmas = static_cast<u32>(vma_map.size());
+    p.Do(num_vmas);
+
+    // The current map is kept until the end, to find the host memory of the loaded mappings
+    std::vector<VirtualMemoryArea> vmas;
+    if (p.GetMode() != PointerWrap::MODE_READ) {
+        for (const auto& entry : vma_map) {
+            vmas.push_back(entry.second);
+        }
+    }
+    vmas.resize(num_vmas);
+
+    for (auto& vma : vmas) {
+        p.Do(vma.base);
+        p.Do(vma.size);
+        p.Do(vma.type);
+        p.Do(vma.permissions);
+        p.Do(vma.meminfo_state);
+
+        switch (vma.type) {
+        case VMAType::Free:
+            break;
+        case VMAType::AllocatedMemoryBlock: {
+            DoMemoryBlock(p, vma.backing_block);
+            u64 offset = vma.offset;
+            p.Do(offset);
+            vma.offset = static_cast<size_t>(offset);
+            break;
+        }
+        case VMAType::BackingMemory:
+        case VMAType::MMIO: {
+            if (vma.type == VMAType::MMIO)
+                p.Do(vma.paddr);
+
+            if (p.GetMode() == PointerWrap::MODE_READ) {
+                auto current = vma_map.upper_bound(vma.base);
+                if (current != vma_map.begin())
+                    --current;
+                if (current == vma_map.end() || current->second.type != vma.type ||
+                    vma.base + vma.size > current->second.base + current->second.size) {
+                    LOG_ERROR(Kernel, "No host memory to load the mapping at 0x%08X", vma.base);
+                    p.SetError(PointerWrap::ERROR_FAILURE);
+                    return;
+                }
+                const u32 offset = vma.base - current->second.base;
+                if (vma.type == VMAType::BackingMemory)
+                    vma.backing_memory = current->second.backing_memory + offset;
+                else
+                    vma.mmio_handler = current->second.mmio_handler;
+            }
+
+            if (vma.type == VMAType::BackingMemory)
+                p.DoVoid(vma.backing_memory, vma.size);
+            break;
+        }
+        }
+    }
+
+    if (p.GetMode() == PointerWrap::MODE_READ) {
+        vma_map.clear();
+        for (auto& vma : vmas) {
+            vma_map.emplace(vma.base, std::move(vma));
+        }
+    }
+}
+
 void VMManager::LogLayout(Log::Level log_level) const {
     for (const auto& p : vma_map) {
         const VirtualMemoryArea& vma = p.second;
@@ -11,6 +11,8 @@
 #include "core/hle/result.h"
 #include "core/mmio.h"
 
+class PointerWrap;
+
 namespace Kernel {
 
 const ResultCode ERR_INVALID_ADDRESS{// 0xE0E01BF5
@@ -189,6 +191,16 @@ public:
      */
     void RefreshMemoryBlockMappings(const std::vector<u8>* block);
 
+    /// Updates the page table range of all the VMAs, for example after the address space was loaded
+    void RefreshMemoryMappings();
+
+    /**
+     * Saves or loads the address space map. The unmanaged host memory and the MMIO handlers are
+     * mapped by the emulator itself and can't be saved, so a loaded map must find them at the same
+     * addresses in the current map.
+     */
+    void DoState(PointerWrap& p);
+
     /// Dumps the address space layout to the log, for debugging
     void LogLayout(Log::Level log_level) const;
 
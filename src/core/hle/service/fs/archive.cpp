@@ -110,13 +110,25 @@ void File::HandleSyncRequest(Kernel::SharedPtr<Kernel::ServerSession> server_ses
                       offset, length, backend->GetSize());
         }
 
-        std::vector<u8> data(length);
-        ResultVal<size_t> read = backend->Read(offset, data.size(), data.data());
+        // Read straight into the guest buffer when it is backed by contiguous host memory and a
+        // failed read can't leave it partly written, and through an intermediate buffer otherwise
+        u8* const guest_buffer = backend->ReadCanFailPartway()
+                                     ? nullptr
+                                     : Memory::GetContiguousSpan(address, length, true);
+        std::vector<u8> data;
+        if (guest_buffer == nullptr) {
+            data.resize(length);
+        }
+
+        ResultVal<size_t> read =
+            backend->Read(offset, length, guest_buffer != nullptr ? guest_buffer : data.data());
         if (read.Failed()) {
             cmd_buff[1] = read.Code().raw;
             return;
         }
-        Memory::WriteBlock(address, data.data(), *read);
+        if (guest_buffer == nullptr) {
+            Memory::WriteBlock(address, data.data(), *read);
+        }
         cmd_buff[2] = static_cast<u32>(*read);
         break;
     }
@@ -8,6 +8,7 @@
 #include "core/hle/kernel/shared_memory.h"
 #include "core/hle/result.h"
 #include "core/hw/gpu.h"
+#include "core/hw/gpu_thread.h"
 #include "core/hw/hw.h"
 #include "core/hw/lcd.h"
 #include "core/memory.h"
@@ -407,6 +408,11 @@ static void UnregisterInterruptRelayQueue(Interface* self) {
  * @todo This probably does not belong in the GSP module, instead move to video_core
  */
 void SignalInterrupt(InterruptId interrupt_id) {
+    // The interrupts of the work running on the GPU thread are signalled on the CPU thread
+    if (GPUThread::IsGPUThread()) {
+        GPUThread::DeferInterrupt(interrupt_id);
+        return;
+    }
     if (!gpu_right_acquired) {
         return;
     }
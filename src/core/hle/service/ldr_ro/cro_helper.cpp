@@ -52,6 +52,15 @@ VAddr CROHelper::SegmentTagToAddress(SegmentTag segment_tag) const {
     return entry.offset + segment_tag.offset_into_segment;
 }
 
+/**
+ * Writes a relocated word. This goes through WriteBlock so that code already translated from the
+ * word, for example when linking a module that is already running, gets invalidated.
+ */
+static void WriteRelocation(VAddr target_address, u32 value) {
+    const u32_le value_le = value;
+    Memory::WriteBlock(target_address, &value_le, sizeof(value_le));
+}
+
 ResultCode CROHelper::ApplyRelocation(VAddr target_address, RelocationType relocation_type,
                                       u32 addend, u32 symbol_address, u32 target_future_address) {
 
@@ -60,10 +69,10 @@ ResultCode CROHelper::ApplyRelocation(VAddr target_address, RelocationType reloc
         break;
     case RelocationType::AbsoluteAddress:
     case RelocationType::AbsoluteAddress2:
-        Memory::Write32(target_address, symbol_address + addend);
+        WriteRelocation(target_address, symbol_address + addend);
         break;
     case RelocationType::RelativeAddress:
-        Memory::Write32(target_address, symbol_address + addend - target_future_address);
+        WriteRelocation(target_address, symbol_address + addend - target_future_address);
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -85,7 +94,7 @@ ResultCode CROHelper::ClearRelocation(VAddr target_address, RelocationType reloc
     case RelocationType::AbsoluteAddress:
     case RelocationType::AbsoluteAddress2:
     case RelocationType::RelativeAddress:
-        Memory::Write32(target_address, 0);
+        WriteRelocation(target_address, 0);
         break;
     case RelocationType::ThumbBranch:
     case RelocationType::ArmBranch:
@@ -6,6 +6,7 @@
 #include <cstring>
 #include <numeric>
 #include <type_traits>
+#include "common/chunk_file.h"
 #include "common/color.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
@@ -15,8 +16,10 @@
 #include "common/timer.h"
 #include "common/vector_math.h"
 #include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
 #include "core/hle/service/gsp_gpu.h"
 #include "core/hw/gpu.h"
+#include "core/hw/gpu_thread.h"
 #include "core/hw/hw.h"
 #include "core/hw/y2r.h"
 #include "core/memory.h"
@@ -44,6 +47,8 @@ static u64 frame_count;
 static u32 time_point;
 /// Total delay caused by slow frames
 static float time_delay;
+/// Fence of the last buffer swap queued on the GPU thread
+static u64 swap_fence;
 
 /// Accumulated delay
 static double autoskip = 1;
@@ -428,19 +433,21 @@ inline void Write(u32 addr, const T data) {
         auto& config = g_regs.memory_fill_config[is_second_filler];
 
         if (config.trigger) {
-            MemoryFill(config);
-            LOG_TRACE(HW_GPU, "MemoryFill from 0x%08x to 0x%08x", config.GetStartAddress(),
-                      config.GetEndAddress());
-
-            // It seems that it won't signal interrupt if "address_start" is zero.
-            // TODO: hwtest this
-            if (config.GetStartAddress() != 0) {
-                if (!is_second_filler) {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
-                } else {
-                    Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+            GPUThread::RunAsynchronously([config, is_second_filler] {
+                MemoryFill(config);
+                LOG_TRACE(HW_GPU, "MemoryFill from 0x%08x to 0x%08x", config.GetStartAddress(),
+                          config.GetEndAddress());
+
+                // It seems that it won't signal interrupt if "address_start" is zero.
+                // TODO: hwtest this
+                if (config.GetStartAddress() != 0) {
+                    if (!is_second_filler) {
+                        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC0);
+                    } else {
+                        Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PSC1);
+                    }
                 }
-            }
+            });
 
             // Reset "trigger" flag and set the "finish" flag
             // NOTE: This was confirmed to happen on hardware even if "address_start" is zero.
@@ -451,35 +458,39 @@ inline void Write(u32 addr, const T data) {
     }
 
     case GPU_REG_INDEX(display_transfer_config.trigger): {
-        MICROPROFILE_SCOPE(GPU_DisplayTransfer);
-
         const auto& config = g_regs.display_transfer_config;
         if (config.trigger & 1) {
+            GPUThread::RunAsynchronously([config] {
+                MICROPROFILE_SCOPE(GPU_DisplayTransfer);
+
+                if (Pica::g_debug_context)
+                    Pica::g_debug_context->OnEvent(
+                        Pica::DebugContext::Event::IncomingDisplayTransfer, nullptr);
+
+                if (config.is_texture_copy) {
+                    TextureCopy(config);
+                    LOG_TRACE(HW_GPU, "TextureCopy: 0x%X bytes from 0x%08X(%u+%u)-> "
+                                      "0x%08X(%u+%u), flags 0x%08X",
+                              config.texture_copy.size, config.GetPhysicalInputAddress(),
+                              config.texture_copy.input_width * 16,
+                              config.texture_copy.input_gap * 16,
+                              config.GetPhysicalOutputAddress(),
+                              config.texture_copy.output_width * 16,
+                              config.texture_copy.output_gap * 16, config.flags);
+                } else {
+                    DisplayTransfer(config);
+                    LOG_TRACE(HW_GPU, "DisplayTransfer: 0x%08x(%ux%u)-> "
+                                      "0x%08x(%ux%u), dst format %x, flags 0x%08X",
+                              config.GetPhysicalInputAddress(), config.input_width.Value(),
+                              config.input_height.Value(), config.GetPhysicalOutputAddress(),
+                              config.output_width.Value(), config.output_height.Value(),
+                              config.output_format.Value(), config.flags);
+                }
 
-            if (Pica::g_debug_context)
-                Pica::g_debug_context->OnEvent(Pica::DebugContext::Event::IncomingDisplayTransfer,
-                                               nullptr);
-
-            if (config.is_texture_copy) {
-                TextureCopy(config);
-                LOG_TRACE(HW_GPU, "TextureCopy: 0x%X bytes from 0x%08X(%u+%u)-> "
-                                  "0x%08X(%u+%u), flags 0x%08X",
-                          config.texture_copy.size, config.GetPhysicalInputAddress(),
-                          config.texture_copy.input_width * 16, config.texture_copy.input_gap * 16,
-                          config.GetPhysicalOutputAddress(), config.texture_copy.output_width * 16,
-                          config.texture_copy.output_gap * 16, config.flags);
-            } else {
-                DisplayTransfer(config);
-                LOG_TRACE(HW_GPU, "DisplayTransfer: 0x%08x(%ux%u)-> "
-                                  "0x%08x(%ux%u), dst format %x, flags 0x%08X",
-                          config.GetPhysicalInputAddress(), config.input_width.Value(),
-                          config.input_height.Value(), config.GetPhysicalOutputAddress(),
-                          config.output_width.Value(), config.output_height.Value(),
-                          config.output_format.Value(), config.flags);
-            }
+                Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
+            });
 
             g_regs.display_transfer_config.trigger = 0;
-            Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PPF);
         }
         break;
     }
@@ -488,16 +499,19 @@ inline void Write(u32 addr, const T data) {
     case GPU_REG_INDEX(command_processor_config.trigger): {
         const auto& config = g_regs.command_processor_config;
         if (config.trigger & 1) {
-            MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
+            const PAddr address = config.GetPhysicalAddress();
+            const u32 size = config.size;
+            GPUThread::RunAsynchronously([address, size] {
+                MICROPROFILE_SCOPE(GPU_CmdlistProcessing);
 
-            u32* buffer = (u32*)Memory::GetPhysicalPointer(config.GetPhysicalAddress());
+                u32* buffer = (u32*)Memory::GetPhysicalPointer(address);
 
-            if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
-                Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, config.size,
-                                                                config.GetPhysicalAddress());
-            }
+                if (Pica::g_debug_context && Pica::g_debug_context->recorder) {
+                    Pica::g_debug_context->recorder->MemoryAccessed((u8*)buffer, size, address);
+                }
 
-            Pica::CommandProcessor::ProcessCommandList(buffer, config.size);
+                Pica::CommandProcessor::ProcessCommandList(buffer, size);
+            });
 
             g_regs.command_processor_config.trigger = 0;
         }
@@ -551,7 +565,18 @@ static void FrameLimiter() {
 static void VBlankCallback(u64 userdata, int cycles_late) {
 
     frame_count++;
-    VideoCore::g_renderer->SwapBuffers();
+
+    if (GPUThread::IsEnabled()) {
+        // Let the GPU thread fall at most one frame behind, and keep handling the window events on
+        // this thread, as the renderer does it on the thread it runs on.
+        GPUThread::WaitForFence(swap_fence);
+        swap_fence = GPUThread::Push([screen_config = RendererBase::GetScreenConfig()] {
+            VideoCore::g_renderer->SwapBuffers(screen_config);
+        });
+        VideoCore::g_emu_window->PollEvents();
+    } else {
+        VideoCore::g_renderer->SwapBuffers(RendererBase::GetScreenConfig());
+    }
 
     // Signal to GSP that GPU interrupt has occurred
     // TODO(yuriks): hwtest to determine if PDC0 is for the Top screen and PDC1 for the Sub
@@ -561,7 +586,8 @@ static void VBlankCallback(u64 userdata, int cycles_late) {
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC0);
     Service::GSP::SignalInterrupt(Service::GSP::InterruptId::PDC1);
 
-    if (!Settings::values.use_vsync && Settings::values.toggle_framelimit) {
+    if (!Settings::values.use_vsync && Settings::values.toggle_framelimit &&
+        !Settings::values.audio_offline_rendering) {
         FrameLimiter();
     }
 
@@ -609,6 +635,7 @@ void Init() {
     framebuffer_sub.active_fb = 0;
 
     frame_count = 0;
+    swap_fence = 0;
     autoskip = 0.0;
     time_point = Common::Timer::GetTimeMs();
 
@@ -623,4 +650,13 @@ void Shutdown() {
     LOG_DEBUG(HW_GPU, "shutdown OK");
 }
 
+void DoState(PointerWrap& p) {
+    // Let the GPU thread finish its work first, as it reads the registers
+    GPUThread::RunSynchronously([] {});
+
+    p.DoVoid(&g_regs, sizeof(g_regs));
+    p.Do(frame_count);
+    p.Do(autoskip);
+}
+
 } // namespace
@@ -11,6 +11,8 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 namespace GPU {
 
 // Returns index corresponding to the Regs member labeled by field_name
@@ -329,4 +331,7 @@ void Init();
 /// Shutdown hardware
 void Shutdown();
 
+/// Saves or loads the registers
+void DoState(PointerWrap& p);
+
 } // namespace
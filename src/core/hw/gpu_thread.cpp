@@ -0,0 +1,186 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/thread.h"
+#include "common/threadsafe_queue.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/hle/service/gsp_gpu.h"
+#include "core/hw/gpu_thread.h"
+
+namespace GPUThread {
+
+struct Work {
+    u64 fence;
+    /// CoreTiming ticks when the work was pushed, the GPU thread can't read them itself
+    s64 ticks;
+    std::function<void()> function;
+};
+
+static std::unique_ptr<std::thread> gpu_thread;
+static std::atomic<bool> enabled{false};
+static thread_local bool is_gpu_thread = false;
+
+static EmuWindow* window = nullptr;
+
+/// Work queued by the CPU thread
+static Common::SPSCQueue<Work> work_queue;
+static Common::Event work_available;
+
+/// Fence of the last work pushed, only accessed by the CPU thread
+static u64 last_fence = 0;
+/// Fence of the last work done by the GPU thread
+static std::atomic<u64> completed_fence{0};
+/// Ticks of the work running on the GPU thread, only accessed by the GPU thread
+static s64 work_ticks = 0;
+static std::mutex completed_mutex;
+static std::condition_variable completed_condvar;
+
+/// Work queued by the GPU thread for the CPU thread
+static Common::SPSCQueue<std::function<void()>> cpu_work_queue;
+/// Whether an event running the work for the CPU thread is pending
+static std::atomic<bool> cpu_work_scheduled{false};
+
+/// CoreTiming event delivering the interrupts raised on the GPU thread
+static int interrupt_event;
+/// CoreTiming event running the work queued for the CPU thread
+static int cpu_work_event;
+
+MICROPROFILE_DEFINE(GPUThread_Wait, "GPU", "Wait for GPU thread", MP_RGB(255, 128, 0));
+
+/// Runs the work queued for the CPU thread, only called by the CPU thread
+static void RunCPUWork() {
+    std::function<void()> work;
+    while (cpu_work_queue.Pop(work)) {
+        work();
+    }
+}
+
+static void CPUWorkCallback(u64 userdata, int cycles_late) {
+    // Cleared first, so that work queued while running the rest gets another event
+    cpu_work_scheduled.store(false, std::memory_order_relaxed);
+    RunCPUWork();
+}
+
+static void InterruptCallback(u64 userdata, int cycles_late) {
+    RunCPUWork();
+    Service::GSP::SignalInterrupt(static_cast<Service::GSP::InterruptId>(userdata));
+}
+
+static void RunThread() {
+    is_gpu_thread = true;
+    Common::SetCurrentThreadName("GPUThread");
+    MicroProfileOnThreadCreate("GPUThread");
+    window->MakeCurrent();
+
+    while (true) {
+        Work work;
+        while (work_queue.Pop(work)) {
+            if (work.function == nullptr) {
+                // Shutdown marker
+                window->DoneCurrent();
+                completed_fence.store(work.fence, std::memory_order_release);
+                std::lock_guard<std::mutex> lock(completed_mutex);
+                completed_condvar.notify_all();
+                return;
+            }
+
+            work_ticks = work.ticks;
+            work.function();
+
+            completed_fence.store(work.fence, std::memory_order_release);
+            std::lock_guard<std::mutex> lock(completed_mutex);
+            completed_condvar.notify_all();
+        }
+        work_available.Wait();
+    }
+}
+
+void Init(EmuWindow* emu_window) {
+    ASSERT(!IsEnabled());
+
+    interrupt_event = CoreTiming::RegisterEvent("GPUThread::Interrupt", InterruptCallback);
+    cpu_work_event = CoreTiming::RegisterEvent("GPUThread::CPUWork", CPUWorkCallback);
+
+    window = emu_window;
+    window->DoneCurrent();
+
+    last_fence = 0;
+    completed_fence = 0;
+    cpu_work_scheduled = false;
+    gpu_thread = std::make_unique<std::thread>(RunThread);
+    enabled = true;
+
+    LOG_INFO(HW_GPU, "GPU thread started");
+}
+
+void Shutdown() {
+    if (!IsEnabled())
+        return;
+
+    // An empty function tells the thread to stop once it ran everything before it
+    WaitForFence(Push(nullptr));
+    gpu_thread->join();
+    gpu_thread.reset();
+    enabled = false;
+
+    window->MakeCurrent();
+    window = nullptr;
+
+    LOG_INFO(HW_GPU, "GPU thread stopped");
+}
+
+bool IsEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+bool IsGPUThread() {
+    return is_gpu_thread;
+}
+
+u64 Push(std::function<void()> work) {
+    DEBUG_ASSERT(!IsGPUThread());
+
+    const u64 fence = ++last_fence;
+    work_queue.Push({fence, static_cast<s64>(CoreTiming::GetTicks()), std::move(work)});
+    work_available.Set();
+    return fence;
+}
+
+void WaitForFence(u64 fence) {
+    if (completed_fence.load(std::memory_order_acquire) < fence) {
+        MICROPROFILE_SCOPE(GPUThread_Wait);
+        std::unique_lock<std::mutex> lock(completed_mutex);
+        completed_condvar.wait(
+            lock, [fence] { return completed_fence.load(std::memory_order_acquire) >= fence; });
+    }
+
+    // The caller may rely on what the waited for work changed, like the rasterizer cached pages
+    RunCPUWork();
+}
+
+void QueueCPUWork(std::function<void()> work) {
+    DEBUG_ASSERT(IsGPUThread());
+
+    cpu_work_queue.Push(std::move(work));
+    if (!cpu_work_scheduled.exchange(true, std::memory_order_relaxed))
+        CoreTiming::ScheduleEventAt_Threadsafe(work_ticks, cpu_work_event);
+}
+
+void DeferInterrupt(Service::GSP::InterruptId interrupt_id) {
+    DEBUG_ASSERT(IsGPUThread());
+
+    CoreTiming::ScheduleEventAt_Threadsafe(work_ticks, interrupt_event,
+                                           static_cast<u64>(interrupt_id));
+}
+
+} // namespace GPUThread
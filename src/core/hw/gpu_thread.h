@@ -0,0 +1,103 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <utility>
+#include "common/common_types.h"
+
+class EmuWindow;
+
+namespace Service {
+namespace GSP {
+enum class InterruptId : u8;
+}
+}
+
+/**
+ * Optional dedicated thread running the GPU work (command lists, memory fills, display transfers
+ * and buffer swaps) decoupled from the emulated CPU. The CPU thread queues the work and only waits
+ * for it when it reads memory owned by the GPU, through the rasterizer flush hooks. Interrupts
+ * raised by the GPU work and the changes it makes to the page table are handed back to the CPU
+ * thread.
+ *
+ * When the GPU thread isn't running, all the work runs synchronously on the calling thread.
+ */
+namespace GPUThread {
+
+/**
+ * Starts the GPU thread. The rendering context is released by the calling thread and made current
+ * on the GPU thread.
+ */
+void Init(EmuWindow* emu_window);
+
+/// Runs the queued work, stops the GPU thread and makes the rendering context current again
+void Shutdown();
+
+/// Returns whether the GPU thread is running
+bool IsEnabled();
+
+/// Returns whether the caller runs on the GPU thread
+bool IsGPUThread();
+
+/**
+ * Queues work to run on the GPU thread.
+ * @returns The fence of the work, to wait for with WaitForFence
+ */
+u64 Push(std::function<void()> work);
+
+/// Waits until the GPU thread ran the work with the given fence and all the work queued before it
+void WaitForFence(u64 fence);
+
+/**
+ * Runs work on the GPU thread without waiting for it, or directly if the GPU thread isn't running.
+ * @returns The fence of the work, or 0 if it already ran
+ */
+template <typename Work>
+u64 RunAsynchronously(Work&& work) {
+    if (!IsEnabled()) {
+        work();
+        return 0;
+    }
+    return Push(std::forward<Work>(work));
+}
+
+/**
+ * Runs work on the GPU thread after the work queued before it, and waits for it. Runs it directly
+ * if the GPU thread isn't running or if called from the GPU thread.
+ */
+template <typename Work>
+void RunSynchronously(Work&& work) {
+    if (!IsEnabled() || IsGPUThread()) {
+        work();
+        return;
+    }
+    WaitForFence(Push(std::forward<Work>(work)));
+}
+
+/// Queues work of the GPU thread to run on the CPU thread, used through RunOnCPUThread
+void QueueCPUWork(std::function<void()> work);
+
+/**
+ * Runs work that changes state owned by the CPU thread, like the page table. When called from the
+ * GPU thread, the CPU thread runs it the next time it waits for the GPU thread, or from a
+ * CoreTiming event, in the order it was queued. Runs it directly otherwise.
+ */
+template <typename Work>
+void RunOnCPUThread(Work&& work) {
+    if (!IsGPUThread()) {
+        work();
+        return;
+    }
+    QueueCPUWork(std::forward<Work>(work));
+}
+
+/**
+ * Delivers an interrupt raised on the GPU thread to the CPU thread, after the work queued for the
+ * CPU thread before it
+ */
+void DeferInterrupt(Service::GSP::InterruptId interrupt_id);
+
+} // namespace GPUThread
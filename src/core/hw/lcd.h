@@ -10,6 +10,8 @@
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 
+class PointerWrap;
+
 #define LCD_REG_INDEX(field_name) (offsetof(LCD::Regs, field_name) / sizeof(u32))
 
 namespace LCD {
@@ -83,4 +85,7 @@ void Init();
 /// Shutdown hardware
 void Shutdown();
 
+/// Saves or loads the registers
+void DoState(PointerWrap& p);
+
 } // namespace
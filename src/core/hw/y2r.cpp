@@ -6,6 +6,7 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <vector>
 #include "common/assert.h"
 #include "common/color.h"
 #include "common/common_types.h"
@@ -84,11 +85,23 @@ static void ConvertYUVToRGB(InputFormat input_format, const u8* input_Y, const u
 /// formats to 8-bit.
 template <size_t N>
 static void ReceiveData(u8* output, ConversionBuffer& buf, size_t amount_of_data) {
-    const u8* input = Memory::GetPointer(buf.address);
-
     size_t output_unit = buf.transfer_unit / N;
     ASSERT(amount_of_data % output_unit == 0);
 
+    const size_t num_units = amount_of_data / output_unit;
+    if (num_units == 0)
+        return;
+
+    // Read the input in place if possible, otherwise copy it out of guest memory first
+    const size_t input_size = (num_units - 1) * (buf.transfer_unit + buf.gap) + buf.transfer_unit;
+    const u8* input = Memory::GetContiguousSpan(buf.address, input_size, false);
+    std::vector<u8> input_copy;
+    if (input == nullptr) {
+        input_copy.resize(input_size);
+        Memory::ReadBlock(buf.address, input_copy.data(), input_size);
+        input = input_copy.data();
+    }
+
     while (amount_of_data > 0) {
         for (size_t i = 0; i < output_unit; ++i) {
             output[i] = input[i * N];
@@ -3,12 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
 #include <cstring>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
 #include "core/hle/kernel/process.h"
+#include "core/hw/gpu_thread.h"
 #include "core/memory.h"
 #include "core/memory_setup.h"
 #include "core/mmio.h"
@@ -68,15 +72,55 @@ struct PageTable {
      * flushed before the memory is accessed
      */
     std::array<u8, PAGE_TABLE_NUM_ENTRIES> cached_res_count;
+
+    /**
+     * Set for the pages the CPU has translated code from. Writing to these pages or remapping them
+     * invalidates the translated code.
+     */
+    std::array<bool, PAGE_TABLE_NUM_ENTRIES> code_pages;
+
+    /**
+     * Same as `pointers`, except that it is null for code pages. Used by the write fast path and
+     * the inline memory accesses of the JIT, so that writes to code pages take the slow path.
+     */
+    std::array<u8*, PAGE_TABLE_NUM_ENTRIES> write_pointers;
 };
 
 /// Singular page table used for the singleton process
 static PageTable main_page_table;
 /// Currently active page table
 static PageTable* current_page_table = &main_page_table;
+/// Slow path counters of the memory accesses. The GPU thread accesses memory too, so they are
+/// atomic. Relaxed increments suffice, since they are only read for statistics.
+static struct {
+    std::atomic<u64> unmapped{0};
+    std::atomic<u64> special{0};
+    std::atomic<u64> rasterizer_cached_memory{0};
+    std::atomic<u64> rasterizer_cached_special{0};
+    std::atomic<u64> released_cached_pages{0};
+    std::atomic<u64> code_invalidations{0};
+    std::atomic<u64> jit_code_page_reads{0};
+} access_stats;
+
+static void Count(std::atomic<u64>& counter) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+}
 
 std::array<u8*, PAGE_TABLE_NUM_ENTRIES>* GetCurrentPageTablePointers() {
-    return &current_page_table->pointers;
+    return &current_page_table->write_pointers;
+}
+
+static void UpdateWritePointer(u32 page) {
+    current_page_table->write_pointers[page] =
+        current_page_table->code_pages[page] ? nullptr : current_page_table->pointers[page];
+}
+
+static void InvalidateCode(VAddr start, u32 size) {
+    Count(access_stats.code_invalidations);
+    // The CPU core doesn't exist yet while the initial process is mapped
+    if (Core::System::GetInstance().IsPoweredOn()) {
+        Core::CPU().InvalidateCacheRange(start, size);
+    }
 }
 
 static void MapPages(u32 base, u32 size, u8* memory, PageType type) {
@@ -84,10 +128,25 @@ static void MapPages(u32 base, u32 size, u8* memory, PageType type) {
               (base + size) * PAGE_SIZE);
 
     u32 end = base + size;
+    // First page of the current run of remapped code pages, `end` if there is none
+    u32 code_run_begin = end;
 
     while (base != end) {
         ASSERT_MSG(base < PAGE_TABLE_NUM_ENTRIES, "out of range mapping at %08X", base);
 
+        // Code translated from a page stays valid if the page is mapped to the same memory again,
+        // which happens when the VMAs around it are split, merged or reprotected
+        const bool remapped = current_page_table->attributes[base] != type ||
+                              current_page_table->pointers[base] != memory;
+        if (remapped && current_page_table->code_pages[base]) {
+            current_page_table->code_pages[base] = false;
+            if (code_run_begin == end)
+                code_run_begin = base;
+        } else if (code_run_begin != end) {
+            InvalidateCode(code_run_begin << PAGE_BITS, (base - code_run_begin) << PAGE_BITS);
+            code_run_begin = end;
+        }
+
         // Since pages are unmapped on shutdown after video core is shutdown, the renderer may be
         // null here
         if (current_page_table->attributes[base] == PageType::RasterizerCachedMemory ||
@@ -99,17 +158,30 @@ static void MapPages(u32 base, u32 size, u8* memory, PageType type) {
         current_page_table->attributes[base] = type;
         current_page_table->pointers[base] = memory;
         current_page_table->cached_res_count[base] = 0;
+        UpdateWritePointer(base);
 
         base += 1;
         if (memory != nullptr)
             memory += PAGE_SIZE;
     }
+
+    if (code_run_begin != end) {
+        InvalidateCode(code_run_begin << PAGE_BITS, (end - code_run_begin) << PAGE_BITS);
+    }
 }
 
 void InitMemoryMap() {
     main_page_table.pointers.fill(nullptr);
     main_page_table.attributes.fill(PageType::Unmapped);
     main_page_table.cached_res_count.fill(0);
+    main_page_table.code_pages.fill(false);
+    main_page_table.write_pointers.fill(nullptr);
+    for (auto* counter :
+         {&access_stats.unmapped, &access_stats.special, &access_stats.rasterizer_cached_memory,
+          &access_stats.rasterizer_cached_special, &access_stats.released_cached_pages,
+          &access_stats.code_invalidations, &access_stats.jit_code_page_reads}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
 }
 
 void MapMemoryRegion(VAddr base, u32 size, u8* target) {
@@ -167,6 +239,108 @@ static MMIORegionPointer GetMMIOHandler(VAddr vaddr) {
     return nullptr; // Should never happen
 }
 
+AccessStats GetAccessStats() {
+    AccessStats stats;
+    stats.unmapped = access_stats.unmapped.load(std::memory_order_relaxed);
+    stats.special = access_stats.special.load(std::memory_order_relaxed);
+    stats.rasterizer_cached_memory =
+        access_stats.rasterizer_cached_memory.load(std::memory_order_relaxed);
+    stats.rasterizer_cached_special =
+        access_stats.rasterizer_cached_special.load(std::memory_order_relaxed);
+    stats.released_cached_pages =
+        access_stats.released_cached_pages.load(std::memory_order_relaxed);
+    stats.code_invalidations = access_stats.code_invalidations.load(std::memory_order_relaxed);
+    stats.jit_code_page_reads = access_stats.jit_code_page_reads.load(std::memory_order_relaxed);
+    return stats;
+}
+
+/**
+ * Flushes and invalidates the rasterizer resources touching the whole page of a CPU access to a
+ * rasterizer cached page. Once no cached resource touches the page anymore, it goes back to the
+ * fast path until the rasterizer caches it again, instead of flushing the few accessed bytes on
+ * every access. Flushing before invalidating also keeps the data the GPU rendered to the page.
+ *
+ * This trades GPU work for CPU work: even the first read of a page writes back and drops every
+ * surface overlapping it, whole surfaces rather than the page, so the next draw using one of them
+ * loads it from memory again. That is cheaper than a flush per access for the CPU reading back a
+ * render target or patching a texture, but costs an extra upload for a surface the CPU only peeks
+ * at between draws.
+ */
+static void ReleaseRasterizerCachedPage(VAddr vaddr) {
+    RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(vaddr & ~PAGE_MASK), PAGE_SIZE);
+
+    if (current_page_table->cached_res_count[vaddr >> PAGE_BITS] == 0) {
+        Count(access_stats.released_cached_pages);
+    }
+}
+
+/// Returns the host memory backing a page, for `Memory` and `RasterizerCachedMemory` pages
+static u8* GetPageHostPointer(PageType type, VAddr page_vaddr) {
+    switch (type) {
+    case PageType::Memory:
+        return current_page_table->pointers[page_vaddr >> PAGE_BITS];
+    case PageType::RasterizerCachedMemory:
+        return GetPointerFromVMA(page_vaddr);
+    default:
+        return nullptr;
+    }
+}
+
+/**
+ * Consecutive pages of the same type that a block operation handles at once. The host memory
+ * backing a run of `Memory` or `RasterizerCachedMemory` pages is contiguous, and a run of `Special`
+ * or `RasterizerCachedSpecial` pages is backed by a single MMIO handler.
+ */
+struct PageRun {
+    PageType type;
+    size_t size;
+    /// Host memory backing the start of the run, for `Memory` and `RasterizerCachedMemory` pages
+    u8* pointer;
+};
+
+/// Returns the run of pages starting at the given address, at most `max_size` bytes long
+static PageRun GetPageRun(VAddr vaddr, size_t max_size) {
+    size_t page_index = vaddr >> PAGE_BITS;
+    const PageType type = current_page_table->attributes[page_index];
+    const size_t page_offset = vaddr & PAGE_MASK;
+
+    PageRun run{type, std::min<size_t>(PAGE_SIZE - page_offset, max_size), nullptr};
+    u8* page_pointer = GetPageHostPointer(type, vaddr & ~PAGE_MASK);
+    if (page_pointer != nullptr)
+        run.pointer = page_pointer + page_offset;
+
+    MMIORegionPointer mmio_handler;
+    if (type == PageType::Special || type == PageType::RasterizerCachedSpecial)
+        mmio_handler = GetMMIOHandler(vaddr);
+
+    while (run.size < max_size && ++page_index < PAGE_TABLE_NUM_ENTRIES) {
+        if (current_page_table->attributes[page_index] != type)
+            break;
+
+        const VAddr page_vaddr = static_cast<VAddr>(page_index << PAGE_BITS);
+        if (run.pointer != nullptr &&
+            GetPageHostPointer(type, page_vaddr) != run.pointer + run.size)
+            break;
+        if (mmio_handler != nullptr && GetMMIOHandler(page_vaddr) != mmio_handler)
+            break;
+
+        run.size += std::min<size_t>(PAGE_SIZE, max_size - run.size);
+    }
+
+    return run;
+}
+
+/// Invalidates the code translated from a written range, if any of its pages contain code
+static void WatchCodeWrite(VAddr vaddr, size_t size) {
+    const size_t last_page = (vaddr + size - 1) >> PAGE_BITS;
+    for (size_t page = vaddr >> PAGE_BITS; page <= last_page; ++page) {
+        if (current_page_table->code_pages[page]) {
+            InvalidateCode(vaddr, static_cast<u32>(size));
+            return;
+        }
+    }
+}
+
 template <typename T>
 T ReadMMIO(MMIORegionPointer mmio_handler, VAddr addr);
 
@@ -183,22 +357,26 @@ T Read(const VAddr vaddr) {
     PageType type = current_page_table->attributes[vaddr >> PAGE_BITS];
     switch (type) {
     case PageType::Unmapped:
+        Count(access_stats.unmapped);
         LOG_ERROR(HW_Memory, "unmapped Read%lu @ 0x%08X", sizeof(T) * 8, vaddr);
         return 0;
     case PageType::Memory:
         ASSERT_MSG(false, "Mapped memory page without a pointer @ %08X", vaddr);
         break;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushRegion(VirtualToPhysicalAddress(vaddr), sizeof(T));
+        Count(access_stats.rasterizer_cached_memory);
+        ReleaseRasterizerCachedPage(vaddr);
 
         T value;
         std::memcpy(&value, GetPointerFromVMA(vaddr), sizeof(T));
         return value;
     }
     case PageType::Special:
+        Count(access_stats.special);
         return ReadMMIO<T>(GetMMIOHandler(vaddr), vaddr);
     case PageType::RasterizerCachedSpecial: {
-        RasterizerFlushRegion(VirtualToPhysicalAddress(vaddr), sizeof(T));
+        Count(access_stats.rasterizer_cached_special);
+        ReleaseRasterizerCachedPage(vaddr);
 
         return ReadMMIO<T>(GetMMIOHandler(vaddr), vaddr);
     }
@@ -212,7 +390,7 @@ void WriteMMIO(MMIORegionPointer mmio_handler, VAddr addr, const T data);
 
 template <typename T>
 void Write(const VAddr vaddr, const T data) {
-    u8* page_pointer = current_page_table->pointers[vaddr >> PAGE_BITS];
+    u8* page_pointer = current_page_table->write_pointers[vaddr >> PAGE_BITS];
     if (page_pointer) {
         // NOTE: Avoid adding any extra logic to this fast-path block
         std::memcpy(&page_pointer[vaddr & PAGE_MASK], &data, sizeof(T));
@@ -222,23 +400,32 @@ void Write(const VAddr vaddr, const T data) {
     PageType type = current_page_table->attributes[vaddr >> PAGE_BITS];
     switch (type) {
     case PageType::Unmapped:
+        Count(access_stats.unmapped);
         LOG_ERROR(HW_Memory, "unmapped Write%lu 0x%08X @ 0x%08X", sizeof(data) * 8, (u32)data,
                   vaddr);
         return;
     case PageType::Memory:
-        ASSERT_MSG(false, "Mapped memory page without a pointer @ %08X", vaddr);
+        // Only pages with translated code are left out of the write fast path
+        ASSERT_MSG(current_page_table->code_pages[vaddr >> PAGE_BITS],
+                   "Mapped memory page without a pointer @ %08X", vaddr);
+        std::memcpy(&current_page_table->pointers[vaddr >> PAGE_BITS][vaddr & PAGE_MASK], &data,
+                    sizeof(T));
+        InvalidateCode(vaddr, sizeof(T));
         break;
     case PageType::RasterizerCachedMemory: {
-        RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(vaddr), sizeof(T));
+        Count(access_stats.rasterizer_cached_memory);
+        ReleaseRasterizerCachedPage(vaddr);
 
         std::memcpy(GetPointerFromVMA(vaddr), &data, sizeof(T));
         break;
     }
     case PageType::Special:
+        Count(access_stats.special);
         WriteMMIO<T>(GetMMIOHandler(vaddr), vaddr, data);
         break;
     case PageType::RasterizerCachedSpecial: {
-        RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(vaddr), sizeof(T));
+        Count(access_stats.rasterizer_cached_special);
+        ReleaseRasterizerCachedPage(vaddr);
 
         WriteMMIO<T>(GetMMIOHandler(vaddr), vaddr, data);
         break;
@@ -285,6 +472,17 @@ u8* GetPointer(const VAddr vaddr) {
     return nullptr;
 }
 
+void MarkRegionAsCode(VAddr start, u32 size) {
+    if (size == 0)
+        return;
+
+    const u32 last_page = static_cast<u32>((static_cast<u64>(start) + size - 1) >> PAGE_BITS);
+    for (u32 page = start >> PAGE_BITS; page <= last_page; ++page) {
+        current_page_table->code_pages[page] = true;
+        current_page_table->write_pointers[page] = nullptr;
+    }
+}
+
 std::string ReadCString(VAddr vaddr, std::size_t max_length) {
     std::string string;
     string.reserve(max_length);
@@ -304,11 +502,7 @@ u8* GetPhysicalPointer(PAddr address) {
     return GetPointer(PhysicalToVirtualAddress(address));
 }
 
-void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
-    if (start == 0) {
-        return;
-    }
-
+static void MarkRegionCached(PAddr start, u32 size, int count_delta) {
     u32 num_pages = ((start + size - 1) >> PAGE_BITS) - (start >> PAGE_BITS) + 1;
     PAddr paddr = start;
 
@@ -326,6 +520,7 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
             case PageType::Memory:
                 page_type = PageType::RasterizerCachedMemory;
                 current_page_table->pointers[vaddr >> PAGE_BITS] = nullptr;
+                current_page_table->write_pointers[vaddr >> PAGE_BITS] = nullptr;
                 break;
             case PageType::Special:
                 page_type = PageType::RasterizerCachedSpecial;
@@ -345,6 +540,7 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
                 page_type = PageType::Memory;
                 current_page_table->pointers[vaddr >> PAGE_BITS] =
                     GetPointerFromVMA(vaddr & ~PAGE_MASK);
+                UpdateWritePointer(vaddr >> PAGE_BITS);
                 break;
             case PageType::RasterizerCachedSpecial:
                 page_type = PageType::Special;
@@ -357,15 +553,31 @@ void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
     }
 }
 
+void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta) {
+    if (start == 0) {
+        return;
+    }
+
+    // The page table belongs to the CPU thread, which the GPU thread hands the update to
+    GPUThread::RunOnCPUThread(
+        [start, size, count_delta] { MarkRegionCached(start, size, count_delta); });
+}
+
+// The rasterizer resources are owned by the GPU thread when it runs, so the CPU thread waits for it
+// to flush them, after the work queued before.
+
 void RasterizerFlushRegion(PAddr start, u32 size) {
     if (VideoCore::g_renderer != nullptr) {
-        VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size);
+        GPUThread::RunSynchronously(
+            [start, size] { VideoCore::g_renderer->Rasterizer()->FlushRegion(start, size); });
     }
 }
 
 void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size) {
     if (VideoCore::g_renderer != nullptr) {
-        VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
+        GPUThread::RunSynchronously([start, size] {
+            VideoCore::g_renderer->Rasterizer()->FlushAndInvalidateRegion(start, size);
+        });
     }
 }
 
@@ -385,57 +597,81 @@ u64 Read64(const VAddr addr) {
     return Read<u64_le>(addr);
 }
 
+template <typename T>
+static T JitRead(const VAddr vaddr) {
+    // The JIT's page table has no pointer for code pages, so their reads miss its inline fast path
+    if (current_page_table->code_pages[vaddr >> PAGE_BITS]) {
+        Count(access_stats.jit_code_page_reads);
+    }
+    return Read<T>(vaddr);
+}
+
+u8 JitRead8(const VAddr addr) {
+    return JitRead<u8>(addr);
+}
+
+u16 JitRead16(const VAddr addr) {
+    return JitRead<u16_le>(addr);
+}
+
+u32 JitRead32(const VAddr addr) {
+    return JitRead<u32_le>(addr);
+}
+
+u64 JitRead64(const VAddr addr) {
+    return JitRead<u64_le>(addr);
+}
+
 void ReadBlock(const VAddr src_addr, void* dest_buffer, const size_t size) {
     size_t remaining_size = size;
-    size_t page_index = src_addr >> PAGE_BITS;
-    size_t page_offset = src_addr & PAGE_MASK;
+    VAddr current_vaddr = src_addr;
+    u8* dest = static_cast<u8*>(dest_buffer);
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
+        const PageRun run = GetPageRun(current_vaddr, remaining_size);
 
-        switch (current_page_table->attributes[page_index]) {
+        switch (run.type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory, "unmapped ReadBlock @ 0x%08X (start address = 0x%08X, size = %zu)",
                       current_vaddr, src_addr, size);
-            std::memset(dest_buffer, 0, copy_amount);
+            std::memset(dest, 0, run.size);
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(current_page_table->pointers[page_index]);
+            DEBUG_ASSERT(run.pointer);
 
-            const u8* src_ptr = current_page_table->pointers[page_index] + page_offset;
-            std::memcpy(dest_buffer, src_ptr, copy_amount);
+            std::memcpy(dest, run.pointer, run.size);
             break;
         }
         case PageType::Special: {
             DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
 
-            GetMMIOHandler(current_vaddr)->ReadBlock(current_vaddr, dest_buffer, copy_amount);
+            GetMMIOHandler(current_vaddr)->ReadBlock(current_vaddr, dest, run.size);
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr), copy_amount);
+            RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr),
+                                  static_cast<u32>(run.size));
 
-            std::memcpy(dest_buffer, GetPointerFromVMA(current_vaddr), copy_amount);
+            std::memcpy(dest, run.pointer, run.size);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
             DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
 
-            RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr), copy_amount);
+            RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr),
+                                  static_cast<u32>(run.size));
 
-            GetMMIOHandler(current_vaddr)->ReadBlock(current_vaddr, dest_buffer, copy_amount);
+            GetMMIOHandler(current_vaddr)->ReadBlock(current_vaddr, dest, run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-        remaining_size -= copy_amount;
+        current_vaddr += static_cast<VAddr>(run.size);
+        dest += run.size;
+        remaining_size -= run.size;
     }
 }
 
@@ -457,14 +693,13 @@ void Write64(const VAddr addr, const u64 data) {
 
 void WriteBlock(const VAddr dest_addr, const void* src_buffer, const size_t size) {
     size_t remaining_size = size;
-    size_t page_index = dest_addr >> PAGE_BITS;
-    size_t page_offset = dest_addr & PAGE_MASK;
+    VAddr current_vaddr = dest_addr;
+    const u8* src = static_cast<const u8*>(src_buffer);
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
+        const PageRun run = GetPageRun(current_vaddr, remaining_size);
 
-        switch (current_page_table->attributes[page_index]) {
+        switch (run.type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory,
                       "unmapped WriteBlock @ 0x%08X (start address = 0x%08X, size = %zu)",
@@ -472,144 +707,150 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, const size_t size
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(current_page_table->pointers[page_index]);
+            DEBUG_ASSERT(run.pointer);
 
-            u8* dest_ptr = current_page_table->pointers[page_index] + page_offset;
-            std::memcpy(dest_ptr, src_buffer, copy_amount);
+            // CopyBlock passes runs of guest memory, which may overlap the destination
+            std::memmove(run.pointer, src, run.size);
             break;
         }
         case PageType::Special: {
             DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
 
-            GetMMIOHandler(current_vaddr)->WriteBlock(current_vaddr, src_buffer, copy_amount);
+            GetMMIOHandler(current_vaddr)->WriteBlock(current_vaddr, src, run.size);
             break;
         }
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(current_vaddr),
-                                               copy_amount);
+                                               static_cast<u32>(run.size));
 
-            std::memcpy(GetPointerFromVMA(current_vaddr), src_buffer, copy_amount);
+            std::memmove(run.pointer, src, run.size);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
             DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
 
             RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(current_vaddr),
-                                               copy_amount);
+                                               static_cast<u32>(run.size));
 
-            GetMMIOHandler(current_vaddr)->WriteBlock(current_vaddr, src_buffer, copy_amount);
+            GetMMIOHandler(current_vaddr)->WriteBlock(current_vaddr, src, run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-        remaining_size -= copy_amount;
+        WatchCodeWrite(current_vaddr, run.size);
+
+        current_vaddr += static_cast<VAddr>(run.size);
+        src += run.size;
+        remaining_size -= run.size;
+    }
+}
+
+/// Writes zeros to a range of MMIO pages, a page at a time
+static void ZeroMMIO(VAddr vaddr, size_t size) {
+    static const std::array<u8, PAGE_SIZE> zeros = {};
+
+    MMIORegionPointer handler = GetMMIOHandler(vaddr);
+    DEBUG_ASSERT(handler);
+    while (size > 0) {
+        const size_t write_amount = std::min<size_t>(PAGE_SIZE, size);
+        handler->WriteBlock(vaddr, zeros.data(), write_amount);
+        vaddr += static_cast<VAddr>(write_amount);
+        size -= write_amount;
     }
 }
 
 void ZeroBlock(const VAddr dest_addr, const size_t size) {
     size_t remaining_size = size;
-    size_t page_index = dest_addr >> PAGE_BITS;
-    size_t page_offset = dest_addr & PAGE_MASK;
-
-    static const std::array<u8, PAGE_SIZE> zeros = {};
+    VAddr current_vaddr = dest_addr;
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
+        const PageRun run = GetPageRun(current_vaddr, remaining_size);
 
-        switch (current_page_table->attributes[page_index]) {
+        switch (run.type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory, "unmapped ZeroBlock @ 0x%08X (start address = 0x%08X, size = %zu)",
                       current_vaddr, dest_addr, size);
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(current_page_table->pointers[page_index]);
+            DEBUG_ASSERT(run.pointer);
 
-            u8* dest_ptr = current_page_table->pointers[page_index] + page_offset;
-            std::memset(dest_ptr, 0, copy_amount);
+            std::memset(run.pointer, 0, run.size);
             break;
         }
         case PageType::Special: {
-            DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
-
-            GetMMIOHandler(current_vaddr)->WriteBlock(current_vaddr, zeros.data(), copy_amount);
+            ZeroMMIO(current_vaddr, run.size);
             break;
         }
         case PageType::RasterizerCachedMemory: {
             RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(current_vaddr),
-                                               copy_amount);
+                                               static_cast<u32>(run.size));
 
-            std::memset(GetPointerFromVMA(current_vaddr), 0, copy_amount);
+            std::memset(run.pointer, 0, run.size);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
-            DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
-
             RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(current_vaddr),
-                                               copy_amount);
+                                               static_cast<u32>(run.size));
 
-            GetMMIOHandler(current_vaddr)->WriteBlock(current_vaddr, zeros.data(), copy_amount);
+            ZeroMMIO(current_vaddr, run.size);
             break;
         }
         default:
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        remaining_size -= copy_amount;
+        WatchCodeWrite(current_vaddr, run.size);
+
+        current_vaddr += static_cast<VAddr>(run.size);
+        remaining_size -= run.size;
     }
 }
 
 void CopyBlock(VAddr dest_addr, VAddr src_addr, const size_t size) {
     size_t remaining_size = size;
-    size_t page_index = src_addr >> PAGE_BITS;
-    size_t page_offset = src_addr & PAGE_MASK;
 
     while (remaining_size > 0) {
-        const size_t copy_amount = std::min(PAGE_SIZE - page_offset, remaining_size);
-        const VAddr current_vaddr = (page_index << PAGE_BITS) + page_offset;
+        // Each run of the source is written with a single WriteBlock, which coalesces the
+        // destination the same way
+        const PageRun run = GetPageRun(src_addr, remaining_size);
 
-        switch (current_page_table->attributes[page_index]) {
+        switch (run.type) {
         case PageType::Unmapped: {
             LOG_ERROR(HW_Memory, "unmapped CopyBlock @ 0x%08X (start address = 0x%08X, size = %zu)",
-                      current_vaddr, src_addr, size);
-            ZeroBlock(dest_addr, copy_amount);
+                      src_addr, src_addr, size);
+            ZeroBlock(dest_addr, run.size);
             break;
         }
         case PageType::Memory: {
-            DEBUG_ASSERT(current_page_table->pointers[page_index]);
-            const u8* src_ptr = current_page_table->pointers[page_index] + page_offset;
-            WriteBlock(dest_addr, src_ptr, copy_amount);
+            DEBUG_ASSERT(run.pointer);
+
+            WriteBlock(dest_addr, run.pointer, run.size);
             break;
         }
         case PageType::Special: {
-            DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
+            DEBUG_ASSERT(GetMMIOHandler(src_addr));
 
-            std::vector<u8> buffer(copy_amount);
-            GetMMIOHandler(current_vaddr)->ReadBlock(current_vaddr, buffer.data(), buffer.size());
+            std::vector<u8> buffer(run.size);
+            GetMMIOHandler(src_addr)->ReadBlock(src_addr, buffer.data(), buffer.size());
             WriteBlock(dest_addr, buffer.data(), buffer.size());
             break;
         }
         case PageType::RasterizerCachedMemory: {
-            RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr), copy_amount);
+            RasterizerFlushRegion(VirtualToPhysicalAddress(src_addr), static_cast<u32>(run.size));
 
-            WriteBlock(dest_addr, GetPointerFromVMA(current_vaddr), copy_amount);
+            WriteBlock(dest_addr, run.pointer, run.size);
             break;
         }
         case PageType::RasterizerCachedSpecial: {
-            DEBUG_ASSERT(GetMMIOHandler(current_vaddr));
+            DEBUG_ASSERT(GetMMIOHandler(src_addr));
 
-            RasterizerFlushRegion(VirtualToPhysicalAddress(current_vaddr), copy_amount);
+            RasterizerFlushRegion(VirtualToPhysicalAddress(src_addr), static_cast<u32>(run.size));
 
-            std::vector<u8> buffer(copy_amount);
-            GetMMIOHandler(current_vaddr)->ReadBlock(current_vaddr, buffer.data(), buffer.size());
+            std::vector<u8> buffer(run.size);
+            GetMMIOHandler(src_addr)->ReadBlock(src_addr, buffer.data(), buffer.size());
             WriteBlock(dest_addr, buffer.data(), buffer.size());
             break;
         }
@@ -617,14 +858,37 @@ void CopyBlock(VAddr dest_addr, VAddr src_addr, const size_t size) {
             UNREACHABLE();
         }
 
-        page_index++;
-        page_offset = 0;
-        dest_addr += copy_amount;
-        src_addr += copy_amount;
-        remaining_size -= copy_amount;
+        dest_addr += static_cast<VAddr>(run.size);
+        src_addr += static_cast<VAddr>(run.size);
+        remaining_size -= run.size;
     }
 }
 
+u8* GetContiguousSpan(VAddr vaddr, size_t size, bool for_writing) {
+    if (size == 0)
+        return nullptr;
+
+    const PageRun run = GetPageRun(vaddr, size);
+    if (run.size != size ||
+        (run.type != PageType::Memory && run.type != PageType::RasterizerCachedMemory)) {
+        return nullptr;
+    }
+
+    if (run.type == PageType::RasterizerCachedMemory) {
+        if (for_writing) {
+            RasterizerFlushAndInvalidateRegion(VirtualToPhysicalAddress(vaddr),
+                                               static_cast<u32>(size));
+        } else {
+            RasterizerFlushRegion(VirtualToPhysicalAddress(vaddr), static_cast<u32>(size));
+        }
+    }
+    if (for_writing) {
+        WatchCodeWrite(vaddr, size);
+    }
+
+    return run.pointer;
+}
+
 template <>
 u8 ReadMMIO<u8>(MMIORegionPointer mmio_handler, VAddr addr) {
     return mmio_handler->Read8(addr);
@@ -113,6 +113,23 @@ enum : VAddr {
     NEW_LINEAR_HEAP_VADDR_END = NEW_LINEAR_HEAP_VADDR + NEW_LINEAR_HEAP_SIZE,
 };
 
+/// Counters of the CPU memory accesses that missed the page table fast path, per page type
+struct AccessStats {
+    u64 unmapped;
+    u64 special;
+    u64 rasterizer_cached_memory;
+    u64 rasterizer_cached_special;
+    /// Number of rasterizer cached pages a CPU access returned to the fast path
+    u64 released_cached_pages;
+    /// Number of writes and remaps that invalidated translated code
+    u64 code_invalidations;
+    /// Number of JIT reads that left its inline fast path only because the page has translated code
+    u64 jit_code_page_reads;
+};
+
+/// Returns the access counters since the memory map was initialized
+AccessStats GetAccessStats();
+
 bool IsValidVirtualAddress(const VAddr addr);
 bool IsValidPhysicalAddress(const PAddr addr);
 
@@ -121,6 +138,15 @@ u16 Read16(VAddr addr);
 u32 Read32(VAddr addr);
 u64 Read64(VAddr addr);
 
+/**
+ * Read functions for the memory callbacks of the JIT. Same as the Read functions, except that they
+ * count the reads of code pages in AccessStats::jit_code_page_reads.
+ */
+u8 JitRead8(VAddr addr);
+u16 JitRead16(VAddr addr);
+u32 JitRead32(VAddr addr);
+u64 JitRead64(VAddr addr);
+
 void Write8(VAddr addr, u8 data);
 void Write16(VAddr addr, u16 data);
 void Write32(VAddr addr, u32 data);
@@ -131,10 +157,31 @@ void WriteBlock(const VAddr dest_addr, const void* src_buffer, size_t size);
 void ZeroBlock(const VAddr dest_addr, const size_t size);
 void CopyBlock(VAddr dest_addr, VAddr src_addr, size_t size);
 
+/**
+ * Returns a pointer to the host memory backing a range of guest memory, so that the range can be
+ * accessed directly instead of being copied with ReadBlock or WriteBlock.
+ *
+ * Rasterizer cached resources touching the range are flushed first, and invalidated as well if
+ * the range is going to be written. The pointer must not be used after the guest runs again.
+ *
+ * @param vaddr Start of the range
+ * @param size Size of the range in bytes
+ * @param for_writing Whether the range is going to be written
+ * @returns nullptr if the range isn't entirely backed by contiguous host memory
+ */
+u8* GetContiguousSpan(VAddr vaddr, size_t size, bool for_writing);
+
 u8* GetPointer(VAddr virtual_address);
 
 std::string ReadCString(VAddr virtual_address, std::size_t max_length);
 
+/**
+ * Marks the pages touching the region as containing code translated by the CPU. Writing to these
+ * pages, or remapping them, invalidates the translated code through
+ * ARM_Interface::InvalidateCacheRange. Writes to them leave the fast path to do so.
+ */
+void MarkRegionAsCode(VAddr start, u32 size);
+
 /**
 * Converts a virtual address inside a region with 1:1 mapping to physical memory to a physical
 * address. This should be used by services to translate addresses for use by the hardware.
@@ -155,7 +202,8 @@ u8* GetPhysicalPointer(PAddr address);
 
 /**
  * Adds the supplied value to the rasterizer resource cache counter of each
- * page touching the region.
+ * page touching the region. When called from the GPU thread, the change is made by the CPU
+ * thread once it syncs with the GPU thread.
  */
 void RasterizerMarkRegionCached(PAddr start, u32 size, int count_delta);
 
@@ -172,7 +220,9 @@ void RasterizerFlushAndInvalidateRegion(PAddr start, u32 size);
 /**
  * Dynarmic has an optimization to memory accesses when the pointer to the page exists that
  * can be used by setting up the current page table as a callback. This function is used to
- * retrieve the current page table for that purpose.
+ * retrieve the current page table for that purpose. Pages with translated code have no pointer
+ * in it, so that the stores of the JIT to them go through the Write functions. Dynarmic uses the
+ * same table for its reads, so its reads of these pages go through the JitRead functions.
  */
 std::array<u8*, PAGE_TABLE_NUM_ENTRIES>* GetCurrentPageTablePointers();
 }
@@ -0,0 +1,267 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstring>
+#include "audio_core/audio_core.h"
+#include "common/chunk_file.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/arm/arm_interface.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/process.h"
+#include "core/hw/gpu_thread.h"
+#include "core/hw/hw.h"
+#include "core/memory.h"
+#include "core/savestate.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace SaveState {
+
+struct Header {
+    char magic[4];
+    u32 version;
+    u64 program_id;
+    u64 body_size;
+    /// Hash of the uncompressed body
+    u64 body_hash;
+};
+
+static const char MAGIC[4] = {'C', 'S', 'S', 'T'};
+static constexpr u32 VERSION = 1;
+
+/// Runs of zeros shorter than this are kept with the literal bytes around them
+static constexpr size_t MIN_ZERO_RUN = 16;
+
+/// Far more than the emulated memory and devices a state holds, larger bodies are corrupted headers
+static constexpr u64 MAX_BODY_SIZE = 512 * 1024 * 1024;
+
+static u64 GetProgramId() {
+    if (Kernel::g_current_process == nullptr)
+        return 0;
+    return Kernel::g_current_process->codeset->program_id;
+}
+
+static void DoState(PointerWrap& p) {
+    // The scheduled events are checked first, as they fail to load when the set of HLE modules
+    // differs, before anything is modified
+    CoreTiming::DoState(p);
+    Kernel::DoState(p);
+
+    {
+        auto s = p.Section("HW", 1);
+        if (!s)
+            return;
+        HW::DoState(p);
+    }
+    {
+        auto s = p.Section("Pica", 1);
+        if (!s)
+            return;
+        Pica::g_state.DoState(p);
+    }
+    {
+        auto s = p.Section("DSP", 2);
+        if (!s)
+            return;
+        AudioCore::DoState(p);
+    }
+}
+
+static void AppendU32(std::vector<u8>& out, u32 value) {
+    const size_t pos = out.size();
+    out.resize(pos + sizeof(value));
+    std::memcpy(&out[pos], &value, sizeof(value));
+}
+
+/**
+ * Most of the emulated memory is zero, so the body is stored as a sequence of records, each made
+ * of a count of literal bytes, the literal bytes, then a count of zeros.
+ */
+static std::vector<u8> Compress(const u8* data, size_t size) {
+    std::vector<u8> out;
+    out.reserve(size / 4);
+
+    size_t pos = 0;
+    while (pos < size) {
+        size_t literal_end = pos;
+        size_t zero_run = 0;
+        while (literal_end < size) {
+            size_t run_end = literal_end;
+            while (run_end < size && data[run_end] == 0)
+                ++run_end;
+            if (run_end - literal_end >= MIN_ZERO_RUN || run_end == size) {
+                zero_run = run_end - literal_end;
+                break;
+            }
+            // Too short, the zeros and the next byte are part of the literal
+            literal_end = run_end + 1;
+        }
+
+        AppendU32(out, static_cast<u32>(literal_end - pos));
+        out.insert(out.end(), data + pos, data + literal_end);
+        AppendU32(out, static_cast<u32>(zero_run));
+        pos = literal_end + zero_run;
+    }
+    return out;
+}
+
+/// Decompresses a body, failing if it's malformed or doesn't decompress to expected_size bytes
+static bool Decompress(const u8* data, size_t size, size_t expected_size, std::vector<u8>& out) {
+    size_t pos = 0;
+    while (pos < size) {
+        u32 literal_size, zero_run;
+        if (size - pos < sizeof(literal_size))
+            return false;
+        std::memcpy(&literal_size, data + pos, sizeof(literal_size));
+        pos += sizeof(literal_size);
+
+        if (size - pos < literal_size + sizeof(zero_run) ||
+            expected_size - out.size() < literal_size)
+            return false;
+        out.insert(out.end(), data + pos, data + pos + literal_size);
+        pos += literal_size;
+
+        std::memcpy(&zero_run, data + pos, sizeof(zero_run));
+        pos += sizeof(zero_run);
+        if (expected_size - out.size() < zero_run)
+            return false;
+        out.resize(out.size() + zero_run, 0);
+    }
+    return out.size() == expected_size;
+}
+
+bool Save(std::vector<u8>& buffer) {
+    // Write back the surfaces rendered by the GPU, so that they're part of the memory
+    GPUThread::RunSynchronously([] {});
+    Memory::RasterizerFlushRegion(Memory::FCRAM_PADDR, Memory::FCRAM_SIZE);
+    Memory::RasterizerFlushRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    DoState(measure);
+    if (measure.error == PointerWrap::ERROR_FAILURE) {
+        LOG_ERROR(Core, "Failed to save the state");
+        return false;
+    }
+
+    std::vector<u8> body(reinterpret_cast<size_t>(ptr));
+    ptr = body.data();
+    PointerWrap write(&ptr, PointerWrap::MODE_WRITE);
+    DoState(write);
+    ASSERT_MSG(ptr == body.data() + body.size(), "Save state size mismatch");
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.program_id = GetProgramId();
+    header.body_size = body.size();
+    header.body_hash = Common::ComputeHash64(body.data(), body.size());
+
+    const std::vector<u8> compressed = Compress(body.data(), body.size());
+    buffer.resize(sizeof(header));
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    buffer.insert(buffer.end(), compressed.begin(), compressed.end());
+
+    LOG_INFO(Core, "Saved state of %zu bytes, %zu compressed", body.size(), buffer.size());
+    return true;
+}
+
+bool Load(const std::vector<u8>& buffer) {
+    Header header;
+    if (buffer.size() < sizeof(header)) {
+        LOG_ERROR(Core, "Save state is too small");
+        return false;
+    }
+    std::memcpy(&header, buffer.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        LOG_ERROR(Core, "Not a save state of this version");
+        return false;
+    }
+    if (header.program_id != GetProgramId()) {
+        LOG_ERROR(Core, "Save state of title %016" PRIX64 ", but %016" PRIX64 " is running",
+                  header.program_id, GetProgramId());
+        return false;
+    }
+
+    if (header.body_size > MAX_BODY_SIZE) {
+        LOG_ERROR(Core, "Save state is corrupted, its body of %" PRIu64 " bytes is too large",
+                  header.body_size);
+        return false;
+    }
+
+    std::vector<u8> body;
+    body.reserve(header.body_size);
+    if (!Decompress(buffer.data() + sizeof(header), buffer.size() - sizeof(header),
+                    header.body_size, body) ||
+        Common::ComputeHash64(body.data(), body.size()) != header.body_hash) {
+        LOG_ERROR(Core, "Save state is corrupted");
+        return false;
+    }
+
+    // The cached surfaces and the compiled code refer to the memory about to be replaced
+    GPUThread::RunSynchronously([] {});
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::FCRAM_PADDR, Memory::FCRAM_SIZE);
+    Memory::RasterizerFlushAndInvalidateRegion(Memory::VRAM_PADDR, Memory::VRAM_SIZE);
+
+    u8* ptr = body.data();
+    PointerWrap read(&ptr, PointerWrap::MODE_READ);
+    DoState(read);
+    if (read.error == PointerWrap::ERROR_FAILURE || ptr != body.data() + body.size()) {
+        LOG_CRITICAL(Core, "Failed to load the state, the system is left in an undefined state");
+        return false;
+    }
+
+    Core::CPU().ClearInstructionCache();
+
+    // The rasterizer keeps its own copy of the Pica registers it uses
+    if (VideoCore::g_renderer != nullptr) {
+        GPUThread::RunSynchronously([] {
+            for (u32 id = 0; id < Pica::Regs::NumIds(); ++id) {
+                VideoCore::g_renderer->Rasterizer()->NotifyPicaRegisterChanged(id);
+            }
+        });
+    }
+
+    LOG_INFO(Core, "Loaded state of %zu bytes", body.size());
+    return true;
+}
+
+bool SaveToFile(const std::string& path) {
+    std::vector<u8> buffer;
+    if (!Save(buffer))
+        return false;
+
+    FileUtil::IOFile file(path, "wb");
+    if (!file.IsOpen() || file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
+        LOG_ERROR(Core, "Could not write the save state to %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool LoadFromFile(const std::string& path) {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Core, "Could not open the save state %s", path.c_str());
+        return false;
+    }
+
+    std::vector<u8> buffer(file.GetSize());
+    if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
+        LOG_ERROR(Core, "Could not read the save state %s", path.c_str());
+        return false;
+    }
+    return Load(buffer);
+}
+
+} // namespace SaveState
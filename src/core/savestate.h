@@ -0,0 +1,42 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+
+/**
+ * Save states of the emulated system: the kernel objects and the memory, the CPU context, the
+ * scheduled events, the GPU registers and the Pica state, and the DSP. The HLE services keep their
+ * own host-side state, which isn't saved; the kernel objects they refer to are loaded in place.
+ *
+ * A save state can only be loaded by the same build running the same title. These functions must
+ * be called from the emulation thread, between two runs of the CPU.
+ */
+namespace SaveState {
+
+/**
+ * Saves the state of the emulated system.
+ * @param buffer Receives the compressed save state
+ * @return Whether the state could be saved
+ */
+bool Save(std::vector<u8>& buffer);
+
+/**
+ * Loads a state saved with Save. If the save state can't be read, for example if it comes from
+ * another title, nothing is loaded. If it fails to load past that point, the emulated system is
+ * left in an undefined state.
+ * @return Whether the state was loaded
+ */
+bool Load(const std::vector<u8>& buffer);
+
+/// Saves the state of the emulated system to a file
+bool SaveToFile(const std::string& path);
+
+/// Loads a state saved with SaveToFile
+bool LoadFromFile(const std::string& path);
+
+} // namespace SaveState
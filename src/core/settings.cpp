@@ -20,6 +20,10 @@ void Apply() {
 
     VideoCore::g_hw_renderer_enabled = values.use_hw_renderer;
     VideoCore::g_shader_jit_enabled = values.use_shader_jit;
+    VideoCore::g_sw_rasterizer_threads = values.sw_rasterizer_threads;
+    VideoCore::g_vertex_shader_threads = values.vertex_shader_threads;
+    VideoCore::g_disk_shader_cache_enabled = values.use_disk_shader_cache;
+    VideoCore::g_async_shader_compilation = values.use_async_shader_compilation;
     VideoCore::g_toggle_framelimit_enabled = values.toggle_framelimit;
 
     if (VideoCore::g_emu_window) {
@@ -28,7 +32,8 @@ void Apply() {
     }
 
     AudioCore::SelectSink(values.sink_id);
-    AudioCore::EnableStretching(values.enable_audio_stretching);
+    // Offline rendering outputs the frames as they are generated, as fast as emulation runs
+    AudioCore::EnableStretching(values.enable_audio_stretching && !values.audio_offline_rendering);
 }
 
 } // namespace
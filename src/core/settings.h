@@ -88,6 +88,11 @@ struct Values {
     // Renderer
     bool use_hw_renderer;
     bool use_shader_jit;
+    u16 sw_rasterizer_threads;
+    u16 vertex_shader_threads;
+    bool use_disk_shader_cache;
+    bool use_async_shader_compilation;
+    bool use_gpu_thread;
     float resolution_factor;
     bool use_vsync;
     bool toggle_framelimit;
@@ -105,6 +110,10 @@ struct Values {
     std::string sink_id;
     bool enable_audio_stretching;
     std::string audio_device_id;
+    bool use_audio_thread;
+    u16 audio_queue_depth;
+    std::string audio_capture_path;
+    bool audio_offline_rendering;
 
     // Debugging
     bool use_gdbstub;
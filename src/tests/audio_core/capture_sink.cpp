@@ -0,0 +1,82 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "audio_core/audio_core.h"
+#include "audio_core/capture_sink.h"
+#include "audio_core/hle/common.h"
+#include "common/file_util.h"
+
+namespace AudioCore {
+
+static const std::string WAV_FILENAME = "test_audio_capture.wav";
+static const std::string RAW_FILENAME = "test_audio_capture.raw";
+
+static std::string ReadFile(const std::string& filename) {
+    std::string contents;
+    FileUtil::ReadFileToString(false, filename.c_str(), contents);
+    return contents;
+}
+
+/// Captures the samples, enqueued in chunks of random sizes up to max_chunk stereo samples
+static void Capture(const std::string& filename, const std::vector<s16>& samples,
+                    size_t max_chunk) {
+    std::mt19937 rng(1234);
+    CaptureSink sink(filename);
+    REQUIRE(sink.SamplesInQueue() == 0);
+
+    size_t position = 0;
+    while (position < samples.size() / 2) {
+        const size_t chunk = std::min(std::uniform_int_distribution<size_t>(1, max_chunk)(rng),
+                                      samples.size() / 2 - position);
+        sink.EnqueueSamples(&samples[position * 2], chunk);
+        position += chunk;
+    }
+}
+
+TEST_CASE("CaptureSink - Writes the samples and the hashes of the frames", "[audio_core]") {
+    constexpr size_t num_frames = 100;
+    constexpr size_t num_samples = num_frames * DSP::HLE::samples_per_frame + 17;
+
+    std::mt19937 rng(5678);
+    std::vector<s16> samples(num_samples * 2);
+    for (auto& sample : samples) {
+        sample = static_cast<s16>(std::uniform_int_distribution<int>(-32768, 32767)(rng));
+    }
+    const std::string pcm(reinterpret_cast<const char*>(samples.data()),
+                          samples.size() * sizeof(s16));
+
+    Capture(WAV_FILENAME, samples, DSP::HLE::samples_per_frame);
+    const std::string wav = ReadFile(WAV_FILENAME);
+    REQUIRE(wav.size() == 44 + pcm.size());
+    REQUIRE(wav.compare(0, 4, "RIFF") == 0);
+    REQUIRE(wav.compare(8, 8, "WAVEfmt ") == 0);
+    REQUIRE(wav.compare(36, 4, "data") == 0);
+    u32 sample_rate, data_size;
+    std::memcpy(&sample_rate, &wav[24], sizeof(u32));
+    std::memcpy(&data_size, &wav[40], sizeof(u32));
+    REQUIRE(sample_rate == native_sample_rate);
+    REQUIRE(data_size == pcm.size());
+    REQUIRE(wav.compare(44, std::string::npos, pcm) == 0);
+
+    const std::string hashes = ReadFile(WAV_FILENAME + ".hashes");
+    REQUIRE(std::count(hashes.begin(), hashes.end(), '\n') == num_frames);
+
+    // The hashes don't depend on how the samples are split
+    Capture(RAW_FILENAME, samples, 5000);
+    REQUIRE(ReadFile(RAW_FILENAME) == pcm);
+    REQUIRE(ReadFile(RAW_FILENAME + ".hashes") == hashes);
+
+    for (const auto& filename : {WAV_FILENAME, RAW_FILENAME}) {
+        FileUtil::Delete(filename);
+        FileUtil::Delete(filename + ".hashes");
+    }
+}
+
+} // namespace AudioCore
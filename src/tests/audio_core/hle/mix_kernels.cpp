@@ -0,0 +1,189 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "audio_core/hle/mix_kernels.h"
+#include "tests/benchmark.h"
+
+namespace DSP {
+namespace HLE {
+
+/// Samples of the full s16 range, with the extremes more likely than they'd be otherwise
+static s16 RandomS16(std::mt19937& rng) {
+    switch (std::uniform_int_distribution<int>(0, 7)(rng)) {
+    case 0:
+        return -32768;
+    case 1:
+        return 32767;
+    default:
+        return static_cast<s16>(std::uniform_int_distribution<int>(-32768, 32767)(rng));
+    }
+}
+
+static StereoFrame16 RandomStereoFrame(std::mt19937& rng) {
+    StereoFrame16 frame;
+    for (auto& sample : frame) {
+        sample = {{RandomS16(rng), RandomS16(rng)}};
+    }
+    return frame;
+}
+
+/// Intermediate mix samples, which are larger than s16 after mixing several sources. They're
+/// kept small enough for the gains of the tests not to overflow.
+static QuadFrame32 RandomQuadFrame(std::mt19937& rng) {
+    std::uniform_int_distribution<s32> small_dist(-40000, 40000);
+    std::uniform_int_distribution<s32> large_dist(-(1 << 28), 1 << 28);
+    const bool large = std::uniform_int_distribution<int>(0, 1)(rng) != 0;
+
+    QuadFrame32 frame;
+    for (auto& sample : frame) {
+        for (auto& channel : sample) {
+            channel = large ? large_dist(rng) : small_dist(rng);
+        }
+    }
+    return frame;
+}
+
+static float RandomGain(std::mt19937& rng) {
+    switch (std::uniform_int_distribution<int>(0, 3)(rng)) {
+    case 0:
+        return 0.0f;
+    case 1:
+        return 1.0f;
+    default:
+        return std::uniform_real_distribution<float>(-2.0f, 2.0f)(rng);
+    }
+}
+
+TEST_CASE("DSP HLE - Mixing kernels match the generic implementation", "[audio_core][hle]") {
+    std::mt19937 rng(1234);
+    const auto kernels = GetSupportedMixKernels();
+
+    for (int i = 0; i < 100; ++i) {
+        const StereoFrame16 stereo = RandomStereoFrame(rng);
+        const QuadFrame32 quad = RandomQuadFrame(rng);
+        const std::array<float, 4> gains = {
+            {RandomGain(rng), RandomGain(rng), RandomGain(rng), RandomGain(rng)}};
+        const float gain = RandomGain(rng);
+
+        QuadFrame32 expected_mix = RandomQuadFrame(rng);
+        const QuadFrame32 mix_dest = expected_mix;
+        mix_kernels_generic.mix_into(expected_mix, stereo, gains);
+
+        StereoFrame16 expected_stereo = stereo;
+        mix_kernels_generic.downmix_stereo(expected_stereo, quad, gain);
+        StereoFrame16 expected_mono = stereo;
+        mix_kernels_generic.downmix_mono(expected_mono, quad, gain);
+
+        IntermediateMixSamples::Samples planar;
+        mix_kernels_generic.deinterleave(planar, quad);
+        QuadFrame32 interleaved;
+        mix_kernels_generic.interleave(interleaved, planar);
+        REQUIRE(interleaved == quad);
+
+        for (const MixKernels* kernel : kernels) {
+            INFO("Kernels: " << kernel->name);
+
+            QuadFrame32 mix = mix_dest;
+            kernel->mix_into(mix, stereo, gains);
+            REQUIRE(mix == expected_mix);
+
+            StereoFrame16 downmix = stereo;
+            kernel->downmix_stereo(downmix, quad, gain);
+            REQUIRE(downmix == expected_stereo);
+
+            downmix = stereo;
+            kernel->downmix_mono(downmix, quad, gain);
+            REQUIRE(downmix == expected_mono);
+
+            IntermediateMixSamples::Samples kernel_planar;
+            kernel->deinterleave(kernel_planar, quad);
+            for (size_t channel = 0; channel < 4; ++channel) {
+                for (size_t sample = 0; sample < samples_per_frame; ++sample) {
+                    REQUIRE(kernel_planar.pcm32[channel][sample] == planar.pcm32[channel][sample]);
+                }
+            }
+
+            kernel->interleave(interleaved, planar);
+            REQUIRE(interleaved == quad);
+        }
+    }
+}
+
+TEST_CASE("DSP HLE - Linear interpolation kernels match the generic implementation",
+          "[audio_core][hle]") {
+    constexpr u64 scale_factor = 1 << 24;
+
+    std::mt19937 rng(1234);
+    const auto kernels = GetSupportedMixKernels();
+
+    std::vector<std::array<s16, 2>> input(300);
+    for (int i = 0; i < 200; ++i) {
+        for (auto& sample : input) {
+            sample = {{RandomS16(rng), RandomS16(rng)}};
+        }
+
+        const float rate = std::uniform_real_distribution<float>(0.01f, 4.0f)(rng);
+        const u64 step_size = static_cast<u64>(rate * scale_factor);
+        const u64 fposition = std::uniform_int_distribution<u64>(0, 3 * scale_factor)(rng);
+        // Every output reads two input samples
+        const u64 max_fposition = (input.size() - 1) * scale_factor;
+        const size_t count =
+            std::min<size_t>((max_fposition - fposition + step_size - 1) / step_size, 1000);
+
+        std::vector<std::array<s16, 2>> expected(count);
+        mix_kernels_generic.interpolate_linear(input.data(), fposition, step_size,
+                                               expected.data(), count);
+
+        for (const MixKernels* kernel : kernels) {
+            INFO("Kernels: " << kernel->name << ", rate " << rate);
+            std::vector<std::array<s16, 2>> output(count);
+            kernel->interpolate_linear(input.data(), fposition, step_size, output.data(), count);
+            REQUIRE(output == expected);
+        }
+    }
+}
+
+TEST_CASE("DSP HLE - Mixing kernel throughput", "[.benchmark]") {
+    std::mt19937 rng(1234);
+    const StereoFrame16 stereo = RandomStereoFrame(rng);
+    const QuadFrame32 quad = RandomQuadFrame(rng);
+    const std::array<float, 4> gains = {{0.5f, 0.5f, 0.25f, 0.25f}};
+    std::vector<std::array<s16, 2>> input(samples_per_frame * 2);
+    for (auto& sample : input) {
+        sample = {{RandomS16(rng), RandomS16(rng)}};
+    }
+
+    // The work of a frame with every source playing, and the three intermediate mixes
+    constexpr int frames = 20000;
+    for (const MixKernels* kernel : GetSupportedMixKernels()) {
+        std::array<QuadFrame32, 3> mixes = {};
+        StereoFrame16 output = {};
+        std::vector<std::array<s16, 2>> resampled(samples_per_frame);
+
+        Benchmark::Measure(kernel->name, frames, "frame", [&] {
+            for (int frame = 0; frame < frames; ++frame) {
+                mixes = {};
+                for (int source = 0; source < num_sources; ++source) {
+                    kernel->interpolate_linear(input.data(), 0, (1 << 24) * 3 / 2,
+                                               resampled.data(), samples_per_frame);
+                    for (auto& mix : mixes) {
+                        kernel->mix_into(mix, stereo, gains);
+                    }
+                }
+                for (const auto& mix : mixes) {
+                    kernel->downmix_stereo(output, mix, 1.0f);
+                }
+                kernel->downmix_stereo(output, quad, 1.0f);
+            }
+        });
+    }
+}
+
+} // namespace HLE
+} // namespace DSP
@@ -0,0 +1,195 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "audio_core/codec.h"
+#include "audio_core/hle/dsp.h"
+#include "audio_core/hle/source.h"
+#include "audio_core/interpolate.h"
+#include "audio_core/null_sink.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "tests/benchmark.h"
+
+namespace DSP {
+namespace HLE {
+
+using Configuration = SourceConfiguration::Configuration;
+
+/// Maps a buffer at the start of FCRAM, where the buffers played by the sources are
+static std::vector<u8> MapFCRAM(size_t size) {
+    Memory::InitMemoryMap();
+    std::vector<u8> fcram(size);
+    Memory::MapMemoryRegion(Memory::LINEAR_HEAP_VADDR, static_cast<u32>(size), fcram.data());
+    return fcram;
+}
+
+static void FillRandom(std::vector<u8>& data) {
+    u32 seed = 12345;
+    for (auto& byte : data) {
+        seed = seed * 1103515245 + 12345;
+        byte = static_cast<u8>(seed >> 16);
+    }
+}
+
+/// Configures a source playing one embedded buffer followed by queued buffers
+static void ConfigureSource(Configuration& config, Configuration::Format format,
+                            Configuration::MonoOrStereo mono_or_stereo,
+                            Configuration::InterpolationMode interpolation, float rate,
+                            const std::vector<PAddr>& addresses, const std::vector<u32>& lengths,
+                            bool is_looping) {
+    std::memset(&config, 0, sizeof(config));
+
+    config.enable = 1;
+    config.enable_dirty.Assign(1);
+    for (size_t i = 0; i < 4; ++i) {
+        config.gain[0][i] = 1.0f;
+    }
+    config.gain_0_dirty.Assign(1);
+    config.format.Assign(format);
+    config.format_dirty.Assign(1);
+    config.mono_or_stereo.Assign(mono_or_stereo);
+    config.mono_or_stereo_dirty.Assign(1);
+    config.rate_multiplier = rate;
+    config.rate_multiplier_dirty.Assign(1);
+    config.interpolation_mode = interpolation;
+    config.interpolation_dirty.Assign(1);
+    config.adpcm_coefficients_dirty.Assign(1);
+
+    config.physical_address = addresses[0];
+    config.length = lengths[0];
+    config.buffer_id = 1;
+    config.is_looping.Assign(is_looping ? 1 : 0);
+    config.embedded_buffer_dirty.Assign(1);
+
+    for (size_t i = 1; i < addresses.size(); ++i) {
+        auto& buffer = config.buffers[i - 1];
+        buffer.physical_address = addresses[i];
+        buffer.length = lengths[i];
+        buffer.buffer_id = static_cast<u16>(i + 1);
+        config.buffers_dirty |= 1 << (i - 1);
+    }
+    if (addresses.size() > 1) {
+        config.buffer_queue_dirty.Assign(1);
+    }
+}
+
+/// Plays buffers of random samples and compares them with the whole buffers resampled at once
+static void CheckStreamedBuffers(Configuration::Format format,
+                                 Configuration::InterpolationMode interpolation, float rate) {
+    std::vector<u8> fcram = MapFCRAM(0x10000);
+    FillRandom(fcram);
+
+    const std::vector<u32> lengths = {1000, 501, 3, 777};
+    std::vector<PAddr> addresses;
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        addresses.push_back(static_cast<PAddr>(Memory::FCRAM_PADDR + i * 0x3000));
+    }
+
+    s16_le adpcm_coeffs[16];
+    std::array<s16, 16> coeffs;
+    for (size_t i = 0; i < 16; ++i) {
+        coeffs[i] = static_cast<s16>((i % 2 == 0 ? 0x700 : -0x300) + i * 16);
+        adpcm_coeffs[i] = coeffs[i];
+    }
+
+    std::vector<std::array<s16, 2>> expected;
+    Codec::ADPCMState adpcm_state = {};
+    AudioInterp::State interp_state = {};
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        const u8* const data = &fcram[addresses[i] - Memory::FCRAM_PADDR];
+        std::vector<std::array<s16, 2>> samples;
+        switch (format) {
+        case Configuration::Format::PCM8:
+            samples = Codec::DecodePCM8(2, data, lengths[i]);
+            break;
+        case Configuration::Format::PCM16:
+            samples = Codec::DecodePCM16(2, data, lengths[i]);
+            break;
+        default:
+            samples = Codec::DecodeADPCM(data, lengths[i], coeffs, adpcm_state);
+            break;
+        }
+        samples = interpolation == Configuration::InterpolationMode::None
+                      ? AudioInterp::None(interp_state, samples, rate)
+                      : AudioInterp::Linear(interp_state, samples, rate);
+        expected.insert(expected.end(), samples.begin(), samples.end());
+    }
+
+    const auto mono_or_stereo = format == Configuration::Format::ADPCM
+                                    ? Configuration::MonoOrStereo::Mono
+                                    : Configuration::MonoOrStereo::Stereo;
+    Source source(0);
+    Configuration config;
+    ConfigureSource(config, format, mono_or_stereo, interpolation, rate, addresses, lengths,
+                    false);
+
+    std::vector<std::array<s16, 2>> played;
+    while (source.Tick(config, adpcm_coeffs).is_enabled) {
+        QuadFrame32 frame = {};
+        source.MixInto(frame, 0);
+        for (const auto& sample : frame) {
+            played.push_back({{static_cast<s16>(sample[0]), static_cast<s16>(sample[1])}});
+        }
+    }
+
+    // The last frame is padded with silence
+    REQUIRE(played.size() >= expected.size());
+    REQUIRE(played.size() < expected.size() + samples_per_frame);
+    played.resize(expected.size());
+    REQUIRE(played == expected);
+}
+
+TEST_CASE("DSP HLE Source - Streams buffers like decoding them whole", "[audio_core][hle]") {
+    for (auto format : {Configuration::Format::PCM8, Configuration::Format::PCM16,
+                        Configuration::Format::ADPCM}) {
+        for (auto interpolation : {Configuration::InterpolationMode::None,
+                                   Configuration::InterpolationMode::Linear}) {
+            for (float rate : {0.37f, 1.0f, 2.5f}) {
+                CheckStreamedBuffers(format, interpolation, rate);
+            }
+        }
+    }
+}
+
+TEST_CASE("DSP HLE Source - Frame generation throughput", "[.benchmark]") {
+    // Every source plays a looping buffer at a rate that needs resampling
+    constexpr u32 buffer_length = 4096;
+    std::vector<u8> fcram = MapFCRAM(num_sources * buffer_length * 2 * sizeof(s16));
+    FillRandom(fcram);
+
+    for (auto& region : g_regions) {
+        std::memset(&region, 0, sizeof(region));
+        for (size_t i = 0; i < num_sources; ++i) {
+            const auto format = i % 2 == 0 ? Configuration::Format::PCM16
+                                           : Configuration::Format::ADPCM;
+            const auto mono_or_stereo = i % 2 == 0 ? Configuration::MonoOrStereo::Stereo
+                                                   : Configuration::MonoOrStereo::Mono;
+            const PAddr address =
+                static_cast<PAddr>(Memory::FCRAM_PADDR + i * buffer_length * 2 * sizeof(s16));
+            ConfigureSource(region.source_configurations.config[i], format, mono_or_stereo,
+                            Configuration::InterpolationMode::Linear, 1.0f + i * 0.01f,
+                            {address}, {buffer_length}, true);
+        }
+    }
+
+    SetSink(std::make_unique<AudioCore::NullSink>());
+    EnableStretching(false);
+    Init();
+
+    constexpr int frames = 20000;
+    Benchmark::Measure(std::to_string(num_sources) + " sources", frames, "frame", [] {
+        for (int i = 0; i < frames; ++i) {
+            Tick();
+        }
+    });
+}
+
+} // namespace HLE
+} // namespace DSP
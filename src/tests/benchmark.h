@@ -0,0 +1,35 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/**
+ * Helpers of the benchmarks, which are test cases hidden behind the "[.benchmark]" tag. They aren't
+ * run with the unit tests, only when asked for with `tests [.benchmark]`.
+ */
+namespace Benchmark {
+
+/**
+ * Runs a piece of work once and prints how fast it went.
+ * @param name Name of the work, printed in front of the results
+ * @param units Number of units the work processes, e.g. pixels, vertices or bytes
+ * @param unit_name Name of a unit, printed with the results
+ * @param run The work
+ */
+template <typename Run>
+void Measure(const std::string& name, double units, const char* unit_name, Run&& run) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("%-40s %10.2f M%s/s %12.2f ns/%s\n", name.c_str(),
+                units / elapsed.count() / 1e6, unit_name, elapsed.count() * 1e9 / units,
+                unit_name);
+}
+
+} // namespace Benchmark
@@ -0,0 +1,184 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "common/alignment.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+#include "common/logging/ring.h"
+
+namespace Log {
+
+static RecordHeader MakeHeader(u16 message_length, u32 line_nr) {
+    RecordHeader header{};
+    header.log_class = Class::Log;
+    header.log_level = Level::Info;
+    header.message_length = message_length;
+    header.line_nr = line_nr;
+    return header;
+}
+
+TEST_CASE("Log Ring - Records come out in order across wrap-arounds", "[common]") {
+    auto ring = std::make_unique<Ring>();
+    REQUIRE(ring->Peek() == nullptr);
+
+    // Odd message lengths, so that records regularly don't fit at the end of the ring
+    const std::string message(1001, 'x');
+    u32 next_pushed = 0;
+    u32 next_popped = 0;
+    for (int round = 0; round < 100; ++round) {
+        for (int i = 0; i < 100; ++i) {
+            const u16 length = static_cast<u16>(next_pushed % message.size());
+            const auto usage = ring->Push(MakeHeader(length, next_pushed), message.data());
+            REQUIRE(usage.second > usage.first);
+            ++next_pushed;
+        }
+
+        // Leave some records behind, so that reads and writes are at different offsets
+        while (next_popped + 10 < next_pushed) {
+            const RecordHeader* header = ring->Peek();
+            REQUIRE(header != nullptr);
+            REQUIRE(header->line_nr == next_popped);
+            REQUIRE(header->message_length == next_popped % message.size());
+            const char* text = reinterpret_cast<const char*>(header + 1);
+            REQUIRE(std::string(text) == message.substr(0, header->message_length));
+            ring->Pop(header);
+            ++next_popped;
+        }
+    }
+
+    REQUIRE(ring->GetDroppedCount() == 0);
+}
+
+TEST_CASE("Log Ring - Messages are dropped and counted when the ring is full", "[common]") {
+    auto ring = std::make_unique<Ring>();
+    const std::string message(1000, 'x');
+    const RecordHeader header = MakeHeader(static_cast<u16>(message.size()), 0);
+
+    u32 pushed = 0;
+    while (ring->GetDroppedCount() == 0) {
+        const auto usage = ring->Push(header, message.data());
+        if (ring->GetDroppedCount() == 0) {
+            ++pushed;
+        } else {
+            // A dropped message doesn't take up any space
+            REQUIRE(usage.first == usage.second);
+        }
+    }
+    const size_t record_size = Common::AlignUp(sizeof(RecordHeader) + message.size() + 1, 8);
+    REQUIRE(pushed == Ring::SIZE / record_size);
+
+    ring->Push(header, message.data());
+    REQUIRE(ring->GetDroppedCount() == 2);
+
+    // Popping a record makes room for the next one
+    ring->Pop(ring->Peek());
+    ring->Push(header, message.data());
+    REQUIRE(ring->GetDroppedCount() == 2);
+
+    u32 popped = 0;
+    while (const RecordHeader* record = ring->Peek()) {
+        ring->Pop(record);
+        ++popped;
+    }
+    REQUIRE(popped == pushed);
+}
+
+TEST_CASE("Log RingPool - Released rings are reused", "[common]") {
+    RingPool pool;
+    Ring* first = pool.Acquire();
+    Ring* second = pool.Acquire();
+    REQUIRE(first != second);
+    REQUIRE(pool.GetSize() == 2);
+
+    pool.Release(first);
+    REQUIRE(pool.Acquire() == first);
+    REQUIRE(pool.GetSize() == 2);
+
+    // Released rings are still drained
+    pool.Release(second);
+    std::vector<Ring*> rings;
+    pool.GetRings(rings);
+    REQUIRE(rings.size() == 2);
+}
+
+static std::vector<std::string> ReadLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST_CASE("Log Backend - Messages are written in order of each thread", "[common]") {
+    const std::string log_file = "logging_backend_test.txt";
+    constexpr int NUM_THREADS = 4;
+    constexpr int NUM_MESSAGES = 100;
+
+    Init(log_file);
+
+    // Each thread takes over the ring of a thread that exited before it, with the messages
+    // that are still queued in it
+    for (int round = 0; round < 2; ++round) {
+        std::vector<std::thread> threads;
+        for (int thread = 0; thread < NUM_THREADS; ++thread) {
+            threads.emplace_back([thread, round] {
+                for (int i = 0; i < NUM_MESSAGES; ++i) {
+                    LOG_INFO(Log, "Logging test %d %d %d", round, thread, i);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // Critical messages are written out before LogMessage returns
+    LOG_CRITICAL(Log, "Logging test critical");
+    auto lines = ReadLines(log_file);
+    REQUIRE(!lines.empty());
+    REQUIRE(lines.back().find("Logging test critical") != std::string::npos);
+
+    LOG_INFO(Log, "Logging test flushed");
+    Flush();
+    lines = ReadLines(log_file);
+    REQUIRE(lines.back().find("Logging test flushed") != std::string::npos);
+
+    Shutdown();
+
+    std::vector<int> next[2];
+    next[0].assign(NUM_THREADS, 0);
+    next[1].assign(NUM_THREADS, 0);
+    for (const auto& line : lines) {
+        const size_t offset = line.find("Logging test ");
+        int round, thread, i;
+        if (offset == std::string::npos ||
+            std::sscanf(line.c_str() + offset, "Logging test %d %d %d", &round, &thread, &i) != 3)
+            continue;
+
+        REQUIRE(i == next[round][thread]);
+        ++next[round][thread];
+    }
+    for (int round = 0; round < 2; ++round) {
+        for (int thread = 0; thread < NUM_THREADS; ++thread) {
+            REQUIRE(next[round][thread] == NUM_MESSAGES);
+        }
+    }
+    REQUIRE(GetDroppedMessageCount() == 0);
+
+    FileUtil::Delete(log_file);
+    for (int i = 1; i <= 3; ++i) {
+        FileUtil::Delete(log_file + "." + std::to_string(i));
+    }
+}
+
+} // namespace Log
@@ -0,0 +1,44 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch.hpp>
+#include "common/thread_queue_list.h"
+
+namespace Common {
+
+TEST_CASE("ThreadQueueList - Pops the best priority level first", "[common]") {
+    ThreadQueueList<int, 64> queue;
+    REQUIRE(queue.get_first() == 0);
+
+    queue.push_back(63, 1);
+    queue.push_back(20, 2);
+    queue.push_back(20, 3);
+    queue.push_front(20, 4);
+    queue.push_back(0, 5);
+
+    REQUIRE(queue.get_first() == 5);
+    REQUIRE(queue.pop_first() == 5);
+    REQUIRE(queue.empty(0));
+
+    // Nothing is better than priority 20
+    REQUIRE(queue.pop_first_better(20) == 0);
+    REQUIRE(queue.pop_first_better(21) == 4);
+
+    queue.rotate(20);
+    REQUIRE(queue.pop_first() == 3);
+
+    queue.move(2, 20, 10);
+    REQUIRE(queue.contains(2) == 10);
+    REQUIRE(queue.empty(20));
+
+    queue.remove(10, 2);
+    REQUIRE(queue.pop_first() == 1);
+    REQUIRE(queue.get_first() == 0);
+
+    queue.push_back(40, 6);
+    queue.clear();
+    REQUIRE(queue.pop_first() == 0);
+}
+
+} // namespace Common
@@ -0,0 +1,122 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "common/threadsafe_queue.h"
+
+namespace Common {
+
+TEST_CASE("MPSCQueue - Elements of each producer arrive in order", "[common]") {
+    constexpr u32 NUM_PRODUCERS = 4;
+    constexpr u32 NUM_ELEMENTS = 100000;
+
+    MPSCQueue<u32> queue;
+    REQUIRE(queue.Empty());
+
+    std::vector<std::thread> producers;
+    for (u32 producer = 0; producer < NUM_PRODUCERS; ++producer) {
+        producers.emplace_back([&queue, producer] {
+            for (u32 i = 0; i < NUM_ELEMENTS; ++i) {
+                queue.Push((producer << 24) | i);
+            }
+        });
+    }
+
+    std::vector<u32> next(NUM_PRODUCERS, 0);
+    u32 popped = 0;
+    while (popped < NUM_PRODUCERS * NUM_ELEMENTS) {
+        u32 value;
+        if (!queue.Pop(value))
+            continue;
+
+        const u32 producer = value >> 24;
+        REQUIRE(producer < NUM_PRODUCERS);
+        REQUIRE((value & 0xFFFFFF) == next[producer]);
+        ++next[producer];
+        ++popped;
+    }
+
+    for (auto& thread : producers) {
+        thread.join();
+    }
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("SPSCQueue - Elements arrive in order", "[common]") {
+    constexpr u32 NUM_ELEMENTS = 100000;
+
+    SPSCQueue<u32> queue;
+    REQUIRE(queue.Empty());
+
+    std::thread producer([&queue] {
+        for (u32 i = 0; i < NUM_ELEMENTS; ++i) {
+            queue.Push(i);
+        }
+    });
+
+    u32 next = 0;
+    while (next < NUM_ELEMENTS) {
+        u32 value;
+        if (!queue.Pop(value))
+            continue;
+
+        REQUIRE(value == next);
+        ++next;
+    }
+
+    producer.join();
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("BoundedSPSCQueue - Elements arrive in order", "[common]") {
+    constexpr u32 NUM_ELEMENTS = 100000;
+
+    BoundedSPSCQueue<u32> queue(16);
+    REQUIRE(queue.Empty());
+    REQUIRE(queue.Capacity() == 16);
+
+    std::thread producer([&queue] {
+        for (u32 i = 0; i < NUM_ELEMENTS; ++i) {
+            while (!queue.TryPush(i)) {
+            }
+        }
+    });
+
+    u32 next = 0;
+    while (next < NUM_ELEMENTS) {
+        u32 value;
+        if (!queue.Pop(value))
+            continue;
+
+        REQUIRE(value == next);
+        ++next;
+    }
+
+    producer.join();
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("BoundedSPSCQueue - Pushes fail when full", "[common]") {
+    BoundedSPSCQueue<u32> queue(3);
+
+    for (u32 round = 0; round < 4; ++round) {
+        for (u32 i = 0; i < 3; ++i) {
+            REQUIRE(queue.TryPush(i));
+        }
+        REQUIRE(queue.Size() == 3);
+        REQUIRE(!queue.TryPush(3));
+
+        u32 value;
+        for (u32 i = 0; i < 3; ++i) {
+            REQUIRE(queue.Pop(value));
+            REQUIRE(value == i);
+        }
+        REQUIRE(!queue.Pop(value));
+        REQUIRE(queue.Size() == 0);
+    }
+}
+
+} // namespace Common
@@ -0,0 +1,98 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include "core/arm/dyncom/arm_dyncom_interpreter.h"
+#include "core/arm/dyncom/arm_dyncom_trans.h"
+#include "core/arm/skyeye_common/armstate.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "core/mmio.h"
+
+static constexpr VAddr CODE_ADDR = 0x10000;
+static constexpr VAddr MMIO_ADDR = 0x20000;
+
+/// Replaces the code and clears the translation cache from within a store, like loading a
+/// savestate from an SVC would
+class ReplaceCodeOnWrite final : public Memory::MMIORegion {
+public:
+    ReplaceCodeOnWrite(ARMul_State& cpu, std::vector<u8>& code) : cpu(cpu), code(code) {}
+
+    bool IsValidAddress(VAddr addr) override {
+        return true;
+    }
+
+    u8 Read8(VAddr addr) override {
+        return 0;
+    }
+    u16 Read16(VAddr addr) override {
+        return 0;
+    }
+    u32 Read32(VAddr addr) override {
+        return 0;
+    }
+    u64 Read64(VAddr addr) override {
+        return 0;
+    }
+
+    bool ReadBlock(VAddr src_addr, void* dest_buffer, size_t size) override {
+        return false;
+    }
+
+    void Write8(VAddr addr, u8 data) override {}
+    void Write16(VAddr addr, u16 data) override {}
+    void Write32(VAddr addr, u32 data) override {
+        // The first exit of the second block is only linked to the first one after it ran once
+        if (++writes != 2)
+            return;
+
+        const u32 add_r2_16 = 0xE2822010;
+        std::memcpy(code.data(), &add_r2_16, sizeof(add_r2_16));
+        ClearTransCache(&cpu);
+    }
+    void Write64(VAddr addr, u64 data) override {}
+
+    bool WriteBlock(VAddr dest_addr, const void* src_buffer, size_t size) override {
+        return false;
+    }
+
+private:
+    ARMul_State& cpu;
+    std::vector<u8>& code;
+    int writes = 0;
+};
+
+TEST_CASE("ARM_DynCom - Links are not followed after the cache is cleared", "[core][arm]") {
+    Memory::InitMemoryMap();
+    std::vector<u8> code(Memory::PAGE_SIZE, 0);
+    Memory::MapMemoryRegion(CODE_ADDR, Memory::PAGE_SIZE, code.data());
+
+    // 0x10000: add r2, r2, #1; b 0x10100
+    Memory::Write32(0x10000, 0xE2822001);
+    Memory::Write32(0x10004, 0xEA00003D);
+    // 0x10100: str r0, [r1]; b 0x10000
+    Memory::Write32(0x10100, 0xE5810000);
+    Memory::Write32(0x10104, 0xEAFFFFBD);
+
+    auto cpu = std::make_unique<ARMul_State>(USER32MODE);
+    Memory::MapIoRegion(MMIO_ADDR, Memory::PAGE_SIZE,
+                        std::make_shared<ReplaceCodeOnWrite>(*cpu, code));
+    ClearTransCache(cpu.get());
+    cpu->Reg[1] = MMIO_ADDR;
+    cpu->Reg[2] = 0;
+    cpu->Reg[15] = CODE_ADDR;
+
+    // Both blocks run twice, the second store replaces the add, which then runs once more
+    cpu->NumInstrsToExecute = 9;
+    InterpreterMainLoop(cpu.get());
+    REQUIRE(cpu->Reg[2] == 2 + 16);
+    REQUIRE(cpu->Reg[15] == 0x10004);
+
+    ClearTransCache(cpu.get());
+    Memory::UnmapRegion(MMIO_ADDR, Memory::PAGE_SIZE);
+    Memory::UnmapRegion(CODE_ADDR, Memory::PAGE_SIZE);
+}
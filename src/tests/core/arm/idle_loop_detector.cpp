@@ -0,0 +1,106 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/arm/idle_loop_detector.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+
+TEST_CASE("IdleLoopDetector - Recognizes loops without side effects", "[core][arm]") {
+    Memory::InitMemoryMap();
+    std::vector<u8> code(Memory::PAGE_SIZE, 0);
+    Memory::MapMemoryRegion(0x10000, Memory::PAGE_SIZE, code.data());
+
+    // loop: ldr r0, [r1]; cmp r0, #0; beq loop
+    Memory::Write32(0x10000, 0xE5910000);
+    Memory::Write32(0x10004, 0xE3500000);
+    Memory::Write32(0x10008, 0x0AFFFFFC);
+
+    // loop: ldr r0, [r1]; add r2, r2, #1; cmp r0, #0; beq loop
+    Memory::Write32(0x10100, 0xE5910000);
+    Memory::Write32(0x10104, 0xE2822001);
+    Memory::Write32(0x10108, 0xE3500000);
+    Memory::Write32(0x1010C, 0x0AFFFFFB);
+
+    // loop: str r0, [r1]; b loop
+    Memory::Write32(0x10200, 0xE5810000);
+    Memory::Write32(0x10204, 0xEAFFFFFD);
+
+    // loop: ldr r0, [r1, #0]; cmp r0, #0; beq loop (Thumb)
+    Memory::Write16(0x10300, 0x6808);
+    Memory::Write16(0x10302, 0x2800);
+    Memory::Write16(0x10304, 0xD0FC);
+
+    IdleLoopDetector detector;
+    REQUIRE(detector.IsIdleLoop(0x10000, false));
+    REQUIRE(detector.IsIdleLoop(0x10008, false));
+    // The counter carries over from one iteration to the next
+    REQUIRE_FALSE(detector.IsIdleLoop(0x10104, false));
+    REQUIRE_FALSE(detector.IsIdleLoop(0x10200, false));
+    REQUIRE(detector.IsIdleLoop(0x10302, true));
+    REQUIRE_FALSE(detector.IsIdleLoop(0x10302, false));
+
+    // Changed code is analyzed again once invalidated
+    Memory::Write32(0x10004, 0xE5810000);
+    REQUIRE(detector.IsIdleLoop(0x10000, false));
+    detector.InvalidateRange(0x10004, 4);
+    REQUIRE_FALSE(detector.IsIdleLoop(0x10000, false));
+
+    Memory::UnmapRegion(0x10000, Memory::PAGE_SIZE);
+}
+
+static int events_fired;
+static int last_cycles_late;
+
+static void CountEvent(u64 userdata, int cycles_late) {
+    ++events_fired;
+    last_cycles_late = cycles_late;
+}
+
+TEST_CASE("IdleLoopDetector - Skips to the next event after two idle slices", "[core][arm]") {
+    Memory::InitMemoryMap();
+    std::vector<u8> code(Memory::PAGE_SIZE, 0);
+    Memory::MapMemoryRegion(0x10000, Memory::PAGE_SIZE, code.data());
+
+    // loop: ldr r0, [r1]; cmp r0, #0; beq loop
+    Memory::Write32(0x10000, 0xE5910000);
+    Memory::Write32(0x10004, 0xE3500000);
+    Memory::Write32(0x10008, 0x0AFFFFFC);
+
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    CoreTiming::Init();
+    const int event_type = CoreTiming::RegisterEvent("IdleLoopDetector test", CountEvent);
+    events_fired = 0;
+
+    // The event scheduled from another thread is due before the one in the queue, and the skip
+    // has to stop at it even though it is only moved to the queue by the next Advance
+    CoreTiming::ScheduleEvent(1000000, event_type);
+    CoreTiming::ScheduleEvent_Threadsafe(5000, event_type, 0);
+
+    IdleLoopDetector detector;
+    detector.EndSlice(0x10008, false, false);
+    REQUIRE(CoreTiming::GetIdleTicks() == 0);
+    REQUIRE(events_fired == 0);
+
+    detector.EndSlice(0x10000, false, false);
+    REQUIRE(CoreTiming::GetIdleTicks() == 5000);
+    REQUIRE(CoreTiming::GetTicks() == 5000);
+    REQUIRE(events_fired == 1);
+    REQUIRE(last_cycles_late == 0);
+
+    // An event ran, so the loop has to go around for two more slices before skipping again
+    detector.EndSlice(0x10000, false, true);
+    detector.EndSlice(0x10000, false, false);
+    REQUIRE(CoreTiming::GetIdleTicks() == 5000);
+
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+    Memory::UnmapRegion(0x10000, Memory::PAGE_SIZE);
+}
@@ -0,0 +1,184 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch.hpp>
+#include "common/chunk_file.h"
+#include "core/core_timing_queue.h"
+#include "tests/benchmark.h"
+
+namespace CoreTiming {
+
+TEST_CASE("EventQueue - Events fire in time order", "[core]") {
+    EventQueue queue;
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<s64> time_dist(0, 1000);
+    std::uniform_int_distribution<int> type_dist(0, 7);
+
+    // Reference: events keyed by time and scheduling order, along with their handles
+    std::map<std::pair<s64, u64>, std::pair<EventQueue::Event, EventHandle>> expected;
+    u64 order = 0;
+
+    for (int i = 0; i < 20000; ++i) {
+        const int op = rng() % 4;
+        if (op <= 1 || expected.empty()) {
+            const s64 time = time_dist(rng);
+            const int type = type_dist(rng);
+            const EventHandle handle = queue.Push(time, type, i);
+            expected[{time, order++}] = {{time, static_cast<u64>(i), type}, handle};
+        } else if (op == 2) {
+            const auto event = queue.Pop();
+            const auto& next = expected.begin()->second.first;
+            REQUIRE(event.time == next.time);
+            REQUIRE(event.userdata == next.userdata);
+
+            // The handle of a fired event is stale
+            const EventHandle handle = expected.begin()->second.second;
+            expected.erase(expected.begin());
+            REQUIRE(queue.Find(handle) == nullptr);
+        } else {
+            auto it = expected.begin();
+            std::advance(it, rng() % expected.size());
+            const EventHandle handle = it->second.second;
+            REQUIRE(queue.Find(handle) != nullptr);
+            REQUIRE(queue.Find(handle)->userdata == it->second.first.userdata);
+            queue.Remove(handle);
+            expected.erase(it);
+
+            // Removing twice does nothing, even if the slot was reused
+            queue.Push(-1, 0, 0);
+            queue.Remove(handle);
+            REQUIRE(queue.Pop().time == -1);
+        }
+        REQUIRE(queue.Size() == expected.size());
+    }
+
+    // Remove all events of one type
+    queue.RemoveIf(3, [](const EventQueue::Event&) { return true; });
+    REQUIRE(!queue.HasType(3));
+    for (auto it = expected.begin(); it != expected.end();) {
+        it = it->second.first.type == 3 ? expected.erase(it) : std::next(it);
+    }
+
+    for (const auto& entry : expected) {
+        REQUIRE(queue.Pop().userdata == entry.second.first.userdata);
+    }
+    REQUIRE(queue.Empty());
+}
+
+TEST_CASE("EventQueue - Handles stay valid across a save and load", "[core]") {
+    EventQueue queue;
+    const EventHandle first = queue.Push(100, 0, 1);
+    const EventHandle removed = queue.Push(50, 1, 2);
+    const EventHandle second = queue.Push(100, 2, 3);
+    queue.Push(200, 0, 4);
+    queue.Remove(removed);
+
+    u8* ptr = nullptr;
+    PointerWrap measure(&ptr, PointerWrap::MODE_MEASURE);
+    queue.DoState(measure);
+    std::vector<u8> buffer(reinterpret_cast<size_t>(ptr));
+
+    ptr = buffer.data();
+    PointerWrap write(&ptr, PointerWrap::MODE_WRITE);
+    queue.DoState(write);
+
+    EventQueue loaded;
+    loaded.Push(10, 5, 0);
+    ptr = buffer.data();
+    PointerWrap read(&ptr, PointerWrap::MODE_READ);
+    loaded.DoState(read);
+
+    REQUIRE(loaded.Size() == 3);
+    REQUIRE(loaded.Find(removed) == nullptr);
+    REQUIRE(loaded.Find(second)->userdata == 3);
+    loaded.Remove(first);
+    REQUIRE(loaded.Pop().userdata == 3);
+    REQUIRE(loaded.Pop().userdata == 4);
+    REQUIRE(loaded.Empty());
+}
+
+TEST_CASE("EventQueue - Scheduler throughput", "[.benchmark]") {
+    // The sorted linked list CoreTiming used before, with cancellation by type and userdata
+    struct ListEvent {
+        s64 time;
+        u64 userdata;
+        int type;
+        ListEvent* next;
+    };
+
+    for (int pending : {16, 256, 4096}) {
+        constexpr int ITERATIONS = 100000;
+        std::mt19937 rng(5678);
+        std::uniform_int_distribution<s64> delay_dist(1, 100000);
+
+        // Each iteration schedules a thread wakeup, cancels another one and fires the next event,
+        // keeping the number of pending events constant
+        auto Measure = [&](const char* name, auto run) {
+            Benchmark::Measure(std::string(name) + ", " + std::to_string(pending) + " pending",
+                               ITERATIONS, "iteration", run);
+        };
+
+        Measure("Heap", [&] {
+            EventQueue queue;
+            std::vector<EventHandle> handles(pending);
+            s64 now = 0;
+            for (int i = 0; i < pending; ++i) {
+                handles[i] = queue.Push(now + delay_dist(rng), 0, i);
+            }
+            for (int i = 0; i < ITERATIONS; ++i) {
+                const int thread = rng() % pending;
+                queue.Remove(handles[thread]);
+                handles[thread] = queue.Push(now + delay_dist(rng), 0, thread);
+
+                const auto event = queue.Pop();
+                now = event.time;
+                handles[event.userdata] = queue.Push(now + delay_dist(rng), 0, event.userdata);
+            }
+        });
+
+        Measure("Sorted list", [&] {
+            ListEvent* first = nullptr;
+            auto Insert = [&first](ListEvent* event) {
+                ListEvent** next = &first;
+                while (*next != nullptr && (*next)->time <= event->time)
+                    next = &(*next)->next;
+                event->next = *next;
+                *next = event;
+            };
+            auto Unlink = [&first](u64 userdata) {
+                ListEvent** next = &first;
+                while ((*next)->userdata != userdata)
+                    next = &(*next)->next;
+                ListEvent* event = *next;
+                *next = event->next;
+                return event;
+            };
+
+            std::vector<ListEvent> events(pending);
+            s64 now = 0;
+            for (int i = 0; i < pending; ++i) {
+                events[i] = {now + delay_dist(rng), static_cast<u64>(i), 0, nullptr};
+                Insert(&events[i]);
+            }
+            for (int i = 0; i < ITERATIONS; ++i) {
+                ListEvent* event = Unlink(rng() % pending);
+                event->time = now + delay_dist(rng);
+                Insert(event);
+
+                event = first;
+                first = event->next;
+                now = event->time;
+                event->time = now + delay_dist(rng);
+                Insert(event);
+            }
+        });
+    }
+}
+
+} // namespace CoreTiming
@@ -0,0 +1,143 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/archive_romfs.h"
+#include "core/file_sys/ivfc_archive.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+static const std::string ROMFS_FILENAME = "test_ivfc_archive.bin";
+
+TEST_CASE("IVFCArchive - Reads the data of the archive", "[core][file_sys]") {
+    constexpr u64 DATA_OFFSET = 0x1234;
+    constexpr u64 DATA_SIZE = 3 * 1024 * 1024;
+
+    std::mt19937 rng(1234);
+    std::vector<u8> contents(DATA_OFFSET + DATA_SIZE + 100);
+    for (auto& byte : contents) {
+        byte = static_cast<u8>(rng());
+    }
+    {
+        FileUtil::IOFile file(ROMFS_FILENAME, "wb");
+        REQUIRE(file.WriteBytes(contents.data(), contents.size()) == contents.size());
+    }
+
+    auto file = std::make_shared<FileUtil::IOFile>(ROMFS_FILENAME, "rb");
+    REQUIRE(file->IsOpen());
+    {
+        const FileUtil::MappedFile mapping(*file);
+        REQUIRE(mapping.IsMapped());
+        REQUIRE(mapping.GetSize() == contents.size());
+        REQUIRE(std::equal(contents.begin(), contents.end(), mapping.GetData()));
+    }
+
+    // The archive is read through the mapping, and from the file if it is larger than the file
+    for (const u64 size : {DATA_SIZE, static_cast<u64>(contents.size())}) {
+        IVFCArchive archive(file, DATA_OFFSET, size);
+        auto ivfc_file = archive.OpenFile(Path(""), Mode{}).MoveFrom();
+        REQUIRE(ivfc_file->GetSize() == size);
+        // Data available in the file
+        const u64 available = std::min<u64>(size, contents.size() - DATA_OFFSET);
+
+        std::vector<u8> buffer(DATA_SIZE);
+        u64 expected_bytes = 0;
+
+        // Sequential reads of various sizes
+        u64 offset = 0;
+        u64 reads = 0;
+        while (offset < DATA_SIZE) {
+            const size_t length = std::min<u64>(
+                std::uniform_int_distribution<size_t>(1, 100000)(rng), DATA_SIZE - offset);
+            const size_t read = *ivfc_file->Read(offset, length, &buffer[offset]);
+            REQUIRE(read == length);
+            offset += read;
+            reads++;
+        }
+        REQUIRE(std::equal(buffer.begin(), buffer.end(), &contents[DATA_OFFSET]));
+        expected_bytes += offset;
+
+        // Random reads, including past the end of the data
+        for (int i = 0; i < 100; ++i) {
+            const u64 read_offset = std::uniform_int_distribution<u64>(0, size + 10)(rng);
+            const size_t length = std::uniform_int_distribution<size_t>(0, 5000)(rng);
+            const size_t expected =
+                read_offset < available ? std::min<u64>(length, available - read_offset) : 0;
+            REQUIRE(*ivfc_file->Read(read_offset, length, buffer.data()) == expected);
+            if (expected > 0) {
+                REQUIRE(std::equal(buffer.begin(), buffer.begin() + expected,
+                                   &contents[DATA_OFFSET + read_offset]));
+            }
+            expected_bytes += expected;
+        }
+
+        const IVFCReadStats& stats = archive.GetReadStats();
+        REQUIRE(stats.read_count == reads + 100);
+        REQUIRE(stats.bytes_read == expected_bytes);
+        REQUIRE(stats.sequential_reads >= reads - 1);
+        REQUIRE(stats.max_read_ns <= stats.total_read_ns);
+    }
+
+    file.reset();
+    FileUtil::Delete(ROMFS_FILENAME);
+}
+
+/// Loader of an application whose RomFS is a whole file
+class RomFSLoader : public Loader::AppLoader {
+public:
+    explicit RomFSLoader(std::shared_ptr<FileUtil::IOFile> romfs_file_)
+        : AppLoader(FileUtil::IOFile()), romfs_file(std::move(romfs_file_)) {}
+
+    Loader::FileType GetFileType() override {
+        return Loader::FileType::Unknown;
+    }
+    Loader::ResultStatus Load() override {
+        return Loader::ResultStatus::Success;
+    }
+    Loader::ResultStatus ReadRomFS(std::shared_ptr<FileUtil::IOFile>& file, u64& offset,
+                                   u64& size) override {
+        file = romfs_file;
+        offset = 0;
+        size = romfs_file->GetSize();
+        return Loader::ResultStatus::Success;
+    }
+
+private:
+    std::shared_ptr<FileUtil::IOFile> romfs_file;
+};
+
+TEST_CASE("ArchiveFactory_RomFS - Archives share the mapped RomFS", "[core][file_sys]") {
+    const std::vector<u8> contents(0x10000, 0x5A);
+    {
+        FileUtil::IOFile file(ROMFS_FILENAME, "wb");
+        REQUIRE(file.WriteBytes(contents.data(), contents.size()) == contents.size());
+    }
+
+    {
+        RomFSLoader loader(std::make_shared<FileUtil::IOFile>(ROMFS_FILENAME, "rb"));
+        ArchiveFactory_RomFS factory(loader);
+        auto first = factory.Open(Path("")).MoveFrom();
+        auto second = factory.Open(Path("")).MoveFrom();
+
+        std::vector<u8> buffer(0x100);
+        auto file = first->OpenFile(Path(""), Mode{}).MoveFrom();
+        REQUIRE(*file->Read(0x8000, buffer.size(), buffer.data()) == buffer.size());
+        REQUIRE(std::equal(buffer.begin(), buffer.end(), contents.begin()));
+
+        // The read shows up in the counters of both archives, as they use the same data
+        REQUIRE(static_cast<IVFCArchive&>(*first).GetReadStats().read_count == 1);
+        REQUIRE(static_cast<IVFCArchive&>(*second).GetReadStats().read_count == 1);
+    }
+
+    FileUtil::Delete(ROMFS_FILENAME);
+}
+
+} // namespace FileSys
@@ -0,0 +1,102 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/thread.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+
+namespace Kernel {
+
+static constexpr VAddr ARBITER_ADDRESS = Memory::HEAP_VADDR;
+
+/// Starts a process with a page of each segment, which leaves its main thread running
+static void StartProcess() {
+    auto codeset = CodeSet::Create("arbiter", 0x0004000000123400);
+    codeset->memory = std::make_shared<std::vector<u8>>(3 * Memory::PAGE_SIZE, 0);
+    CodeSet::Segment* const segments[] = {&codeset->code, &codeset->rodata, &codeset->data};
+    for (u32 i = 0; i < 3; ++i) {
+        segments[i]->offset = i * Memory::PAGE_SIZE;
+        segments[i]->addr = Memory::PROCESS_IMAGE_VADDR + i * Memory::PAGE_SIZE;
+        segments[i]->size = Memory::PAGE_SIZE;
+    }
+    codeset->entrypoint = Memory::PROCESS_IMAGE_VADDR;
+
+    g_current_process = Process::Create(std::move(codeset));
+    g_current_process->resource_limit =
+        ResourceLimit::GetForCategory(ResourceLimitCategory::APPLICATION);
+    g_current_process->Run(48, DEFAULT_STACK_SIZE);
+}
+
+static SharedPtr<Thread> CreateThread(s32 priority) {
+    return Thread::Create("waiter", Memory::PROCESS_IMAGE_VADDR, priority, 0, THREADPROCESSORID_0,
+                          Memory::HEAP_VADDR_END - DEFAULT_STACK_SIZE)
+        .MoveFrom();
+}
+
+TEST_CASE("Thread - Arbitration resumes waiters by priority, then in waiting order",
+          "[core][kernel]") {
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    Memory::Init();
+    CoreTiming::Init();
+    Init(0);
+    StartProcess();
+
+    const SharedPtr<Thread> main_thread = GetCurrentThread();
+    const SharedPtr<Thread> a = CreateThread(40);
+    const SharedPtr<Thread> b = CreateThread(30);
+    const SharedPtr<Thread> c = CreateThread(40);
+    const SharedPtr<Thread> d = CreateThread(30);
+
+    // The threads run and start waiting in the order b, d, a, c, then the main thread runs again
+    for (int i = 0; i < 4; ++i) {
+        Reschedule();
+        WaitCurrentThread_ArbitrateAddress(ARBITER_ADDRESS);
+    }
+    Reschedule();
+    REQUIRE(GetCurrentThread() == main_thread.get());
+    REQUIRE(c->status == THREADSTATUS_WAIT_ARB);
+
+    // Priority changes of waiting threads move them to their new place among the waiters
+    c->SetPriority(20);
+    b->SetPriority(35);
+    a->SetPriority(30);
+
+    // Waiters: c (20), d (30), a (30), b (35)
+    REQUIRE(ArbitrateHighestPriorityThread(ARBITER_ADDRESS) == c.get());
+    REQUIRE(c->status == THREADSTATUS_READY);
+    REQUIRE(ArbitrateHighestPriorityThread(ARBITER_ADDRESS) == d.get());
+    REQUIRE(ArbitrateHighestPriorityThread(ARBITER_ADDRESS) == a.get());
+    REQUIRE(ArbitrateHighestPriorityThread(ARBITER_ADDRESS) == b.get());
+    REQUIRE(ArbitrateHighestPriorityThread(ARBITER_ADDRESS) == nullptr);
+
+    // Waiting again on the address after it was emptied works like the first time
+    for (int i = 0; i < 2; ++i) {
+        Reschedule();
+        WaitCurrentThread_ArbitrateAddress(ARBITER_ADDRESS);
+    }
+    REQUIRE(c->status == THREADSTATUS_WAIT_ARB);
+    REQUIRE(d->status == THREADSTATUS_WAIT_ARB);
+    ArbitrateAllThreads(ARBITER_ADDRESS);
+    REQUIRE(c->status == THREADSTATUS_READY);
+    REQUIRE(d->status == THREADSTATUS_READY);
+    REQUIRE(ArbitrateHighestPriorityThread(ARBITER_ADDRESS) == nullptr);
+
+    Shutdown();
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+    Memory::InitMemoryMap();
+}
+
+} // namespace Kernel
@@ -0,0 +1,137 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "common/string_util.h"
+#include "common/thread.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/hle/service/gsp_gpu.h"
+#include "core/hw/gpu_thread.h"
+
+namespace GPUThread {
+
+/// Window without a rendering context, for running the GPU thread
+class NullWindow : public EmuWindow {
+public:
+    void SwapBuffers() override {}
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+    void ReloadSetKeymaps() override {}
+};
+
+TEST_CASE("GPUThread - Work runs in the order it was queued", "[core][gpu]") {
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    CoreTiming::Init();
+    std::vector<int> order;
+
+    // Without the GPU thread, the work runs right away
+    REQUIRE(RunAsynchronously([&order] { order.push_back(0); }) == 0);
+    REQUIRE(order == std::vector<int>{0});
+
+    NullWindow window;
+    Init(&window);
+    order.clear();
+
+    const u64 first = RunAsynchronously([&order] { order.push_back(1); });
+    const u64 second = RunAsynchronously([&order] {
+        // Synchronous work queued by the GPU thread itself can't wait for the queue
+        RunSynchronously([&order] { order.push_back(2); });
+        order.push_back(3);
+    });
+    REQUIRE(second > first);
+
+    // Waiting for the work also waits for the work queued before it
+    RunSynchronously([&order] { order.push_back(4); });
+    REQUIRE(order == std::vector<int>{1, 2, 3, 4});
+
+    RunAsynchronously([&order] { order.push_back(5); });
+    Shutdown();
+    REQUIRE(order == std::vector<int>{1, 2, 3, 4, 5});
+
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+}
+
+TEST_CASE("GPUThread - Waiting for a fence runs the work queued for the CPU thread",
+          "[core][gpu]") {
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    CoreTiming::Init();
+    NullWindow window;
+    Init(&window);
+
+    const std::thread::id cpu_thread = std::this_thread::get_id();
+    std::vector<int> order;
+    bool on_cpu_thread = true;
+    const u64 fence = Push([&] {
+        for (int i = 0; i < 3; ++i) {
+            RunOnCPUThread([&, i] {
+                on_cpu_thread &= std::this_thread::get_id() == cpu_thread;
+                order.push_back(i);
+            });
+        }
+    });
+    WaitForFence(fence);
+    REQUIRE(order == std::vector<int>{0, 1, 2});
+    REQUIRE(on_cpu_thread);
+
+    // The CoreTiming event scheduled for it doesn't run it again
+    CoreTiming::Advance();
+    REQUIRE(order == std::vector<int>{0, 1, 2});
+
+    Shutdown();
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+}
+
+TEST_CASE("GPUThread - Interrupts are delivered at the time their work was queued",
+          "[core][gpu]") {
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    CoreTiming::Init();
+    NullWindow window;
+    Init(&window);
+
+    Core::CPU().down_count -= 100;
+    const s64 queued_ticks = static_cast<s64>(CoreTiming::GetTicks());
+
+    std::vector<int> order;
+    Common::Event done;
+    Push([&order, &done] {
+        RunOnCPUThread([&order] { order.push_back(0); });
+        DeferInterrupt(Service::GSP::InterruptId::PSC0);
+        done.Set();
+    });
+
+    // The CPU thread goes on while the GPU thread runs the work
+    Core::CPU().down_count -= 500;
+    done.Wait();
+    REQUIRE(order.empty());
+
+    CoreTiming::MoveEvents();
+    const std::string interrupt = Common::StringFromFormat(
+        "GPUThread::Interrupt : %i %08x%08x\n", static_cast<int>(queued_ticks), 0,
+        static_cast<u32>(Service::GSP::InterruptId::PSC0));
+    REQUIRE(CoreTiming::GetScheduledEventsSummary().find(interrupt) != std::string::npos);
+
+    // The interrupt is already due, and the work queued before it runs first
+    CoreTiming::Advance();
+    REQUIRE(order == std::vector<int>{0});
+    REQUIRE(CoreTiming::GetScheduledEventsSummary().find("GPUThread::") == std::string::npos);
+
+    Shutdown();
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+}
+
+} // namespace GPUThread
@@ -0,0 +1,311 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "common/thread.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/frontend/emu_window.h"
+#include "core/hle/kernel/process.h"
+#include "core/hw/gpu_thread.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "tests/benchmark.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/video_core.h"
+
+namespace Memory {
+
+TEST_CASE("Memory - Block functions span pages with separate backings", "[core][memory]") {
+    InitMemoryMap();
+
+    // Two pages with contiguous backing, then a page backed by separate memory
+    std::vector<u8> first(2 * PAGE_SIZE, 0);
+    std::vector<u8> second(PAGE_SIZE, 0);
+    MapMemoryRegion(0x10000, 2 * PAGE_SIZE, first.data());
+    MapMemoryRegion(0x12000, PAGE_SIZE, second.data());
+
+    std::vector<u8> data(3 * PAGE_SIZE - 0x20);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7);
+    }
+    WriteBlock(0x10010, data.data(), data.size());
+    REQUIRE(first[0x10] == data[0]);
+    REQUIRE(second[PAGE_SIZE - 0x11] == data.back());
+
+    std::vector<u8> read(data.size());
+    ReadBlock(0x10010, read.data(), read.size());
+    REQUIRE(read == data);
+
+    CopyBlock(0x10000, 0x10010, 2 * PAGE_SIZE);
+    REQUIRE(std::memcmp(first.data(), data.data(), 2 * PAGE_SIZE) == 0);
+
+    ZeroBlock(0x11ff0, 0x20);
+    REQUIRE(first[2 * PAGE_SIZE - 1] == 0);
+    REQUIRE(second[0x0f] == 0);
+    REQUIRE(second[0x11] == data[0x2001]);
+
+    REQUIRE(GetContiguousSpan(0x10010, 2 * PAGE_SIZE - 0x10, false) == first.data() + 0x10);
+    REQUIRE(GetContiguousSpan(0x10010, 2 * PAGE_SIZE, false) == nullptr);
+    REQUIRE(GetContiguousSpan(0x12000, PAGE_SIZE + 1, true) == nullptr);
+
+    UnmapRegion(0x10000, 3 * PAGE_SIZE);
+}
+
+TEST_CASE("Memory - Writes to code pages invalidate the translated code", "[core][memory]") {
+    InitMemoryMap();
+    std::vector<u8> memory(3 * PAGE_SIZE, 0);
+    MapMemoryRegion(0x10000, 3 * PAGE_SIZE, memory.data());
+    const auto& jit_pointers = *GetCurrentPageTablePointers();
+
+    // An empty region doesn't mark any page
+    MarkRegionAsCode(0x11000, 0);
+    Write32(0x10ffc, 1);
+    Write32(0x11000, 1);
+    REQUIRE(GetAccessStats().code_invalidations == 0);
+    REQUIRE(jit_pointers[0x10] == memory.data());
+    REQUIRE(jit_pointers[0x11] == memory.data() + PAGE_SIZE);
+
+    MarkRegionAsCode(0x10ffe, 4);
+    REQUIRE(jit_pointers[0x10] == nullptr);
+    REQUIRE(jit_pointers[0x11] == nullptr);
+    REQUIRE(jit_pointers[0x12] == memory.data() + 2 * PAGE_SIZE);
+
+    // Typed writes leave the fast path and still write the memory
+    Write8(0x10000, 0x12);
+    Write16(0x10002, 0x3456);
+    Write32(0x11004, 0x789abcde);
+    Write64(0x11008, 0x0123456789abcdefULL);
+    REQUIRE(GetAccessStats().code_invalidations == 4);
+    REQUIRE(Read8(0x10000) == 0x12);
+    REQUIRE(Read16(0x10002) == 0x3456);
+    REQUIRE(Read32(0x11004) == 0x789abcde);
+    REQUIRE(Read64(0x11008) == 0x0123456789abcdefULL);
+
+    Write32(0x12000, 1);
+    WriteBlock(0x12004, memory.data(), 8);
+    REQUIRE(GetAccessStats().code_invalidations == 4);
+
+    const u32 value = 0x11223344;
+    WriteBlock(0x11ffe, &value, sizeof(value));
+    ZeroBlock(0x10010, 4);
+    CopyBlock(0x11010, 0x12000, 4);
+    REQUIRE(GetAccessStats().code_invalidations == 7);
+
+    // Mapping the same memory again keeps the code, mapping other memory invalidates it
+    MapMemoryRegion(0x10000, 2 * PAGE_SIZE, memory.data());
+    REQUIRE(GetAccessStats().code_invalidations == 7);
+    std::vector<u8> other(PAGE_SIZE, 0);
+    MapMemoryRegion(0x11000, PAGE_SIZE, other.data());
+    REQUIRE(GetAccessStats().code_invalidations == 8);
+    REQUIRE(jit_pointers[0x11] == other.data());
+    Write32(0x11000, 1);
+    REQUIRE(GetAccessStats().code_invalidations == 8);
+
+    UnmapRegion(0x10000, 3 * PAGE_SIZE);
+}
+
+TEST_CASE("Memory - JIT reads of code pages are counted", "[core][memory]") {
+    InitMemoryMap();
+    std::vector<u8> memory(2 * PAGE_SIZE, 0);
+    MapMemoryRegion(0x10000, 2 * PAGE_SIZE, memory.data());
+    MarkRegionAsCode(0x10000, 4);
+    Write32(0x10004, 0x12345678);
+
+    REQUIRE(JitRead32(0x10004) == 0x12345678);
+    REQUIRE(JitRead8(0x10004) == 0x78);
+    REQUIRE(JitRead64(0x11000) == 0);
+    REQUIRE(GetAccessStats().jit_code_page_reads == 2);
+
+    // The other Read functions don't count
+    Read16(0x10004);
+    REQUIRE(GetAccessStats().jit_code_page_reads == 2);
+
+    UnmapRegion(0x10000, 2 * PAGE_SIZE);
+}
+
+static constexpr PAddr SURFACE_ADDR = VRAM_PADDR + 0x1000;
+static constexpr u32 SURFACE_SIZE = 2 * PAGE_SIZE;
+
+/// Caches a single surface, which is rendered to and written back to memory once flushed
+class SingleSurfaceRasterizer : public VideoCore::RasterizerInterface {
+public:
+    void AddTriangle(const Pica::Shader::OutputVertex& v0, const Pica::Shader::OutputVertex& v1,
+                     const Pica::Shader::OutputVertex& v2) override {}
+    void DrawTriangles() override {}
+    void NotifyPicaRegisterChanged(u32 id) override {}
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {
+        if (!cached || addr >= SURFACE_ADDR + SURFACE_SIZE || SURFACE_ADDR >= addr + size)
+            return;
+
+        std::memset(GetPhysicalPointer(SURFACE_ADDR), 0xAB, SURFACE_SIZE);
+        RasterizerMarkRegionCached(SURFACE_ADDR, SURFACE_SIZE, -1);
+        cached = false;
+        ++flushes;
+    }
+
+    void CacheSurface() {
+        RasterizerMarkRegionCached(SURFACE_ADDR, SURFACE_SIZE, 1);
+        cached = true;
+    }
+
+    bool cached = false;
+    int flushes = 0;
+};
+
+class SingleSurfaceRenderer : public RendererBase {
+public:
+    SingleSurfaceRenderer() {
+        rasterizer = std::make_unique<SingleSurfaceRasterizer>();
+    }
+    void SwapBuffers(const ScreenConfig& screen_config) override {}
+    void SetWindow(EmuWindow* window) override {}
+    bool Init() override {
+        return true;
+    }
+    void ShutDown() override {}
+
+    SingleSurfaceRasterizer& GetRasterizer() const {
+        return static_cast<SingleSurfaceRasterizer&>(*Rasterizer());
+    }
+};
+
+TEST_CASE("Memory - A read of a rasterizer cached page releases it", "[core][memory]") {
+    InitMemoryMap();
+    Kernel::g_current_process = Kernel::Process::Create(Kernel::CodeSet::Create("", 0));
+    VideoCore::g_renderer = std::make_unique<SingleSurfaceRenderer>();
+    auto& rasterizer = static_cast<SingleSurfaceRenderer&>(*VideoCore::g_renderer).GetRasterizer();
+
+    const VAddr surface_vaddr = PhysicalToVirtualAddress(SURFACE_ADDR);
+    Write32(surface_vaddr + PAGE_SIZE, 0x12345678);
+    rasterizer.CacheSurface();
+
+    // The read flushes the whole surface and sees the rendered data
+    REQUIRE(Read32(surface_vaddr + PAGE_SIZE) == 0xABABABAB);
+    REQUIRE(rasterizer.flushes == 1);
+    REQUIRE(GetAccessStats().rasterizer_cached_memory == 1);
+    REQUIRE(GetAccessStats().released_cached_pages == 1);
+
+    // Both pages of the surface are back on the fast path
+    REQUIRE(Read32(surface_vaddr) == 0xABABABAB);
+    Write32(surface_vaddr + PAGE_SIZE, 0);
+    REQUIRE(GetAccessStats().rasterizer_cached_memory == 1);
+    REQUIRE(rasterizer.flushes == 1);
+
+    // Until the surface is cached again
+    rasterizer.CacheSurface();
+    Write32(surface_vaddr, 0);
+    REQUIRE(rasterizer.flushes == 2);
+    REQUIRE(GetAccessStats().rasterizer_cached_memory == 2);
+    REQUIRE(GetAccessStats().released_cached_pages == 2);
+
+    VideoCore::g_renderer.reset();
+    Kernel::g_current_process = nullptr;
+    InitMemoryMap();
+}
+
+/// Window without a rendering context, for running the GPU thread
+class NullWindow : public EmuWindow {
+public:
+    void SwapBuffers() override {}
+    void PollEvents() override {}
+    void MakeCurrent() override {}
+    void DoneCurrent() override {}
+    void ReloadSetKeymaps() override {}
+};
+
+TEST_CASE("Memory - A draw on the GPU thread and a CPU write share a page", "[core][memory]") {
+    InitMemoryMap();
+    Kernel::g_current_process = Kernel::Process::Create(Kernel::CodeSet::Create("", 0));
+    VideoCore::g_renderer = std::make_unique<SingleSurfaceRenderer>();
+    auto& rasterizer = static_cast<SingleSurfaceRenderer&>(*VideoCore::g_renderer).GetRasterizer();
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    CoreTiming::Init();
+    NullWindow window;
+    GPUThread::Init(&window);
+
+    const VAddr surface_vaddr = PhysicalToVirtualAddress(SURFACE_ADDR);
+    Write32(surface_vaddr, 0x12345678);
+
+    Common::Event drawn;
+    GPUThread::Push([&rasterizer, &drawn] {
+        rasterizer.CacheSurface();
+        drawn.Set();
+    });
+    drawn.Wait();
+
+    // The GPU thread doesn't touch the page table, the pages stay on the fast path until the CPU
+    // thread takes the change over
+    REQUIRE(Read32(surface_vaddr) == 0x12345678);
+    REQUIRE(GetAccessStats().rasterizer_cached_memory == 0);
+
+    CoreTiming::Advance();
+    REQUIRE(Read32(surface_vaddr + PAGE_SIZE) == 0xABABABAB);
+    REQUIRE(rasterizer.flushes == 1);
+    REQUIRE(GetAccessStats().rasterizer_cached_memory == 1);
+
+    // The flush on the GPU thread uncaches the pages again before the read goes on
+    REQUIRE(GetAccessStats().released_cached_pages == 1);
+    Write32(surface_vaddr, 0x87654321);
+    REQUIRE(Read32(surface_vaddr) == 0x87654321);
+    REQUIRE(GetAccessStats().rasterizer_cached_memory == 1);
+
+    // The same from a write, with the draw synced by waiting for it
+    GPUThread::WaitForFence(GPUThread::Push([&rasterizer] { rasterizer.CacheSurface(); }));
+    Write32(surface_vaddr, 0x11111111);
+    REQUIRE(rasterizer.flushes == 2);
+    REQUIRE(GetAccessStats().released_cached_pages == 2);
+    REQUIRE(Read32(surface_vaddr) == 0x11111111);
+    REQUIRE(Read32(surface_vaddr + PAGE_SIZE) == 0xABABABAB);
+    REQUIRE(GetAccessStats().rasterizer_cached_memory == 2);
+
+    GPUThread::Shutdown();
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+    VideoCore::g_renderer.reset();
+    Kernel::g_current_process = nullptr;
+    InitMemoryMap();
+}
+
+TEST_CASE("Memory - Block copy throughput", "[.benchmark]") {
+    // Small copies stay in the host caches and show the per-page overhead, large ones are bound
+    // by the memory bandwidth
+    for (u32 size : {64 * 1024, 16 * 1024 * 1024}) {
+        const int iterations = (256 * 1024 * 1024) / size;
+
+        InitMemoryMap();
+        std::vector<u8> source(size, 0x55);
+        std::vector<u8> dest(size);
+        MapMemoryRegion(0x10000000, size, source.data());
+        MapMemoryRegion(0x20000000, size, dest.data());
+
+        auto Measure = [&](const char* name, auto run) {
+            Benchmark::Measure(std::string(name) + ", " + std::to_string(size) + " bytes",
+                               double(size) * iterations, "byte", [&] {
+                                   for (int i = 0; i < iterations; ++i) {
+                                       run();
+                                   }
+                               });
+        };
+
+        Measure("memcpy", [&] { std::memcpy(dest.data(), source.data(), size); });
+        Measure("CopyBlock", [&] { CopyBlock(0x20000000, 0x10000000, size); });
+        Measure("ReadBlock", [&] { ReadBlock(0x10000000, dest.data(), size); });
+        Measure("WriteBlock", [&] { WriteBlock(0x20000000, source.data(), size); });
+
+        UnmapRegion(0x10000000, size);
+        UnmapRegion(0x20000000, size);
+    }
+}
+
+} // namespace Memory
@@ -0,0 +1,142 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+#include <vector>
+#include <catch.hpp>
+#include "audio_core/audio_core.h"
+#include "core/arm/dyncom/arm_dyncom.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/kernel.h"
+#include "core/hle/kernel/memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/resource_limit.h"
+#include "core/hle/kernel/thread.h"
+#include "core/hw/hw.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "core/savestate.h"
+
+namespace SaveState {
+
+static constexpr VAddr DATA_VADDR = Memory::PROCESS_IMAGE_VADDR + 2 * Memory::PAGE_SIZE;
+
+/// Starts a process with a page of each segment, like the loaders do
+static void StartProcess() {
+    auto codeset = Kernel::CodeSet::Create("savestate", 0x0004000000123400);
+    codeset->memory = std::make_shared<std::vector<u8>>(3 * Memory::PAGE_SIZE, 0);
+    Kernel::CodeSet::Segment* const segments[] = {&codeset->code, &codeset->rodata,
+                                                  &codeset->data};
+    for (u32 i = 0; i < 3; ++i) {
+        segments[i]->offset = i * Memory::PAGE_SIZE;
+        segments[i]->addr = Memory::PROCESS_IMAGE_VADDR + i * Memory::PAGE_SIZE;
+        segments[i]->size = Memory::PAGE_SIZE;
+    }
+    codeset->entrypoint = Memory::PROCESS_IMAGE_VADDR;
+
+    Kernel::g_current_process = Kernel::Process::Create(std::move(codeset));
+    Kernel::g_current_process->resource_limit =
+        Kernel::ResourceLimit::GetForCategory(Kernel::ResourceLimitCategory::APPLICATION);
+    Kernel::g_current_process->Run(48, Kernel::DEFAULT_STACK_SIZE);
+}
+
+TEST_CASE("SaveState - A loaded state saves to the same bytes", "[core]") {
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    Memory::Init();
+    CoreTiming::Init();
+    HW::Init();
+    Kernel::Init(0);
+    AudioCore::Init();
+    AudioCore::SelectSink("null");
+    StartProcess();
+
+    Memory::Write32(DATA_VADDR, 0x12345678);
+    Core::CPU().SetReg(0, 0xCAFE);
+
+    std::vector<u8> first;
+    REQUIRE(Save(first));
+
+    // Loading undoes the changes made since the save
+    Memory::Write32(DATA_VADDR, 0);
+    Core::CPU().SetReg(0, 0);
+    Kernel::Thread::Create("extra", Memory::PROCESS_IMAGE_VADDR, 40, 0, 0,
+                           Memory::HEAP_VADDR_END - Kernel::DEFAULT_STACK_SIZE);
+    REQUIRE(Load(first));
+    REQUIRE(Memory::Read32(DATA_VADDR) == 0x12345678);
+    REQUIRE(Core::CPU().GetReg(0) == 0xCAFE);
+
+    std::vector<u8> second;
+    REQUIRE(Save(second));
+    REQUIRE(second.size() == first.size());
+    REQUIRE(second == first);
+
+    AudioCore::Shutdown();
+    Kernel::Shutdown();
+    HW::Shutdown();
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+    Memory::InitMemoryMap();
+}
+
+TEST_CASE("SaveState - A corrupted state is rejected before anything is loaded", "[core]") {
+    auto previous_cpu =
+        Core::System::GetInstance().SetCPU(std::make_unique<ARM_DynCom>(USER32MODE));
+    Memory::Init();
+    CoreTiming::Init();
+    HW::Init();
+    Kernel::Init(0);
+    AudioCore::Init();
+    AudioCore::SelectSink("null");
+    StartProcess();
+
+    Memory::Write32(DATA_VADDR, 0x12345678);
+    std::vector<u8> state;
+    REQUIRE(Save(state));
+    Memory::Write32(DATA_VADDR, 0);
+
+    // The header is followed by the first record: the literal size, the literals, the zero run
+    constexpr size_t HEADER_SIZE = 32;
+    constexpr size_t BODY_SIZE_OFFSET = 16;
+    u32 literal_size;
+    std::memcpy(&literal_size, &state[HEADER_SIZE], sizeof(literal_size));
+    const size_t zero_run_offset = HEADER_SIZE + sizeof(literal_size) + literal_size;
+
+    SECTION("a body size no state has") {
+        const u64 body_size = u64(1) << 40;
+        std::memcpy(&state[BODY_SIZE_OFFSET], &body_size, sizeof(body_size));
+        REQUIRE(!Load(state));
+    }
+
+    SECTION("a zero run past the body size") {
+        const u32 zero_run = 0xFFFFFFFF;
+        std::memcpy(&state[zero_run_offset], &zero_run, sizeof(zero_run));
+        REQUIRE(!Load(state));
+    }
+
+    SECTION("literals past the body size") {
+        REQUIRE(literal_size > 1);
+        const u64 body_size = literal_size / 2;
+        std::memcpy(&state[BODY_SIZE_OFFSET], &body_size, sizeof(body_size));
+        REQUIRE(!Load(state));
+    }
+
+    SECTION("a body shorter than the header says") {
+        state.resize(zero_run_offset);
+        REQUIRE(!Load(state));
+    }
+
+    REQUIRE(Memory::Read32(DATA_VADDR) == 0);
+
+    AudioCore::Shutdown();
+    Kernel::Shutdown();
+    HW::Shutdown();
+    CoreTiming::Shutdown();
+    Core::System::GetInstance().SetCPU(std::move(previous_cpu));
+    Memory::InitMemoryMap();
+}
+
+} // namespace SaveState
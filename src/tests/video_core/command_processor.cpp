@@ -0,0 +1,248 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "video_core/command_processor.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_base.h"
+#include "video_core/shader/shader.h"
+#include "video_core/video_core.h"
+
+namespace Pica {
+
+using Shader::OutputVertex;
+
+static constexpr PAddr VERTEX_DATA_ADDR = Memory::VRAM_PADDR;
+static constexpr u32 INDEX_DATA_OFFSET = 0x100000;
+static constexpr u32 NUM_UNIQUE_VERTICES = 2000;
+/// Well above the threshold for processing a draw on the vertex thread pool
+static constexpr u32 NUM_INDICES = 3 * 4000;
+
+/// Records the triangles submitted by the command processor
+class CapturingRasterizer : public VideoCore::RasterizerInterface {
+public:
+    void AddTriangle(const OutputVertex& v0, const OutputVertex& v1,
+                     const OutputVertex& v2) override {
+        triangles.push_back({{v0, v1, v2}});
+    }
+    void DrawTriangles() override {}
+    void NotifyPicaRegisterChanged(u32 id) override {}
+    void FlushAll() override {}
+    void FlushRegion(PAddr addr, u32 size) override {}
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
+
+    std::vector<std::array<OutputVertex, 3>> triangles;
+};
+
+class CapturingRenderer : public RendererBase {
+public:
+    CapturingRenderer() {
+        rasterizer = std::make_unique<CapturingRasterizer>();
+    }
+    void SwapBuffers(const ScreenConfig& screen_config) override {}
+    void SetWindow(EmuWindow* window) override {}
+    bool Init() override {
+        return true;
+    }
+    void ShutDown() override {}
+
+    CapturingRasterizer& GetRasterizer() const {
+        return static_cast<CapturingRasterizer&>(*Rasterizer());
+    }
+};
+
+static u32 EncodeInstruction(u32 opcode, u32 dest, u32 src1, u32 src2, u32 operand_desc) {
+    return (opcode << 26) | (dest << 21) | (src1 << 12) | (src2 << 7) | operand_desc;
+}
+
+/**
+ * Sets up an indexed triangle list draw of two float attributes, with a vertex shader that outputs
+ * the first attribute as the position, the second as the color and their sum as a texture
+ * coordinate.
+ */
+static void SetupIndexedDraw(std::vector<u8>& vram) {
+    g_state.Reset();
+    auto& regs = g_state.regs;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+    float* vertex_data = reinterpret_cast<float*>(vram.data());
+    for (u32 i = 0; i < NUM_UNIQUE_VERTICES * 8; ++i) {
+        vertex_data[i] = dist(rng);
+    }
+    u16* index_data = reinterpret_cast<u16*>(vram.data() + INDEX_DATA_OFFSET);
+    for (u32 i = 0; i < NUM_INDICES; ++i) {
+        index_data[i] = static_cast<u16>(rng() % NUM_UNIQUE_VERTICES);
+    }
+
+    // Two attributes of four floats each, loaded by a single loader with a stride of 32 bytes
+    const size_t attributes_index = PICA_REG_INDEX(vertex_attributes);
+    regs[attributes_index] = VERTEX_DATA_ADDR / 8;
+    regs[attributes_index + 1] = 0xFF;
+    regs[attributes_index + 2] = 1 << 28;
+    regs[attributes_index + 3] = 0;
+    regs[attributes_index + 4] = 0x10;
+    regs[attributes_index + 5] = (2 << 28) | (32 << 16);
+
+    regs[PICA_REG_INDEX(index_array)] = INDEX_DATA_OFFSET | (1u << 31);
+    regs.num_vertices = NUM_INDICES;
+
+    auto& setup = g_state.vs;
+    setup.swizzle_data[0] = 0xf | (0x1b << 5) | (0x1b << 14) | (0x1b << 23);
+    setup.program_code[0] = EncodeInstruction(0x13, 0x0, 0x00, 0, 0);   // mov o0, v0
+    setup.program_code[1] = EncodeInstruction(0x13, 0x1, 0x01, 0, 0);   // mov o1, v1
+    setup.program_code[2] = EncodeInstruction(0x00, 0x2, 0x00, 0x1, 0); // add o2, v0, v1
+    setup.program_code[3] = EncodeInstruction(0x22, 0, 0, 0, 0);        // end
+
+    regs.vs.input_register_map.attribute1_register.Assign(1);
+    regs.vs.output_mask.Assign(0x7);
+    regs.vs_output_total.Assign(3);
+
+    using Semantic = Regs::VSOutputAttributes::Semantic;
+    auto MapOutput = [&regs](unsigned index, Semantic x, Semantic y, Semantic z, Semantic w) {
+        regs.vs_output_attributes[index].map_x.Assign(x);
+        regs.vs_output_attributes[index].map_y.Assign(y);
+        regs.vs_output_attributes[index].map_z.Assign(z);
+        regs.vs_output_attributes[index].map_w.Assign(w);
+    };
+    MapOutput(0, Semantic::POSITION_X, Semantic::POSITION_Y, Semantic::POSITION_Z,
+              Semantic::POSITION_W);
+    MapOutput(1, Semantic::COLOR_R, Semantic::COLOR_G, Semantic::COLOR_B, Semantic::COLOR_A);
+    MapOutput(2, Semantic::TEXCOORD0_U, Semantic::TEXCOORD0_V, Semantic::INVALID,
+              Semantic::INVALID);
+}
+
+/// Runs the draw set up by SetupIndexedDraw and returns the triangles it produced
+static std::vector<std::array<OutputVertex, 3>> RunDraw(u16 num_threads, bool indexed = true) {
+    VideoCore::g_vertex_shader_threads = num_threads;
+
+    auto& rasterizer = static_cast<CapturingRenderer&>(*VideoCore::g_renderer).GetRasterizer();
+    rasterizer.triangles.clear();
+
+    CommandProcessor::CommandHeader header{};
+    header.cmd_id.Assign(indexed ? PICA_REG_INDEX(trigger_draw_indexed)
+                                 : PICA_REG_INDEX(trigger_draw));
+    header.parameter_mask.Assign(0xF);
+    const std::array<u32, 2> command_list = {{1, header.hex}};
+    CommandProcessor::ProcessCommandList(command_list.data(), sizeof(command_list));
+
+    return std::move(rasterizer.triangles);
+}
+
+static bool VerticesEqual(const OutputVertex& a, const OutputVertex& b) {
+    return std::memcmp(&a.pos, &b.pos, sizeof(a.pos)) == 0 &&
+           std::memcmp(&a.color, &b.color, sizeof(a.color)) == 0 &&
+           std::memcmp(&a.tc0, &b.tc0, sizeof(a.tc0)) == 0;
+}
+
+TEST_CASE("CommandProcessor - Parallel vertex processing matches the serial path",
+          "[video_core]") {
+    std::vector<u8> vram(Memory::VRAM_SIZE);
+    Memory::InitMemoryMap();
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+    VideoCore::g_renderer = std::make_unique<CapturingRenderer>();
+
+    SetupIndexedDraw(vram);
+    const auto expected = RunDraw(1);
+    REQUIRE(expected.size() == NUM_INDICES / 3);
+
+    // Check the serial path itself against the vertex data
+    const float* vertex_data = reinterpret_cast<const float*>(vram.data());
+    const u16* index_data = reinterpret_cast<const u16*>(vram.data() + INDEX_DATA_OFFSET);
+    for (u32 i = 0; i < NUM_INDICES; ++i) {
+        const auto& vertex = expected[i / 3][i % 3];
+        REQUIRE(vertex.pos.x.ToFloat32() == vertex_data[index_data[i] * 8]);
+        REQUIRE(vertex.color.w.ToFloat32() == vertex_data[index_data[i] * 8 + 7]);
+    }
+
+    for (u16 num_threads : {2, 4, 7}) {
+        INFO(num_threads << " threads");
+        SetupIndexedDraw(vram);
+        const auto triangles = RunDraw(num_threads);
+        REQUIRE(triangles.size() == expected.size());
+        for (size_t i = 0; i < triangles.size(); ++i) {
+            for (int vertex = 0; vertex < 3; ++vertex) {
+                REQUIRE(VerticesEqual(triangles[i][vertex], expected[i][vertex]));
+            }
+        }
+    }
+
+    VideoCore::g_vertex_shader_threads = 1;
+    VideoCore::g_renderer.reset();
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+}
+
+TEST_CASE("CommandProcessor - Non-indexed draws shade consecutive vertices", "[video_core]") {
+    std::vector<u8> vram(Memory::VRAM_SIZE);
+    Memory::InitMemoryMap();
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+    VideoCore::g_renderer = std::make_unique<CapturingRenderer>();
+
+    // Enough vertices for the thread pool, starting at an offset
+    constexpr u32 VERTEX_OFFSET = 2;
+    constexpr u32 NUM_VERTICES = NUM_UNIQUE_VERTICES - 5;
+    const float* vertex_data = reinterpret_cast<const float*>(vram.data());
+
+    for (u16 num_threads : {1, 4}) {
+        INFO(num_threads << " threads");
+        SetupIndexedDraw(vram);
+        g_state.regs.num_vertices = NUM_VERTICES;
+        g_state.regs.vertex_offset = VERTEX_OFFSET;
+        const auto triangles = RunDraw(num_threads, false);
+        REQUIRE(triangles.size() == NUM_VERTICES / 3);
+        for (u32 i = 0; i < NUM_VERTICES; ++i) {
+            const auto& vertex = triangles[i / 3][i % 3];
+            REQUIRE(vertex.pos.x.ToFloat32() == vertex_data[(VERTEX_OFFSET + i) * 8]);
+            REQUIRE(vertex.color.w.ToFloat32() == vertex_data[(VERTEX_OFFSET + i) * 8 + 7]);
+        }
+    }
+
+    VideoCore::g_vertex_shader_threads = 1;
+    VideoCore::g_renderer.reset();
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+}
+
+TEST_CASE("CommandProcessor - A debug context alone keeps draws on the thread pool",
+          "[video_core]") {
+    std::vector<u8> vram(Memory::VRAM_SIZE);
+    Memory::InitMemoryMap();
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+    VideoCore::g_renderer = std::make_unique<CapturingRenderer>();
+
+    SetupIndexedDraw(vram);
+    const auto expected = RunDraw(1);
+
+    // The frontends always create a debug context. Without a trace being recorded or a breakpoint
+    // on shader invocations, it must not force draws onto the serial path.
+    g_debug_context = DebugContext::Construct();
+    g_debug_context->breakpoints[(int)DebugContext::Event::BufferSwapped].enabled = true;
+
+    SetupIndexedDraw(vram);
+    const u64 parallel_draws = CommandProcessor::GetParallelDrawCount();
+    const auto triangles = RunDraw(4);
+    REQUIRE(CommandProcessor::GetParallelDrawCount() == parallel_draws + 1);
+    REQUIRE(triangles.size() == expected.size());
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        for (int vertex = 0; vertex < 3; ++vertex) {
+            REQUIRE(VerticesEqual(triangles[i][vertex], expected[i][vertex]));
+        }
+    }
+
+    g_debug_context.reset();
+    VideoCore::g_vertex_shader_threads = 1;
+    VideoCore::g_renderer.reset();
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+}
+
+} // namespace Pica
@@ -0,0 +1,156 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "common/file_util.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace GLShader {
+
+static const std::string CACHE_FILENAME = "gl_shader_disk_cache_test.bin";
+
+static PicaShaderConfig MakeConfig(u8 seed) {
+    PicaShaderConfig config;
+    std::memset(&config, seed, sizeof(config));
+    return config;
+}
+
+static std::vector<u8> MakeBinary(size_t size, u8 seed) {
+    std::vector<u8> binary(size);
+    for (size_t i = 0; i < size; ++i) {
+        binary[i] = static_cast<u8>(seed + i * 7);
+    }
+    return binary;
+}
+
+TEST_CASE("ProgramDiskCache - Entries are read back", "[video_core][opengl]") {
+    FileUtil::Delete(CACHE_FILENAME);
+
+    {
+        ProgramDiskCache cache;
+        REQUIRE(cache.Open(CACHE_FILENAME).empty());
+        cache.Append(MakeConfig(1), 0x1234, MakeBinary(100, 1));
+        cache.Append(MakeConfig(2), 0x5678, MakeBinary(3000, 2));
+        cache.Close();
+    }
+
+    {
+        ProgramDiskCache cache;
+        const auto entries = cache.Open(CACHE_FILENAME);
+        REQUIRE(entries.size() == 2);
+        REQUIRE(entries[0].config == MakeConfig(1));
+        REQUIRE(entries[0].binary_format == 0x1234);
+        REQUIRE(entries[0].binary == MakeBinary(100, 1));
+        REQUIRE(entries[1].config == MakeConfig(2));
+        REQUIRE(entries[1].binary_format == 0x5678);
+        REQUIRE(entries[1].binary == MakeBinary(3000, 2));
+
+        // Entries appended after reading go after the existing ones
+        cache.Append(MakeConfig(3), 0x9abc, MakeBinary(10, 3));
+        cache.Close();
+    }
+
+    {
+        ProgramDiskCache cache;
+        const auto entries = cache.Open(CACHE_FILENAME);
+        REQUIRE(entries.size() == 3);
+        REQUIRE(entries[2].config == MakeConfig(3));
+        REQUIRE(entries[2].binary == MakeBinary(10, 3));
+
+        cache.Clear();
+        cache.Close();
+    }
+
+    {
+        ProgramDiskCache cache;
+        REQUIRE(cache.Open(CACHE_FILENAME).empty());
+        cache.Close();
+    }
+
+    FileUtil::Delete(CACHE_FILENAME);
+}
+
+TEST_CASE("ProgramDiskCache - Truncated entries are dropped", "[video_core][opengl]") {
+    FileUtil::Delete(CACHE_FILENAME);
+
+    {
+        ProgramDiskCache cache;
+        cache.Open(CACHE_FILENAME);
+        cache.Append(MakeConfig(1), 0x1234, MakeBinary(100, 1));
+        cache.Append(MakeConfig(2), 0x5678, MakeBinary(100, 2));
+        cache.Close();
+    }
+
+    // Simulate the emulator being killed while the last entry was being written
+    {
+        FileUtil::IOFile file(CACHE_FILENAME, "r+b");
+        REQUIRE(file.Resize(file.GetSize() - 50));
+    }
+
+    {
+        ProgramDiskCache cache;
+        const auto entries = cache.Open(CACHE_FILENAME);
+        REQUIRE(entries.size() == 1);
+        REQUIRE(entries[0].config == MakeConfig(1));
+
+        // The partial entry is overwritten by the next one
+        cache.Append(MakeConfig(3), 0x9abc, MakeBinary(10, 3));
+        cache.Close();
+    }
+
+    {
+        ProgramDiskCache cache;
+        const auto entries = cache.Open(CACHE_FILENAME);
+        REQUIRE(entries.size() == 2);
+        REQUIRE(entries[1].config == MakeConfig(3));
+        REQUIRE(entries[1].binary == MakeBinary(10, 3));
+        cache.Close();
+    }
+
+    FileUtil::Delete(CACHE_FILENAME);
+}
+
+TEST_CASE("ProgramDiskCache - Caches written by another build are discarded",
+          "[video_core][opengl]") {
+    FileUtil::Delete(CACHE_FILENAME);
+
+    {
+        ProgramDiskCache cache;
+        cache.Open(CACHE_FILENAME);
+        cache.Append(MakeConfig(1), 0x1234, MakeBinary(100, 1));
+        cache.Close();
+    }
+
+    // Change the revision stored in the header, which follows the 4-byte id and the two sizes
+    {
+        FileUtil::IOFile file(CACHE_FILENAME, "r+b");
+        REQUIRE(file.Seek(8, SEEK_SET));
+        const char other_revision[] = "0123456789abcdef";
+        REQUIRE(file.WriteBytes(other_revision, sizeof(other_revision)) == sizeof(other_revision));
+    }
+
+    {
+        ProgramDiskCache cache;
+        REQUIRE(cache.Open(CACHE_FILENAME).empty());
+
+        // The file is recreated for this build
+        cache.Append(MakeConfig(2), 0x5678, MakeBinary(10, 2));
+        cache.Close();
+    }
+
+    {
+        ProgramDiskCache cache;
+        const auto entries = cache.Open(CACHE_FILENAME);
+        REQUIRE(entries.size() == 1);
+        REQUIRE(entries[0].config == MakeConfig(2));
+        cache.Close();
+    }
+
+    FileUtil::Delete(CACHE_FILENAME);
+}
+
+} // namespace GLShader
@@ -0,0 +1,174 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "tests/benchmark.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/rasterizer.h"
+#include "video_core/rasterizer_coverage.h"
+#include "video_core/shader/shader.h"
+#include "video_core/video_core.h"
+
+namespace Pica {
+
+static constexpr u32 FRAMEBUFFER_WIDTH = 256;
+static constexpr u32 FRAMEBUFFER_HEIGHT = 240;
+static constexpr PAddr COLOR_BUFFER_ADDR = Memory::VRAM_PADDR;
+static constexpr PAddr DEPTH_BUFFER_ADDR = Memory::VRAM_PADDR + 0x100000;
+static constexpr size_t BUFFER_SIZE = FRAMEBUFFER_WIDTH * FRAMEBUFFER_HEIGHT * 4;
+
+static void SetupRegisters() {
+    g_state.Reset();
+    auto& regs = g_state.regs;
+
+    regs.framebuffer.color_buffer_address = COLOR_BUFFER_ADDR / 8;
+    regs.framebuffer.depth_buffer_address = DEPTH_BUFFER_ADDR / 8;
+    regs.framebuffer.width.Assign(FRAMEBUFFER_WIDTH);
+    regs.framebuffer.height.Assign(FRAMEBUFFER_HEIGHT - 1);
+    regs.framebuffer.color_format.Assign(Regs::ColorFormat::RGBA8);
+    regs.framebuffer.depth_format = Regs::DepthFormat::D24S8;
+    regs.framebuffer.allow_color_write.Assign(1);
+    regs.framebuffer.allow_depth_stencil_write.Assign(1);
+
+    regs.viewport_depth_range.Assign(0x3F0000); // 1.0 in float24
+    regs.depthmap_enable.Assign(Regs::DepthBuffering::ZBuffering);
+
+    // Depth testing and alpha blending both make the result depend on the primitive order
+    auto& output_merger = regs.output_merger;
+    output_merger.depth_test_enable.Assign(1);
+    output_merger.depth_test_func.Assign(Regs::CompareFunc::LessThanOrEqual);
+    output_merger.depth_write_enable.Assign(1);
+    output_merger.red_enable.Assign(1);
+    output_merger.green_enable.Assign(1);
+    output_merger.blue_enable.Assign(1);
+    output_merger.alpha_enable.Assign(1);
+    output_merger.alphablend_enable.Assign(1);
+    output_merger.alpha_blending.factor_source_rgb.Assign(Regs::BlendFactor::SourceAlpha);
+    output_merger.alpha_blending.factor_dest_rgb.Assign(Regs::BlendFactor::OneMinusSourceAlpha);
+    output_merger.alpha_blending.factor_source_a.Assign(Regs::BlendFactor::One);
+    output_merger.alpha_blending.factor_dest_a.Assign(Regs::BlendFactor::Zero);
+}
+
+static std::vector<Shader::OutputVertex> GenerateTriangles(unsigned count) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> x_dist(0.0f, FRAMEBUFFER_WIDTH);
+    std::uniform_real_distribution<float> y_dist(0.0f, FRAMEBUFFER_HEIGHT);
+    std::uniform_real_distribution<float> unit_dist(0.0f, 1.0f);
+
+    std::vector<Shader::OutputVertex> vertices(count * 3);
+    for (auto& vertex : vertices) {
+        std::memset(&vertex, 0, sizeof(vertex));
+        vertex.pos.w = float24::FromFloat32(1.0f);
+        vertex.screenpos = Math::MakeVec(float24::FromFloat32(x_dist(rng)),
+                                         float24::FromFloat32(y_dist(rng)),
+                                         float24::FromFloat32(unit_dist(rng)));
+        vertex.color = Math::MakeVec(
+            float24::FromFloat32(unit_dist(rng)), float24::FromFloat32(unit_dist(rng)),
+            float24::FromFloat32(unit_dist(rng)), float24::FromFloat32(unit_dist(rng)));
+    }
+    return vertices;
+}
+
+static void Render(const std::vector<Shader::OutputVertex>& vertices, u16 num_threads) {
+    VideoCore::g_sw_rasterizer_threads = num_threads;
+
+    std::memset(Memory::GetPhysicalPointer(COLOR_BUFFER_ADDR), 0, BUFFER_SIZE);
+    std::memset(Memory::GetPhysicalPointer(DEPTH_BUFFER_ADDR), 0xFF, BUFFER_SIZE);
+
+    for (size_t i = 0; i < vertices.size(); i += 3) {
+        Rasterizer::ProcessTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+    }
+    Rasterizer::Flush();
+}
+
+TEST_CASE("Rasterizer - Multi-threaded output matches single-threaded", "[video_core]") {
+    std::vector<u8> vram(Memory::VRAM_SIZE);
+    Memory::InitMemoryMap();
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+
+    SetupRegisters();
+    const auto vertices = GenerateTriangles(500);
+
+    Render(vertices, 1);
+    const std::vector<u8> expected_color(vram.begin(), vram.begin() + BUFFER_SIZE);
+    const std::vector<u8> expected_depth(vram.begin() + 0x100000,
+                                         vram.begin() + 0x100000 + BUFFER_SIZE);
+
+    for (u16 num_threads : {2, 4, 7}) {
+        Render(vertices, num_threads);
+        REQUIRE(std::equal(expected_color.begin(), expected_color.end(), vram.begin()));
+        REQUIRE(std::equal(expected_depth.begin(), expected_depth.end(), vram.begin() + 0x100000));
+    }
+
+    VideoCore::g_sw_rasterizer_threads = 1;
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+}
+
+TEST_CASE("Rasterizer - Coverage evaluators give the same output", "[video_core]") {
+    std::vector<u8> vram(Memory::VRAM_SIZE);
+    Memory::InitMemoryMap();
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+
+    SetupRegisters();
+    const auto vertices = GenerateTriangles(500);
+
+    Rasterizer::SetCoverageEvaluator(&Rasterizer::coverage_evaluator_generic);
+    Render(vertices, 1);
+    const std::vector<u8> expected(vram.begin(), vram.begin() + 0x100000 + BUFFER_SIZE);
+
+    for (const auto* evaluator : Rasterizer::GetSupportedCoverageEvaluators()) {
+        INFO("Evaluator: " << evaluator->name);
+        Rasterizer::SetCoverageEvaluator(evaluator);
+        Render(vertices, 1);
+        REQUIRE(std::equal(expected.begin(), expected.end(), vram.begin()));
+    }
+
+    Rasterizer::SetCoverageEvaluator(nullptr);
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+}
+
+TEST_CASE("Rasterizer - Pixel throughput", "[.benchmark]") {
+    std::vector<u8> vram(Memory::VRAM_SIZE);
+    Memory::InitMemoryMap();
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+
+    SetupRegisters();
+    const auto vertices = GenerateTriangles(5000);
+
+    // The pixels the triangles cover, from their areas
+    double pixels = 0.0;
+    for (size_t i = 0; i < vertices.size(); i += 3) {
+        float x[3], y[3];
+        for (size_t v = 0; v < 3; ++v) {
+            x[v] = vertices[i + v].screenpos.x.ToFloat32();
+            y[v] = vertices[i + v].screenpos.y.ToFloat32();
+        }
+        pixels += std::abs((x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0])) / 2;
+    }
+
+    // The whole pipeline of each coverage path: coverage, interpolation, texturing and blending
+    for (const auto* evaluator : Rasterizer::GetSupportedCoverageEvaluators()) {
+        Rasterizer::SetCoverageEvaluator(evaluator);
+        for (u16 num_threads : {1, 4}) {
+            Benchmark::Measure(std::string(evaluator->name) + ", " +
+                                   std::to_string(num_threads) + " thread(s)",
+                               pixels, "pixel", [&] { Render(vertices, num_threads); });
+        }
+    }
+
+    Rasterizer::SetCoverageEvaluator(nullptr);
+    VideoCore::g_sw_rasterizer_threads = 1;
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+}
+
+} // namespace Pica
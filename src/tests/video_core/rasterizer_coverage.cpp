@@ -0,0 +1,106 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <string>
+#include <vector>
+#include <catch.hpp>
+#include "tests/benchmark.h"
+#include "video_core/rasterizer_coverage.h"
+
+namespace Pica {
+namespace Rasterizer {
+
+static CoverageSetup GenerateSetup(std::mt19937& rng) {
+    // 12.4 fixed point coordinates on a 400x240 render target, with some vertices outside of it
+    std::uniform_int_distribution<int> x_dist(-0x200, 0x1A00);
+    std::uniform_int_distribution<int> y_dist(-0x200, 0x1000);
+    std::uniform_int_distribution<int> bias_dist(-1, 0);
+
+    int vtx_x[3], vtx_y[3];
+    for (int i = 0; i < 3; ++i) {
+        vtx_x[i] = x_dist(rng);
+        vtx_y[i] = y_dist(rng);
+    }
+
+    CoverageSetup setup;
+    for (int i = 0; i < 3; ++i) {
+        const int a = (i + 1) % 3;
+        const int b = (i + 2) % 3;
+        setup.edges[i] = {vtx_x[a], vtx_y[a], vtx_x[b] - vtx_x[a], vtx_y[b] - vtx_y[a],
+                          bias_dist(rng)};
+    }
+
+    setup.max_x = 400 * 16;
+    setup.max_y = 240 * 16;
+    setup.scissor_exclude = std::uniform_int_distribution<int>(0, 1)(rng) != 0;
+    setup.scissor_x1 = std::uniform_int_distribution<int>(0, 200)(rng) * 16;
+    setup.scissor_y1 = std::uniform_int_distribution<int>(0, 120)(rng) * 16;
+    setup.scissor_x2 = setup.scissor_x1 + std::uniform_int_distribution<int>(0, 200)(rng) * 16;
+    setup.scissor_y2 = setup.scissor_y1 + std::uniform_int_distribution<int>(0, 120)(rng) * 16;
+    return setup;
+}
+
+/// Returns the coverage of the whole render target as one bit per pixel
+static std::vector<bool> EvaluateCoverage(const CoverageEvaluator& evaluator,
+                                          const CoverageSetup& setup) {
+    std::vector<bool> coverage(400 * 240);
+    for (int y = 8; y < setup.max_y; y += 0x20) {
+        for (int x = 8; x < setup.max_x; x += 0x10 * evaluator.block_width) {
+            const u32 mask = evaluator.evaluate(setup, x, y);
+            for (unsigned lane = 0; lane < evaluator.block_width * 2; ++lane) {
+                if (mask & (1 << lane)) {
+                    const int px = x / 16 + lane % evaluator.block_width;
+                    const int py = y / 16 + lane / evaluator.block_width;
+                    REQUIRE(px < 400);
+                    REQUIRE(py < 240);
+                    coverage[py * 400 + px] = true;
+                }
+            }
+        }
+    }
+    return coverage;
+}
+
+TEST_CASE("Rasterizer - Coverage evaluators match the generic implementation", "[video_core]") {
+    std::mt19937 rng(1234);
+    const auto evaluators = GetSupportedCoverageEvaluators();
+
+    for (int i = 0; i < 200; ++i) {
+        const CoverageSetup setup = GenerateSetup(rng);
+        const auto expected = EvaluateCoverage(coverage_evaluator_generic, setup);
+
+        for (const CoverageEvaluator* evaluator : evaluators) {
+            INFO("Evaluator: " << evaluator->name);
+            REQUIRE(EvaluateCoverage(*evaluator, setup) == expected);
+        }
+    }
+}
+
+TEST_CASE("Rasterizer - Coverage evaluator throughput", "[.benchmark]") {
+    std::mt19937 rng(1234);
+    std::vector<CoverageSetup> setups(1000);
+    for (auto& setup : setups)
+        setup = GenerateSetup(rng);
+
+    const double pixels = static_cast<double>(setups.size()) * 400 * 240;
+    for (const CoverageEvaluator* evaluator : GetSupportedCoverageEvaluators()) {
+        const unsigned block_width = evaluator->block_width;
+        u32 covered = 0;
+
+        Benchmark::Measure(std::string("Coverage only, ") + evaluator->name, pixels, "pixel", [&] {
+            for (const auto& setup : setups) {
+                for (int y = 8; y < setup.max_y; y += 0x20) {
+                    for (int x = 8; x < setup.max_x; x += 0x10 * block_width) {
+                        covered += evaluator->evaluate(setup, x, y) != 0;
+                    }
+                }
+            }
+        });
+        REQUIRE(covered > 0);
+    }
+}
+
+} // namespace Rasterizer
+} // namespace Pica
@@ -0,0 +1,396 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+#include <catch.hpp>
+#include "tests/benchmark.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/shader/shader_jit_x64.h"
+#endif // ARCHITECTURE_x86_64
+#include "video_core/video_core.h"
+
+namespace Pica {
+namespace Shader {
+
+// Raw encodings of the instructions used by the test program
+static constexpr u32 OPCODE_ADD = 0x00;
+static constexpr u32 OPCODE_DP4 = 0x02;
+static constexpr u32 OPCODE_MUL = 0x08;
+static constexpr u32 OPCODE_MAX = 0x0C;
+static constexpr u32 OPCODE_RCP = 0x0E;
+static constexpr u32 OPCODE_MOVA = 0x12;
+static constexpr u32 OPCODE_MOV = 0x13;
+static constexpr u32 OPCODE_END = 0x22;
+static constexpr u32 OPCODE_CALL = 0x24;
+static constexpr u32 OPCODE_IFC = 0x28;
+static constexpr u32 OPCODE_LOOP = 0x29;
+static constexpr u32 OPCODE_CMP = 0x2E;
+
+static constexpr u32 REG_INPUT = 0x00;
+static constexpr u32 REG_TEMPORARY = 0x10;
+static constexpr u32 REG_UNIFORM = 0x20;
+static constexpr u32 REG_OUTPUT = 0x00;
+
+static u32 EncodeInstruction(u32 opcode, u32 dest, u32 src1, u32 src2, u32 operand_desc) {
+    return (opcode << 26) | (dest << 21) | (src1 << 12) | (src2 << 7) | operand_desc;
+}
+
+/// Encodes an instruction whose first source is offset by the given address register (1-3)
+static u32 EncodeIndexed(u32 opcode, u32 dest, u32 src1, u32 src2, u32 operand_desc,
+                         u32 address_register) {
+    return EncodeInstruction(opcode, dest, src1, src2, operand_desc) | (address_register << 19);
+}
+
+static u32 EncodeFlowControl(u32 opcode, u32 dest_offset, u32 num_instructions) {
+    return (opcode << 26) | (dest_offset << 10) | num_instructions;
+}
+
+static constexpr u32 COMPARE_GREATER_THAN = 4;
+
+/// Encodes a CMP, whose comparison modes take the place of the destination register
+static u32 EncodeCompare(u32 compare_x, u32 compare_y, u32 src1, u32 src2, u32 operand_desc) {
+    return (OPCODE_CMP << 26) | (compare_x << 24) | (compare_y << 21) | (src1 << 12) | (src2 << 7) |
+           operand_desc;
+}
+
+static u32 EncodeSwizzle(u32 dest_mask) {
+    // All source registers unswizzled and not negated
+    return dest_mask | (0x1b << 5) | (0x1b << 14) | (0x1b << 23);
+}
+
+/**
+ * Sets up a typical vertex shader: transforms v0 by the matrix in c0-c3, scales v1 by c4 and
+ * outputs the sum of both inputs as a texture coordinate.
+ */
+static void SetupShader() {
+    g_state.Reset();
+    auto& regs = g_state.regs;
+    auto& setup = g_state.vs;
+
+    setup.swizzle_data[0] = EncodeSwizzle(0x8);
+    setup.swizzle_data[1] = EncodeSwizzle(0x4);
+    setup.swizzle_data[2] = EncodeSwizzle(0x2);
+    setup.swizzle_data[3] = EncodeSwizzle(0x1);
+    setup.swizzle_data[4] = EncodeSwizzle(0xf);
+
+    unsigned pc = 0;
+    for (u32 i = 0; i < 4; ++i) {
+        setup.program_code[pc++] =
+            EncodeInstruction(OPCODE_DP4, REG_OUTPUT + 0, REG_UNIFORM + i, REG_INPUT + 0, i);
+    }
+    setup.program_code[pc++] =
+        EncodeInstruction(OPCODE_MUL, REG_OUTPUT + 1, REG_UNIFORM + 4, REG_INPUT + 1, 4);
+    setup.program_code[pc++] =
+        EncodeInstruction(OPCODE_ADD, REG_TEMPORARY + 0, REG_INPUT + 0, REG_INPUT + 1, 4);
+    setup.program_code[pc++] =
+        EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 2, REG_TEMPORARY + 0, 0, 4);
+    setup.program_code[pc++] = EncodeInstruction(OPCODE_END, 0, 0, 0, 0);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    for (unsigned i = 0; i < 5; ++i) {
+        setup.uniforms.f[i] =
+            Math::MakeVec(float24::FromFloat32(dist(rng)), float24::FromFloat32(dist(rng)),
+                          float24::FromFloat32(dist(rng)), float24::FromFloat32(dist(rng)));
+    }
+
+    regs.vs.input_register_map.attribute1_register.Assign(1);
+    regs.vs.output_mask.Assign(0x7);
+    regs.vs_output_total.Assign(3);
+
+    using Semantic = Regs::VSOutputAttributes::Semantic;
+    auto MapOutput = [&regs](unsigned index, Semantic x, Semantic y, Semantic z, Semantic w) {
+        regs.vs_output_attributes[index].map_x.Assign(x);
+        regs.vs_output_attributes[index].map_y.Assign(y);
+        regs.vs_output_attributes[index].map_z.Assign(z);
+        regs.vs_output_attributes[index].map_w.Assign(w);
+    };
+    MapOutput(0, Semantic::POSITION_X, Semantic::POSITION_Y, Semantic::POSITION_Z,
+              Semantic::POSITION_W);
+    MapOutput(1, Semantic::COLOR_R, Semantic::COLOR_G, Semantic::COLOR_B, Semantic::COLOR_A);
+    MapOutput(2, Semantic::TEXCOORD0_U, Semantic::TEXCOORD0_V, Semantic::INVALID,
+              Semantic::INVALID);
+}
+
+static std::vector<InputVertex> GenerateInputs(size_t count) {
+    std::mt19937 rng(5678);
+    std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+
+    std::vector<InputVertex> inputs(count);
+    for (auto& input : inputs) {
+        std::memset(&input, 0, sizeof(input));
+        for (unsigned attribute = 0; attribute < 2; ++attribute) {
+            for (unsigned comp = 0; comp < 4; ++comp) {
+                input.attr[attribute][comp] = float24::FromFloat32(dist(rng));
+            }
+        }
+    }
+    return inputs;
+}
+
+/// Runs the shader one vertex at a time, the way the command processor used to
+static std::vector<OutputVertex> RunSerial(ShaderEngine& engine,
+                                           const std::vector<InputVertex>& inputs) {
+    // Zeroed, so that the registers a shader reads before writing them are the same in each run
+    UnitState state{};
+    engine.SetupBatch(g_state.vs, 0);
+
+    std::vector<OutputVertex> outputs(inputs.size());
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        state.LoadInputVertex(inputs[i], 2);
+        engine.Run(g_state.vs, state);
+        outputs[i] = OutputVertex::FromRegisters(state.registers.output, g_state.regs,
+                                                 g_state.regs.vs.output_mask);
+    }
+    return outputs;
+}
+
+static std::vector<OutputVertex> RunBatched(ShaderEngine& engine,
+                                            const std::vector<InputVertex>& inputs) {
+    UnitState state{};
+    engine.SetupBatch(g_state.vs, 0);
+
+    std::vector<OutputVertex> outputs(inputs.size());
+    engine.RunBatch(g_state.vs, state, inputs.data(), 2, outputs.data(), inputs.size());
+    return outputs;
+}
+
+/// Compares the attributes written by the test shader bit by bit
+static bool OutputsEqual(const std::vector<OutputVertex>& a, const std::vector<OutputVertex>& b) {
+    if (a.size() != b.size())
+        return false;
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::memcmp(&a[i].pos, &b[i].pos, sizeof(a[i].pos)) != 0 ||
+            std::memcmp(&a[i].color, &b[i].color, sizeof(a[i].color)) != 0 ||
+            std::memcmp(&a[i].tc0, &b[i].tc0, sizeof(a[i].tc0)) != 0)
+            return false;
+    }
+    return true;
+}
+
+TEST_CASE("Shader - Batched execution matches per-vertex execution", "[video_core][shader]") {
+    SetupShader();
+    const auto inputs = GenerateInputs(1000);
+
+    InterpreterEngine interpreter;
+    const auto expected = RunSerial(interpreter, inputs);
+    REQUIRE(OutputsEqual(RunBatched(interpreter, inputs), expected));
+
+#ifdef ARCHITECTURE_x86_64
+    JitX64Engine jit;
+    REQUIRE(OutputsEqual(RunSerial(jit, inputs), expected));
+    REQUIRE(OutputsEqual(RunBatched(jit, inputs), expected));
+#endif // ARCHITECTURE_x86_64
+}
+
+TEST_CASE("Shader - END inside a subroutine ends the program", "[video_core][shader]") {
+    SetupShader();
+    auto& program_code = g_state.vs.program_code;
+    program_code.fill(0);
+
+    // The MOV following the CALL must not run, as the subroutine ends the program
+    program_code[0] = EncodeFlowControl(OPCODE_CALL, 3, 4);
+    program_code[1] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 0, REG_INPUT + 1, 0, 4);
+    program_code[2] = EncodeInstruction(OPCODE_END, 0, 0, 0, 0);
+    program_code[3] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 0, REG_INPUT + 0, 0, 4);
+    program_code[4] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 1, REG_INPUT + 1, 0, 4);
+    program_code[5] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 2, REG_INPUT + 0, 0, 4);
+    program_code[6] = EncodeInstruction(OPCODE_END, 0, 0, 0, 0);
+
+    const auto inputs = GenerateInputs(100);
+
+    InterpreterEngine interpreter;
+    const auto expected = RunSerial(interpreter, inputs);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        REQUIRE(std::memcmp(&expected[i].pos, &inputs[i].attr[0], sizeof(expected[i].pos)) == 0);
+    }
+
+#ifdef ARCHITECTURE_x86_64
+    // Ending the program also has to unwind the subroutine's stack frame, otherwise the batch
+    // loop would return to the wrong place
+    JitX64Engine jit;
+    REQUIRE(OutputsEqual(RunSerial(jit, inputs), expected));
+    REQUIRE(OutputsEqual(RunBatched(jit, inputs), expected));
+#endif // ARCHITECTURE_x86_64
+}
+
+/// Makes each input vertex's first attribute start with a small integer, to be used as an index
+static void SetIndices(std::vector<InputVertex>& inputs, int modulo) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i].attr[0].x = float24::FromFloat32(static_cast<float>((i * 7) % modulo));
+    }
+}
+
+TEST_CASE("Shader - Lanes index and loop over uniforms like single vertices",
+          "[video_core][shader]") {
+    SetupShader();
+    auto& setup = g_state.vs;
+    auto& program_code = setup.program_code;
+    program_code.fill(0);
+
+    // The uniform read through a0 differs between the vertices of a batch
+    unsigned pc = 0;
+    program_code[pc++] = EncodeInstruction(OPCODE_MOVA, 0, REG_INPUT + 0, 0, 0);
+    program_code[pc++] = EncodeIndexed(OPCODE_MOV, REG_OUTPUT + 0, REG_UNIFORM + 10, 0, 4, 1);
+    program_code[pc++] = EncodeInstruction(OPCODE_MOV, REG_TEMPORARY + 1, REG_UNIFORM + 5, 0, 4);
+    program_code[pc++] = EncodeFlowControl(OPCODE_LOOP, 4, 0);
+    program_code[pc++] =
+        EncodeIndexed(OPCODE_ADD, REG_TEMPORARY + 1, REG_UNIFORM + 20, REG_TEMPORARY + 1, 4, 3);
+    program_code[pc++] = EncodeInstruction(OPCODE_RCP, REG_OUTPUT + 1, REG_INPUT + 1, 0, 4);
+    program_code[pc++] =
+        EncodeInstruction(OPCODE_MAX, REG_OUTPUT + 2, REG_TEMPORARY + 1, REG_INPUT + 1, 4);
+    program_code[pc++] = EncodeInstruction(OPCODE_END, 0, 0, 0, 0);
+
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> dist(-2.0f, 2.0f);
+    for (unsigned i = 5; i < 30; ++i) {
+        setup.uniforms.f[i] =
+            Math::MakeVec(float24::FromFloat32(dist(rng)), float24::FromFloat32(dist(rng)),
+                          float24::FromFloat32(dist(rng)), float24::FromFloat32(dist(rng)));
+    }
+    // Four iterations, aL going from 2 to 8 in steps of 2
+    setup.uniforms.i[0] = Math::MakeVec<u8>(3, 2, 2, 0);
+
+    auto inputs = GenerateInputs(1000);
+    SetIndices(inputs, 8);
+
+    InterpreterEngine interpreter;
+    const auto expected = RunSerial(interpreter, inputs);
+    REQUIRE(OutputsEqual(RunBatched(interpreter, inputs), expected));
+    REQUIRE(interpreter.GetStats().lockstep_vertices == inputs.size());
+    REQUIRE(interpreter.GetStats().serial_vertices == 0);
+
+#ifdef ARCHITECTURE_x86_64
+    JitX64Engine jit;
+    REQUIRE(OutputsEqual(RunBatched(jit, inputs), expected));
+#endif // ARCHITECTURE_x86_64
+}
+
+TEST_CASE("Shader - Lanes taking different branches run one vertex at a time",
+          "[video_core][shader]") {
+    SetupShader();
+    auto& setup = g_state.vs;
+    auto& program_code = setup.program_code;
+    program_code.fill(0);
+
+    // Outputs v0 or v1 depending on whether c0.x > v0.x, the uniform can only be the first source
+    program_code[0] = EncodeCompare(COMPARE_GREATER_THAN, COMPARE_GREATER_THAN, REG_UNIFORM + 0,
+                                    REG_INPUT + 0, 4);
+    program_code[1] = EncodeFlowControl(OPCODE_IFC, 3, 1) | (1 << 25) | (2 << 22);
+    program_code[2] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 0, REG_INPUT + 0, 0, 4);
+    program_code[3] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 0, REG_INPUT + 1, 0, 4);
+    program_code[4] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 1, REG_INPUT + 1, 0, 4);
+    program_code[5] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 2, REG_INPUT + 0, 0, 4);
+    program_code[6] = EncodeInstruction(OPCODE_END, 0, 0, 0, 0);
+    setup.uniforms.f[0] = Math::Vec4<float24>::AssignToAll(float24::Zero());
+
+    // The first vertices all take the same branch, the rest at random
+    auto inputs = GenerateInputs(1000);
+    for (size_t i = 0; i < 64; ++i) {
+        inputs[i].attr[0].x = float24::FromFloat32(-1.0f - i);
+    }
+
+    InterpreterEngine interpreter;
+    const auto expected = RunSerial(interpreter, inputs);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const bool less = inputs[i].attr[0].x.ToFloat32() < 0.0f;
+        REQUIRE(std::memcmp(&expected[i].pos, &inputs[i].attr[less ? 0 : 1],
+                            sizeof(expected[i].pos)) == 0);
+    }
+
+    REQUIRE(OutputsEqual(RunBatched(interpreter, inputs), expected));
+    const auto stats = interpreter.GetStats();
+    REQUIRE(stats.lockstep_vertices >= 64);
+    REQUIRE(stats.serial_vertices > 0);
+    REQUIRE(stats.lockstep_vertices + stats.serial_vertices == inputs.size());
+}
+
+TEST_CASE("Shader - Registers left behind by the previous vertex are seen by the next",
+          "[video_core][shader]") {
+    SetupShader();
+    auto& program_code = g_state.vs.program_code;
+    program_code.fill(0);
+
+    // Each vertex outputs the sum of its v0 and the one of the vertex before it
+    program_code[0] =
+        EncodeInstruction(OPCODE_ADD, REG_OUTPUT + 0, REG_INPUT + 0, REG_TEMPORARY + 0, 4);
+    program_code[1] = EncodeInstruction(OPCODE_MOV, REG_TEMPORARY + 0, REG_INPUT + 0, 0, 4);
+    program_code[2] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 1, REG_INPUT + 1, 0, 4);
+    program_code[3] = EncodeInstruction(OPCODE_MOV, REG_OUTPUT + 2, REG_INPUT + 0, 0, 4);
+    program_code[4] = EncodeInstruction(OPCODE_END, 0, 0, 0, 0);
+
+    const auto inputs = GenerateInputs(100);
+
+    InterpreterEngine interpreter;
+    const auto expected = RunSerial(interpreter, inputs);
+    REQUIRE(OutputsEqual(RunBatched(interpreter, inputs), expected));
+    REQUIRE(interpreter.GetStats().lockstep_vertices == 0);
+    REQUIRE(interpreter.GetStats().serial_vertices == inputs.size());
+}
+
+#ifdef ARCHITECTURE_x86_64
+TEST_CASE("Shader - Asynchronous compilation falls back to the interpreter",
+          "[video_core][shader]") {
+    SetupShader();
+    const auto inputs = GenerateInputs(1000);
+
+    InterpreterEngine interpreter;
+    const auto expected = RunBatched(interpreter, inputs);
+
+    VideoCore::g_async_shader_compilation = true;
+    {
+        JitX64Engine jit;
+
+        // The first batch is run by the interpreter while the shader compiles
+        REQUIRE(OutputsEqual(RunBatched(jit, inputs), expected));
+        REQUIRE(g_state.vs.engine_data.cached_shader == nullptr);
+        REQUIRE(jit.GetStats().fallbacks == 1);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (jit.GetStats().background_compiles == 0 &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // Once compiled, the same batch runs on the JIT
+        REQUIRE(OutputsEqual(RunBatched(jit, inputs), expected));
+        REQUIRE(g_state.vs.engine_data.cached_shader != nullptr);
+        REQUIRE(jit.GetStats().background_compiles == 1);
+        REQUIRE(OutputsEqual(RunSerial(jit, inputs), expected));
+    }
+    VideoCore::g_async_shader_compilation = false;
+}
+#endif // ARCHITECTURE_x86_64
+
+TEST_CASE("Shader - Batched execution throughput", "[.benchmark]") {
+    SetupShader();
+    const auto inputs = GenerateInputs(100000);
+
+    const double vertices = static_cast<double>(inputs.size());
+    auto Measure = [vertices](const char* name, auto run) {
+        Benchmark::Measure(name, vertices, "vertex", run);
+    };
+
+    InterpreterEngine interpreter;
+    Measure("Interpreter, per vertex", [&] { RunSerial(interpreter, inputs); });
+    Measure("Interpreter, lockstep batches", [&] { RunBatched(interpreter, inputs); });
+
+#ifdef ARCHITECTURE_x86_64
+    JitX64Engine jit;
+    Measure("JIT, per vertex", [&] { RunSerial(jit, inputs); });
+    Measure("JIT, batched", [&] { RunBatched(jit, inputs); });
+#endif // ARCHITECTURE_x86_64
+}
+
+} // namespace Shader
+} // namespace Pica
@@ -0,0 +1,78 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <catch.hpp>
+#include "video_core/vertex_cache.h"
+
+namespace Pica {
+
+TEST_CASE("VertexCache - Lookups hit inserted vertices only", "[video_core]") {
+    VertexCache cache;
+    cache.Reset(100, 199, 50);
+
+    REQUIRE(cache.Lookup(150) == VertexCache::INVALID_SLOT);
+    REQUIRE(cache.Insert(150) == 0);
+    REQUIRE(cache.Lookup(100) == VertexCache::INVALID_SLOT);
+    REQUIRE(cache.Insert(100) == 1);
+    REQUIRE(cache.Lookup(199) == VertexCache::INVALID_SLOT);
+    REQUIRE(cache.Insert(199) == 2);
+
+    REQUIRE(cache.Lookup(150) == 0);
+    REQUIRE(cache.Lookup(100) == 1);
+    REQUIRE(cache.Lookup(199) == 2);
+    REQUIRE(cache.Lookup(101) == VertexCache::INVALID_SLOT);
+
+    REQUIRE(cache.GetSize() == 3);
+    REQUIRE(cache.GetHits() == 3);
+    REQUIRE(cache.GetMisses() == 4);
+}
+
+TEST_CASE("VertexCache - Slots keep their contents until Reset", "[video_core]") {
+    VertexCache cache;
+    cache.Reset(0, 9, 10);
+
+    const Shader::OutputVertex* first = nullptr;
+    for (u32 vertex = 0; vertex < 10; ++vertex) {
+        const u32 slot = cache.Insert(9 - vertex);
+        cache.GetVertex(slot).pos.x = float24::FromFloat32(static_cast<float>(9 - vertex));
+        if (first == nullptr)
+            first = &cache.GetVertex(slot);
+    }
+
+    // Storage is reserved upfront, so inserting doesn't move previously returned vertices
+    REQUIRE(first == &cache.GetVertex(0));
+    for (u32 vertex = 0; vertex < 10; ++vertex) {
+        const u32 slot = cache.Lookup(vertex);
+        REQUIRE(slot == 9 - vertex);
+        REQUIRE(cache.GetVertex(slot).pos.x.ToFloat32() == static_cast<float>(vertex));
+    }
+}
+
+TEST_CASE("VertexCache - Reset empties the cache and its statistics", "[video_core]") {
+    VertexCache cache;
+    cache.Reset(0, 15, 16);
+    cache.Insert(3);
+    cache.Lookup(3);
+    cache.Lookup(4);
+
+    // The new range doesn't overlap the old one, and vertex 3 has to be gone
+    cache.Reset(3, 1000, 4);
+    REQUIRE(cache.GetSize() == 0);
+    REQUIRE(cache.GetHits() == 0);
+    REQUIRE(cache.GetMisses() == 0);
+    REQUIRE(cache.Lookup(3) == VertexCache::INVALID_SLOT);
+    REQUIRE(cache.Lookup(1000) == VertexCache::INVALID_SLOT);
+
+    // Only as many slots as vertices in the draw are needed, even for a wide index range
+    for (u32 vertex : {3, 500, 1000, 4}) {
+        cache.Insert(vertex);
+    }
+    REQUIRE(cache.GetSize() == 4);
+    REQUIRE(cache.Lookup(500) == 1);
+    REQUIRE(cache.Lookup(4) == 3);
+    REQUIRE(cache.GetMisses() == 2);
+    REQUIRE(cache.GetHits() == 2);
+}
+
+} // namespace Pica
@@ -0,0 +1,150 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <catch.hpp>
+#include "common/alignment.h"
+#include "core/memory.h"
+#include "core/memory_setup.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader.h"
+
+namespace Pica {
+
+static constexpr PAddr VERTEX_DATA_ADDR = Memory::VRAM_PADDR;
+static constexpr u32 NUM_VERTICES = 1000;
+/// Spacing between the data of two attribute loaders, large enough for NUM_VERTICES at the
+/// maximum stride of 255 bytes
+static constexpr u32 LOADER_DATA_SPACING = 0x40000;
+
+/// Writes a 64-bit value to two consecutive registers, low word first
+static void WriteRegisterPair(size_t index, u64 value) {
+    g_state.regs[static_cast<int>(index)] = static_cast<u32>(value);
+    g_state.regs[static_cast<int>(index) + 1] = static_cast<u32>(value >> 32);
+}
+
+/// Fills the attribute registers with a random, valid attribute configuration
+static void SetupRandomAttributes(std::mt19937& rng) {
+    auto& attributes = g_state.regs.vertex_attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.base_address.Assign(VERTEX_DATA_ADDR / 8);
+
+    // The attribute formats and the loaders are 64-bit fields following the base address and
+    // the data offset register, respectively
+    const size_t attribute_config_index = PICA_REG_INDEX(vertex_attributes) + 1;
+    const size_t loader_config_index = attribute_config_index + 3;
+
+    const int num_attributes = std::uniform_int_distribution<int>(1, 12)(rng);
+    std::uniform_int_distribution<int> dist4(0, 3);
+    u64 attribute_config = static_cast<u64>(num_attributes - 1) << 60;
+    for (int i = 0; i < 12; ++i) {
+        attribute_config |= static_cast<u64>(dist4(rng)) << (i * 4);
+    }
+
+    // Spread the attributes over up to three loaders, leaving some of them to the default
+    // attributes and inserting random padding components
+    const int num_loaders = std::uniform_int_distribution<int>(1, 3)(rng);
+    std::vector<int> components[3];
+    for (int i = 0; i < num_attributes; ++i) {
+        if (dist4(rng) == 0) {
+            attribute_config |= 1ULL << (48 + i);
+            continue;
+        }
+        auto& loader_components = components[rng() % num_loaders];
+        if (dist4(rng) == 0 && loader_components.size() < 11) {
+            loader_components.push_back(12 + dist4(rng));
+        }
+        loader_components.push_back(i);
+    }
+
+    WriteRegisterPair(attribute_config_index, attribute_config);
+
+    for (int loader = 0; loader < num_loaders; ++loader) {
+        attributes.attribute_loaders[loader].data_offset =
+            loader * LOADER_DATA_SPACING + dist4(rng) * 4;
+        u64 loader_config = static_cast<u64>(components[loader].size()) << 60;
+
+        u32 size = 0;
+        for (size_t component = 0; component < components[loader].size(); ++component) {
+            const u64 attribute_index = components[loader][component];
+            loader_config |= attribute_index << (component * 4);
+
+            if (attribute_index < 12) {
+                size = Common::AlignUp<u32>(
+                    size, attributes.GetElementSizeInBytes(static_cast<int>(attribute_index)));
+                size += attributes.GetStride(static_cast<int>(attribute_index));
+            } else {
+                size = Common::AlignUp<u32>(size, 4) + static_cast<u32>(attribute_index - 11) * 4;
+            }
+        }
+
+        // Strides larger than the vertex data are allowed, and need not be aligned
+        const u32 stride =
+            std::min<u32>(255, size + std::uniform_int_distribution<u32>(0, 16)(rng));
+        loader_config |= static_cast<u64>(stride) << 48;
+        WriteRegisterPair(loader_config_index + loader * 3, loader_config);
+    }
+
+    for (auto& attribute : g_state.vs_default_attributes) {
+        for (int comp = 0; comp < 4; ++comp) {
+            attribute[comp] = float24::FromFloat32(static_cast<float>(rng() % 1000) - 500.0f);
+        }
+    }
+}
+
+TEST_CASE("VertexLoader - Batch loader matches the interpreted loader", "[video_core]") {
+    std::vector<u8> vram(Memory::VRAM_SIZE);
+    Memory::InitMemoryMap();
+    Memory::MapMemoryRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE, vram.data());
+
+    std::mt19937 rng(1234);
+    g_state.Reset();
+
+    // Random bytes make up random integers and floats (including NaNs and denormals) alike
+    for (auto& byte : vram) {
+        byte = static_cast<u8>(rng());
+    }
+
+    std::vector<u32> vertex_ids(NUM_VERTICES);
+    for (auto& id : vertex_ids) {
+        id = rng() % NUM_VERTICES;
+    }
+
+    DebugUtils::MemoryAccessTracker memory_accesses;
+    for (int iteration = 0; iteration < 500; ++iteration) {
+        SetupRandomAttributes(rng);
+        const auto& attributes = g_state.regs.vertex_attributes;
+        INFO("Iteration " << iteration << ", " << attributes.GetNumTotalAttributes()
+                          << " attributes");
+
+        VertexLoader loader(g_state.regs);
+
+        // Attributes that neither loader touches keep their previous contents
+        std::vector<Shader::InputVertex> expected(NUM_VERTICES);
+        std::vector<Shader::InputVertex> actual(NUM_VERTICES);
+        std::memset(expected.data(), 0, expected.size() * sizeof(Shader::InputVertex));
+        std::memset(actual.data(), 0, actual.size() * sizeof(Shader::InputVertex));
+
+        for (u32 i = 0; i < NUM_VERTICES; ++i) {
+            loader.LoadVertex(VERTEX_DATA_ADDR, i, vertex_ids[i], expected[i], memory_accesses);
+        }
+        loader.LoadVertices(VERTEX_DATA_ADDR, vertex_ids.data(), NUM_VERTICES, actual.data(),
+                            memory_accesses);
+
+        for (u32 i = 0; i < NUM_VERTICES; ++i) {
+            INFO("Vertex " << i);
+            REQUIRE(std::memcmp(&expected[i], &actual[i], sizeof(Shader::InputVertex)) == 0);
+        }
+    }
+
+    Memory::UnmapRegion(Memory::VRAM_VADDR, Memory::VRAM_SIZE);
+}
+
+} // namespace Pica
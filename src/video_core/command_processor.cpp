@@ -2,13 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/thread_pool.h"
 #include "common/vector_math.h"
 #include "core/hle/service/gsp_gpu.h"
 #include "core/hw/gpu.h"
@@ -47,6 +51,185 @@ static const u32 expand_bits_to_bytes[] = {
 
 MICROPROFILE_DEFINE(GPU_Drawing, "GPU", "Drawing", MP_RGB(50, 50, 240));
 
+/// Number of vertices loaded and shaded with one call to the vertex loader and shader engine
+constexpr unsigned int VERTEX_BATCH_SIZE = 64;
+
+/// Draws with at least this many vertices are processed on the vertex thread pool, if enabled
+constexpr unsigned int PARALLEL_VERTEX_THRESHOLD = 1024;
+/// Number of unique vertices processed by one job on the vertex thread pool
+constexpr size_t PARALLEL_VERTEX_CHUNK_SIZE = 4 * VERTEX_BATCH_SIZE;
+
+static std::unique_ptr<Common::ThreadPool> vertex_thread_pool;
+/// Shader unit state of each thread of the vertex thread pool
+static std::vector<Shader::UnitState> vertex_thread_units;
+/// Number of draws processed on the vertex thread pool
+static u64 parallel_draw_count = 0;
+
+/// Returns the thread pool for vertex processing, or nullptr if it is disabled
+static Common::ThreadPool* GetVertexThreadPool() {
+    size_t num_threads = VideoCore::g_vertex_shader_threads;
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+    const size_t current_threads = vertex_thread_pool ? vertex_thread_pool->GetNumThreads() : 1;
+    if (num_threads != current_threads) {
+        if (num_threads == 1) {
+            vertex_thread_pool.reset();
+        } else {
+            vertex_thread_pool = std::make_unique<Common::ThreadPool>(num_threads, "VertexShader");
+        }
+        vertex_thread_units.resize(num_threads);
+    }
+
+    return vertex_thread_pool.get();
+}
+
+/// Post-transform vertex cache of the current draw
+static VertexCache vertex_cache;
+/// Shaded vertices of the current non-indexed draw on the vertex thread pool, which skips the cache
+static std::vector<Shader::OutputVertex> unindexed_vertices;
+
+/// Reads the id of the vertex submitted at each index of a draw
+class DrawIndices {
+public:
+    DrawIndices(const Regs& regs, bool is_indexed) : is_indexed(is_indexed) {
+        const auto& index_info = regs.index_array;
+        index_address = regs.vertex_attributes.GetPhysicalBaseAddress() + index_info.offset;
+        index_address_8 = Memory::GetPhysicalPointer(index_address);
+        index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+        index_u16 = index_info.format != 0;
+        vertex_offset = regs.vertex_offset;
+    }
+
+    bool IsIndexed() const {
+        return is_indexed;
+    }
+
+    u32 operator[](unsigned int index) const {
+        // Indexed rendering doesn't use the start offset
+        if (!is_indexed)
+            return index + vertex_offset;
+        return index_u16 ? index_address_16[index] : index_address_8[index];
+    }
+
+    /// Scans the first `count` indices for the smallest and largest vertex id
+    std::pair<u32, u32> GetRange(unsigned int count) const {
+        if (!is_indexed)
+            return {vertex_offset, vertex_offset + count - 1};
+
+        u32 min_vertex = 0xFFFF;
+        u32 max_vertex = 0;
+        if (index_u16) {
+            for (unsigned int index = 0; index < count; ++index) {
+                min_vertex = std::min<u32>(min_vertex, index_address_16[index]);
+                max_vertex = std::max<u32>(max_vertex, index_address_16[index]);
+            }
+        } else {
+            for (unsigned int index = 0; index < count; ++index) {
+                min_vertex = std::min<u32>(min_vertex, index_address_8[index]);
+                max_vertex = std::max<u32>(max_vertex, index_address_8[index]);
+            }
+        }
+        return {min_vertex, max_vertex};
+    }
+
+    /// Returns the physical address and size of the index buffer entry read for the given index
+    std::pair<PAddr, u32> GetIndexAccess(unsigned int index) const {
+        const u32 size = index_u16 ? 2 : 1;
+        return {index_address + size * index, size};
+    }
+
+private:
+    bool is_indexed;
+    bool index_u16;
+    PAddr index_address;
+    const u8* index_address_8;
+    const u16* index_address_16;
+    u32 vertex_offset;
+};
+
+/// Sends a vertex of the current draw to primitive assembly
+static void SubmitVertex(Shader::OutputVertex& vertex) {
+    using Pica::Shader::OutputVertex;
+    auto AddTriangle = [](const OutputVertex& v0, const OutputVertex& v1, const OutputVertex& v2) {
+        VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
+    };
+
+    g_state.primitive_assembler.SubmitVertex(vertex, AddTriangle);
+}
+
+/**
+ * Loads and shades the vertices of a draw on the vertex thread pool. For indexed draws, the vertex
+ * cache, which has to be reset for the draw, is used to find the unique vertices. Each unique
+ * vertex is then processed exactly once. Afterwards, the vertices are submitted to primitive
+ * assembly in index order.
+ */
+static void ProcessVerticesParallel(Common::ThreadPool& thread_pool, const VertexLoader& loader,
+                                    const DrawIndices& indices) {
+    const auto& regs = g_state.regs;
+    const u32 base_address = regs.vertex_attributes.GetPhysicalBaseAddress();
+    const unsigned int num_vertices = regs.num_vertices;
+
+    // The vertex shaded for unique_vertices[i] is stored in outputs[i]
+    std::vector<u32> unique_vertices;
+    std::vector<u32> vertex_slots;
+    Shader::OutputVertex* outputs;
+    if (indices.IsIndexed()) {
+        vertex_slots.resize(num_vertices);
+        for (unsigned int index = 0; index < num_vertices; ++index) {
+            const u32 vertex = indices[index];
+
+            // -1 is a common special value used for primitive restart. Since it's unknown if the
+            // PICA supports it, and it would mess up the caching, guard against it here.
+            ASSERT(vertex != -1);
+
+            u32 slot = vertex_cache.Lookup(vertex);
+            if (slot == VertexCache::INVALID_SLOT) {
+                slot = vertex_cache.Insert(vertex);
+                unique_vertices.push_back(vertex);
+            }
+            vertex_slots[index] = slot;
+        }
+        // Slots are allocated in the order of unique_vertices
+        outputs = &vertex_cache.GetVertex(0);
+    } else {
+        // Every vertex of a non-indexed draw is used once, so there is nothing to look up
+        unique_vertices.resize(num_vertices);
+        for (unsigned int index = 0; index < num_vertices; ++index) {
+            unique_vertices[index] = indices[index];
+        }
+        unindexed_vertices.resize(num_vertices);
+        outputs = unindexed_vertices.data();
+    }
+
+    auto* shader_engine = Shader::GetEngine();
+    const int num_attributes = loader.GetNumTotalAttributes();
+
+    const size_t num_chunks =
+        (unique_vertices.size() + PARALLEL_VERTEX_CHUNK_SIZE - 1) / PARALLEL_VERTEX_CHUNK_SIZE;
+    thread_pool.ParallelFor(num_chunks, [&](size_t chunk, size_t thread_index) {
+        const size_t chunk_start = chunk * PARALLEL_VERTEX_CHUNK_SIZE;
+        const size_t chunk_end =
+            std::min(chunk_start + PARALLEL_VERTEX_CHUNK_SIZE, unique_vertices.size());
+
+        std::array<Shader::InputVertex, VERTEX_BATCH_SIZE> inputs;
+        DebugUtils::MemoryAccessTracker memory_accesses;
+
+        for (size_t batch_start = chunk_start; batch_start < chunk_end;
+             batch_start += VERTEX_BATCH_SIZE) {
+            const size_t batch_size = std::min<size_t>(VERTEX_BATCH_SIZE, chunk_end - batch_start);
+            loader.LoadVertices(base_address, &unique_vertices[batch_start], batch_size,
+                                inputs.data(), memory_accesses);
+            shader_engine->RunBatch(g_state.vs, vertex_thread_units[thread_index], inputs.data(),
+                                    num_attributes, &outputs[batch_start], batch_size);
+        }
+    });
+
+    for (unsigned int index = 0; index < num_vertices; ++index) {
+        SubmitVertex(outputs[indices.IsIndexed() ? vertex_slots[index] : index]);
+    }
+}
+
 static void WritePicaReg(u32 id, u32 value, u32 mask) {
     auto& regs = g_state.regs;
 
@@ -157,13 +340,7 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                         shader_unit.registers.output, regs, regs.vs.output_mask);
 
                     // Send to renderer
-                    using Pica::Shader::OutputVertex;
-                    auto AddTriangle = [](const OutputVertex& v0, const OutputVertex& v1,
-                                          const OutputVertex& v2) {
-                        VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
-                    };
-
-                    g_state.primitive_assembler.SubmitVertex(output_vertex, AddTriangle);
+                    SubmitVertex(output_vertex);
                 }
             }
         }
@@ -205,20 +382,13 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
             g_debug_context->OnEvent(DebugContext::Event::IncomingPrimitiveBatch, nullptr);
 
         // Processes information about internal vertex attributes to figure out how a vertex is
-        // loaded.
-        // Later, these can be compiled and cached.
+        // loaded. On x64, this also looks up the loader compiled for the attribute configuration.
         const u32 base_address = regs.vertex_attributes.GetPhysicalBaseAddress();
         VertexLoader loader(regs);
 
         // Load vertices
         bool is_indexed = (id == PICA_REG_INDEX(trigger_draw_indexed));
-
-        const auto& index_info = regs.index_array;
-        const u8* index_address_8 = Memory::GetPhysicalPointer(base_address + index_info.offset);
-        const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
-        bool index_u16 = index_info.format != 0;
-
-        PrimitiveAssembler<Shader::OutputVertex>& primitive_assembler = g_state.primitive_assembler;
+        const DrawIndices indices(regs, is_indexed);
 
         if (g_debug_context && g_debug_context->recorder) {
             for (int i = 0; i < 3; ++i) {
@@ -234,71 +404,116 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
             }
         }
 
-        DebugUtils::MemoryAccessTracker memory_accesses;
+        if (regs.num_vertices == 0)
+            break;
 
-        Shader::OutputVertex output_vertex;
+        // Size the vertex cache for the index range of the draw, so that every vertex is only
+        // shaded once. Non-indexed draws use every vertex once, so they don't need it.
+        if (is_indexed) {
+            const auto vertex_range = indices.GetRange(regs.num_vertices);
+            vertex_cache.Reset(vertex_range.first, vertex_range.second, regs.num_vertices);
+        }
 
         auto* shader_engine = Shader::GetEngine();
-        Shader::UnitState shader_unit;
-
         shader_engine->SetupBatch(g_state.vs, regs.vs.main_offset);
 
-        for (unsigned int index = 0; index < regs.num_vertices; ++index) {
-            // Indexed rendering doesn't use the start offset
-            unsigned int vertex =
-                is_indexed ? (index_u16 ? index_address_16[index] : index_address_8[index])
-                           : (index + regs.vertex_offset);
+        // Large draws are split across the vertex thread pool. Recording a trace or breaking on
+        // shader invocations needs the vertices in order on this thread, so these use the serial
+        // path below.
+        const bool needs_serial_path =
+            g_debug_context &&
+            (g_debug_context->recorder ||
+             g_debug_context->breakpoints[(int)DebugContext::Event::VertexShaderInvocation].enabled);
+        Common::ThreadPool* thread_pool = GetVertexThreadPool();
+        if (thread_pool != nullptr && regs.num_vertices >= PARALLEL_VERTEX_THRESHOLD &&
+            !needs_serial_path) {
+            ProcessVerticesParallel(*thread_pool, loader, indices);
+            ++parallel_draw_count;
+        } else {
+            DebugUtils::MemoryAccessTracker memory_accesses;
+            Shader::UnitState shader_unit;
+
+            // Vertices are loaded and shaded in batches, so that the loader and the shader engine
+            // only have to be invoked once for many vertices
+            std::array<u32, VERTEX_BATCH_SIZE> batch_slots;
+            std::array<u32, VERTEX_BATCH_SIZE> load_vertices;
+            std::array<Shader::InputVertex, VERTEX_BATCH_SIZE> load_inputs;
+            std::array<Shader::OutputVertex, VERTEX_BATCH_SIZE> unindexed_outputs;
+
+            for (unsigned int batch_start = 0; batch_start < regs.num_vertices;
+                 batch_start += VERTEX_BATCH_SIZE) {
+                const unsigned int batch_size =
+                    std::min<unsigned int>(VERTEX_BATCH_SIZE, regs.num_vertices - batch_start);
+
+                // Vertices missing from the cache get consecutive slots starting at this one
+                const u32 first_load_slot = static_cast<u32>(vertex_cache.GetSize());
+                size_t num_loads = 0;
+
+                if (is_indexed) {
+                    for (unsigned int i = 0; i < batch_size; ++i) {
+                        const unsigned int index = batch_start + i;
+                        const u32 vertex = indices[index];
+
+                        // -1 is a common special value used for primitive restart. Since it's
+                        // unknown if the PICA supports it, and it would mess up the caching, guard
+                        // against it here.
+                        ASSERT(vertex != -1);
+
+                        if (g_debug_context && g_debug_context->recorder) {
+                            const auto access = indices.GetIndexAccess(index);
+                            memory_accesses.AddAccess(access.first, access.second);
+                        }
+
+                        u32 slot = vertex_cache.Lookup(vertex);
+                        if (slot == VertexCache::INVALID_SLOT) {
+                            slot = vertex_cache.Insert(vertex);
+                            load_vertices[num_loads++] = vertex;
+                        }
+                        batch_slots[i] = slot;
+                    }
+                } else {
+                    // Every vertex of a non-indexed draw is used once, so there is nothing to look
+                    // up
+                    for (unsigned int i = 0; i < batch_size; ++i) {
+                        load_vertices[i] = indices[batch_start + i];
+                    }
+                    num_loads = batch_size;
+                }
 
-            // -1 is a common special value used for primitive restart. Since it's unknown if
-            // the PICA supports it, and it would mess up the caching, guard against it here.
-            ASSERT(vertex != -1);
+                if (num_loads != 0) {
+                    loader.LoadVertices(base_address, load_vertices.data(), num_loads,
+                                        load_inputs.data(), memory_accesses);
 
-            if (is_indexed) {
-                if (g_debug_context && Pica::g_debug_context->recorder) {
-                    int size = index_u16 ? 2 : 1;
-                    memory_accesses.AddAccess(base_address + index_info.offset + size * index,
-                                              size);
+                    // Send to vertex shader
+                    if (g_debug_context) {
+                        for (size_t i = 0; i < num_loads; ++i) {
+                            g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                                     (void*)&load_inputs[i]);
+                        }
+                    }
+                    Shader::OutputVertex* const outputs =
+                        is_indexed ? &vertex_cache.GetVertex(first_load_slot)
+                                   : unindexed_outputs.data();
+                    shader_engine->RunBatch(g_state.vs, shader_unit, load_inputs.data(),
+                                            loader.GetNumTotalAttributes(), outputs, num_loads);
+                }
+
+                for (unsigned int i = 0; i < batch_size; ++i) {
+                    SubmitVertex(is_indexed ? vertex_cache.GetVertex(batch_slots[i])
+                                            : unindexed_outputs[i]);
                 }
             }
 
-            if (!VertexCache::contains(vertex)) {
-                // Initialize data for the current vertex
-                Shader::InputVertex input;
-                loader.LoadVertex(base_address, index, vertex, input, memory_accesses);
-
-                // Send to vertex shader
-                if (g_debug_context)
-                    g_debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                             (void*)&input);
-                shader_unit.LoadInputVertex(input, loader.GetNumTotalAttributes());
-                shader_engine->Run(g_state.vs, shader_unit);
-
-                // Retrieve vertex from register data
-                output_vertex = Shader::OutputVertex::FromRegisters(shader_unit.registers.output,
-                                                                    regs, regs.vs.output_mask);
-
-                if (is_indexed)
-                    VertexCache::store(vertex, output_vertex);
-            } else
-                output_vertex = VertexCache::obtain(vertex);
-
-            // Send to renderer
-            using Pica::Shader::OutputVertex;
-            auto AddTriangle = [](const OutputVertex& v0, const OutputVertex& v1,
-                                  const OutputVertex& v2) {
-                VideoCore::g_renderer->Rasterizer()->AddTriangle(v0, v1, v2);
-            };
-
-            primitive_assembler.SubmitVertex(output_vertex, AddTriangle);
+            for (auto& range : memory_accesses.ranges) {
+                g_debug_context->recorder->MemoryAccessed(Memory::GetPhysicalPointer(range.first),
+                                                          range.second, range.first);
+            }
         }
 
-        for (auto& range : memory_accesses.ranges) {
-            g_debug_context->recorder->MemoryAccessed(Memory::GetPhysicalPointer(range.first),
-                                                      range.second, range.first);
+        if (is_indexed) {
+            MICROPROFILE_META_CPU("Vertex cache hits", vertex_cache.GetHits());
+            MICROPROFILE_META_CPU("Vertex cache misses", vertex_cache.GetMisses());
         }
-
-        if (is_indexed)
-            VertexCache::clear();
         break;
     }
 
@@ -441,6 +656,10 @@ static void WritePicaReg(u32 id, u32 value, u32 mask) {
                                  reinterpret_cast<void*>(&id));
 }
 
+u64 GetParallelDrawCount() {
+    return parallel_draw_count;
+}
+
 void ProcessCommandList(const u32* list, u32 size) {
     g_state.cmd_list.head_ptr = g_state.cmd_list.current_ptr = list;
     g_state.cmd_list.length = size / sizeof(u32);
@@ -36,6 +36,9 @@ static_assert(sizeof(CommandHeader) == sizeof(u32), "CommandHeader has incorrect
 
 void ProcessCommandList(const u32* list, u32 size);
 
+/// Returns the number of draws whose vertices were processed on the vertex thread pool
+u64 GetParallelDrawCount();
+
 } // namespace
 
 } // namespace
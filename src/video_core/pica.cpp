@@ -6,6 +6,7 @@
 #include <iterator>
 #include <unordered_map>
 #include <utility>
+#include "common/chunk_file.h"
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/primitive_assembly.h"
@@ -496,6 +497,7 @@ std::string Regs::GetCommandName(int index) {
 
 void Init() {
     g_state.Reset();
+    Shader::Init();
 }
 
 void Shutdown() {
@@ -515,4 +517,25 @@ void State::Reset() {
     Zero(immediate);
     primitive_assembler.Reconfigure(Regs::TriangleTopology::List);
 }
+
+static void DoShaderSetup(PointerWrap& p, Shader::ShaderSetup& setup) {
+    p.DoVoid(&setup.uniforms, sizeof(setup.uniforms));
+    p.DoVoid(setup.program_code.data(), sizeof(setup.program_code));
+    p.DoVoid(setup.swizzle_data.data(), sizeof(setup.swizzle_data));
+    p.Do(setup.engine_data.entry_point);
+    if (p.GetMode() == PointerWrap::MODE_READ)
+        setup.engine_data.cached_shader = nullptr;
+}
+
+void State::DoState(PointerWrap& p) {
+    p.DoVoid(&regs, sizeof(regs));
+    DoShaderSetup(p, vs);
+    DoShaderSetup(p, gs);
+    p.DoVoid(vs_default_attributes.data(), sizeof(vs_default_attributes));
+    p.DoVoid(lighting.luts.data(), sizeof(lighting.luts));
+    p.DoVoid(fog.lut.data(), sizeof(fog.lut));
+    p.DoVoid(&immediate.input_vertex, sizeof(immediate.input_vertex));
+    p.Do(immediate.current_attribute);
+    primitive_assembler.DoState(p);
+}
 }
@@ -11,12 +11,20 @@
 #include "video_core/primitive_assembly.h"
 #include "video_core/shader/shader.h"
 
+class PointerWrap;
+
 namespace Pica {
 
 /// Struct used to describe current Pica state
 struct State {
     void Reset();
 
+    /**
+     * Saves or loads the state, but not the command list being processed, so it must be called
+     * between command lists. The compiled shaders are looked up again after a load.
+     */
+    void DoState(PointerWrap& p);
+
     /// Pica registers
     Regs regs;
 
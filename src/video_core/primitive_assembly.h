@@ -7,6 +7,8 @@
 #include <functional>
 #include "video_core/pica.h"
 
+class PointerWrap;
+
 namespace Pica {
 
 /*
@@ -37,6 +39,9 @@ struct PrimitiveAssembler {
      */
     void Reconfigure(Regs::TriangleTopology topology);
 
+    /// Saves or loads the topology and the buffered vertices
+    void DoState(PointerWrap& p);
+
 private:
     Regs::TriangleTopology topology;
 
@@ -12,9 +12,16 @@ struct OutputVertex;
 
 namespace Rasterizer {
 
+/**
+ * Rasterizes the given triangle. When multi-threaded rasterization is enabled, the triangle is only
+ * queued into the screen tiles it touches and gets drawn on the next call to Flush.
+ */
 void ProcessTriangle(const Shader::OutputVertex& v0, const Shader::OutputVertex& v1,
                      const Shader::OutputVertex& v2);
 
+/// Draws all queued triangles, returning once the framebuffer in memory is up to date
+void Flush();
+
 } // namespace Rasterizer
 
 } // namespace Pica
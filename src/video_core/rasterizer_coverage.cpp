@@ -0,0 +1,76 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include "video_core/rasterizer_coverage.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include "common/x64/cpu_detect.h"
+#endif // ARCHITECTURE_x86_64
+
+namespace Pica {
+
+namespace Rasterizer {
+
+static u32 EvaluateGeneric(const CoverageSetup& setup, int x, int y) {
+    u32 mask = 0;
+
+    for (unsigned lane = 0; lane < 4; ++lane) {
+        const int px = x + (lane % 2) * 16;
+        const int py = y + (lane / 2) * 16;
+
+        if (px >= setup.max_x || py >= setup.max_y)
+            continue;
+
+        if (setup.scissor_exclude && px >= setup.scissor_x1 && px < setup.scissor_x2 &&
+            py >= setup.scissor_y1 && py < setup.scissor_y2)
+            continue;
+
+        bool covered = true;
+        for (const auto& edge : setup.edges) {
+            const int w = edge.bias + edge.dx * (py - edge.origin_y) -
+                          edge.dy * (px - edge.origin_x);
+            covered &= w >= 0;
+        }
+
+        if (covered)
+            mask |= 1 << lane;
+    }
+
+    return mask;
+}
+
+const CoverageEvaluator coverage_evaluator_generic = {"Generic", 2, EvaluateGeneric};
+
+/// Evaluator chosen with SetCoverageEvaluator, read by the rasterizer threads
+static std::atomic<const CoverageEvaluator*> selected_evaluator{nullptr};
+
+const CoverageEvaluator& GetCoverageEvaluator() {
+    static const CoverageEvaluator& fastest_evaluator = *GetSupportedCoverageEvaluators().back();
+
+    const CoverageEvaluator* evaluator = selected_evaluator.load(std::memory_order_relaxed);
+    return evaluator != nullptr ? *evaluator : fastest_evaluator;
+}
+
+void SetCoverageEvaluator(const CoverageEvaluator* evaluator) {
+    selected_evaluator.store(evaluator, std::memory_order_relaxed);
+}
+
+std::vector<const CoverageEvaluator*> GetSupportedCoverageEvaluators() {
+    std::vector<const CoverageEvaluator*> evaluators = {&coverage_evaluator_generic};
+
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.sse4_1)
+        evaluators.push_back(&coverage_evaluator_sse41);
+    if (caps.avx2)
+        evaluators.push_back(&coverage_evaluator_avx2);
+#endif // ARCHITECTURE_x86_64
+
+    return evaluators;
+}
+
+} // namespace Rasterizer
+
+} // namespace Pica
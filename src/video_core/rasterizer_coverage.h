@@ -0,0 +1,85 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+#include "common/common_types.h"
+
+namespace Pica {
+
+namespace Rasterizer {
+
+/**
+ * Per-triangle state required to determine which pixels of the render target are covered by a
+ * triangle. All coordinates are in the 12.4 fixed point format used by the rasterizer.
+ */
+struct CoverageSetup {
+    /**
+     * Edge function of one triangle edge going from vertex a to vertex b. Its value at a point p,
+     *     bias + (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x),
+     * is the (biased) signed area of the triangle (a, b, p), i.e. one barycentric coordinate.
+     */
+    struct Edge {
+        int origin_x; ///< a.x
+        int origin_y; ///< a.y
+        int dx;       ///< b.x - a.x
+        int dy;       ///< b.y - a.y
+        int bias;
+    };
+
+    Edge edges[3];
+
+    /// Pixel centers at or beyond these coordinates are never covered
+    int max_x;
+    int max_y;
+
+    /// If set, pixels inside the scissor box are not covered
+    bool scissor_exclude;
+    int scissor_x1;
+    int scissor_y1;
+    int scissor_x2; ///< Exclusive
+    int scissor_y2; ///< Exclusive
+};
+
+/**
+ * Implementation of the coverage test for a block of 2 rows of pixels. Lane i of the block maps to
+ * the pixel center (x + (i % block_width) * 16, y + (i / block_width) * 16), and bit i of the
+ * returned mask is set if that pixel is covered. All implementations are bit-exact with each other.
+ */
+struct CoverageEvaluator {
+    const char* name;
+    unsigned block_width;
+    u32 (*evaluate)(const CoverageSetup& setup, int x, int y);
+};
+
+/**
+ * Returns the coverage evaluator used by the rasterizer, the fastest one supported by the host CPU
+ * unless another one was chosen with SetCoverageEvaluator
+ */
+const CoverageEvaluator& GetCoverageEvaluator();
+
+/**
+ * Makes the rasterizer use the given coverage evaluator, to compare them in benchmarks. Only called
+ * while no triangle is being rasterized.
+ * @param evaluator The evaluator, or nullptr to go back to the fastest one
+ */
+void SetCoverageEvaluator(const CoverageEvaluator* evaluator);
+
+/// Returns all coverage evaluators supported by the host CPU, starting with the portable one
+std::vector<const CoverageEvaluator*> GetSupportedCoverageEvaluators();
+
+/// Portable implementation, evaluating a 2x2 pixel quad
+extern const CoverageEvaluator coverage_evaluator_generic;
+
+#ifdef ARCHITECTURE_x86_64
+/// SSE4.1 implementation, evaluating a 2x2 pixel quad
+extern const CoverageEvaluator coverage_evaluator_sse41;
+/// AVX2 implementation, evaluating two horizontally adjacent 2x2 pixel quads
+extern const CoverageEvaluator coverage_evaluator_avx2;
+#endif // ARCHITECTURE_x86_64
+
+} // namespace Rasterizer
+
+} // namespace Pica
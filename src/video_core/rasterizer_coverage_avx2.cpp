@@ -0,0 +1,54 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <immintrin.h>
+#include "video_core/rasterizer_coverage.h"
+
+namespace Pica {
+
+namespace Rasterizer {
+
+static u32 EvaluateAVX2(const CoverageSetup& setup, int x, int y) {
+    // Lanes 0-3 cover the row at y, lanes 4-7 the row at y + 16
+    const __m256i px = _mm256_add_epi32(_mm256_set1_epi32(x),
+                                        _mm256_setr_epi32(0, 16, 32, 48, 0, 16, 32, 48));
+    const __m256i py =
+        _mm256_add_epi32(_mm256_set1_epi32(y), _mm256_setr_epi32(0, 0, 0, 0, 16, 16, 16, 16));
+
+    // Lanes inside the bounds end up with a cleared sign bit. Any negative edge function value
+    // sets it afterwards, so that only covered lanes stay non-negative.
+    __m256i result = _mm256_and_si256(_mm256_sub_epi32(px, _mm256_set1_epi32(setup.max_x)),
+                                      _mm256_sub_epi32(py, _mm256_set1_epi32(setup.max_y)));
+    result = _mm256_xor_si256(result, _mm256_set1_epi32(-1));
+
+    for (const auto& edge : setup.edges) {
+        const __m256i rel_x = _mm256_sub_epi32(px, _mm256_set1_epi32(edge.origin_x));
+        const __m256i rel_y = _mm256_sub_epi32(py, _mm256_set1_epi32(edge.origin_y));
+        const __m256i w = _mm256_add_epi32(
+            _mm256_set1_epi32(edge.bias),
+            _mm256_sub_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(edge.dx), rel_y),
+                             _mm256_mullo_epi32(_mm256_set1_epi32(edge.dy), rel_x)));
+        result = _mm256_or_si256(result, w);
+    }
+
+    u32 mask = ~_mm256_movemask_ps(_mm256_castsi256_ps(result)) & 0xFF;
+
+    if (setup.scissor_exclude) {
+        const __m256i inside_x =
+            _mm256_and_si256(_mm256_cmpgt_epi32(px, _mm256_set1_epi32(setup.scissor_x1 - 1)),
+                             _mm256_cmpgt_epi32(_mm256_set1_epi32(setup.scissor_x2), px));
+        const __m256i inside_y =
+            _mm256_and_si256(_mm256_cmpgt_epi32(py, _mm256_set1_epi32(setup.scissor_y1 - 1)),
+                             _mm256_cmpgt_epi32(_mm256_set1_epi32(setup.scissor_y2), py));
+        mask &= ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(inside_x, inside_y)));
+    }
+
+    return mask;
+}
+
+const CoverageEvaluator coverage_evaluator_avx2 = {"AVX2", 4, EvaluateAVX2};
+
+} // namespace Rasterizer
+
+} // namespace Pica
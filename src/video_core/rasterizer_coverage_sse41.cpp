@@ -0,0 +1,52 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <smmintrin.h>
+#include "video_core/rasterizer_coverage.h"
+
+namespace Pica {
+
+namespace Rasterizer {
+
+static u32 EvaluateSSE41(const CoverageSetup& setup, int x, int y) {
+    // Lanes are laid out as (x, y), (x + 16, y), (x, y + 16), (x + 16, y + 16)
+    const __m128i px = _mm_add_epi32(_mm_set1_epi32(x), _mm_setr_epi32(0, 16, 0, 16));
+    const __m128i py = _mm_add_epi32(_mm_set1_epi32(y), _mm_setr_epi32(0, 0, 16, 16));
+
+    // Lanes inside the bounds end up with a cleared sign bit. Any negative edge function value
+    // sets it afterwards, so that only covered lanes stay non-negative.
+    __m128i result = _mm_and_si128(_mm_sub_epi32(px, _mm_set1_epi32(setup.max_x)),
+                                   _mm_sub_epi32(py, _mm_set1_epi32(setup.max_y)));
+    result = _mm_xor_si128(result, _mm_set1_epi32(-1));
+
+    for (const auto& edge : setup.edges) {
+        const __m128i rel_x = _mm_sub_epi32(px, _mm_set1_epi32(edge.origin_x));
+        const __m128i rel_y = _mm_sub_epi32(py, _mm_set1_epi32(edge.origin_y));
+        const __m128i w = _mm_add_epi32(
+            _mm_set1_epi32(edge.bias),
+            _mm_sub_epi32(_mm_mullo_epi32(_mm_set1_epi32(edge.dx), rel_y),
+                          _mm_mullo_epi32(_mm_set1_epi32(edge.dy), rel_x)));
+        result = _mm_or_si128(result, w);
+    }
+
+    u32 mask = ~_mm_movemask_ps(_mm_castsi128_ps(result)) & 0xF;
+
+    if (setup.scissor_exclude) {
+        const __m128i inside_x =
+            _mm_and_si128(_mm_cmpgt_epi32(px, _mm_set1_epi32(setup.scissor_x1 - 1)),
+                          _mm_cmplt_epi32(px, _mm_set1_epi32(setup.scissor_x2)));
+        const __m128i inside_y =
+            _mm_and_si128(_mm_cmpgt_epi32(py, _mm_set1_epi32(setup.scissor_y1 - 1)),
+                          _mm_cmplt_epi32(py, _mm_set1_epi32(setup.scissor_y2)));
+        mask &= ~_mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(inside_x, inside_y)));
+    }
+
+    return mask;
+}
+
+const CoverageEvaluator coverage_evaluator_sse41 = {"SSE4.1", 2, EvaluateSSE41};
+
+} // namespace Rasterizer
+
+} // namespace Pica
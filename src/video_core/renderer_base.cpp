@@ -4,11 +4,18 @@
 
 #include <atomic>
 #include <memory>
+#include "core/hw/gpu.h"
+#include "core/hw/lcd.h"
 #include "video_core/renderer_base.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/swrasterizer.h"
 #include "video_core/video_core.h"
 
+RendererBase::ScreenConfig RendererBase::GetScreenConfig() {
+    return {{{GPU::g_regs.framebuffer_config[0], GPU::g_regs.framebuffer_config[1]}},
+            {{LCD::g_regs.color_fill_top, LCD::g_regs.color_fill_bottom}}};
+}
+
 void RendererBase::RefreshRasterizerSetting() {
     bool hw_renderer_enabled = VideoCore::g_hw_renderer_enabled;
     if (rasterizer == nullptr || opengl_rasterizer_active != hw_renderer_enabled) {
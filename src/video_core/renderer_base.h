@@ -4,8 +4,11 @@
 
 #pragma once
 
+#include <array>
 #include <memory>
 #include "common/common_types.h"
+#include "core/hw/gpu.h"
+#include "core/hw/lcd.h"
 #include "video_core/rasterizer_interface.h"
 
 class EmuWindow;
@@ -15,10 +18,22 @@ public:
     /// Used to reference a framebuffer
     enum kFramebuffer { kFramebuffer_VirtualXFB = 0, kFramebuffer_EFB, kFramebuffer_Texture };
 
+    /**
+     * Registers deciding what the screens show. They are copied when the frame ends, since the
+     * renderer may run on the GPU thread while the emulated CPU changes them.
+     */
+    struct ScreenConfig {
+        std::array<GPU::Regs::FramebufferConfig, 2> framebuffers;
+        std::array<LCD::Regs::ColorFill, 2> color_fills;
+    };
+
     virtual ~RendererBase() {}
 
+    /// Returns the current screen registers, top screen first
+    static ScreenConfig GetScreenConfig();
+
     /// Swap buffers (render frame)
-    virtual void SwapBuffers() = 0;
+    virtual void SwapBuffers(const ScreenConfig& screen_config) = 0;
 
     /**
      * Set the emulator window to use for renderer
@@ -17,10 +17,12 @@
 #include "video_core/pica.h"
 #include "video_core/pica_state.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
 #include "video_core/renderer_opengl/pica_to_gl.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
+#include "video_core/video_core.h"
 
 MICROPROFILE_DEFINE(OpenGL_Drawing, "OpenGL", "Drawing", MP_RGB(128, 128, 192));
 MICROPROFILE_DEFINE(OpenGL_Blits, "OpenGL", "Blits", MP_RGB(100, 100, 255));
@@ -135,6 +137,11 @@ RasterizerOpenGL::RasterizerOpenGL() : shader_dirty(true) {
     SyncColorWriteMask();
     SyncStencilWriteMask();
     SyncDepthWriteMask();
+
+    // Shaders loaded from the disk cache are found in the shader cache on first use, so the
+    // uniforms that would otherwise be synced when the shader is generated are synced here
+    LoadDiskShaderCache();
+    SyncShaderUniforms();
 }
 
 RasterizerOpenGL::~RasterizerOpenGL() {}
@@ -1010,7 +1017,6 @@ void RasterizerOpenGL::SamplerInfo::SyncWithConfig(const Pica::Regs::TextureConf
 
 void RasterizerOpenGL::SetShader() {
     PicaShaderConfig config = PicaShaderConfig::CurrentConfig();
-    std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
 
     // Find (or generate) the GLSL shader for the current TEV state
     auto cached_shader = shader_cache.find(config);
@@ -1022,91 +1028,166 @@ void RasterizerOpenGL::SetShader() {
     } else {
         LOG_DEBUG(Render_OpenGL, "Creating new shader");
 
+        std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
         shader->shader.Create(GLShader::GenerateVertexShader().c_str(),
-                              GLShader::GenerateFragmentShader(config).c_str());
-
-        state.draw.shader_program = shader->shader.handle;
-        state.Apply();
+                              GLShader::GenerateFragmentShader(config).c_str(),
+                              disk_shader_cache != nullptr);
 
-        // Set the texture samplers to correspond to different texture units
-        GLuint uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[0]");
-        if (uniform_tex != -1) {
-            glUniform1i(uniform_tex, 0);
-        }
-        uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[1]");
-        if (uniform_tex != -1) {
-            glUniform1i(uniform_tex, 1);
-        }
-        uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[2]");
-        if (uniform_tex != -1) {
-            glUniform1i(uniform_tex, 2);
+        if (disk_shader_cache) {
+            StoreDiskShader(config, *shader);
         }
 
-        // Set the texture samplers to correspond to different lookup table texture units
-        GLuint uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[0]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 3);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[1]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 4);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[2]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 5);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[3]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 6);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[4]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 7);
-        }
-        uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[5]");
-        if (uniform_lut != -1) {
-            glUniform1i(uniform_lut, 8);
-        }
+        current_shader = AddShader(config, std::move(shader));
 
-        GLuint uniform_fog_lut = glGetUniformLocation(shader->shader.handle, "fog_lut");
-        if (uniform_fog_lut != -1) {
-            glUniform1i(uniform_fog_lut, 9);
-        }
+        SyncShaderUniforms();
+    }
+}
+
+void RasterizerOpenGL::SyncShaderUniforms() {
+    SyncDepthScale();
+    SyncDepthOffset();
+    SyncAlphaTest();
+    SyncCombinerColor();
+    auto& tev_stages = Pica::g_state.regs.GetTevStages();
+    for (int index = 0; index < tev_stages.size(); ++index)
+        SyncTevConstColor(index, tev_stages[index]);
+
+    SyncGlobalAmbient();
+    for (int light_index = 0; light_index < 8; light_index++) {
+        SyncLightSpecular0(light_index);
+        SyncLightSpecular1(light_index);
+        SyncLightDiffuse(light_index);
+        SyncLightAmbient(light_index);
+        SyncLightPosition(light_index);
+        SyncLightDistanceAttenuationBias(light_index);
+        SyncLightDistanceAttenuationScale(light_index);
+    }
 
-        current_shader = shader_cache.emplace(config, std::move(shader)).first->second.get();
+    SyncFogColor();
+}
 
-        unsigned int block_index =
-            glGetUniformBlockIndex(current_shader->shader.handle, "shader_data");
-        GLint block_size;
-        glGetActiveUniformBlockiv(current_shader->shader.handle, block_index,
-                                  GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
-        ASSERT_MSG(block_size == sizeof(UniformData),
-                   "Uniform block size did not match! Got %d, expected %zu",
-                   static_cast<int>(block_size), sizeof(UniformData));
-        glUniformBlockBinding(current_shader->shader.handle, block_index, 0);
+const RasterizerOpenGL::PicaShader* RasterizerOpenGL::AddShader(
+    const PicaShaderConfig& config, std::unique_ptr<PicaShader> shader) {
 
-        // Update uniforms
-        SyncDepthScale();
-        SyncDepthOffset();
-        SyncAlphaTest();
-        SyncCombinerColor();
-        auto& tev_stages = Pica::g_state.regs.GetTevStages();
-        for (int index = 0; index < tev_stages.size(); ++index)
-            SyncTevConstColor(index, tev_stages[index]);
+    state.draw.shader_program = shader->shader.handle;
+    state.Apply();
 
-        SyncGlobalAmbient();
-        for (int light_index = 0; light_index < 8; light_index++) {
-            SyncLightSpecular0(light_index);
-            SyncLightSpecular1(light_index);
-            SyncLightDiffuse(light_index);
-            SyncLightAmbient(light_index);
-            SyncLightPosition(light_index);
-            SyncLightDistanceAttenuationBias(light_index);
-            SyncLightDistanceAttenuationScale(light_index);
+    // Set the texture samplers to correspond to different texture units
+    GLuint uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[0]");
+    if (uniform_tex != -1) {
+        glUniform1i(uniform_tex, 0);
+    }
+    uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[1]");
+    if (uniform_tex != -1) {
+        glUniform1i(uniform_tex, 1);
+    }
+    uniform_tex = glGetUniformLocation(shader->shader.handle, "tex[2]");
+    if (uniform_tex != -1) {
+        glUniform1i(uniform_tex, 2);
+    }
+
+    // Set the texture samplers to correspond to different lookup table texture units
+    GLuint uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[0]");
+    if (uniform_lut != -1) {
+        glUniform1i(uniform_lut, 3);
+    }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[1]");
+    if (uniform_lut != -1) {
+        glUniform1i(uniform_lut, 4);
+    }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[2]");
+    if (uniform_lut != -1) {
+        glUniform1i(uniform_lut, 5);
+    }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[3]");
+    if (uniform_lut != -1) {
+        glUniform1i(uniform_lut, 6);
+    }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[4]");
+    if (uniform_lut != -1) {
+        glUniform1i(uniform_lut, 7);
+    }
+    uniform_lut = glGetUniformLocation(shader->shader.handle, "lut[5]");
+    if (uniform_lut != -1) {
+        glUniform1i(uniform_lut, 8);
+    }
+
+    GLuint uniform_fog_lut = glGetUniformLocation(shader->shader.handle, "fog_lut");
+    if (uniform_fog_lut != -1) {
+        glUniform1i(uniform_fog_lut, 9);
+    }
+
+    const PicaShader* added_shader =
+        shader_cache.emplace(config, std::move(shader)).first->second.get();
+
+    unsigned int block_index = glGetUniformBlockIndex(added_shader->shader.handle, "shader_data");
+    GLint block_size;
+    glGetActiveUniformBlockiv(added_shader->shader.handle, block_index,
+                              GL_UNIFORM_BLOCK_DATA_SIZE, &block_size);
+    ASSERT_MSG(block_size == sizeof(UniformData),
+               "Uniform block size did not match! Got %d, expected %zu",
+               static_cast<int>(block_size), sizeof(UniformData));
+    glUniformBlockBinding(added_shader->shader.handle, block_index, 0);
+
+    return added_shader;
+}
+
+void RasterizerOpenGL::LoadDiskShaderCache() {
+    if (!VideoCore::g_disk_shader_cache_enabled || VideoCore::g_program_id == 0)
+        return;
+
+    if (!GLShader::IsProgramBinarySupported()) {
+        LOG_INFO(Render_OpenGL, "Disk shader cache disabled, program binaries are unsupported");
+        return;
+    }
+
+    disk_shader_cache = std::make_unique<GLShader::ProgramDiskCache>();
+    const auto entries = disk_shader_cache->Open(
+        GLShader::ProgramDiskCache::GetCachePath(VideoCore::g_program_id));
+
+    size_t num_regenerated = 0;
+    for (const auto& entry : entries) {
+        if (shader_cache.count(entry.config) != 0)
+            continue;
+
+        std::unique_ptr<PicaShader> shader = std::make_unique<PicaShader>();
+        shader->shader.CreateFromBinary(entry.binary_format, entry.binary);
+
+        // The binary was created by a different driver, fall back to generating the program
+        if (shader->shader.handle == 0) {
+            shader->shader.Create(GLShader::GenerateVertexShader().c_str(),
+                                  GLShader::GenerateFragmentShader(entry.config).c_str(), true);
+            ++num_regenerated;
         }
 
-        SyncFogColor();
+        AddShader(entry.config, std::move(shader));
     }
+
+    // Replace the stale binaries, so that the programs don't have to be regenerated again
+    if (num_regenerated != 0) {
+        disk_shader_cache->Clear();
+        for (const auto& shader : shader_cache) {
+            StoreDiskShader(shader.first, *shader.second);
+        }
+    }
+
+    // The programs are bound on first use, just like the ones created while drawing
+    state.draw.shader_program = 0;
+    state.Apply();
+
+    LOG_INFO(Render_OpenGL, "Loaded %zu shader programs from the disk cache, %zu regenerated",
+             shader_cache.size(), num_regenerated);
+}
+
+void RasterizerOpenGL::StoreDiskShader(const PicaShaderConfig& config, const PicaShader& shader) {
+    GLenum binary_format;
+    std::vector<u8> binary;
+    if (!GLShader::GetProgramBinary(shader.shader.handle, binary_format, binary)) {
+        LOG_WARNING(Render_OpenGL, "Failed to retrieve the binary of a shader program");
+        return;
+    }
+
+    disk_shader_cache->Append(config, binary_format, binary);
 }
 
 void RasterizerOpenGL::SyncCullMode() {
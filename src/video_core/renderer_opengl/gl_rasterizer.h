@@ -28,6 +28,10 @@
 
 struct ScreenInfo;
 
+namespace GLShader {
+class ProgramDiskCache;
+} // namespace GLShader
+
 /**
  * This struct contains all state used to generate the GLSL shader program that emulates the current
  * Pica register configuration. This struct is used as a cache key for generated GLSL shader
@@ -351,6 +355,21 @@ private:
     /// Sets the OpenGL shader in accordance with the current PICA register state
     void SetShader();
 
+    /**
+     * Sets up a newly created shader program and adds it to the shader cache
+     * @returns The shader in the cache
+     */
+    const PicaShader* AddShader(const PicaShaderConfig& config, std::unique_ptr<PicaShader> shader);
+
+    /// Syncs all uniforms of the shader programs to match the PICA registers
+    void SyncShaderUniforms();
+
+    /// Creates the shader programs stored in the disk cache of the running title
+    void LoadDiskShaderCache();
+
+    /// Stores the binary of a shader program in the disk cache
+    void StoreDiskShader(const PicaShaderConfig& config, const PicaShader& shader);
+
     /// Syncs the cull mode to match the PICA register
     void SyncCullMode();
 
@@ -436,6 +455,8 @@ private:
     std::unordered_map<PicaShaderConfig, std::unique_ptr<PicaShader>> shader_cache;
     const PicaShader* current_shader = nullptr;
     bool shader_dirty;
+    /// Persistent cache of the shader programs, nullptr if it is disabled
+    std::unique_ptr<GLShader::ProgramDiskCache> disk_shader_cache;
 
     struct {
         UniformData data;
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <utility>
+#include <vector>
 #include <glad/glad.h>
 #include "common/common_types.h"
 #include "video_core/renderer_opengl/gl_shader_util.h"
@@ -91,10 +92,19 @@ public:
     }
 
     /// Creates a new internal OpenGL resource and stores the handle
-    void Create(const char* vert_shader, const char* frag_shader) {
+    void Create(const char* vert_shader, const char* frag_shader,
+                bool retrievable_binary = false) {
         if (handle != 0)
             return;
-        handle = GLShader::LoadProgram(vert_shader, frag_shader);
+        handle = GLShader::LoadProgram(vert_shader, frag_shader, retrievable_binary);
+    }
+
+    /// Creates a new internal OpenGL resource from a program binary, leaving the handle at 0 if
+    /// the driver rejects it
+    void CreateFromBinary(GLenum binary_format, const std::vector<u8>& binary) {
+        if (handle != 0)
+            return;
+        handle = GLShader::LoadProgramBinary(binary_format, binary);
     }
 
     /// Deletes the internal OpenGL resource
@@ -0,0 +1,87 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cinttypes>
+#include <cstring>
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/string_util.h"
+#include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+
+namespace GLShader {
+
+// Each value starts with the binary format, followed by the program binary
+static constexpr size_t BINARY_FORMAT_SIZE = sizeof(u32);
+
+namespace {
+
+class EntryReader final : public LinearDiskCacheReader<PicaShaderConfig, u8> {
+public:
+    explicit EntryReader(std::vector<ProgramDiskCache::Entry>& entries) : entries(entries) {}
+
+    void Read(const PicaShaderConfig& key, const u8* value, u32 value_size) override {
+        if (value_size < BINARY_FORMAT_SIZE)
+            return;
+
+        u32 binary_format;
+        std::memcpy(&binary_format, value, BINARY_FORMAT_SIZE);
+
+        ProgramDiskCache::Entry entry{key, binary_format};
+        entry.binary.assign(value + BINARY_FORMAT_SIZE, value + value_size);
+        entries.push_back(std::move(entry));
+    }
+
+private:
+    std::vector<ProgramDiskCache::Entry>& entries;
+};
+
+} // anonymous namespace
+
+std::string ProgramDiskCache::GetCachePath(u64 program_id) {
+    return FileUtil::GetUserPath(D_CACHE_IDX) + "opengl" DIR_SEP +
+           Common::StringFromFormat("%016" PRIX64 ".bin", program_id);
+}
+
+std::vector<ProgramDiskCache::Entry> ProgramDiskCache::Open(const std::string& filename_) {
+    filename = filename_;
+    if (!FileUtil::Exists(filename))
+        FileUtil::CreateFullPath(filename);
+
+    std::vector<Entry> entries;
+    EntryReader reader(entries);
+    file.OpenAndRead(filename, reader);
+
+    LOG_DEBUG(Render_OpenGL, "Read %zu programs from %s", entries.size(), filename.c_str());
+    return entries;
+}
+
+void ProgramDiskCache::Append(const PicaShaderConfig& config, GLenum binary_format,
+                              const std::vector<u8>& binary) {
+    std::vector<u8> value(BINARY_FORMAT_SIZE + binary.size());
+    const u32 format = binary_format;
+    std::memcpy(value.data(), &format, BINARY_FORMAT_SIZE);
+    std::memcpy(value.data() + BINARY_FORMAT_SIZE, binary.data(), binary.size());
+
+    file.Append(config, value.data(), static_cast<u32>(value.size()));
+
+    // Flush right away, so that the entry isn't lost if the emulator doesn't exit cleanly
+    file.Sync();
+}
+
+void ProgramDiskCache::Clear() {
+    file.Close();
+    FileUtil::Delete(filename);
+
+    std::vector<Entry> entries;
+    EntryReader reader(entries);
+    file.OpenAndRead(filename, reader);
+}
+
+void ProgramDiskCache::Close() {
+    file.Sync();
+    file.Close();
+}
+
+} // namespace GLShader
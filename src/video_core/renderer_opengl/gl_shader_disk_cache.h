@@ -0,0 +1,58 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glad/glad.h>
+#include "common/common_types.h"
+#include "common/linear_disk_cache.h"
+#include "video_core/renderer_opengl/gl_rasterizer.h"
+
+namespace GLShader {
+
+/**
+ * Persistent cache of the programs generated for each PicaShaderConfig used by a title. Every
+ * entry stores a config along with the binary of its linked program, so that the programs can be
+ * recreated when the title boots instead of being generated and compiled in the middle of a frame.
+ *
+ * The cache file is discarded whenever it was written by a different build, as the generated
+ * programs may have changed. Binaries created by a different driver have to be detected by the
+ * caller, since only the driver can tell whether it accepts them.
+ */
+class ProgramDiskCache {
+public:
+    struct Entry {
+        PicaShaderConfig config;
+        GLenum binary_format;
+        std::vector<u8> binary;
+    };
+
+    /// Returns the path of the cache file of the title with the given program id
+    static std::string GetCachePath(u64 program_id);
+
+    /**
+     * Opens a cache file, creating it if it doesn't exist or can't be used by this build.
+     * @param filename Path of the cache file
+     * @returns The entries stored in the file
+     */
+    std::vector<Entry> Open(const std::string& filename);
+
+    /// Appends a program to the open cache file
+    void Append(const PicaShaderConfig& config, GLenum binary_format,
+                const std::vector<u8>& binary);
+
+    /// Discards all entries stored in the open cache file
+    void Clear();
+
+    /// Closes the cache file, after writing all pending entries
+    void Close();
+
+private:
+    std::string filename;
+    LinearDiskCache<PicaShaderConfig, u8> file;
+};
+
+} // namespace GLShader
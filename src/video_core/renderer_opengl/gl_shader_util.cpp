@@ -10,7 +10,8 @@
 
 namespace GLShader {
 
-GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
+GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader,
+                   bool retrievable_binary) {
 
     // Create the shaders
     GLuint vertex_shader_id = glCreateShader(GL_VERTEX_SHADER);
@@ -67,6 +68,10 @@ GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
     glAttachShader(program_id, vertex_shader_id);
     glAttachShader(program_id, fragment_shader_id);
 
+    if (retrievable_binary && IsProgramBinarySupported()) {
+        glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
     glLinkProgram(program_id);
 
     // Check the program
@@ -96,4 +101,46 @@ GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader) {
     return program_id;
 }
 
+bool IsProgramBinarySupported() {
+    if (!GLAD_GL_ARB_get_program_binary)
+        return false;
+
+    // Some drivers expose the extension without supporting any binary format
+    GLint num_formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    return num_formats > 0;
+}
+
+bool GetProgramBinary(GLuint program, GLenum& binary_format, std::vector<u8>& binary) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return false;
+
+    binary.resize(length);
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &binary_format, binary.data());
+    if (written <= 0)
+        return false;
+
+    binary.resize(written);
+    return true;
+}
+
+GLuint LoadProgramBinary(GLenum binary_format, const std::vector<u8>& binary) {
+    GLuint program_id = glCreateProgram();
+    glProgramBinary(program_id, binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    // Drivers reject binaries created by other driver versions or hardware
+    GLint result = GL_FALSE;
+    glGetProgramiv(program_id, GL_LINK_STATUS, &result);
+    if (result == GL_FALSE) {
+        LOG_DEBUG(Render_OpenGL, "Program binary was rejected by the driver");
+        glDeleteProgram(program_id);
+        return 0;
+    }
+
+    return program_id;
+}
+
 } // namespace GLShader
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include <vector>
 #include <glad/glad.h>
+#include "common/common_types.h"
 
 namespace GLShader {
 
@@ -23,8 +25,30 @@ enum Attributes {
  * Utility function to create and compile an OpenGL GLSL shader program (vertex + fragment shader)
  * @param vertex_shader String of the GLSL vertex shader program
  * @param fragment_shader String of the GLSL fragment shader program
+ * @param retrievable_binary Hint the driver that the binary of the program will be retrieved
  * @returns Handle of the newly created OpenGL shader object
  */
-GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader);
+GLuint LoadProgram(const char* vertex_shader, const char* fragment_shader,
+                   bool retrievable_binary = false);
+
+/// Returns whether the driver supports retrieving and loading program binaries
+bool IsProgramBinarySupported();
+
+/**
+ * Retrieves the binary of a linked program, so that it can be recreated with LoadProgramBinary
+ * @param program Handle of the program
+ * @param binary_format Set to the driver-specific format of the binary
+ * @param binary Set to the program binary
+ * @returns Whether the binary could be retrieved
+ */
+bool GetProgramBinary(GLuint program, GLenum& binary_format, std::vector<u8>& binary);
+
+/**
+ * Creates a program from a binary previously returned by GetProgramBinary
+ * @param binary_format Driver-specific format of the binary
+ * @param binary Program binary
+ * @returns Handle of the newly created program, or 0 if the driver rejected the binary
+ */
+GLuint LoadProgramBinary(GLenum binary_format, const std::vector<u8>& binary);
 
 } // namespace
@@ -14,7 +14,7 @@
 #include "common/synchronized_wrapper.h"
 #include "core/frontend/emu_window.h"
 #include "core/hw/gpu.h"
-#include "core/hw/hw.h"
+#include "core/hw/gpu_thread.h"
 #include "core/hw/lcd.h"
 #include "core/memory.h"
 #include "core/settings.h"
@@ -104,20 +104,14 @@ RendererOpenGL::RendererOpenGL() {
 RendererOpenGL::~RendererOpenGL() {}
 
 /// Swap buffers (render frame)
-void RendererOpenGL::SwapBuffers() {
+void RendererOpenGL::SwapBuffers(const ScreenConfig& screen_config) {
     // Maintain the rasterizer's state as a priority
     OpenGLState prev_state = OpenGLState::GetCurState();
     state.Apply();
 
     for (int i : {0, 1}) {
-        const auto& framebuffer = GPU::g_regs.framebuffer_config[i];
-
-        // Main LCD (0): 0x1ED02204, Sub LCD (1): 0x1ED02A04
-        u32 lcd_color_addr =
-            (i == 0) ? LCD_REG_INDEX(color_fill_top) : LCD_REG_INDEX(color_fill_bottom);
-        lcd_color_addr = HW::VADDR_LCD + 4 * lcd_color_addr;
-        LCD::Regs::ColorFill color_fill = {0};
-        LCD::Read(color_fill.raw, lcd_color_addr);
+        const auto& framebuffer = screen_config.framebuffers[i];
+        const auto& color_fill = screen_config.color_fills[i];
 
         if (color_fill.is_enabled) {
             LoadColorToActiveGLTexture(color_fill.color_r, color_fill.color_g, color_fill.color_b,
@@ -152,8 +146,10 @@ void RendererOpenGL::SwapBuffers() {
         aggregator->AddFrame(profiler.GetPreviousFrameResults());
     }
 
-    // Swap buffers
-    render_window->PollEvents();
+    // Swap buffers. The window events are handled by the CPU thread when rendering on the GPU
+    // thread.
+    if (!GPUThread::IsGPUThread())
+        render_window->PollEvents();
     render_window->SwapBuffers();
 
     prev_state.Apply();
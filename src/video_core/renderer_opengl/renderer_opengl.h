@@ -38,7 +38,7 @@ public:
     ~RendererOpenGL() override;
 
     /// Swap buffers (render frame)
-    void SwapBuffers() override;
+    void SwapBuffers(const ScreenConfig& screen_config) override;
 
     /**
      * Set the emulator window to use for renderer
@@ -79,6 +79,16 @@ void UnitState::LoadInputVertex(const InputVertex& input, int num_attributes) {
         registers.input[attribute_register_map.GetRegisterForAttribute(i)] = input.attr[i];
 }
 
+void ShaderEngine::RunBatch(const ShaderSetup& setup, UnitState& state, const InputVertex* inputs,
+                            int num_attributes, OutputVertex* outputs, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        state.LoadInputVertex(inputs[i], num_attributes);
+        Run(setup, state);
+        outputs[i] = OutputVertex::FromRegisters(state.registers.output, g_state.regs,
+                                                 g_state.regs.vs.output_mask);
+    }
+}
+
 MICROPROFILE_DEFINE(GPU_Shader, "GPU", "Shader", MP_RGB(50, 50, 240));
 
 #ifdef ARCHITECTURE_x86_64
@@ -100,6 +110,10 @@ ShaderEngine* GetEngine() {
     return &interpreter_engine;
 }
 
+void Init() {
+    GetEngine();
+}
+
 void Shutdown() {
 #ifdef ARCHITECTURE_x86_64
     jit_engine = nullptr;
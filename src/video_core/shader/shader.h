@@ -193,10 +193,27 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, UnitState& state) const = 0;
+
+    /**
+     * Runs the currently setup shader for a batch of vertices. This is equivalent to calling
+     * LoadInputVertex, Run and OutputVertex::FromRegisters for each vertex in order, but allows
+     * engines to amortize the per-invocation overhead.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param state Shader unit state used for running the shader.
+     * @param inputs Input vertices, `count` in total
+     * @param num_attributes The number of vertex shader attributes to load
+     * @param outputs Array receiving `count` output vertices
+     * @param count Number of vertices to process
+     */
+    virtual void RunBatch(const ShaderSetup& setup, UnitState& state, const InputVertex* inputs,
+                          int num_attributes, OutputVertex* outputs, size_t count) const;
 };
 
 // TODO(yuriks): Remove and make it non-global state somewhere
 ShaderEngine* GetEngine();
+/// Creates the shader engine ahead of the first draw, so that the JIT can start prewarming
+void Init();
 void Shutdown();
 
 } // namespace Shader
@@ -10,6 +10,7 @@
 #include <boost/range/algorithm/fill.hpp>
 #include <nihstro/shader_bytecode.h>
 #include "common/assert.h"
+#include "common/bit_set.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -652,6 +653,652 @@ static void RunInterpreter(const ShaderSetup& setup, UnitState& state, DebugData
     }
 }
 
+/// Number of vertices the lockstep interpreter runs at once, one per lane of its registers
+static constexpr size_t BATCH_LANES = 32;
+
+/// Components of a register for each lane, with the lanes innermost
+using LaneRegister = float24[4][BATCH_LANES];
+
+/// Registers of BATCH_LANES shader units, laid out so that each operation runs on all lanes
+struct LaneRegisters {
+    alignas(32) LaneRegister input[16];
+    alignas(32) LaneRegister temporary[16];
+    alignas(32) LaneRegister output[16];
+    s32 address[3][BATCH_LANES];
+    bool conditional_code[2][BATCH_LANES];
+};
+
+/**
+ * Runs the shader for up to BATCH_LANES vertices at once, decoding each instruction a single time
+ * for all of them. The lanes share the program counter, so this only works as long as the vertices
+ * take the same path through the program: it gives up when a conditional branch goes different
+ * ways for different lanes.
+ *
+ * A shader may also read registers the previous vertex left behind, which the lanes can't see as
+ * they run side by side. This is detected as well, the lockstep results are then thrown away.
+ *
+ * @returns Whether the vertices were run, nothing is changed otherwise
+ */
+static bool RunLockstepInterpreter(const ShaderSetup& setup, UnitState& state,
+                                   const InputVertex* inputs, int num_attributes,
+                                   OutputVertex* outputs, size_t count, unsigned offset) {
+    DEBUG_ASSERT(count > 0 && count <= BATCH_LANES);
+
+    LaneRegisters regs;
+
+    // Registers holding a value for each lane. The others hold the same value in all lanes, which
+    // is read from the unit, until they are written.
+    u32 input_lanes = 0;
+    u32 temporary_lanes = 0;
+    u32 output_lanes = 0;
+
+    auto copy_to_lanes = [](LaneRegister& lanes, const Math::Vec4<float24>& value) {
+        for (int comp = 0; comp < 4; ++comp) {
+            std::fill_n(lanes[comp], BATCH_LANES, value[comp]);
+        }
+    };
+
+    const auto& input_register_map = g_state.regs.vs.input_register_map;
+    for (int attribute = 0; attribute < num_attributes; ++attribute) {
+        const int reg = input_register_map.GetRegisterForAttribute(attribute);
+        input_lanes |= 1 << reg;
+        for (int comp = 0; comp < 4; ++comp) {
+            // The unused lanes repeat the last vertex, so that they don't branch differently
+            for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                regs.input[reg][comp][lane] =
+                    inputs[std::min(lane, count - 1)].attr[attribute][comp];
+            }
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        std::fill_n(regs.address[i], BATCH_LANES, state.address_registers[i]);
+    }
+    for (int i = 0; i < 2; ++i) {
+        std::fill_n(regs.conditional_code[i], BATCH_LANES, false);
+    }
+
+    // Temporary components (one bit per component) and address registers written by this
+    // invocation, and the ones read before that
+    u64 temporaries_written = 0;
+    u64 temporaries_read_first = 0;
+    u32 address_written = 0;
+    u32 address_read_first = 0;
+
+    boost::container::static_vector<CallStackElement, 16> call_stack;
+    u32 program_counter = offset;
+
+    auto call = [&program_counter, &call_stack](u32 offset, u32 num_instructions, u32 return_offset,
+                                                u8 repeat_count, u8 loop_increment) {
+        // -1 to make sure when incrementing the PC we end up at the correct offset
+        program_counter = offset - 1;
+        ASSERT(call_stack.size() < call_stack.capacity());
+        call_stack.push_back(
+            {offset + num_instructions, return_offset, repeat_count, loop_increment, offset});
+    };
+
+    // Evaluates the condition of a branch on the comparison results, fails if the lanes disagree
+    auto evaluate_condition = [&regs](Instruction::FlowControlType flow_control, bool& result) {
+        using Op = Instruction::FlowControlType::Op;
+
+        bool lane_results[BATCH_LANES];
+        for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+            bool result_x = flow_control.refx.Value() == regs.conditional_code[0][lane];
+            bool result_y = flow_control.refy.Value() == regs.conditional_code[1][lane];
+
+            switch (flow_control.op) {
+            case Op::Or:
+                lane_results[lane] = result_x || result_y;
+                break;
+            case Op::And:
+                lane_results[lane] = result_x && result_y;
+                break;
+            case Op::JustX:
+                lane_results[lane] = result_x;
+                break;
+            case Op::JustY:
+                lane_results[lane] = result_y;
+                break;
+            default:
+                UNREACHABLE();
+                lane_results[lane] = false;
+                break;
+            }
+        }
+
+        result = lane_results[0];
+        return std::all_of(lane_results, lane_results + BATCH_LANES,
+                           [result](bool lane_result) { return lane_result == result; });
+    };
+
+    const auto& uniforms = setup.uniforms;
+    const auto& swizzle_data = setup.swizzle_data;
+    const auto& program_code = setup.program_code;
+
+    /**
+     * Loads a swizzled source operand for all lanes. The offset from the given address register
+     * may differ between the lanes, in which case they read different registers.
+     * @returns false if a lane reads a register the interpreter substitutes a placeholder for
+     */
+    auto load_source = [&](const SourceRegister& source_reg, int address_register_index,
+                           const int(&selectors)[4], bool negate, LaneRegister& out) {
+        const s32* address = nullptr;
+        if (address_register_index != 0) {
+            address = regs.address[address_register_index - 1];
+            if (!(address_written & (1 << (address_register_index - 1))))
+                address_read_first |= 1 << (address_register_index - 1);
+        }
+
+        size_t lane = 0;
+        while (lane < BATCH_LANES) {
+            // The lanes up to the next one with a different offset read the same register
+            const int address_offset = address == nullptr ? 0 : address[lane];
+            size_t end = lane + 1;
+            if (address == nullptr) {
+                end = BATCH_LANES;
+            } else {
+                while (end < BATCH_LANES && address[end] == address_offset)
+                    ++end;
+            }
+
+            const SourceRegister reg = source_reg + address_offset;
+            const float24* components;
+            size_t component_stride;
+            size_t lane_stride;
+            switch (reg.GetRegisterType()) {
+            case RegisterType::Input:
+                if (input_lanes & (1 << reg.GetIndex())) {
+                    components = regs.input[reg.GetIndex()][0];
+                    component_stride = BATCH_LANES;
+                    lane_stride = 1;
+                } else {
+                    components = &state.registers.input[reg.GetIndex()].x;
+                    component_stride = 1;
+                    lane_stride = 0;
+                }
+                break;
+
+            case RegisterType::Temporary:
+                if (temporary_lanes & (1 << reg.GetIndex())) {
+                    components = regs.temporary[reg.GetIndex()][0];
+                    component_stride = BATCH_LANES;
+                    lane_stride = 1;
+                } else {
+                    components = &state.registers.temporary[reg.GetIndex()].x;
+                    component_stride = 1;
+                    lane_stride = 0;
+                }
+                for (int comp = 0; comp < 4; ++comp) {
+                    const u64 bit = u64(1) << (reg.GetIndex() * 4 + selectors[comp]);
+                    if (!(temporaries_written & bit))
+                        temporaries_read_first |= bit;
+                }
+                break;
+
+            case RegisterType::FloatUniform:
+                components = &uniforms.f[reg.GetIndex()].x;
+                component_stride = 1;
+                lane_stride = 0;
+                break;
+
+            default:
+                return false;
+            }
+
+            for (int comp = 0; comp < 4; ++comp) {
+                const float24* src = components + selectors[comp] * component_stride;
+                if (lane_stride == 0) {
+                    std::fill(out[comp] + lane, out[comp] + end, negate ? -*src : *src);
+                } else if (negate) {
+                    std::transform(src + lane, src + end, out[comp] + lane,
+                                   [](float24 value) { return -value; });
+                } else {
+                    std::copy(src + lane, src + end, out[comp] + lane);
+                }
+            }
+            lane = end;
+        }
+        return true;
+    };
+
+    /// Looks up the destination registers, marking the written components of temporaries
+    auto lookup_dest = [&](const DestRegister& dest_reg,
+                           const SwizzlePattern& swizzle) -> LaneRegister* {
+        const int index = dest_reg.GetIndex();
+        if (dest_reg < 0x10) {
+            if (!(output_lanes & (1 << index))) {
+                copy_to_lanes(regs.output[index], state.registers.output[index]);
+                output_lanes |= 1 << index;
+            }
+            return &regs.output[index];
+        }
+        if (dest_reg >= 0x20)
+            return nullptr;
+
+        for (int comp = 0; comp < 4; ++comp) {
+            if (swizzle.DestComponentEnabled(comp))
+                temporaries_written |= u64(1) << (index * 4 + comp);
+        }
+        if (!(temporary_lanes & (1 << index))) {
+            copy_to_lanes(regs.temporary[index], state.registers.temporary[index]);
+            temporary_lanes |= 1 << index;
+        }
+        return &regs.temporary[index];
+    };
+
+    bool exit_loop = false;
+    while (!exit_loop) {
+        if (!call_stack.empty()) {
+            auto& top = call_stack.back();
+            if (program_counter == top.final_address) {
+                for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                    regs.address[2][lane] += top.loop_increment;
+                }
+
+                if (top.repeat_counter-- == 0) {
+                    program_counter = top.return_address;
+                    call_stack.pop_back();
+                } else {
+                    program_counter = top.loop_address;
+                }
+
+                continue;
+            }
+        }
+
+        const Instruction instr = {program_code[program_counter]};
+
+        switch (instr.opcode.Value().GetInfo().type) {
+        case OpCode::Type::Arithmetic: {
+            const SwizzlePattern swizzle = {swizzle_data[instr.common.operand_desc_id]};
+            const bool is_inverted =
+                (0 != (instr.opcode.Value().GetInfo().subtype & OpCode::Info::SrcInversed));
+            const int address_register_index = instr.common.address_register_index;
+
+            const int src1_selectors[4] = {
+                (int)swizzle.src1_selector_0.Value(), (int)swizzle.src1_selector_1.Value(),
+                (int)swizzle.src1_selector_2.Value(), (int)swizzle.src1_selector_3.Value(),
+            };
+            const int src2_selectors[4] = {
+                (int)swizzle.src2_selector_0.Value(), (int)swizzle.src2_selector_1.Value(),
+                (int)swizzle.src2_selector_2.Value(), (int)swizzle.src2_selector_3.Value(),
+            };
+
+            LaneRegister src1, src2;
+            if (!load_source(instr.common.GetSrc1(is_inverted),
+                             is_inverted ? 0 : address_register_index, src1_selectors,
+                             (bool)swizzle.negate_src1, src1) ||
+                !load_source(instr.common.GetSrc2(is_inverted),
+                             is_inverted ? address_register_index : 0, src2_selectors,
+                             (bool)swizzle.negate_src2, src2))
+                return false;
+
+            const OpCode::Id opcode = instr.opcode.Value().EffectiveOpCode();
+            if (opcode == OpCode::Id::CMP) {
+                for (int i = 0; i < 2; ++i) {
+                    auto compare_op = instr.common.compare_op;
+                    auto op = (i == 0) ? compare_op.x.Value() : compare_op.y.Value();
+
+                    for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                        const float24 a = src1[i][lane];
+                        const float24 b = src2[i][lane];
+                        bool& result = regs.conditional_code[i][lane];
+
+                        switch (op) {
+                        case Instruction::Common::CompareOpType::Equal:
+                            result = (a == b);
+                            break;
+
+                        case Instruction::Common::CompareOpType::NotEqual:
+                            result = (a != b);
+                            break;
+
+                        case Instruction::Common::CompareOpType::LessThan:
+                            result = (a < b);
+                            break;
+
+                        case Instruction::Common::CompareOpType::LessEqual:
+                            result = (a <= b);
+                            break;
+
+                        case Instruction::Common::CompareOpType::GreaterThan:
+                            result = (a > b);
+                            break;
+
+                        case Instruction::Common::CompareOpType::GreaterEqual:
+                            result = (a >= b);
+                            break;
+
+                        default:
+                            // Left to the interpreter, which reports it
+                            return false;
+                        }
+                    }
+                }
+                break;
+            }
+
+            if (opcode == OpCode::Id::MOVA) {
+                for (int i = 0; i < 2; ++i) {
+                    if (!swizzle.DestComponentEnabled(i))
+                        continue;
+
+                    address_written |= 1 << i;
+                    for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                        regs.address[i][lane] = static_cast<s32>(src1[i][lane].ToFloat32());
+                    }
+                }
+                break;
+            }
+
+            LaneRegister* const dest_ = lookup_dest(instr.common.dest.Value(), swizzle);
+            if (dest_ == nullptr)
+                return false;
+            LaneRegister& dest = *dest_;
+
+            // Runs an operation computing one value per lane for the whole destination, like the
+            // dot products and the operations on the first component
+            auto write_all = [&](auto op) {
+                float24 result[BATCH_LANES];
+                for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                    result[lane] = op(lane);
+                }
+                for (int comp = 0; comp < 4; ++comp) {
+                    if (!swizzle.DestComponentEnabled(comp))
+                        continue;
+
+                    std::copy_n(result, BATCH_LANES, dest[comp]);
+                }
+            };
+
+            // Runs an operation on each component of each lane
+            auto write_each = [&](auto op) {
+                for (int comp = 0; comp < 4; ++comp) {
+                    if (!swizzle.DestComponentEnabled(comp))
+                        continue;
+
+                    for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                        dest[comp][lane] = op(src1[comp][lane], src2[comp][lane]);
+                    }
+                }
+            };
+
+            switch (opcode) {
+            case OpCode::Id::ADD:
+                write_each([](float24 a, float24 b) { return a + b; });
+                break;
+
+            case OpCode::Id::MUL:
+                write_each([](float24 a, float24 b) { return a * b; });
+                break;
+
+            case OpCode::Id::FLR:
+                write_each([](float24 a, float24) {
+                    return float24::FromFloat32(std::floor(a.ToFloat32()));
+                });
+                break;
+
+            case OpCode::Id::MAX:
+                // Same NaN semantics as the interpreter
+                write_each([](float24 a, float24 b) { return (a > b) ? a : b; });
+                break;
+
+            case OpCode::Id::MIN:
+                write_each([](float24 a, float24 b) { return (a < b) ? a : b; });
+                break;
+
+            case OpCode::Id::DP3:
+            case OpCode::Id::DP4:
+            case OpCode::Id::DPH:
+            case OpCode::Id::DPHI: {
+                if (opcode == OpCode::Id::DPH || opcode == OpCode::Id::DPHI)
+                    std::fill_n(src1[3], BATCH_LANES, float24::FromFloat32(1.0f));
+
+                const int num_components = (opcode == OpCode::Id::DP3) ? 3 : 4;
+                write_all([&](size_t lane) {
+                    float24 dot = float24::FromFloat32(0.f);
+                    for (int comp = 0; comp < num_components; ++comp) {
+                        dot = dot + src1[comp][lane] * src2[comp][lane];
+                    }
+                    return dot;
+                });
+                break;
+            }
+
+            case OpCode::Id::RCP:
+                write_all([&](size_t lane) {
+                    return float24::FromFloat32(1.0f / src1[0][lane].ToFloat32());
+                });
+                break;
+
+            case OpCode::Id::RSQ:
+                write_all([&](size_t lane) {
+                    return float24::FromFloat32(1.0f / std::sqrt(src1[0][lane].ToFloat32()));
+                });
+                break;
+
+            case OpCode::Id::MOV:
+                write_each([](float24 a, float24) { return a; });
+                break;
+
+            case OpCode::Id::SGE:
+            case OpCode::Id::SGEI:
+                write_each([](float24 a, float24 b) {
+                    return (a >= b) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+                });
+                break;
+
+            case OpCode::Id::SLT:
+            case OpCode::Id::SLTI:
+                write_each([](float24 a, float24 b) {
+                    return (a < b) ? float24::FromFloat32(1.0f) : float24::FromFloat32(0.0f);
+                });
+                break;
+
+            case OpCode::Id::EX2:
+                write_all([&](size_t lane) {
+                    return float24::FromFloat32(std::exp2(src1[0][lane].ToFloat32()));
+                });
+                break;
+
+            case OpCode::Id::LG2:
+                write_all([&](size_t lane) {
+                    return float24::FromFloat32(std::log2(src1[0][lane].ToFloat32()));
+                });
+                break;
+
+            default:
+                // Left to the interpreter, which reports it
+                return false;
+            }
+            break;
+        }
+
+        case OpCode::Type::MultiplyAdd: {
+            if ((instr.opcode.Value().EffectiveOpCode() != OpCode::Id::MAD) &&
+                (instr.opcode.Value().EffectiveOpCode() != OpCode::Id::MADI))
+                return false;
+
+            const SwizzlePattern swizzle = {swizzle_data[instr.mad.operand_desc_id]};
+            const bool is_inverted = (instr.opcode.Value().EffectiveOpCode() == OpCode::Id::MADI);
+            const int address_register_index = instr.mad.address_register_index;
+
+            const int src1_selectors[4] = {
+                (int)swizzle.src1_selector_0.Value(), (int)swizzle.src1_selector_1.Value(),
+                (int)swizzle.src1_selector_2.Value(), (int)swizzle.src1_selector_3.Value(),
+            };
+            const int src2_selectors[4] = {
+                (int)swizzle.src2_selector_0.Value(), (int)swizzle.src2_selector_1.Value(),
+                (int)swizzle.src2_selector_2.Value(), (int)swizzle.src2_selector_3.Value(),
+            };
+            const int src3_selectors[4] = {
+                (int)swizzle.src3_selector_0.Value(), (int)swizzle.src3_selector_1.Value(),
+                (int)swizzle.src3_selector_2.Value(), (int)swizzle.src3_selector_3.Value(),
+            };
+
+            LaneRegister src1, src2, src3;
+            if (!load_source(instr.mad.GetSrc1(is_inverted), 0, src1_selectors,
+                             (bool)swizzle.negate_src1, src1) ||
+                !load_source(instr.mad.GetSrc2(is_inverted),
+                             is_inverted ? 0 : address_register_index, src2_selectors,
+                             (bool)swizzle.negate_src2, src2) ||
+                !load_source(instr.mad.GetSrc3(is_inverted),
+                             is_inverted ? address_register_index : 0, src3_selectors,
+                             (bool)swizzle.negate_src3, src3))
+                return false;
+
+            LaneRegister* const dest = lookup_dest(instr.mad.dest.Value(), swizzle);
+            if (dest == nullptr)
+                return false;
+
+            for (int comp = 0; comp < 4; ++comp) {
+                if (!swizzle.DestComponentEnabled(comp))
+                    continue;
+
+                for (size_t lane = 0; lane < BATCH_LANES; ++lane) {
+                    (*dest)[comp][lane] =
+                        src1[comp][lane] * src2[comp][lane] + src3[comp][lane];
+                }
+            }
+            break;
+        }
+
+        default: {
+            bool condition;
+            switch (instr.opcode.Value()) {
+            case OpCode::Id::END:
+                exit_loop = true;
+                break;
+
+            case OpCode::Id::JMPC:
+                if (!evaluate_condition(instr.flow_control, condition))
+                    return false;
+                if (condition) {
+                    program_counter = instr.flow_control.dest_offset - 1;
+                }
+                break;
+
+            case OpCode::Id::JMPU:
+                if (uniforms.b[instr.flow_control.bool_uniform_id] ==
+                    !(instr.flow_control.num_instructions & 1)) {
+                    program_counter = instr.flow_control.dest_offset - 1;
+                }
+                break;
+
+            case OpCode::Id::CALL:
+                call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                     program_counter + 1, 0, 0);
+                break;
+
+            case OpCode::Id::CALLU:
+                if (uniforms.b[instr.flow_control.bool_uniform_id]) {
+                    call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                         program_counter + 1, 0, 0);
+                }
+                break;
+
+            case OpCode::Id::CALLC:
+                if (!evaluate_condition(instr.flow_control, condition))
+                    return false;
+                if (condition) {
+                    call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                         program_counter + 1, 0, 0);
+                }
+                break;
+
+            case OpCode::Id::NOP:
+                break;
+
+            case OpCode::Id::IFU:
+                if (uniforms.b[instr.flow_control.bool_uniform_id]) {
+                    call(program_counter + 1, instr.flow_control.dest_offset - program_counter - 1,
+                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0,
+                         0);
+                } else {
+                    call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0,
+                         0);
+                }
+                break;
+
+            case OpCode::Id::IFC:
+                if (!evaluate_condition(instr.flow_control, condition))
+                    return false;
+                if (condition) {
+                    call(program_counter + 1, instr.flow_control.dest_offset - program_counter - 1,
+                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0,
+                         0);
+                } else {
+                    call(instr.flow_control.dest_offset, instr.flow_control.num_instructions,
+                         instr.flow_control.dest_offset + instr.flow_control.num_instructions, 0,
+                         0);
+                }
+                break;
+
+            case OpCode::Id::LOOP: {
+                Math::Vec4<u8> loop_param(uniforms.i[instr.flow_control.int_uniform_id].x,
+                                          uniforms.i[instr.flow_control.int_uniform_id].y,
+                                          uniforms.i[instr.flow_control.int_uniform_id].z,
+                                          uniforms.i[instr.flow_control.int_uniform_id].w);
+                address_written |= 1 << 2;
+                std::fill_n(regs.address[2], BATCH_LANES, loop_param.y);
+
+                call(program_counter + 1, instr.flow_control.dest_offset - program_counter + 1,
+                     instr.flow_control.dest_offset + 1, loop_param.x, loop_param.z);
+                break;
+            }
+
+            default:
+                // Left to the interpreter, which reports it
+                return false;
+            }
+            break;
+        }
+        }
+
+        ++program_counter;
+    }
+
+    // Each vertex would have seen what the one before it left in these registers
+    if ((temporaries_read_first & temporaries_written) != 0 ||
+        (address_read_first & address_written) != 0)
+        return false;
+
+    const auto& pica_regs = g_state.regs;
+    Math::Vec4<float24> lane_output[16];
+    std::copy_n(state.registers.output, 16, lane_output);
+    for (size_t lane = 0; lane < count; ++lane) {
+        for (int reg : BitSet32(output_lanes)) {
+            for (int comp = 0; comp < 4; ++comp) {
+                lane_output[reg][comp] = regs.output[reg][comp][lane];
+            }
+        }
+        outputs[lane] = OutputVertex::FromRegisters(lane_output, pica_regs,
+                                                    pica_regs.vs.output_mask);
+    }
+
+    // Leave the unit as the last vertex would have
+    const size_t last = count - 1;
+    auto copy_from_lane = [last](Math::Vec4<float24>& value, const LaneRegister& lanes) {
+        for (int comp = 0; comp < 4; ++comp) {
+            value[comp] = lanes[comp][last];
+        }
+    };
+    for (int reg : BitSet32(input_lanes)) {
+        copy_from_lane(state.registers.input[reg], regs.input[reg]);
+    }
+    for (int reg : BitSet32(temporary_lanes)) {
+        copy_from_lane(state.registers.temporary[reg], regs.temporary[reg]);
+    }
+    std::copy_n(lane_output, 16, state.registers.output);
+    for (int i = 0; i < 3; ++i) {
+        state.address_registers[i] = regs.address[i][last];
+    }
+    for (int i = 0; i < 2; ++i) {
+        state.conditional_code[i] = regs.conditional_code[i][last];
+    }
+    return true;
+}
+
 void InterpreterEngine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < 1024);
     setup.engine_data.entry_point = entry_point;
@@ -667,6 +1314,32 @@ void InterpreterEngine::Run(const ShaderSetup& setup, UnitState& state) const {
     RunInterpreter(setup, state, dummy_debug_data, setup.engine_data.entry_point);
 }
 
+void InterpreterEngine::RunBatch(const ShaderSetup& setup, UnitState& state,
+                                 const InputVertex* inputs, int num_attributes,
+                                 OutputVertex* outputs, size_t count) const {
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    for (size_t start = 0; start < count; start += BATCH_LANES) {
+        const size_t lanes = std::min(BATCH_LANES, count - start);
+        if (RunLockstepInterpreter(setup, state, inputs + start, num_attributes, outputs + start,
+                                   lanes, setup.engine_data.entry_point)) {
+            lockstep_vertices.fetch_add(lanes, std::memory_order_relaxed);
+            continue;
+        }
+
+        ShaderEngine::RunBatch(setup, state, inputs + start, num_attributes, outputs + start,
+                               lanes);
+        serial_vertices.fetch_add(lanes, std::memory_order_relaxed);
+    }
+}
+
+InterpreterEngine::Stats InterpreterEngine::GetStats() const {
+    Stats stats;
+    stats.lockstep_vertices = lockstep_vertices.load(std::memory_order_relaxed);
+    stats.serial_vertices = serial_vertices.load(std::memory_order_relaxed);
+    return stats;
+}
+
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
                                                     const InputVertex& input,
                                                     int num_attributes) const {
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <atomic>
+#include "common/common_types.h"
 #include "video_core/shader/debug_data.h"
 #include "video_core/shader/shader.h"
 
@@ -13,9 +15,27 @@ namespace Shader {
 
 class InterpreterEngine final : public ShaderEngine {
 public:
+    /// Counters describing how the batches were run since the engine was created
+    struct Stats {
+        /// Number of vertices run in lockstep with the other vertices of their batch
+        u64 lockstep_vertices;
+        /// Number of vertices run one at a time, as their batch couldn't run in lockstep
+        u64 serial_vertices;
+    };
+
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
 
+    /**
+     * Runs the vertices in groups, each instruction being decoded once for the whole group and
+     * run on the registers of all its vertices. Groups whose vertices take different branches run
+     * one vertex at a time instead.
+     */
+    void RunBatch(const ShaderSetup& setup, UnitState& state, const InputVertex* inputs,
+                  int num_attributes, OutputVertex* outputs, size_t count) const override;
+
+    Stats GetStats() const;
+
     /**
      * Produce debug information based on the given shader and input vertex
      * @param input Input vertex into the shader
@@ -25,6 +45,10 @@ public:
      */
     DebugData<true> ProduceDebugInfo(const ShaderSetup& setup, const InputVertex& input,
                                      int num_attributes) const;
+
+private:
+    mutable std::atomic<u64> lockstep_vertices{0};
+    mutable std::atomic<u64> serial_vertices{0};
 };
 
 } // namespace
@@ -1,18 +1,77 @@
 // Copyright 2016 Citra Emulator Project
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <functional>
 #include "common/avx_utils.h"
+#include "common/bit_set.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/microprofile.h"
+#include "common/string_util.h"
+#include "common/thread.h"
+#include "video_core/pica_state.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit_x64.h"
 #include "video_core/shader/shader_jit_x64_compiler.h"
+#include "video_core/video_core.h"
 
 namespace Pica {
 namespace Shader {
 
-JitX64Engine::JitX64Engine() = default;
-JitX64Engine::~JitX64Engine() = default;
+MICROPROFILE_DEFINE(GPU_ShaderCompile, "GPU", "Shader JIT Compile", MP_RGB(100, 50, 180));
+
+// Each disk cache entry holds the program code followed by the swizzle data
+static constexpr u32 DISK_CACHE_VALUE_SIZE = 2 * 1024;
+
+namespace {
+
+class ShaderProgramReader final : public LinearDiskCacheReader<u64, u32> {
+public:
+    explicit ShaderProgramReader(std::function<void(u64, const u32*)> callback)
+        : callback(std::move(callback)) {}
+
+    void Read(const u64& key, const u32* value, u32 value_size) override {
+        if (value_size == DISK_CACHE_VALUE_SIZE)
+            callback(key, value);
+    }
+
+private:
+    std::function<void(u64, const u32*)> callback;
+};
+
+} // anonymous namespace
+
+JitX64Engine::JitX64Engine() {
+    if (VideoCore::g_disk_shader_cache_enabled && VideoCore::g_program_id != 0) {
+        OpenDiskCache();
+    }
+}
+
+JitX64Engine::~JitX64Engine() {
+    if (compile_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(compile_mutex);
+            stop_compiling = true;
+        }
+        queue_cv.notify_one();
+        compile_thread.join();
+    }
+
+    const Stats stats = GetStats();
+    LOG_INFO(HW_GPU,
+             "Shader JIT: %" PRIu64 " hits, %" PRIu64 " misses, %" PRIu64 " interpreter fallbacks, "
+             "%" PRIu64 " compiled in background, %" PRIu64 " us compiling, %" PRIu64
+             " bytes of code",
+             stats.hits, stats.misses, stats.fallbacks, stats.background_compiles,
+             stats.compile_time_us, stats.code_size);
+}
 
 void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     ASSERT(entry_point < 1024);
@@ -25,18 +84,184 @@ void JitX64Engine::SetupBatch(ShaderSetup& setup, unsigned int entry_point) {
     auto iter = cache.find(cache_key);
     if (iter != cache.end()) {
         setup.engine_data.cached_shader = iter->second.get();
+        ++hits;
+        return;
+    }
+
+    const bool async = VideoCore::g_async_shader_compilation;
+    std::unique_ptr<JitShader> shader = TakeCompiledShader(cache_key, setup, async);
+    if (shader != nullptr) {
+        ++hits;
     } else {
-        auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.engine_data.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        ++misses;
+        StoreProgram(cache_key, setup);
+
+        if (async) {
+            ++fallbacks;
+            setup.engine_data.cached_shader = nullptr;
+            interpreter.SetupBatch(setup, entry_point);
+            return;
+        }
+
+        shader = Compile(setup.program_code, setup.swizzle_data);
+    }
+
+    setup.engine_data.cached_shader = shader.get();
+    cache.emplace_hint(iter, cache_key, std::move(shader));
+}
+
+JitX64Engine::Stats JitX64Engine::GetStats() const {
+    return {hits, misses, fallbacks, background_compiles, compile_time_us, code_size};
+}
+
+std::unique_ptr<JitShader> JitX64Engine::Compile(const std::array<u32, 1024>& program_code,
+                                                 const std::array<u32, 1024>& swizzle_data) {
+    MICROPROFILE_SCOPE(GPU_ShaderCompile);
+    const auto start = std::chrono::steady_clock::now();
+
+    auto shader = std::make_unique<JitShader>();
+    shader->Compile(&program_code, &swizzle_data);
+
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    compile_time_us += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    code_size += shader->getSize();
+    return shader;
+}
+
+void JitX64Engine::OpenDiskCache() {
+    const std::string filename = FileUtil::GetUserPath(D_CACHE_IDX) + "shader" DIR_SEP +
+                                 Common::StringFromFormat("%016" PRIX64 ".bin",
+                                                          VideoCore::g_program_id);
+    if (!FileUtil::Exists(filename))
+        FileUtil::CreateFullPath(filename);
+
+    std::deque<ShaderProgram> programs;
+    ShaderProgramReader reader([&](u64 key, const u32* value) {
+        if (!disk_keys.insert(key).second)
+            return;
+
+        programs.emplace_back();
+        ShaderProgram& program = programs.back();
+        program.key = key;
+        std::memcpy(program.program_code.data(), value, sizeof(program.program_code));
+        std::memcpy(program.swizzle_data.data(), value + program.program_code.size(),
+                    sizeof(program.swizzle_data));
+    });
+
+    disk_cache = std::make_unique<LinearDiskCache<u64, u32>>();
+    disk_cache->OpenAndRead(filename, reader);
+
+    LOG_INFO(HW_GPU, "Prewarming %zu shaders from %s", programs.size(), filename.c_str());
+    if (!programs.empty()) {
+        compile_queue = std::move(programs);
+        StartCompileThread();
+    }
+}
+
+void JitX64Engine::StoreProgram(u64 key, const ShaderSetup& setup) {
+    if (!disk_cache || !disk_keys.insert(key).second)
+        return;
+
+    std::array<u32, DISK_CACHE_VALUE_SIZE> value;
+    std::copy(setup.program_code.begin(), setup.program_code.end(), value.begin());
+    std::copy(setup.swizzle_data.begin(), setup.swizzle_data.end(),
+              value.begin() + setup.program_code.size());
+    disk_cache->Append(key, value.data(), DISK_CACHE_VALUE_SIZE);
+    disk_cache->Sync();
+}
+
+std::unique_ptr<JitShader> JitX64Engine::TakeCompiledShader(u64 key, const ShaderSetup& setup,
+                                                            bool async) {
+    if (!async && !compile_thread.joinable())
+        return nullptr;
+
+    std::unique_lock<std::mutex> lock(compile_mutex);
+
+    // Wait for a shader that is already being compiled rather than compiling it a second time
+    if (!async) {
+        done_cv.wait(lock, [&] { return !compiling || compiling_key != key; });
+    }
+
+    auto compiled = compiled_shaders.find(key);
+    if (compiled != compiled_shaders.end()) {
+        std::unique_ptr<JitShader> shader = std::move(compiled->second);
+        compiled_shaders.erase(compiled);
+        return shader;
+    }
+
+    auto queued = std::find_if(compile_queue.begin(), compile_queue.end(),
+                               [key](const ShaderProgram& program) { return program.key == key; });
+    if (!async) {
+        if (queued != compile_queue.end())
+            compile_queue.erase(queued);
+        return nullptr;
+    }
+
+    if (compiling && compiling_key == key)
+        return nullptr;
+
+    if (queued == compile_queue.end()) {
+        ShaderProgram program;
+        program.key = key;
+        program.program_code = setup.program_code;
+        program.swizzle_data = setup.swizzle_data;
+        compile_queue.push_front(std::move(program));
+    } else if (queued != compile_queue.begin()) {
+        // The shader was queued for prewarming, but is needed right now
+        ShaderProgram program = std::move(*queued);
+        compile_queue.erase(queued);
+        compile_queue.push_front(std::move(program));
+    }
+
+    lock.unlock();
+    StartCompileThread();
+    queue_cv.notify_one();
+    return nullptr;
+}
+
+void JitX64Engine::StartCompileThread() {
+    if (!compile_thread.joinable()) {
+        compile_thread = std::thread(&JitX64Engine::CompileThread, this);
+    }
+}
+
+void JitX64Engine::CompileThread() {
+    Common::SetCurrentThreadName("ShaderCompile");
+
+    while (true) {
+        ShaderProgram program;
+        {
+            std::unique_lock<std::mutex> lock(compile_mutex);
+            queue_cv.wait(lock, [this] { return stop_compiling || !compile_queue.empty(); });
+            if (stop_compiling)
+                return;
+
+            program = std::move(compile_queue.front());
+            compile_queue.pop_front();
+            compiling = true;
+            compiling_key = program.key;
+        }
+
+        auto shader = Compile(program.program_code, program.swizzle_data);
+
+        {
+            std::lock_guard<std::mutex> lock(compile_mutex);
+            compiled_shaders.emplace(program.key, std::move(shader));
+            compiling = false;
+            ++background_compiles;
+        }
+        done_cv.notify_all();
     }
 }
 
 MICROPROFILE_DECLARE(GPU_Shader);
 
 void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
-    ASSERT(setup.engine_data.cached_shader != nullptr);
+    // The shader is still being compiled in asynchronous mode
+    if (setup.engine_data.cached_shader == nullptr) {
+        interpreter.Run(setup, state);
+        return;
+    }
 
     MICROPROFILE_SCOPE(GPU_Shader);
 
@@ -45,5 +270,56 @@ void JitX64Engine::Run(const ShaderSetup& setup, UnitState& state) const {
     shader->Run(setup, state, setup.engine_data.entry_point);
 }
 
+void JitX64Engine::RunBatch(const ShaderSetup& setup, UnitState& state, const InputVertex* inputs,
+                            int num_attributes, OutputVertex* outputs, size_t count) const {
+    if (setup.engine_data.cached_shader == nullptr) {
+        interpreter.RunBatch(setup, state, inputs, num_attributes, outputs, count);
+        return;
+    }
+
+    MICROPROFILE_SCOPE(GPU_Shader);
+
+    const JitShader* shader = static_cast<const JitShader*>(setup.engine_data.cached_shader);
+    const auto& regs = g_state.regs;
+
+    std::array<int, 16> attribute_registers;
+    BitSet32 unmapped_registers(0xFFFF);
+    for (int i = 0; i < num_attributes; ++i) {
+        attribute_registers[i] = regs.vs.input_register_map.GetRegisterForAttribute(i);
+        unmapped_registers[attribute_registers[i]] = false;
+    }
+
+    constexpr size_t BATCH_SIZE = 64;
+    std::array<JitShader::VertexRegisters, BATCH_SIZE> input_registers;
+    std::array<JitShader::VertexRegisters, BATCH_SIZE> output_registers;
+
+    ZeroUpperAVX();
+
+    for (size_t batch_start = 0; batch_start < count; batch_start += BATCH_SIZE) {
+        const size_t batch_size = std::min(BATCH_SIZE, count - batch_start);
+
+        for (size_t i = 0; i < batch_size; ++i) {
+            auto& input = input_registers[i];
+            for (int attribute = 0; attribute < num_attributes; ++attribute) {
+                input.reg[attribute_registers[attribute]] =
+                    inputs[batch_start + i].attr[attribute];
+            }
+
+            // Registers without an attribute keep their value, like with LoadInputVertex
+            for (int reg : unmapped_registers) {
+                input.reg[reg] = state.registers.input[reg];
+            }
+        }
+
+        shader->RunBatch(setup, state, setup.engine_data.entry_point, input_registers.data(),
+                         output_registers.data(), batch_size);
+
+        for (size_t i = 0; i < batch_size; ++i) {
+            outputs[batch_start + i] = OutputVertex::FromRegisters(output_registers[i].reg, regs,
+                                                                   regs.vs.output_mask);
+        }
+    }
+}
+
 } // namespace Shader
 } // namespace Pica
@@ -4,10 +4,20 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include "common/common_types.h"
+#include "common/linear_disk_cache.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
 
 namespace Pica {
 namespace Shader {
@@ -16,14 +26,101 @@ class JitShader;
 
 class JitX64Engine final : public ShaderEngine {
 public:
+    /// Counters describing the work done by the JIT since the engine was created
+    struct Stats {
+        /// Number of SetupBatch calls that found a compiled shader
+        u64 hits;
+        /// Number of SetupBatch calls that didn't find a compiled shader
+        u64 misses;
+        /// Number of SetupBatch calls that fell back to the interpreter during compilation
+        u64 fallbacks;
+        /// Number of shaders compiled on the compile thread
+        u64 background_compiles;
+        /// Total time spent compiling shaders, in microseconds
+        u64 compile_time_us;
+        /// Total size of the compiled code, in bytes
+        u64 code_size;
+    };
+
     JitX64Engine();
     ~JitX64Engine() override;
 
+    /**
+     * Looks up or compiles the shader. In asynchronous mode, a shader that isn't compiled yet is
+     * queued for the compile thread instead, and the batch runs on the interpreter. Later batches
+     * switch over to the compiled shader once it is ready.
+     */
     void SetupBatch(ShaderSetup& setup, unsigned int entry_point) override;
     void Run(const ShaderSetup& setup, UnitState& state) const override;
+    void RunBatch(const ShaderSetup& setup, UnitState& state, const InputVertex* inputs,
+                  int num_attributes, OutputVertex* outputs, size_t count) const override;
+
+    Stats GetStats() const;
 
 private:
+    /// Program and swizzle data of a shader, as recorded in the disk cache
+    struct ShaderProgram {
+        u64 key;
+        std::array<u32, 1024> program_code;
+        std::array<u32, 1024> swizzle_data;
+    };
+
+    std::unique_ptr<JitShader> Compile(const std::array<u32, 1024>& program_code,
+                                       const std::array<u32, 1024>& swizzle_data);
+
+    /**
+     * Opens the disk cache of the running title and queues the shaders recorded in it on the
+     * compile thread.
+     */
+    void OpenDiskCache();
+
+    /// Appends the shader to the disk cache, unless it is already stored there
+    void StoreProgram(u64 key, const ShaderSetup& setup);
+
+    /**
+     * Fetches the shader from the compile thread. If it is queued, it is either removed from the
+     * queue to be compiled by the caller, or in asynchronous mode moved to the front of the queue.
+     * @returns The compiled shader, or nullptr if it isn't ready
+     */
+    std::unique_ptr<JitShader> TakeCompiledShader(u64 key, const ShaderSetup& setup, bool async);
+
+    void StartCompileThread();
+
+    /// Compiles the queued shaders, run on the compile thread
+    void CompileThread();
+
     std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+
+    /// Runs the shaders that are still being compiled in asynchronous mode
+    InterpreterEngine interpreter;
+
+    /// Records the shaders seen for the running title, nullptr if disabled
+    std::unique_ptr<LinearDiskCache<u64, u32>> disk_cache;
+    /// Keys of the shaders stored in the disk cache
+    std::unordered_set<u64> disk_keys;
+
+    std::thread compile_thread;
+    /// Protects all members below, up to the counters
+    std::mutex compile_mutex;
+    /// Signaled when a shader is queued or the compile thread has to stop
+    std::condition_variable queue_cv;
+    /// Signaled when the compile thread finishes a shader
+    std::condition_variable done_cv;
+    /// Shaders waiting to be compiled, the most urgent ones first
+    std::deque<ShaderProgram> compile_queue;
+    /// Shaders finished by the compile thread that weren't taken by SetupBatch yet
+    std::unordered_map<u64, std::unique_ptr<JitShader>> compiled_shaders;
+    /// Whether the compile thread is compiling the shader with compiling_key
+    bool compiling = false;
+    u64 compiling_key = 0;
+    bool stop_compiling = false;
+
+    std::atomic<u64> hits{0};
+    std::atomic<u64> misses{0};
+    std::atomic<u64> fallbacks{0};
+    std::atomic<u64> background_compiles{0};
+    std::atomic<u64> compile_time_us{0};
+    std::atomic<u64> code_size{0};
 };
 
 } // namespace Shader
@@ -99,8 +99,8 @@ const JitFunction instr_table[64] = {
     &JitShader::Compile_MAD,   // mad
 };
 
-// The following is used to alias some commonly used registers. Generally, RAX-RDX and XMM0-XMM3 can
-// be used as scratch registers within a compiler function. The other registers have designated
+// The following is used to alias some commonly used registers. Generally, RAX, RCX, RDX and XMM0-XMM3
+// can be used as scratch registers within a compiler function. The other registers have designated
 // purposes, as documented below:
 
 /// Pointer to the uniform memory
@@ -120,6 +120,11 @@ static const Reg64 COND0 = r13;
 static const Reg64 COND1 = r14;
 /// Pointer to the UnitState instance for the current VS unit
 static const Reg64 STATE = r15;
+/// Stack pointer at the entry of the shader program, restored by END to return from any subroutine
+/// depth. Callee-saved, so it survives calls to external functions.
+static const Reg64 ENTRY_RSP = rbx;
+/// Pointer to the arguments of the running batch, only used outside of the shader program itself
+static const Reg64 BATCH = rbp;
 /// SIMD scratch register
 static const Xmm SCRATCH = xmm0;
 /// Loaded with the first swizzled source register, otherwise can be used as a scratch register
@@ -310,18 +315,18 @@ void JitShader::Compile_EvaluateCondition(Instruction instr) {
     switch (instr.flow_control.op) {
     case Instruction::FlowControlType::Or:
         mov(eax, COND0);
-        mov(ebx, COND1);
+        mov(ecx, COND1);
         xor(eax, (instr.flow_control.refx.Value() ^ 1));
-        xor(ebx, (instr.flow_control.refy.Value() ^ 1));
-        or (eax, ebx);
+        xor(ecx, (instr.flow_control.refy.Value() ^ 1));
+        or (eax, ecx);
         break;
 
     case Instruction::FlowControlType::And:
         mov(eax, COND0);
-        mov(ebx, COND1);
+        mov(ecx, COND1);
         xor(eax, (instr.flow_control.refx.Value() ^ 1));
-        xor(ebx, (instr.flow_control.refy.Value() ^ 1));
-        and(eax, ebx);
+        xor(ecx, (instr.flow_control.refy.Value() ^ 1));
+        and(eax, ecx);
         break;
 
     case Instruction::FlowControlType::JustX:
@@ -587,8 +592,8 @@ void JitShader::Compile_RSQ(Instruction instr) {
 void JitShader::Compile_NOP(Instruction instr) {}
 
 void JitShader::Compile_END(Instruction instr) {
-    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8);
-    ret();
+    // END may be reached from within a subroutine, so a plain `ret` isn't enough
+    jmp(program_end, T_NEAR);
 }
 
 void JitShader::Compile_CALL(Instruction instr) {
@@ -802,6 +807,81 @@ void JitShader::Compile_NextInstr() {
     }
 }
 
+void JitShader::Compile_LoadConstants() {
+    // Used to set a register to one
+    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
+    mov(rax, reinterpret_cast<size_t>(&one));
+    movaps(ONE, xword[rax]);
+
+    // Used to negate registers
+    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
+    mov(rax, reinterpret_cast<size_t>(&neg));
+    movaps(NEGBIT, xword[rax]);
+}
+
+void JitShader::Compile_CallProgram(const Xbyak::Operand& entry) {
+    // Zero address/loop  registers
+    xor(ADDROFFS_REG_0.cvt32(), ADDROFFS_REG_0.cvt32());
+    xor(ADDROFFS_REG_1.cvt32(), ADDROFFS_REG_1.cvt32());
+    xor(LOOPCOUNT_REG, LOOPCOUNT_REG);
+
+    // Compile_Return peeks at the stack slot above the return address for the offset pushed by
+    // Compile_CALL. Fill it with an offset that never matches, which also keeps the stack pointer
+    // 16-byte aligned within the program.
+    push(qword, -1);
+
+    // The stack pointer as it is after pushing the return address, see Compile_ProgramEnd
+    lea(ENTRY_RSP, ptr[rsp - 8]);
+    call(entry);
+    add(rsp, 8);
+}
+
+void JitShader::Compile_ProgramEnd() {
+    // Discard the frames of all subroutines that are still running and return to
+    // Compile_CallProgram
+    L(program_end);
+    mov(rsp, ENTRY_RSP);
+    ret();
+}
+
+void JitShader::Compile_BatchProgram() {
+    batch_program = (CompiledBatch*)getCurr();
+
+    ABI_PushRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8);
+
+    mov(SETUP, ABI_PARAM1);
+    mov(STATE, ABI_PARAM2);
+    mov(BATCH, ABI_PARAM3);
+    Compile_LoadConstants();
+
+    Label loop;
+    L(loop);
+
+    mov(rax, qword[BATCH + offsetof(BatchArgs, inputs)]);
+    for (size_t i = 0; i < 16; ++i) {
+        const size_t reg_offset = i * sizeof(Math::Vec4<float24>);
+        movaps(SCRATCH, xword[rax + reg_offset]);
+        movaps(xword[STATE + offsetof(UnitState, registers.input) + reg_offset], SCRATCH);
+    }
+
+    Compile_CallProgram(qword[BATCH + offsetof(BatchArgs, start_addr)]);
+
+    mov(rax, qword[BATCH + offsetof(BatchArgs, outputs)]);
+    for (size_t i = 0; i < 16; ++i) {
+        const size_t reg_offset = i * sizeof(Math::Vec4<float24>);
+        movaps(SCRATCH, xword[STATE + offsetof(UnitState, registers.output) + reg_offset]);
+        movaps(xword[rax + reg_offset], SCRATCH);
+    }
+
+    add(qword[BATCH + offsetof(BatchArgs, inputs)], sizeof(VertexRegisters));
+    add(qword[BATCH + offsetof(BatchArgs, outputs)], sizeof(VertexRegisters));
+    sub(qword[BATCH + offsetof(BatchArgs, count)], 1);
+    jnz(loop);
+
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8);
+    ret();
+}
+
 void JitShader::FindReturnOffsets() {
     return_offsets.clear();
 
@@ -834,6 +914,7 @@ void JitShader::Compile(const std::array<u32, 1024>* program_code_,
     program_counter = 0;
     looping = false;
     instruction_labels.fill(Xbyak::Label());
+    program_end = Xbyak::Label();
 
     // Find all `CALL` instructions and identify return locations
     FindReturnOffsets();
@@ -843,27 +924,17 @@ void JitShader::Compile(const std::array<u32, 1024>* program_code_,
 
     mov(SETUP, ABI_PARAM1);
     mov(STATE, ABI_PARAM2);
+    Compile_LoadConstants();
+    Compile_CallProgram(ABI_PARAM3);
 
-    // Zero address/loop  registers
-    xor(ADDROFFS_REG_0.cvt32(), ADDROFFS_REG_0.cvt32());
-    xor(ADDROFFS_REG_1.cvt32(), ADDROFFS_REG_1.cvt32());
-    xor(LOOPCOUNT_REG, LOOPCOUNT_REG);
-
-    // Used to set a register to one
-    static const __m128 one = {1.f, 1.f, 1.f, 1.f};
-    mov(rax, reinterpret_cast<size_t>(&one));
-    movaps(ONE, xword[rax]);
-
-    // Used to negate registers
-    static const __m128 neg = {-0.f, -0.f, -0.f, -0.f};
-    mov(rax, reinterpret_cast<size_t>(&neg));
-    movaps(NEGBIT, xword[rax]);
+    ABI_PopRegistersAndAdjustStack(*this, ABI_ALL_CALLEE_SAVED, 8);
+    ret();
 
-    // Jump to start of the shader program
-    jmp(ABI_PARAM3);
+    Compile_BatchProgram();
 
     // Compile entire program
     Compile_Block(static_cast<unsigned>(program_code->size()));
+    Compile_ProgramEnd();
 
     // Free memory that's no longer needed
     program_code = nullptr;
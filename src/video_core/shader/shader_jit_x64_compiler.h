@@ -32,12 +32,29 @@ constexpr size_t MAX_SHADER_SIZE = 1024 * 64;
  */
 class JitShader : public Xbyak::CodeGenerator {
 public:
+    /// Input or output register file of a single vertex processed by RunBatch
+    struct VertexRegisters {
+        alignas(16) Math::Vec4<float24> reg[16];
+    };
+
     JitShader();
 
     void Run(const ShaderSetup& setup, UnitState& state, unsigned offset) const {
         program(&setup, &state, instruction_labels[offset].getAddress());
     }
 
+    /**
+     * Runs the shader once for each of `count` vertices without leaving the compiled code in
+     * between. For each vertex, the input registers are loaded from `inputs` and the output
+     * registers stored to `outputs`, while all other state carries over like with repeated calls
+     * to Run.
+     */
+    void RunBatch(const ShaderSetup& setup, UnitState& state, unsigned offset,
+                  const VertexRegisters* inputs, VertexRegisters* outputs, size_t count) const {
+        BatchArgs args = {instruction_labels[offset].getAddress(), inputs, outputs, count};
+        batch_program(&setup, &state, &args);
+    }
+
     void Compile(const std::array<u32, 1024>* program_code,
                  const std::array<u32, 1024>* swizzle_data);
 
@@ -72,6 +89,14 @@ private:
     void Compile_Block(unsigned end);
     void Compile_NextInstr();
 
+    /// Loads the constants used by the compiled instructions into their registers
+    void Compile_LoadConstants();
+    /// Emits a call to the shader program entry point in `entry`, with freshly zeroed registers
+    void Compile_CallProgram(const Xbyak::Operand& entry);
+    /// Emits the epilogue END jumps to, which returns from the program at any subroutine depth
+    void Compile_ProgramEnd();
+    void Compile_BatchProgram();
+
     void Compile_SwizzleSrc(Instruction instr, unsigned src_num, SourceRegister src_reg,
                             Xbyak::Xmm dest);
     void Compile_DestEnable(Instruction instr, Xbyak::Xmm dest);
@@ -110,6 +135,9 @@ private:
     /// Mapping of Pica VS instructions to pointers in the emitted code
     std::array<Xbyak::Label, 1024> instruction_labels;
 
+    /// Label of the epilogue emitted by Compile_ProgramEnd
+    Xbyak::Label program_end;
+
     /// Offsets in code where a return needs to be inserted
     std::vector<unsigned> return_offsets;
 
@@ -118,6 +146,17 @@ private:
 
     using CompiledShader = void(const void* setup, void* state, const u8* start_addr);
     CompiledShader* program = nullptr;
+
+    /// Arguments of the compiled batch loop, which it also uses for keeping track of its progress
+    struct BatchArgs {
+        const u8* start_addr;
+        const VertexRegisters* inputs;
+        VertexRegisters* outputs;
+        size_t count;
+    };
+
+    using CompiledBatch = void(const void* setup, void* state, BatchArgs* args);
+    CompiledBatch* batch_program = nullptr;
 };
 
 } // Shader
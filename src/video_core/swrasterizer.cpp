@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "video_core/clipper.h"
+#include "video_core/rasterizer.h"
 #include "video_core/swrasterizer.h"
 
 namespace VideoCore {
@@ -12,4 +13,27 @@ void SWRasterizer::AddTriangle(const Pica::Shader::OutputVertex& v0,
                                const Pica::Shader::OutputVertex& v2) {
     Pica::Clipper::ProcessTriangle(v0, v1, v2);
 }
+
+void SWRasterizer::DrawTriangles() {
+    Pica::Rasterizer::Flush();
+}
+
+void SWRasterizer::NotifyPicaRegisterChanged(u32 id) {
+    // Queued triangles have to be drawn with the register state they were submitted with. Since
+    // triangles are only ever submitted from within a register write, flushing after every write
+    // also guarantees that no triangles are left pending once the command processor returns.
+    Pica::Rasterizer::Flush();
+}
+
+void SWRasterizer::FlushAll() {
+    Pica::Rasterizer::Flush();
+}
+
+void SWRasterizer::FlushRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::Flush();
+}
+
+void SWRasterizer::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    Pica::Rasterizer::Flush();
+}
 }
@@ -0,0 +1,26 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include "video_core/vertex_cache.h"
+
+namespace Pica {
+
+constexpr u32 VertexCache::INVALID_SLOT;
+
+void VertexCache::Reset(u32 min_vertex_, u32 max_vertex, size_t max_vertices) {
+    ASSERT(min_vertex_ <= max_vertex);
+
+    min_vertex = min_vertex_;
+    slot_table.assign(max_vertex - min_vertex + 1, INVALID_SLOT);
+
+    // Slots are handed out as pointers to consecutive vertices, so the storage must never move
+    vertices.clear();
+    vertices.reserve(std::min<size_t>(max_vertices, slot_table.size()));
+
+    hits = 0;
+    misses = 0;
+}
+
+} // namespace Pica
@@ -1,92 +1,87 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
 
 #pragma once
 
-#include <algorithm>
-#include <array>
+#include <vector>
+#include "common/assert.h"
 #include "common/common_types.h"
 #include "video_core/shader/shader.h"
 
-// This little module emulates PICA's vertex shader's post transform vertex cache.
-// TODO: when parallizing the shader units, this should be refactored into a
-// 'multiton' aka 4 singletons with it's own size.
-namespace VertexCache {
-
-namespace {
-constexpr size_t cache_max_size = 256 * 256;
-constexpr size_t index_table_max_size = cache_max_size / 8;
-// testing has proven that this size produces no misses at all in most games.
-// in total the cache size is 128Kb
-constexpr size_t cache_size = 1028;
-
-// this is used to find if a vertex is in the cache
-static std::array<u8, index_table_max_size> index_table = {};
-
-#ifdef _DEBUG
-static std::array<u8, index_table_max_size> seen_table = {};
-u32 cache_misses = 0;
-#endif
-
-inline bool table_lookup(std::array<u8, index_table_max_size>& lookup, u32 position) {
-    return (lookup[position / 8] & (0x01 << (position % 8))) != 0;
-}
-
-const u8 set_true = 0xFF;
-const u8 set_false = 0;
-inline void table_set(std::array<u8, index_table_max_size>& lookup, u32 position, u8 value) {
-    const u8 mask = 0x01 << (position % 8);
-    const u32 pos = position / 8;
-    lookup[pos] = lookup[pos] ^ ((lookup[pos] ^ value) & mask);
-}
-// le cache
-static std::array<Pica::Shader::OutputVertex, cache_size> cache;
-
-// stores positions that are cached;
-static std::array<u16, cache_size> remapper = {};
-
-// used for clearing the cache;
-u32 min_index = cache_size;
-u32 max_index = 0;
-} // Anonymous namespace
-
-inline bool contains(u32 position) {
-#ifdef _DEBUG
-    if (table_lookup(seen_table, position) != table_lookup(index_table, position))
-        cache_misses++;
-#endif
-    return table_lookup(index_table, position);
-}
-
-inline Pica::Shader::OutputVertex& obtain(u32 position) {
-    return cache[position % cache_size];
-}
-
-inline void store(u32 position, Pica::Shader::OutputVertex& vertex) {
-    const u32 remap_index = position % cache_size;
-    table_set(index_table, remapper[remap_index], set_false);
-    remapper[remap_index] = position;
-    table_set(index_table, position, set_true);
-    cache[remap_index] = vertex;
-    max_index = std::max(max_index, remap_index);
-    min_index = std::min(min_index, remap_index);
-#ifdef _DEBUG
-    table_set(seen_table, position, set_true);
-#endif
-}
-
-void clear() {
-    max_index++;
-    auto result = std::minmax_element(remapper.begin() + min_index, remapper.begin() + max_index);
-    const u32 min = *result.first / 8;
-    const u32 max = *result.second / 8;
-    std::fill(index_table.begin() + min, index_table.begin() + max + 1, 0);
-    max_index = 0;
-    min_index = cache_size;
-#ifdef _DEBUG
-    seen_table.fill(0);
-    if (cache_misses > 0)
-        LOG_TRACE(HW_GPU, "The vertex cache had %d misses", cache_misses);
-    cache_misses = 0;
-#endif
-}
-
-} // VertexCache
+namespace Pica {
+
+/**
+ * Emulates the post-transform vertex cache for a single draw. Unlike the cache of the PICA, it is
+ * sized to hold every vertex in the index range of the draw, so that each vertex only needs to be
+ * shaded once. Vertices are stored in slots, which are allocated consecutively in the order the
+ * vertices are first seen.
+ */
+class VertexCache {
+public:
+    static constexpr u32 INVALID_SLOT = 0xFFFFFFFF;
+
+    /**
+     * Empties the cache and prepares it for a draw.
+     * @param min_vertex Smallest vertex id used by the draw
+     * @param max_vertex Largest vertex id used by the draw
+     * @param max_vertices Upper bound for the number of vertices that will be inserted
+     */
+    void Reset(u32 min_vertex, u32 max_vertex, size_t max_vertices);
+
+    /// Returns the slot of the given vertex, or INVALID_SLOT if it hasn't been inserted yet
+    u32 Lookup(u32 vertex) {
+        ASSERT(vertex >= min_vertex && vertex - min_vertex < slot_table.size());
+
+        const u32 slot = slot_table[vertex - min_vertex];
+        if (slot != INVALID_SLOT)
+            ++hits;
+        else
+            ++misses;
+        return slot;
+    }
+
+    /**
+     * Allocates the next slot for a vertex that isn't in the cache yet. The slot contents are
+     * expected to be written by the caller.
+     */
+    u32 Insert(u32 vertex) {
+        ASSERT(vertices.size() < vertices.capacity());
+
+        const u32 slot = static_cast<u32>(vertices.size());
+        slot_table[vertex - min_vertex] = slot;
+        vertices.emplace_back();
+        return slot;
+    }
+
+    /// Returns the vertex stored in the given slot. Slots stay valid until the next Reset.
+    Shader::OutputVertex& GetVertex(u32 slot) {
+        return vertices[slot];
+    }
+
+    /// Returns the number of allocated slots
+    size_t GetSize() const {
+        return vertices.size();
+    }
+
+    /// Number of lookups that found the vertex since the last Reset
+    unsigned GetHits() const {
+        return hits;
+    }
+
+    /// Number of lookups that didn't find the vertex since the last Reset
+    unsigned GetMisses() const {
+        return misses;
+    }
+
+private:
+    u32 min_vertex = 0;
+    /// Slot of each vertex in the index range, indexed by vertex id minus min_vertex
+    std::vector<u32> slot_table;
+    std::vector<Shader::OutputVertex> vertices;
+
+    unsigned hits = 0;
+    unsigned misses = 0;
+};
+
+} // namespace Pica
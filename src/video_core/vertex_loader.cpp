@@ -1,9 +1,11 @@
 #include <memory>
+#include <unordered_map>
 #include <boost/range/algorithm/fill.hpp>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "common/bit_field.h"
 #include "common/common_types.h"
+#include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
@@ -14,8 +16,17 @@
 #include "video_core/shader/shader.h"
 #include "video_core/vertex_loader.h"
 
+#ifdef ARCHITECTURE_x86_64
+#include "video_core/vertex_loader_jit_x64.h"
+#endif
+
 namespace Pica {
 
+#ifdef ARCHITECTURE_x86_64
+/// Compiled loaders, indexed by a hash of the attribute configuration they were compiled for
+static std::unordered_map<u64, std::unique_ptr<VertexLoaderJit>> compiled_loaders;
+#endif
+
 void VertexLoader::Setup(const Pica::Regs& regs) {
     ASSERT_MSG(!is_setup, "VertexLoader is not intended to be setup more than once.");
 
@@ -68,10 +79,22 @@ void VertexLoader::Setup(const Pica::Regs& regs) {
     }
 
     is_setup = true;
+
+#ifdef ARCHITECTURE_x86_64
+    // The base address is only needed at runtime, so it doesn't take part in the lookup
+    const u8* config = reinterpret_cast<const u8*>(&attribute_config) + sizeof(u32);
+    u64 cache_key = Common::ComputeHash64(config, sizeof(attribute_config) - sizeof(u32));
+
+    auto iter = compiled_loaders.find(cache_key);
+    if (iter == compiled_loaders.end()) {
+        iter = compiled_loaders.emplace(cache_key, std::make_unique<VertexLoaderJit>(*this)).first;
+    }
+    compiled_loader = iter->second.get();
+#endif
 }
 
 void VertexLoader::LoadVertex(u32 base_address, int index, int vertex, Shader::InputVertex& input,
-                              DebugUtils::MemoryAccessTracker& memory_accesses) {
+                              DebugUtils::MemoryAccessTracker& memory_accesses) const {
     ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
 
     for (int i = 0; i < num_total_attributes; ++i) {
@@ -155,4 +178,30 @@ void VertexLoader::LoadVertex(u32 base_address, int index, int vertex, Shader::I
     }
 }
 
+void VertexLoader::LoadVertices(u32 base_address, const u32* vertices, size_t count,
+                                Shader::InputVertex* inputs,
+                                DebugUtils::MemoryAccessTracker& memory_accesses) const {
+    ASSERT_MSG(is_setup, "A VertexLoader needs to be setup before loading vertices.");
+
+#ifdef ARCHITECTURE_x86_64
+    // The compiled loader doesn't record memory accesses
+    if (compiled_loader != nullptr && !(g_debug_context && g_debug_context->recorder)) {
+        std::array<const u8*, 12> attribute_pointers{};
+        for (int i = 0; i < 12; ++i) {
+            if (vertex_attribute_elements[i] != 0) {
+                attribute_pointers[i] =
+                    Memory::GetPhysicalPointer(base_address + vertex_attribute_sources[i]);
+            }
+        }
+
+        compiled_loader->Run(attribute_pointers, vertices, count, inputs);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < count; ++i) {
+        LoadVertex(base_address, static_cast<int>(i), vertices[i], inputs[i], memory_accesses);
+    }
+}
+
 } // namespace Pica
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
 #include "common/common_types.h"
 #include "video_core/pica.h"
 
@@ -14,6 +15,8 @@ namespace Shader {
 struct InputVertex;
 }
 
+class VertexLoaderJit;
+
 class VertexLoader {
 public:
     VertexLoader() = default;
@@ -23,7 +26,20 @@ public:
 
     void Setup(const Pica::Regs& regs);
     void LoadVertex(u32 base_address, int index, int vertex, Shader::InputVertex& input,
-                    DebugUtils::MemoryAccessTracker& memory_accesses);
+                    DebugUtils::MemoryAccessTracker& memory_accesses) const;
+
+    /**
+     * Loads a batch of vertices. Uses a loader compiled for the current attribute configuration
+     * if available, falling back to LoadVertex otherwise.
+     * @param base_address Physical address the vertex attribute offsets are relative to
+     * @param vertices Ids of the vertices to load
+     * @param count Number of vertices to load
+     * @param inputs Array receiving `count` loaded vertices
+     * @param memory_accesses Tracker for the memory read by the loader
+     */
+    void LoadVertices(u32 base_address, const u32* vertices, size_t count,
+                      Shader::InputVertex* inputs,
+                      DebugUtils::MemoryAccessTracker& memory_accesses) const;
 
     int GetNumTotalAttributes() const {
         return num_total_attributes;
@@ -37,6 +53,11 @@ private:
     std::array<bool, 16> vertex_attribute_is_default;
     int num_total_attributes = 0;
     bool is_setup = false;
+
+    /// Loader compiled for this attribute configuration, owned by the global loader cache
+    const VertexLoaderJit* compiled_loader = nullptr;
+
+    friend class VertexLoaderJit;
 };
 
 } // namespace Pica
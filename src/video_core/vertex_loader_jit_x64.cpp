@@ -0,0 +1,190 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <xmmintrin.h>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/x64/xbyak_abi.h"
+#include "video_core/pica.h"
+#include "video_core/pica_state.h"
+#include "video_core/shader/shader.h"
+#include "video_core/vertex_loader.h"
+#include "video_core/vertex_loader_jit_x64.h"
+
+using namespace Common::X64;
+using namespace Xbyak::util;
+using Xbyak::Label;
+using Xbyak::Reg32;
+using Xbyak::Reg64;
+using Xbyak::Xmm;
+
+namespace Pica {
+
+/// Memory allocated for each compiled vertex loader
+constexpr size_t MAX_LOADER_SIZE = 1024 * 4;
+
+// Only caller-saved registers are used, so that the loader doesn't need to touch the stack. The
+// parameters are moved out of the ABI parameter registers first, which frees RCX, RDX and R8 to be
+// used as scratch registers on both the Microsoft and the System V ABI.
+
+/// Pointer to the array of per-attribute host pointers
+static const Reg64 ATTRIBUTE_POINTERS = r10;
+/// Pointer to the id of the current vertex
+static const Reg64 VERTEX_ID = r11;
+/// Number of vertices left to load
+static const Reg64 COUNT = r9;
+/// Pointer to the current InputVertex
+static const Reg64 INPUT = rax;
+/// Id of the current vertex
+static const Reg64 VERTEX = rcx;
+/// Address of the current attribute data
+static const Reg64 SOURCE = rdx;
+/// Scratch register used for loading small integer attributes
+static const Reg32 SCRATCH = r8d;
+/// (0, 0, 0, 1), used to fill in the components missing from an attribute
+static const Xmm DEFAULT_W = xmm1;
+
+VertexLoaderJit::VertexLoaderJit(const VertexLoader& loader)
+    : Xbyak::CodeGenerator(MAX_LOADER_SIZE) {
+    program = (CompiledLoader*)getCurr();
+
+    // Windows passes the fourth parameter in R9, so it has to be moved out before COUNT is set
+    mov(ATTRIBUTE_POINTERS, ABI_PARAM1);
+    mov(VERTEX_ID, ABI_PARAM2);
+    mov(INPUT, ABI_PARAM4);
+    mov(COUNT, ABI_PARAM3);
+
+    Label end;
+    test(COUNT, COUNT);
+    jz(end);
+
+    static const __m128 default_w = {0.f, 0.f, 0.f, 1.f};
+    mov(SOURCE, reinterpret_cast<size_t>(&default_w));
+    movaps(DEFAULT_W, xword[SOURCE]);
+
+    Label loop;
+    L(loop);
+    mov(VERTEX.cvt32(), dword[VERTEX_ID]);
+
+    for (int i = 0; i < loader.num_total_attributes; ++i) {
+        const size_t input_offset = i * sizeof(Math::Vec4<float24>);
+        const u32 elements = loader.vertex_attribute_elements[i];
+
+        if (elements == 0) {
+            if (loader.vertex_attribute_is_default[i]) {
+                mov(SOURCE, reinterpret_cast<size_t>(&g_state.vs_default_attributes[i]));
+                movups(xmm0, xword[SOURCE]);
+                movaps(xword[INPUT + input_offset], xmm0);
+            }
+            // Otherwise the attribute retains its previous value, see VertexLoader::LoadVertex
+            continue;
+        }
+
+        imul(SOURCE, VERTEX, loader.vertex_attribute_strides[i]);
+        add(SOURCE, qword[ATTRIBUTE_POINTERS + i * sizeof(const u8*)]);
+
+        switch (loader.vertex_attribute_formats[i]) {
+        case Regs::VertexAttributeFormat::BYTE:
+        case Regs::VertexAttributeFormat::UBYTE:
+            // Only read the bytes that belong to the attribute
+            switch (elements) {
+            case 1:
+                movzx(SCRATCH, byte[SOURCE]);
+                break;
+            case 2:
+                movzx(SCRATCH, word[SOURCE]);
+                break;
+            case 3:
+                movzx(SCRATCH, byte[SOURCE + 2]);
+                shl(SCRATCH, 16);
+                or(SCRATCH.cvt16(), word[SOURCE]);
+                break;
+            case 4:
+                mov(SCRATCH, dword[SOURCE]);
+                break;
+            }
+            movd(xmm0, SCRATCH);
+
+            if (loader.vertex_attribute_formats[i] == Regs::VertexAttributeFormat::BYTE) {
+                // Sign-extend by moving each byte into the top of its dword
+                punpcklbw(xmm0, xmm0);
+                punpcklwd(xmm0, xmm0);
+                psrad(xmm0, 24);
+            } else {
+                pxor(xmm2, xmm2);
+                punpcklbw(xmm0, xmm2);
+                punpcklwd(xmm0, xmm2);
+            }
+            cvtdq2ps(xmm0, xmm0);
+            break;
+
+        case Regs::VertexAttributeFormat::SHORT:
+            switch (elements) {
+            case 1:
+                movzx(SCRATCH, word[SOURCE]);
+                movd(xmm0, SCRATCH);
+                break;
+            case 2:
+                movd(xmm0, dword[SOURCE]);
+                break;
+            case 3:
+                movd(xmm0, dword[SOURCE]);
+                pinsrw(xmm0, word[SOURCE + 4], 2);
+                break;
+            case 4:
+                movq(xmm0, qword[SOURCE]);
+                break;
+            }
+
+            // Sign-extend by moving each word into the top of its dword
+            punpcklwd(xmm0, xmm0);
+            psrad(xmm0, 16);
+            cvtdq2ps(xmm0, xmm0);
+            break;
+
+        case Regs::VertexAttributeFormat::FLOAT:
+            // Values are copied bit by bit, just like float24::FromFloat32 does
+            switch (elements) {
+            case 1:
+                movss(xmm0, dword[SOURCE]);
+                break;
+            case 2:
+                movq(xmm0, qword[SOURCE]);
+                break;
+            case 3:
+                movq(xmm0, qword[SOURCE]);
+                movss(xmm2, dword[SOURCE + 8]);
+                movlhps(xmm0, xmm2);
+                break;
+            case 4:
+                movups(xmm0, xword[SOURCE]);
+                break;
+            }
+            break;
+        }
+
+        // Components that weren't loaded are zero at this point, so this sets them to (0, 0, 0, 1)
+        if (elements < 4) {
+            orps(xmm0, DEFAULT_W);
+        }
+
+        movaps(xword[INPUT + input_offset], xmm0);
+    }
+
+    add(VERTEX_ID, sizeof(u32));
+    add(INPUT, sizeof(Shader::InputVertex));
+    sub(COUNT, 1);
+    jnz(loop);
+
+    L(end);
+    ret();
+
+    ready();
+
+    ASSERT_MSG(getSize() <= MAX_LOADER_SIZE,
+               "Compiled a vertex loader that exceeds the allocated size!");
+    LOG_DEBUG(HW_GPU, "Compiled vertex loader size=%lu", getSize());
+}
+
+} // namespace Pica
@@ -0,0 +1,48 @@
+// Copyright 2016 Citra Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <xbyak.h>
+#include "common/common_types.h"
+
+namespace Pica {
+
+class VertexLoader;
+
+namespace Shader {
+struct InputVertex;
+}
+
+/**
+ * Vertex loader specialized for a single vertex attribute configuration. All per-attribute
+ * decisions (format, element count, stride, default attributes) are made at compile time, so that
+ * the generated code only has to convert the attribute data of each vertex.
+ */
+class VertexLoaderJit : public Xbyak::CodeGenerator {
+public:
+    explicit VertexLoaderJit(const VertexLoader& loader);
+
+    /**
+     * Loads a batch of vertices.
+     * @param attribute_pointers Host pointer to the data of vertex 0 for each attribute
+     * @param vertices Ids of the vertices to load
+     * @param count Number of vertices to load
+     * @param inputs Array receiving `count` loaded vertices
+     */
+    void Run(const std::array<const u8*, 12>& attribute_pointers, const u32* vertices,
+             size_t count, Shader::InputVertex* inputs) const {
+        program(attribute_pointers.data(), vertices, count, inputs);
+    }
+
+private:
+    using CompiledLoader = void(const u8* const* attribute_pointers, const u32* vertices,
+                                size_t count, Shader::InputVertex* inputs);
+
+    CompiledLoader* program = nullptr;
+};
+
+} // namespace Pica
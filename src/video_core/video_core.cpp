@@ -19,9 +19,15 @@ std::unique_ptr<RendererBase> g_renderer; ///< Renderer plugin
 
 std::atomic<bool> g_hw_renderer_enabled;
 std::atomic<bool> g_shader_jit_enabled;
+std::atomic<u16> g_sw_rasterizer_threads;
+std::atomic<u16> g_vertex_shader_threads;
+std::atomic<bool> g_disk_shader_cache_enabled;
+std::atomic<bool> g_async_shader_compilation;
 std::atomic<bool> g_vsync_enabled;
 std::atomic<bool> g_toggle_framelimit_enabled;
 
+u64 g_program_id = 0;
+
 /// Initialize the video core
 bool Init(EmuWindow* emu_window) {
     Pica::Init();
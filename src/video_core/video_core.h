@@ -6,6 +6,7 @@
 
 #include <atomic>
 #include <memory>
+#include "common/common_types.h"
 
 class EmuWindow;
 class RendererBase;
@@ -37,8 +38,18 @@ extern EmuWindow* g_emu_window;                  ///< Emu window
 // qt ui)
 extern std::atomic<bool> g_hw_renderer_enabled;
 extern std::atomic<bool> g_shader_jit_enabled;
+/// Number of threads used by the software rasterizer, 0 selects one per host core
+extern std::atomic<u16> g_sw_rasterizer_threads;
+/// Number of threads used for vertex processing of large draws, 0 selects one per host core
+extern std::atomic<u16> g_vertex_shader_threads;
+extern std::atomic<bool> g_disk_shader_cache_enabled;
+/// Whether the shader JIT compiles on a worker thread, running the interpreter in the meantime
+extern std::atomic<bool> g_async_shader_compilation;
 extern std::atomic<bool> g_toggle_framelimit_enabled;
 
+/// Program id of the running title, used to find its persistent caches. 0 if there is none.
+extern u64 g_program_id;
+
 /// Start the video core
 void Start();
 